@@ -0,0 +1,237 @@
+﻿#ifndef GDS_GDSBBOX_H
+#define GDS_GDSBBOX_H
+
+/// @file YmGds/GdsBBox.h
+/// @brief GdsBBox のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsBBox GdsBBox.h "YmGds/GdsBBox.h"
+/// @brief 座標軸に平行な外接矩形を表すクラス
+///
+/// 点を一つも含まない空の状態を持つ．
+//////////////////////////////////////////////////////////////////////
+class GdsBBox
+{
+public:
+
+  /// @brief 空のコンストラクタ
+  GdsBBox();
+
+  /// @brief 範囲を指定したコンストラクタ
+  /// @param[in] xmin, ymin 左下の座標
+  /// @param[in] xmax, ymax 右上の座標
+  GdsBBox(ymint32 xmin,
+	  ymint32 ymin,
+	  ymint32 xmax,
+	  ymint32 ymax);
+
+  /// @brief デストラクタ
+  ~GdsBBox();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 空の時 true を返す．
+  bool
+  is_empty() const;
+
+  /// @brief X 座標の最小値を返す．
+  ymint32
+  xmin() const;
+
+  /// @brief Y 座標の最小値を返す．
+  ymint32
+  ymin() const;
+
+  /// @brief X 座標の最大値を返す．
+  ymint32
+  xmax() const;
+
+  /// @brief Y 座標の最大値を返す．
+  ymint32
+  ymax() const;
+
+  /// @brief 点を追加する．
+  /// @param[in] x, y 座標
+  void
+  add_point(ymint32 x,
+	    ymint32 y);
+
+  /// @brief 他の矩形を含むように拡張する．
+  /// @param[in] src 対象の矩形
+  void
+  merge(const GdsBBox& src);
+
+  /// @brief 他の矩形と重なりを持つ時 true を返す．
+  /// @param[in] src 対象の矩形
+  ///
+  /// 辺が接しているだけの場合も true を返す．
+  bool
+  intersect(const GdsBBox& src) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // X 座標の最小値
+  ymint32 mXmin;
+
+  // Y 座標の最小値
+  ymint32 mYmin;
+
+  // X 座標の最大値
+  ymint32 mXmax;
+
+  // Y 座標の最大値
+  ymint32 mYmax;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief 空のコンストラクタ
+inline
+GdsBBox::GdsBBox() :
+  mXmin(1),
+  mYmin(1),
+  mXmax(0),
+  mYmax(0)
+{
+}
+
+// @brief 範囲を指定したコンストラクタ
+// @param[in] xmin, ymin 左下の座標
+// @param[in] xmax, ymax 右上の座標
+inline
+GdsBBox::GdsBBox(ymint32 xmin,
+		 ymint32 ymin,
+		 ymint32 xmax,
+		 ymint32 ymax) :
+  mXmin(xmin),
+  mYmin(ymin),
+  mXmax(xmax),
+  mYmax(ymax)
+{
+}
+
+// @brief デストラクタ
+inline
+GdsBBox::~GdsBBox()
+{
+}
+
+// @brief 空の時 true を返す．
+inline
+bool
+GdsBBox::is_empty() const
+{
+  return mXmin > mXmax;
+}
+
+// @brief X 座標の最小値を返す．
+inline
+ymint32
+GdsBBox::xmin() const
+{
+  return mXmin;
+}
+
+// @brief Y 座標の最小値を返す．
+inline
+ymint32
+GdsBBox::ymin() const
+{
+  return mYmin;
+}
+
+// @brief X 座標の最大値を返す．
+inline
+ymint32
+GdsBBox::xmax() const
+{
+  return mXmax;
+}
+
+// @brief Y 座標の最大値を返す．
+inline
+ymint32
+GdsBBox::ymax() const
+{
+  return mYmax;
+}
+
+// @brief 点を追加する．
+// @param[in] x, y 座標
+inline
+void
+GdsBBox::add_point(ymint32 x,
+		   ymint32 y)
+{
+  if ( is_empty() ) {
+    mXmin = mXmax = x;
+    mYmin = mYmax = y;
+    return;
+  }
+  if ( mXmin > x ) {
+    mXmin = x;
+  }
+  if ( mXmax < x ) {
+    mXmax = x;
+  }
+  if ( mYmin > y ) {
+    mYmin = y;
+  }
+  if ( mYmax < y ) {
+    mYmax = y;
+  }
+}
+
+// @brief 他の矩形を含むように拡張する．
+// @param[in] src 対象の矩形
+inline
+void
+GdsBBox::merge(const GdsBBox& src)
+{
+  if ( src.is_empty() ) {
+    return;
+  }
+  add_point(src.mXmin, src.mYmin);
+  add_point(src.mXmax, src.mYmax);
+}
+
+// @brief 他の矩形と重なりを持つ時 true を返す．
+// @param[in] src 対象の矩形
+//
+// 辺が接しているだけの場合も true を返す．
+inline
+bool
+GdsBBox::intersect(const GdsBBox& src) const
+{
+  if ( is_empty() || src.is_empty() ) {
+    return false;
+  }
+  return mXmin <= src.mXmax && src.mXmin <= mXmax &&
+    mYmin <= src.mYmax && src.mYmin <= mYmax;
+}
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSBBOX_H
@@ -0,0 +1,357 @@
+﻿#ifndef GDS_GDSBOOLEAN_H
+#define GDS_GDSBOOLEAN_H
+
+/// @file YmGds/GdsBoolean.h
+/// @brief GdsBoolean のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsGeom.h"
+#include "YmGds/GdsBBox.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsBoolean GdsBoolean.h "YmGds/GdsBoolean.h"
+/// @brief 多角形の集合どうしの論理演算を行うクラス
+///
+/// 二つの多角形の集合 A ( set_id = 0 ) と B ( set_id = 1 ) を
+/// 登録して compute() を呼ぶと結果の多角形が得られる．
+/// 各集合の中の多角形は重なっていてもよい(和をとったものとみなす)．
+///
+/// 走査線法で y 方向のスラブに区切り，結果を台形の集合として求める．
+/// 上下に隣接して左右の辺が同一直線上にある台形は一つにまとめる．
+/// すべての辺が座標軸に平行な場合は辺の交差を調べずに済ませ，
+/// 結果は矩形となる．
+/// それ以外の場合は交差する辺をあらかじめ交点で分割しておく．
+/// 交点は整数座標に丸められるが，すべての辺が座標軸に平行か
+/// 45度の場合には交点が半整数になる場合を除いて誤差はない．
+///
+/// y 方向をタイル(帯)に分割して並列に処理し，タイルの境界で
+/// 分断された台形は最後につなぎ合わせる．
+//////////////////////////////////////////////////////////////////////
+class GdsBoolean
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsBoolean();
+
+  /// @brief デストラクタ
+  ~GdsBoolean();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief タイル数を設定する．
+  /// @param[in] num タイル数
+  ///
+  /// 0 の時はスレッド数から決める．
+  void
+  set_tile_num(ymuint num);
+
+  /// @brief 結果を切り出す矩形を設定する．
+  /// @param[in] bbox 矩形
+  ///
+  /// 空の矩形を与えると切り出しを行わない．
+  void
+  set_clip(const GdsBBox& bbox);
+
+  /// @brief 登録した多角形と結果をクリアする．
+  ///
+  /// 切り出す矩形はクリアしない．
+  void
+  clear();
+
+  /// @brief 多角形を登録する．
+  /// @param[in] set_id 集合番号 ( 0 or 1 )
+  /// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+  /// @param[in] n 頂点数
+  ///
+  /// 頂点の向きはどちらでもよい．
+  void
+  add_polygon(ymuint set_id,
+	      const ymint32* data,
+	      ymuint n);
+
+  /// @brief 変換を施した多角形を登録する．
+  /// @param[in] set_id 集合番号 ( 0 or 1 )
+  /// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+  /// @param[in] n 頂点数
+  /// @param[in] trans 座標変換
+  void
+  add_polygon(ymuint set_id,
+	      const ymint32* data,
+	      ymuint n,
+	      const GdsTrans& trans);
+
+  /// @brief 構造中の図形を登録する．
+  /// @param[in] set_id 集合番号 ( 0 or 1 )
+  /// @param[in] str 対象の構造
+  /// @param[in] layer 層番号
+  /// @param[in] datatype データ型 ( 負の時は任意 )
+  /// @param[in] flatten true の時は SREF/AREF を展開する．
+  ///
+  /// BOUNDARY/BOX と PATH の輪郭を対象とする．
+  void
+  add_struct(ymuint set_id,
+	     const GdsStruct* str,
+	     int layer,
+	     int datatype,
+	     bool flatten);
+
+  /// @brief 論理演算を行う．
+  /// @param[in] op 演算の種類
+  ///
+  /// 登録された多角形はそのまま残る．
+  void
+  compute(GdsBoolOp op);
+
+  /// @brief 結果の多角形の数を返す．
+  ymuint
+  polygon_num() const;
+
+  /// @brief 結果の多角形の頂点数を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+  ymuint
+  point_num(ymuint pos) const;
+
+  /// @brief 結果の多角形の座標の配列を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+  ///
+  /// x0, y0, x1, y1, ... の順に point_num(pos) * 2 個の要素を持つ．
+  /// 頂点は反時計回りに並ぶ．
+  const ymint32*
+  polygon_data(ymuint pos) const;
+
+  /// @brief 結果の面積の2倍を返す．
+  tGdsInt128
+  area2() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 辺
+  // 水平な辺は登録しない．
+  struct Edge
+  {
+    // 下端の座標
+    ymint32 mX0;
+    ymint32 mY0;
+
+    // 上端の座標 ( mY1 > mY0 )
+    ymint32 mX1;
+    ymint32 mY1;
+
+    // 向き ( 多角形の向きを正にそろえた時，上向きなら 1，下向きなら -1 )
+    ymint8 mWind;
+
+    // 集合番号
+    // 切り出す矩形の辺は 2 となる．
+    ymuint8 mSet;
+  };
+
+  // 辺の交差
+  struct Crossing
+  {
+    // 辺の番号
+    ymuint32 mEdge1;
+    ymuint32 mEdge2;
+
+    // 交点(丸めたもの)
+    ymint32 mX;
+    ymint32 mY;
+  };
+
+  // 結果の台形
+  // 左右の辺は Edge の番号で表す．
+  struct Trap
+  {
+    // 下端の y 座標
+    ymint32 mYb;
+
+    // 上端の y 座標
+    ymint32 mYt;
+
+    // 左の辺
+    ymuint32 mLeft;
+
+    // 右の辺
+    ymuint32 mRight;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 構造中の図形を登録する．
+  /// @param[in] set_id 集合番号 ( 0 or 1 )
+  /// @param[in] str 対象の構造
+  /// @param[in] layer 層番号
+  /// @param[in] datatype データ型 ( 負の時は任意 )
+  /// @param[in] flatten true の時は SREF/AREF を展開する．
+  /// @param[in] trans 座標変換
+  /// @param[in] expander PATH の展開に用いるオブジェクト
+  void
+  add_struct_sub(ymuint set_id,
+		 const GdsStruct* str,
+		 int layer,
+		 int datatype,
+		 bool flatten,
+		 const GdsTrans& trans,
+		 GdsPathExpander& expander);
+
+  /// @brief y 方向のタイルに分割する．
+  /// @param[out] bound_list タイルの境界の y 座標のリスト
+  /// @param[out] tile_edge_array タイルごとの辺の番号のリスト
+  ///
+  /// タイルの境界は辺の下端の y 座標の分布から決める．
+  /// tile_edge_array の各リストは max(mY0, ylo) の昇順に並ぶ．
+  void
+  make_tiles(vector<ymint32>& bound_list,
+	     vector<vector<ymuint32> >& tile_edge_array) const;
+
+  /// @brief 走査線を止める y 座標のリストを作る．
+  /// @param[in] edge_list 対象の辺の番号のリスト
+  /// @param[in] ylo, yhi タイルの範囲
+  /// @param[out] event_list 結果を格納するリスト
+  ///
+  /// event_list は昇順に並び，ylo と yhi を含む．
+  void
+  make_events(const vector<ymuint32>& edge_list,
+	      ymint32 ylo,
+	      ymint32 yhi,
+	      vector<ymint32>& event_list) const;
+
+  /// @brief 一つのタイルの中で辺の交差を求める．
+  /// @param[in] edge_list 対象の辺の番号のリスト
+  /// @param[in] ylo, yhi タイルの範囲
+  /// @param[out] crossing_list 結果を格納するリスト
+  ///
+  /// 端点での接触は交差とみなさない．
+  void
+  find_crossings(const vector<ymuint32>& edge_list,
+		 ymint32 ylo,
+		 ymint32 yhi,
+		 vector<Crossing>& crossing_list) const;
+
+  /// @brief 辺を交点で分割する．
+  /// @param[in] crossing_list 交差のリスト
+  void
+  split_edges(const vector<Crossing>& crossing_list);
+
+  /// @brief 一つのタイルの中を走査する．
+  /// @param[in] edge_list 対象の辺の番号のリスト
+  /// @param[in] ylo, yhi タイルの範囲
+  /// @param[in] op 演算の種類
+  /// @param[in] manhattan すべての辺が垂直の時 true
+  /// @param[out] trap_list 結果の台形を格納するリスト
+  ///
+  /// edge_list は max(mY0, ylo) の昇順に並んでいなければならない．
+  void
+  sweep(const vector<ymuint32>& edge_list,
+	ymint32 ylo,
+	ymint32 yhi,
+	GdsBoolOp op,
+	bool manhattan,
+	vector<Trap>& trap_list) const;
+
+  /// @brief 辺の y における x 座標を返す．
+  /// @param[in] edge 辺
+  /// @param[in] y y 座標
+  ///
+  /// 最も近い整数に丸める．
+  static
+  ymint64
+  x_at(const Edge& edge,
+       ymint64 y);
+
+  /// @brief 二つの辺の y における x 座標を比較する．
+  /// @param[in] edge1, edge2 辺
+  /// @param[in] y y 座標
+  /// @return edge1 が左なら負，右なら正，一致していたら 0 を返す．
+  static
+  int
+  compare_at(const Edge& edge1,
+	     const Edge& edge2,
+	     ymint64 y);
+
+  /// @brief 二つの辺の交点を求める．
+  /// @param[in] edge1, edge2 辺
+  /// @param[out] x, y 交点の座標
+  ///
+  /// 結果は最も近い整数に丸める．
+  static
+  void
+  crossing_point(const Edge& edge1,
+		 const Edge& edge2,
+		 ymint32& x,
+		 ymint32& y);
+
+  /// @brief 除算の結果を最も近い整数に丸める．
+  /// @param[in] num 分子
+  /// @param[in] den 分母 ( 0 以外 )
+  static
+  ymint64
+  round_div(tGdsInt128 num,
+	    tGdsInt128 den);
+
+  /// @brief 二つの辺が同一直線上にある時 true を返す．
+  static
+  bool
+  collinear(const Edge& edge1,
+	    const Edge& edge2);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // タイル数
+  ymuint32 mTileNum;
+
+  // 切り出す矩形
+  GdsBBox mClip;
+
+  // 登録された辺のリスト
+  vector<Edge> mEdgeList;
+
+  // 交点で分割した辺のリスト
+  vector<Edge> mWorkEdgeList;
+
+  // 結果の頂点のプール
+  vector<ymint32> mPool;
+
+  // 結果の多角形の先頭位置(頂点単位)のリスト
+  // 末尾に番兵を持つ．
+  vector<ymuint32> mPosList;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSBOOLEAN_H
@@ -0,0 +1,263 @@
+﻿#ifndef GDS_GDSBUILDER_H
+#define GDS_GDSBUILDER_H
+
+/// @file YmGds/GdsBuilder.h
+/// @brief GdsBuilder のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmUtils/SimpleAlloc.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsBuilder GdsBuilder.h "YmGds/GdsBuilder.h"
+/// @brief GdsData とその部品を作るクラス
+///
+/// GdsParser と GdsOasisParser はこのクラスを通してデータを作る．
+/// データのクラスの内部に触れるのはこのクラスだけである．
+/// 作ったものはすべてこのオブジェクトのメモリ上にあり，
+/// このオブジェクトが破壊されるまで有効である．
+//////////////////////////////////////////////////////////////////////
+class GdsBuilder
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsBuilder();
+
+  /// @brief デストラクタ
+  ~GdsBuilder();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 部品を作る関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief GdsData を作る．
+  /// @param[in] version バージョン番号
+  /// @param[in] date 2つの日時の配列
+  /// @param[in] libdirsize LIBDIRSIZE の値
+  /// @param[in] srfname SRFNAME の値
+  /// @param[in] acl LIBSECURE の値
+  /// @param[in] libname LIBNAME の値
+  /// @param[in] reflibs REFLIBS の値
+  /// @param[in] fonts FONTS の値
+  /// @param[in] attrtable ATTRTABLE の値
+  /// @param[in] generations GENERATIONS の値
+  /// @param[in] format フォーマット情報
+  /// @param[in] units UNITS の値
+  GdsData*
+  new_data(ymint16 version,
+	   GdsDate* date,
+	   ymint16 libdirsize,
+	   GdsString* srfname,
+	   GdsACL* acl,
+	   GdsString* libname,
+	   GdsString* reflibs,
+	   GdsString* fonts,
+	   GdsString* attrtable,
+	   ymint16 generations,
+	   GdsFormat* format,
+	   GdsUnits* units);
+
+  /// @brief 2つの日時の配列を作る．
+  ///
+  /// 値は GdsDate::set() で設定する．
+  GdsDate*
+  new_date();
+
+  /// @brief GdsString を作る．
+  /// @param[in] str 文字列の先頭
+  /// @param[in] len 文字列の長さ
+  GdsString*
+  new_string(const char* str,
+	     ymuint len);
+
+  /// @brief GdsXY を作る．
+  /// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+  /// @param[in] num 点の数
+  GdsXY*
+  new_xy(const ymint32* data,
+	 ymuint num);
+
+  /// @brief GdsUnits を作る．
+  /// @param[in] user user unit
+  /// @param[in] meter meter unit
+  GdsUnits*
+  new_units(double user,
+	    double meter);
+
+  /// @brief GdsACL を作る．
+  /// @param[in] group グループ番号
+  /// @param[in] user ユーザー番号
+  /// @param[in] access アクセス権
+  /// @param[in] next 次の要素
+  GdsACL*
+  new_acl(ymuint group,
+	  ymuint user,
+	  ymuint access,
+	  GdsACL* next);
+
+  /// @brief GdsFormat を作る．
+  /// @param[in] type FORMAT の値
+  /// @param[in] masks MASK の値のリスト
+  GdsFormat*
+  new_format(ymint16 type,
+	     const vector<GdsString*>& masks);
+
+  /// @brief GdsStrans を作る．
+  /// @param[in] flags STRANS の値
+  /// @param[in] mag MAG の値
+  /// @param[in] angle ANGLE の値
+  GdsStrans*
+  new_strans(ymuint16 flags,
+	     double mag,
+	     double angle);
+
+  /// @brief GdsStruct を作る．
+  /// @param[in] date 2つの日時の配列
+  /// @param[in] name 構造名
+  GdsStruct*
+  new_struct(GdsDate* date,
+	     GdsString* name);
+
+  /// @brief BOUNDARY を作る．
+  GdsElement*
+  new_boundary(ymuint16 elflags,
+	       ymint32 plex,
+	       ymint16 layer,
+	       ymint16 datatype,
+	       GdsXY* xy);
+
+  /// @brief PATH を作る．
+  GdsElement*
+  new_path(ymuint16 elflags,
+	   ymint32 plex,
+	   ymint16 layer,
+	   ymint16 datatype,
+	   ymint16 pathtype,
+	   ymint32 width,
+	   ymint32 bgn_extn,
+	   ymint32 end_extn,
+	   GdsXY* xy);
+
+  /// @brief SREF を作る．
+  GdsElement*
+  new_sref(ymuint16 elflags,
+	   ymint32 plex,
+	   GdsString* strname,
+	   GdsStrans* strans,
+	   GdsXY* xy);
+
+  /// @brief AREF を作る．
+  GdsElement*
+  new_aref(ymuint16 elflags,
+	   ymint32 plex,
+	   GdsString* strname,
+	   GdsStrans* strans,
+	   ymuint32 colrow,
+	   GdsXY* xy);
+
+  /// @brief TEXT を作る．
+  GdsElement*
+  new_text(ymuint16 elflags,
+	   ymint32 plex,
+	   ymint16 layer,
+	   ymint16 texttype,
+	   ymuint16 presentation,
+	   ymint16 pathtype,
+	   ymint32 width,
+	   GdsStrans* strans,
+	   GdsXY* xy,
+	   GdsString* body);
+
+  /// @brief NODE を作る．
+  GdsElement*
+  new_node(ymuint16 elflags,
+	   ymint32 plex,
+	   ymint16 layer,
+	   ymint16 nodetype,
+	   GdsXY* xy);
+
+  /// @brief BOX を作る．
+  GdsElement*
+  new_box(ymuint16 elflags,
+	  ymint32 plex,
+	  ymint16 layer,
+	  ymint16 boxtype,
+	  GdsXY* xy);
+
+  /// @brief GdsProperty を作る．
+  /// @param[in] attr PROPATTR の値
+  /// @param[in] value PROPVALUE の値
+  GdsProperty*
+  new_property(ymuint attr,
+	       GdsString* value);
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 部品をつなぐ関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 構造をつなぐ．
+  /// @param[in] data 対象のデータ
+  /// @param[in] prev 直前の構造 (NULL の時は先頭につなぐ)
+  /// @param[in] str つなぐ構造
+  ///
+  /// prev の後ろにあったものは切り離される．
+  /// str を NULL にすれば prev より後ろを捨てられる．
+  static
+  void
+  link_struct(GdsData* data,
+	      GdsStruct* prev,
+	      GdsStruct* str);
+
+  /// @brief 要素をつなぐ．
+  /// @param[in] str 対象の構造
+  /// @param[in] prev 直前の要素 (NULL の時は先頭につなぐ)
+  /// @param[in] elem つなぐ要素
+  static
+  void
+  link_element(GdsStruct* str,
+	       GdsElement* prev,
+	       GdsElement* elem);
+
+  /// @brief プロパティをつなぐ．
+  /// @param[in] elem 対象の要素
+  /// @param[in] prev 直前のプロパティ (NULL の時は先頭につなぐ)
+  /// @param[in] prop つなぐプロパティ
+  static
+  void
+  link_property(GdsElement* elem,
+		GdsProperty* prev,
+		GdsProperty* prop);
+
+  /// @brief 構造の表を作り，参照を解決する．
+  /// @param[in] data 対象のデータ
+  ///
+  /// 全ての構造をつないだ後で呼ぶ．
+  void
+  make_struct_table(GdsData* data);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // メモリアロケータ
+  SimpleAlloc mAlloc;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSBUILDER_H
@@ -20,7 +20,7 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 class GdsData
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 private:
 
@@ -119,6 +119,33 @@ public:
   const GdsStruct*
   struct_top() const;
 
+  /// @brief GdsStruct の数を返す．
+  ymuint
+  struct_num() const;
+
+  /// @brief GdsStruct を返す．
+  /// @param[in] id ID番号 ( 0 <= id < struct_num() )
+  const GdsStruct*
+  structure(ymuint id) const;
+
+  /// @brief 名前から GdsStruct を探す．
+  /// @param[in] name 構造名
+  ///
+  /// 見つからなければ NULL を返す．
+  const GdsStruct*
+  find_struct(const char* name) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 構造名のハッシュ値を計算する．
+  static
+  ymuint
+  hash_func(const char* name);
+
 
 private:
   //////////////////////////////////////////////////////////////////////
@@ -164,6 +191,18 @@ private:
   // GdsStruct の先頭
   GdsStruct* mStruct;
 
+  // GdsStruct の数
+  ymuint32 mStructNum;
+
+  // ID番号をキーにした GdsStruct の配列
+  GdsStruct** mStructArray;
+
+  // ハッシュ表のサイズ
+  ymuint32 mHashSize;
+
+  // 構造名をキーにしたハッシュ表
+  GdsStruct** mHashTable;
+
 };
 
 END_NAMESPACE_YM_GDS
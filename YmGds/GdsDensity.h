@@ -0,0 +1,256 @@
+﻿#ifndef GDS_GDSDENSITY_H
+#define GDS_GDSDENSITY_H
+
+/// @file YmGds/GdsDensity.h
+/// @brief GdsDensity のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsBBox.h"
+#include "YmGds/GdsTrans.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsDensity GdsDensity.h "YmGds/GdsDensity.h"
+/// @brief 層ごとの図形の被覆率をタイルの格子上で求めるクラス
+///
+/// 各構造の図形の和(重なりを除いた多角形)は一度だけ求めておき，
+/// 配置ごとに座標変換して用いる．
+/// 格子の行ごとに，その行と重なる配置だけをたどって図形を集め，
+/// タイルごとに和の面積を求める．行は並列に処理する．
+/// 配置の変換が 90 度の倍数の回転と反転だけで，図形が
+/// 座標軸に平行な場合は面積は正確に求まる．
+///
+/// 対象は BOUNDARY/BOX と PATH の輪郭で，BOX は boxtype を
+/// datatype とみなす．
+//////////////////////////////////////////////////////////////////////
+class GdsDensity
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsDensity();
+
+  /// @brief デストラクタ
+  ~GdsDensity();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief タイルの大きさを設定する．
+  /// @param[in] width 幅(database unit)
+  /// @param[in] height 高さ(database unit)
+  void
+  set_tile_size(ymint32 width,
+		ymint32 height);
+
+  /// @brief 対象の領域を設定する．
+  /// @param[in] region 領域
+  ///
+  /// 空の矩形の時は最上位の構造の外接矩形を用いる．
+  void
+  set_region(const GdsBBox& region);
+
+  /// @brief 対象の (layer, datatype) を追加する．
+  /// @param[in] layer 層番号
+  /// @param[in] datatype データ型
+  ///
+  /// 一つも追加しなかった場合はすべての (layer, datatype) を対象とする．
+  void
+  add_layer(int layer,
+	    int datatype);
+
+  /// @brief 被覆率を求める．
+  /// @param[in] data 対象のデータ
+  /// @param[in] top_name 最上位の構造名
+  /// @retval true 成功した．
+  /// @retval false 最上位の構造が決まらないか階層が循環していた．
+  ///
+  /// top_name が NULL の時は唯一の最上位の構造を用いる．
+  bool
+  compute(const GdsData& data,
+	  const char* top_name);
+
+  /// @brief 対象の (layer, datatype) の数を返す．
+  ymuint
+  layer_num() const;
+
+  /// @brief 層番号を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  int
+  layer(ymuint pos) const;
+
+  /// @brief データ型を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  int
+  datatype(ymuint pos) const;
+
+  /// @brief 実際に用いた領域を返す．
+  const GdsBBox&
+  region() const;
+
+  /// @brief X 方向のタイル数を返す．
+  ymuint
+  x_num() const;
+
+  /// @brief Y 方向のタイル数を返す．
+  ymuint
+  y_num() const;
+
+  /// @brief タイルの矩形を返す．
+  /// @param[in] ix X 方向の位置 ( 0 <= ix < x_num() )
+  /// @param[in] iy Y 方向の位置 ( 0 <= iy < y_num() )
+  ///
+  /// 右端と上端のタイルは領域で切り取られている．
+  GdsBBox
+  tile(ymuint ix,
+       ymuint iy) const;
+
+  /// @brief タイル中の図形の面積を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  /// @param[in] ix X 方向の位置 ( 0 <= ix < x_num() )
+  /// @param[in] iy Y 方向の位置 ( 0 <= iy < y_num() )
+  double
+  area(ymuint pos,
+       ymuint ix,
+       ymuint iy) const;
+
+  /// @brief タイルの被覆率を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  /// @param[in] ix X 方向の位置 ( 0 <= ix < x_num() )
+  /// @param[in] iy Y 方向の位置 ( 0 <= iy < y_num() )
+  ///
+  /// 0.0 以上 1.0 以下の値をとる．
+  double
+  density(ymuint pos,
+	  ymuint ix,
+	  ymuint iy) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 一つの構造の一つの層の図形
+  struct CellLayer
+  {
+    // 層の位置番号
+    ymuint32 mLayer;
+
+    // 頂点のプール
+    vector<ymint32> mPool;
+
+    // 多角形の先頭位置(頂点単位)のリスト
+    // 末尾に番兵を持つ．
+    vector<ymuint32> mPosList;
+  };
+
+  // 行ごとに集めた多角形
+  struct BandPolygon
+  {
+    // 頂点のプール中の先頭位置(頂点単位)
+    ymuint32 mPos;
+
+    // 頂点数
+    ymuint32 mNum;
+
+    // 外接矩形
+    GdsBBox mBBox;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 構造中の図形の和を求める．
+  /// @param[in] str 対象の構造
+  /// @param[out] cell_list 結果を格納するリスト
+  void
+  make_cell(const GdsStruct* str,
+	    vector<CellLayer>& cell_list) const;
+
+  /// @brief 行と重なる図形を集める．
+  /// @param[in] str 対象の構造
+  /// @param[in] trans 座標変換
+  /// @param[in] band 行の矩形
+  /// @param[out] pool_array 層ごとの頂点のプール
+  /// @param[out] polygon_array 層ごとの多角形のリスト
+  void
+  collect(const GdsStruct* str,
+	  const GdsTrans& trans,
+	  const GdsBBox& band,
+	  vector<vector<ymint32> >& pool_array,
+	  vector<vector<BandPolygon> >& polygon_array) const;
+
+  /// @brief 一つの行の面積を求める．
+  /// @param[in] top 最上位の構造
+  /// @param[in] iy Y 方向の位置
+  void
+  compute_band(const GdsStruct* top,
+	       ymuint iy);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // タイルの幅
+  ymint32 mTileWidth;
+
+  // タイルの高さ
+  ymint32 mTileHeight;
+
+  // 指定された領域
+  GdsBBox mReqRegion;
+
+  // 実際に用いた領域
+  GdsBBox mRegion;
+
+  // 対象の (layer, datatype) のリスト
+  // (layer << 16) | datatype の形で持つ．
+  vector<ymuint32> mKeyList;
+
+  // X 方向のタイル数
+  ymuint32 mXNum;
+
+  // Y 方向のタイル数
+  ymuint32 mYNum;
+
+  // 構造のID番号をキーにした図形の和のリスト
+  vector<vector<CellLayer> > mCellArray;
+
+  // 構造のID番号をキーにした外接矩形の配列
+  vector<GdsBBox> mBBoxArray;
+
+  // 面積の配列
+  // ( pos * mYNum + iy ) * mXNum + ix 番めの要素が対応する．
+  vector<double> mAreaArray;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSDENSITY_H
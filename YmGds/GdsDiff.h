@@ -0,0 +1,220 @@
+﻿#ifndef GDS_GDSDIFF_H
+#define GDS_GDSDIFF_H
+
+/// @file YmGds/GdsDiff.h
+/// @brief GdsDiff のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsStructHash.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsDiff GdsDiff.h "YmGds/GdsDiff.h"
+/// @brief 二つのレイアウトの構造上の差分を求めるクラス
+///
+/// 構造は名前で対応づける．
+/// 一方にしかない構造のうち内容のハッシュ値が一致するものは
+/// 名前が変わったとみなす．
+/// 同じ名前の構造はハッシュ値が一致すれば比較を省略し，
+/// 異なる場合には要素を多重集合として比較する．
+/// 要素の順番の違いは差分とみなさない．
+/// SREF/AREF は参照先の構造の名前で比較するので，
+/// 子孫の構造の変化は親の構造の差分には現れない．
+//////////////////////////////////////////////////////////////////////
+class GdsDiff
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsDiff();
+
+  /// @brief デストラクタ
+  ~GdsDiff();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief 差分を求める．
+  /// @param[in] data1 旧いデータ
+  /// @param[in] data2 新しいデータ
+  /// @retval true 成功した．
+  /// @retval false 階層が循環していた．
+  bool
+  compute(const GdsData& data1,
+	  const GdsData& data2);
+
+  /// @brief 両方にあって要素に差分のない構造の数を返す．
+  ///
+  /// 子孫の構造だけが変化したものも含む．
+  ymuint
+  same_num() const;
+
+  /// @brief data1 にだけある構造の数を返す．
+  ymuint
+  removed_num() const;
+
+  /// @brief data1 にだけある構造を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < removed_num() )
+  const GdsStruct*
+  removed(ymuint pos) const;
+
+  /// @brief data2 にだけある構造の数を返す．
+  ymuint
+  added_num() const;
+
+  /// @brief data2 にだけある構造を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < added_num() )
+  const GdsStruct*
+  added(ymuint pos) const;
+
+  /// @brief 名前が変わった構造の数を返す．
+  ymuint
+  renamed_num() const;
+
+  /// @brief 名前が変わった構造の data1 側を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < renamed_num() )
+  const GdsStruct*
+  renamed1(ymuint pos) const;
+
+  /// @brief 名前が変わった構造の data2 側を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < renamed_num() )
+  const GdsStruct*
+  renamed2(ymuint pos) const;
+
+  /// @brief 要素が変化した構造の数を返す．
+  ymuint
+  changed_num() const;
+
+  /// @brief 要素が変化した構造の data1 側を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < changed_num() )
+  const GdsStruct*
+  changed1(ymuint pos) const;
+
+  /// @brief 要素が変化した構造の data2 側を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < changed_num() )
+  const GdsStruct*
+  changed2(ymuint pos) const;
+
+  /// @brief 要素の差分の数を返す．
+  /// @param[in] pos 構造の位置番号 ( 0 <= pos < changed_num() )
+  ymuint
+  elem_diff_num(ymuint pos) const;
+
+  /// @brief 要素の差分の種類を返す．
+  /// @param[in] pos 構造の位置番号 ( 0 <= pos < changed_num() )
+  /// @param[in] idx 差分の番号 ( 0 <= idx < elem_diff_num(pos) )
+  GdsDiffType
+  elem_diff_type(ymuint pos,
+		 ymuint idx) const;
+
+  /// @brief 差分の data1 側の要素を返す．
+  /// @param[in] pos 構造の位置番号 ( 0 <= pos < changed_num() )
+  /// @param[in] idx 差分の番号 ( 0 <= idx < elem_diff_num(pos) )
+  ///
+  /// kGdsDiffAdded の時は NULL を返す．
+  const GdsElement*
+  elem_diff1(ymuint pos,
+	     ymuint idx) const;
+
+  /// @brief 差分の data2 側の要素を返す．
+  /// @param[in] pos 構造の位置番号 ( 0 <= pos < changed_num() )
+  /// @param[in] idx 差分の番号 ( 0 <= idx < elem_diff_num(pos) )
+  ///
+  /// kGdsDiffRemoved の時は NULL を返す．
+  const GdsElement*
+  elem_diff2(ymuint pos,
+	     ymuint idx) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 要素の差分
+  struct ElemDiff
+  {
+    // 種類
+    GdsDiffType mType;
+
+    // data1 側の要素
+    const GdsElement* mElem1;
+
+    // data2 側の要素
+    const GdsElement* mElem2;
+  };
+
+  // 構造の差分
+  struct StructDiff
+  {
+    // data1 側の構造
+    const GdsStruct* mStruct1;
+
+    // data2 側の構造
+    const GdsStruct* mStruct2;
+
+    // 要素の差分のリスト
+    vector<ElemDiff> mElemDiffList;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 同じ名前の構造の要素を比較する．
+  /// @param[inout] sdiff 対象の構造と結果
+  static
+  void
+  diff_elements(StructDiff& sdiff);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // 構造ごとのハッシュ値
+  GdsStructHash mHash[2];
+
+  // 要素に差分のない構造の数
+  ymuint32 mSameNum;
+
+  // data1 にだけある構造のリスト
+  vector<const GdsStruct*> mRemovedList;
+
+  // data2 にだけある構造のリスト
+  vector<const GdsStruct*> mAddedList;
+
+  // 名前が変わった構造の対のリスト
+  vector<std::pair<const GdsStruct*, const GdsStruct*> > mRenamedList;
+
+  // 要素が変化した構造のリスト
+  vector<StructDiff> mChangedList;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSDIFF_H
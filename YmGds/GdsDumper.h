@@ -18,6 +18,19 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 /// @class GdsDumper GdsDumper.h "YmGds/GdsDumper.h"
 /// @brief GDS-II ファイルの中身をダンプするためのクラス
+///
+/// 出力はいったん内部のバッファに溜めて，大きなかたまりごとに
+/// ストリームに書き出す．そのため，同じストリームに他の出力を
+/// 混ぜる場合には先に flush() を呼ぶ必要がある．
+/// デストラクタでも flush() を呼ぶ．
+///
+/// dump_file() はファイルを mmap() してレコードの境界で区切り，
+/// かたまりごとに並列に整形してからファイル中の順に書き出す．
+/// 結果は GdsScanner で読んだレコードを一つずつ渡した場合と同じになる．
+/// dump_range() は同じ処理をメモリ上の一部の範囲に対して行う．
+/// GdsStructIndex と組み合わせれば一つの構造だけを出力できる．
+///
+/// select_rtype() で出力するレコードの型を絞ることができる．
 //////////////////////////////////////////////////////////////////////
 class GdsDumper
 {
@@ -47,12 +60,123 @@ public:
   void
   operator()(const GdsScanner& scanner);
 
+  /// @brief 出力するレコードの型を選ぶ．
+  /// @param[in] rtype レコードの型
+  ///
+  /// 一度も呼ばなければすべての型を出力する．
+  void
+  select_rtype(GdsRtype rtype);
+
+  /// @brief dump_file() で用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief ファイルの中身をすべて出力する．
+  /// @param[in] filename ファイル名
+  /// @retval true 末尾まで読めた．
+  /// @retval false ファイルが読めないか形式が正しくなかった．
+  ///
+  /// 形式が正しくない場合にはその直前のレコードまで出力する．
+  bool
+  dump_file(const string& filename);
+
+  /// @brief メモリ上のレコード列の一部を出力する．
+  /// @param[in] data 先頭
+  /// @param[in] size サイズ
+  /// @param[in] begin 範囲の先頭
+  /// @param[in] end 範囲の末尾
+  /// @retval true 範囲の末尾まで読めた．
+  /// @retval false 形式が正しくなかった．
+  ///
+  /// 先頭が begin 以上 end 未満のレコードを出力する．
+  /// begin がレコードの先頭でない時は，そこから続くいくつかのレコードが
+  /// 正しく読める最初の位置をレコードの先頭とみなす．
+  /// オフセットは data からの位置で表す．
+  bool
+  dump_range(const ymuint8* data,
+	     ymuint64 size,
+	     ymuint64 begin,
+	     ymuint64 end);
+
+  /// @brief レコードの型の名前から型を求める．
+  /// @param[in] name 名前 ( "XY" など．大文字と小文字は区別しない )
+  /// @param[out] rtype 結果の型
+  /// @retval true 見つかった．
+  /// @retval false 該当する型がなかった．
+  static
+  bool
+  find_rtype(const string& name,
+	     GdsRtype& rtype);
+
+  /// @brief バッファに溜まった内容をストリームに書き出す．
+  void
+  flush();
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // dump_file() で並列に整形するかたまり
+  struct Chunk
+  {
+    // ファイル上の先頭位置
+    ymuint64 mBegin;
+
+    // サイズ
+    ymuint32 mSize;
+
+    // 整形した結果
+    string mText;
+
+    // 末尾まで読めた時 true
+    bool mOk;
+  };
+
 
 private:
   //////////////////////////////////////////////////////////////////////
   // 内部で用いる下請け関数
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief ストリームを持たないコンストラクタ
+  ///
+  /// 結果は mBuf に溜めたままにする．
+  GdsDumper();
+
+  /// @brief 一つのかたまりを整形する．
+  /// @param[in] data ファイルの先頭
+  /// @param[inout] chunk 対象のかたまり
+  void
+  dump_chunk(const ymuint8* data,
+	     Chunk& chunk) const;
+
+  /// @brief pos から始まるレコードのヘッダが正しいか調べる．
+  /// @param[in] data 先頭
+  /// @param[in] size サイズ
+  /// @param[in] pos 位置
+  /// @return 正しければレコードのサイズを，そうでなければ 0 を返す．
+  static
+  ymuint
+  check_header(const ymuint8* data,
+	       ymuint64 size,
+	       ymuint64 pos);
+
+  /// @brief pos 以降で最初のレコードの先頭を探す．
+  /// @param[in] data 先頭
+  /// @param[in] size サイズ
+  /// @param[in] pos 探し始める位置
+  /// @return レコードの先頭を返す．見つからない時は size を返す．
+  static
+  ymuint64
+  find_record(const ymuint8* data,
+	      ymuint64 size,
+	      ymuint64 pos);
+
   /// @brief record の共通部分の出力
   /// @param[in] data データ
   /// @param[in] offset オフセット
@@ -61,12 +185,23 @@ private:
   /// @param[in] dtype レコードのデータ型
   /// @param[in] data データ
   void
-  dump_common(ymuint32 offset,
+  dump_common(ymuint64 offset,
 	      ymuint32 size,
 	      GdsRtype rtype,
 	      GdsDtype dtype,
 	      const ymuint8 data[]);
 
+  /// @brief record の整形された部分の出力
+  /// @param[in] rtype レコードの型
+  /// @param[in] dtype レコードのデータ型
+  /// @param[in] dsize データサイズ
+  /// @param[in] data データ
+  void
+  dump_body(GdsRtype rtype,
+	    GdsDtype dtype,
+	    ymuint dsize,
+	    const ymuint8 data[]);
+
   /// @brief HEADER の出力
   /// @param[in] data データ
   void
@@ -161,6 +296,42 @@ private:
   void
   dump_byte(ymuint8 byte);
 
+  /// @brief 1文字出力する．
+  void
+  put_char(char c);
+
+  /// @brief 文字列を出力する．
+  void
+  put_str(const char* str);
+
+  /// @brief 符号なし整数を10進数で出力する．
+  void
+  put_uint(ymuint64 val);
+
+  /// @brief 符号つき整数を10進数で出力する．
+  void
+  put_int(ymint64 val);
+
+  /// @brief 符号なし整数を16進数で出力する．
+  /// @param[in] val 値
+  /// @param[in] width 幅 ( 足りない分は左に空白を詰める )
+  void
+  put_hex(ymuint64 val,
+	  ymuint width);
+
+  /// @brief 符号なし整数を8進数で出力する．
+  void
+  put_oct(ymuint64 val);
+
+  /// @brief 浮動小数点数を出力する．
+  /// @param[in] val 値
+  /// @param[in] s_form 科学形式で出力する時 true にするフラグ
+  ///
+  /// 精度は ostream の既定値と同じ 6桁とする．
+  void
+  put_real(double val,
+	   bool s_form);
+
   /// @brief data を 2バイト整数の配列とみなして pos 番めの要素を返す．
   /// @param[in] data データ
   /// @param[in] pos 位置
@@ -219,7 +390,21 @@ private:
   //////////////////////////////////////////////////////////////////////
 
   // 出力ストリーム
-  ostream& mOs;
+  // ストリームを持たない時は NULL
+  ostream* mOs;
+
+  // dump_file() で用いるスレッド数
+  ymuint32 mThreadNum;
+
+  // select_rtype() が呼ばれた時 true
+  bool mSelect;
+
+  // 出力するレコードの型のフラグ
+  // レコードの型の番号で引く．
+  bool mRtypeFlag[256];
+
+  // 出力用のバッファ
+  string mBuf;
 
 };
 
@@ -20,7 +20,7 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 class GdsElement
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 protected:
 
@@ -40,6 +40,14 @@ public:
   // 外部インターフェイス
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief 要素の種類を返す．
+  ///
+  /// kGdsBOUNDARY, kGdsPATH, kGdsSREF, kGdsAREF, kGdsTEXT, kGdsNODE,
+  /// kGdsBOX のいずれかを返す．
+  virtual
+  GdsRtype
+  type() const = 0;
+
   /// @brief external data ビットが立っているとき true を返す．
   bool
   external_data() const;
@@ -127,13 +135,35 @@ public:
   const char*
   text() const;
 
+  /// @brief 参照している構造名を返す．
+  virtual
+  const char*
+  strname() const;
+
+  /// @brief 参照している構造を返す．
+  ///
+  /// 該当する構造が存在しない場合には NULL を返す．
+  virtual
+  const GdsStruct*
+  ref_struct() const;
+
+  /// @brief column 数を返す．
+  virtual
+  int
+  column() const;
+
+  /// @brief row 数を返す．
+  virtual
+  int
+  row() const;
+
   /// @brief property の先頭要素を返す．
   const GdsProperty*
   property() const;
 
   /// @brief 次の要素を返す．
   const GdsElement*
-  next();
+  next() const;
 
 
 private:
@@ -0,0 +1,271 @@
+﻿#ifndef GDS_GDSEXPORTER_H
+#define GDS_GDSEXPORTER_H
+
+/// @file YmGds/GdsExporter.h
+/// @brief GdsExporter のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsExporter GdsExporter.h "YmGds/GdsExporter.h"
+/// @brief GDS-II の要素を一行一要素の JSON か CSV で書き出すクラス
+///
+/// GdsScanner で読んだレコードから直接書き出し，データ構造は作らない．
+/// 溜めておくのは読んでいる途中の要素一つ分だけなので，
+/// ファイルの大きさによらず一定のメモリで動く．
+/// 出力は大きなバッファに溜めてからまとめて書き出し，
+/// 整数の文字列への変換も自前で行う．
+///
+/// 一行が一つの要素を表し，次の項目を持つ．
+///  - struct:     要素を含む構造の名前
+///  - type:       要素の種類 ( boundary, path, sref, aref, text, node, box )
+///  - layer:      層番号
+///  - datatype:   DATATYPE, TEXTTYPE, NODETYPE, BOXTYPE のいずれか
+///  - pathtype, width, bgnextn, endextn: PATH と TEXT の属性
+///  - sname:      参照する構造の名前
+///  - reflection, mag, angle: STRANS とその値
+///  - cols, rows: AREF の列数と行数
+///  - string:     TEXT の文字列
+///  - properties: プロパティの属性と値の組のリスト
+///  - xy:         座標 ( x0, y0, x1, y1, ... )
+/// JSON では要素にない項目は書かない．xy は数の配列，properties は
+/// [ 属性, 値 ] の配列の配列とする．
+/// CSV では先頭に項目名の行を置き，ない項目は空にする．
+/// xy は空白で区切った数の並び，properties は "属性=値" を ';' で
+/// 区切った並びとする．
+//////////////////////////////////////////////////////////////////////
+class GdsExporter
+{
+public:
+
+  /// @brief コンストラクタ
+  /// @param[in] os 出力先のストリーム
+  explicit
+  GdsExporter(ostream& os);
+
+  /// @brief デストラクタ
+  ~GdsExporter();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 出力形式を設定する．
+  /// @param[in] format 出力形式
+  ///
+  /// 既定では kGdsExportJson となる．
+  void
+  set_format(GdsExportFormat format);
+
+  /// @brief レコード列を読んで書き出す．
+  /// @param[in] scanner 入力
+  /// @retval true 成功した．
+  /// @retval false 読み込みか書き出しに失敗した．
+  ///
+  /// scanner の末尾 ( ENDLIB の後) まで読む．
+  bool
+  write(GdsScanner& scanner);
+
+  /// @brief 読み込んだレコードの数を返す．
+  ymuint64
+  record_num() const;
+
+  /// @brief 読み込んだ構造の数を返す．
+  ymuint64
+  struct_num() const;
+
+  /// @brief 書き出した要素の数を返す．
+  ymuint64
+  elem_num() const;
+
+  /// @brief 書き出したバイト数を返す．
+  ymuint64
+  byte_num() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 読んでいる途中の要素
+  struct Elem
+  {
+    // 要素の先頭のレコードの型
+    GdsRtype mRtype;
+
+    // 値を持つ項目のフラグ
+    ymuint32 mFlags;
+
+    // 層番号
+    int mLayer;
+
+    // データ型
+    int mDatatype;
+
+    // パスタイプ
+    int mPathtype;
+
+    // 幅
+    ymint32 mWidth;
+
+    // 始点と終点の延長
+    ymint32 mBgnExtn;
+    ymint32 mEndExtn;
+
+    // STRANS
+    ymuint32 mStrans;
+
+    // 倍率
+    double mMag;
+
+    // 回転角度
+    double mAngle;
+
+    // 列数と行数
+    ymuint32 mCols;
+    ymuint32 mRows;
+
+    // 参照する構造の名前
+    string mSname;
+
+    // TEXT の文字列
+    string mString;
+
+    // 座標
+    vector<ymint32> mXY;
+
+    // プロパティの属性
+    vector<int> mPropAttr;
+
+    // プロパティの値
+    vector<string> mPropValue;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 要素を一行書き出す．
+  void
+  put_elem();
+
+  /// @brief JSON の形式で要素を一行書き出す．
+  void
+  put_json();
+
+  /// @brief CSV の形式で要素を一行書き出す．
+  void
+  put_csv();
+
+  /// @brief CSV の項目名の行を書き出す．
+  void
+  put_csv_header();
+
+  /// @brief JSON の項目名を書き出す．
+  /// @param[in] key 項目名
+  ///
+  /// 2番め以降の項目の前には ',' を置く．
+  void
+  put_key(const char* key);
+
+  /// @brief JSON の文字列を書き出す．
+  /// @param[in] str 文字列
+  void
+  put_json_string(const string& str);
+
+  /// @brief CSV の文字列を書き出す．
+  /// @param[in] str 文字列
+  ///
+  /// 必要なら '"' で囲む．
+  void
+  put_csv_string(const string& str);
+
+  /// @brief 文字列を書き出す．
+  /// @param[in] str 文字列
+  void
+  put_str(const char* str);
+
+  /// @brief 1文字書き出す．
+  /// @param[in] c 文字
+  void
+  put_char(char c);
+
+  /// @brief 整数を書き出す．
+  /// @param[in] val 値
+  void
+  put_int(ymint64 val);
+
+  /// @brief 実数を書き出す．
+  /// @param[in] val 値
+  void
+  put_real(double val);
+
+  /// @brief バッファの中身をストリームに書き出す．
+  void
+  flush();
+
+  /// @brief 直前のレコードの文字列を取り出す．
+  /// @param[in] scanner 入力
+  ///
+  /// 末尾の詰め物の '\0' は除く．
+  static
+  string
+  rec_string(const GdsScanner& scanner);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 出力先のストリーム
+  ostream& mOs;
+
+  // 出力形式
+  GdsExportFormat mFormat;
+
+  // 出力用のバッファ
+  vector<char> mBuf;
+
+  // mBuf の使用済みのサイズ
+  ymuint32 mBufPos;
+
+  // JSON の行の最初の項目の時 true
+  bool mFirstKey;
+
+  // 現在の構造名
+  string mStructName;
+
+  // 読んでいる途中の要素
+  Elem mElem;
+
+  // 読み込んだレコードの数
+  ymuint64 mRecordNum;
+
+  // 読み込んだ構造の数
+  ymuint64 mStructNum;
+
+  // 書き出した要素の数
+  ymuint64 mElemNum;
+
+  // 書き出したバイト数
+  ymuint64 mByteNum;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSEXPORTER_H
@@ -0,0 +1,168 @@
+﻿#ifndef GDS_GDSFILTER_H
+#define GDS_GDSFILTER_H
+
+/// @file YmGds/GdsFilter.h
+/// @brief GdsFilter のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsFilter GdsFilter.h "YmGds/GdsFilter.h"
+/// @brief GDS-II のレコード列を書き換えながら写すクラス
+///
+/// GdsScanner で読んだレコードを一つずつ GdsWriter に書き出す．
+/// その際に
+///  - 層番号とデータ型の付け替え
+///  - 層による要素の削除
+///  - 要素の種類による削除
+/// を行う．データ構造は作らない．
+///
+/// 要素の先頭から LAYER と型(DATATYPE/TEXTTYPE/BOXTYPE/NODETYPE)
+/// のレコードまでだけを溜めておき，そこで残すかどうかを決める．
+/// それ以降のレコードは溜めずに写すか読み捨てるので，
+/// ファイルの大きさによらず一定のメモリで動く．
+///
+/// 層の指定でデータ型に -1 を与えるとすべてのデータ型を表す．
+/// データ型 0xFFFF そのものを指定するには 65535 を与える．
+/// 残す層と削除する層は元の層番号で指定する．
+/// 残す層を一つでも指定するとそれ以外の層の要素はすべて削除する．
+//////////////////////////////////////////////////////////////////////
+class GdsFilter
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsFilter();
+
+  /// @brief デストラクタ
+  ~GdsFilter();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 層の付け替えを追加する．
+  /// @param[in] layer 元の層番号
+  /// @param[in] datatype 元のデータ型 ( -1 ですべて )
+  /// @param[in] new_layer 新しい層番号
+  /// @param[in] new_datatype 新しいデータ型 ( -1 で元のまま )
+  void
+  add_map(int layer,
+	  int datatype,
+	  int new_layer,
+	  int new_datatype);
+
+  /// @brief 残す層を追加する．
+  /// @param[in] layer 層番号
+  /// @param[in] datatype データ型 ( -1 ですべて )
+  void
+  add_keep(int layer,
+	   int datatype);
+
+  /// @brief 削除する層を追加する．
+  /// @param[in] layer 層番号
+  /// @param[in] datatype データ型 ( -1 ですべて )
+  void
+  add_drop(int layer,
+	   int datatype);
+
+  /// @brief 削除する要素の種類を追加する．
+  /// @param[in] rtype 要素の先頭のレコード型
+  ///
+  /// kGdsBOUNDARY, kGdsPATH, kGdsSREF, kGdsAREF, kGdsTEXT, kGdsNODE, kGdsBOX
+  /// のいずれか
+  void
+  drop_element(GdsRtype rtype);
+
+  /// @brief レコード列を写す．
+  /// @param[in] scanner 入力
+  /// @param[in] writer 出力
+  /// @retval true 成功した．
+  /// @retval false 読み込みか書き出しに失敗した．
+  ///
+  /// scanner の末尾 ( ENDLIB の後) まで読む．
+  bool
+  filter(GdsScanner& scanner,
+	 GdsWriter& writer);
+
+  /// @brief 読み込んだレコードの数を返す．
+  ymuint64
+  record_num() const;
+
+  /// @brief 読み込んだ要素の数を返す．
+  ymuint64
+  elem_num() const;
+
+  /// @brief 削除した要素の数を返す．
+  ymuint64
+  drop_num() const;
+
+  /// @brief 層を付け替えた要素の数を返す．
+  ymuint64
+  map_num() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 層を残すかどうか調べる．
+  /// @param[in] key 層番号とデータ型を表すキー
+  bool
+  check_layer(ymuint64 key) const;
+
+  /// @brief 直前のレコードを mElemBuf に追加する．
+  void
+  push_rec(const GdsScanner& scanner);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 付け替えの辞書
+  std::map<ymuint64, ymuint64> mMap;
+
+  // 残す層の辞書
+  std::map<ymuint64, bool> mKeep;
+
+  // 削除する層の辞書
+  std::map<ymuint64, bool> mDrop;
+
+  // 削除する要素の種類のフラグ
+  // レコードの型の番号でビットを指す．
+  ymuint64 mDropElemMask;
+
+  // 要素の先頭部分を溜めておくバッファ
+  vector<ymuint8> mElemBuf;
+
+  // 読み込んだレコードの数
+  ymuint64 mRecordNum;
+
+  // 読み込んだ要素の数
+  ymuint64 mElemNum;
+
+  // 削除した要素の数
+  ymuint64 mDropNum;
+
+  // 層を付け替えた要素の数
+  ymuint64 mMapNum;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSFILTER_H
@@ -0,0 +1,87 @@
+﻿#ifndef GDS_GDSGEOM_H
+#define GDS_GDSGEOM_H
+
+/// @file YmGds/GdsGeom.h
+/// @brief 多角形の幾何計算を行う関数
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsXY.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+/// @brief 面積の計算に用いる 128 ビット符号付き整数
+///
+/// 座標は 32 ビットなので面積の2倍は 64 ビットに収まるが，
+/// 配置数を掛けた合計は 64 ビットを超えることがある．
+typedef __int128 tGdsInt128;
+
+/// @brief 多角形の符号付き面積の2倍を求める．
+/// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+/// @param[in] n 頂点数
+///
+/// 頂点が反時計回りの時に正となる．
+/// 始点と終点が一致していてもいなくてもよい．
+/// 計算は整数で行うので誤差はない．
+tGdsInt128
+polygon_area2(const ymint32* data,
+	      ymuint n);
+
+/// @brief 多角形の周囲長を求める．
+/// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+/// @param[in] n 頂点数
+///
+/// 始点と終点が一致していない場合には閉じた多角形とみなす．
+double
+polygon_perimeter(const ymint32* data,
+		  ymuint n);
+
+/// @brief 折れ線の長さを求める．
+/// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+/// @param[in] n 頂点数
+double
+polyline_length(const ymint32* data,
+		ymuint n);
+
+/// @brief すべての辺が座標軸に平行な時 true を返す．
+/// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+/// @param[in] n 頂点数
+bool
+is_manhattan(const ymint32* data,
+	     ymuint n);
+
+/// @brief 多角形の符号付き面積の2倍を求める．
+/// @param[in] xy 頂点のリスト
+inline
+tGdsInt128
+polygon_area2(const GdsXY* xy)
+{
+  return polygon_area2(xy->data(), xy->num());
+}
+
+/// @brief 多角形の周囲長を求める．
+/// @param[in] xy 頂点のリスト
+inline
+double
+polygon_perimeter(const GdsXY* xy)
+{
+  return polygon_perimeter(xy->data(), xy->num());
+}
+
+/// @brief 折れ線の長さを求める．
+/// @param[in] xy 頂点のリスト
+inline
+double
+polyline_length(const GdsXY* xy)
+{
+  return polyline_length(xy->data(), xy->num());
+}
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSGEOM_H
@@ -0,0 +1,216 @@
+﻿#ifndef GDS_GDSGREP_H
+#define GDS_GDSGREP_H
+
+/// @file YmGds/GdsGrep.h
+/// @brief GdsGrep のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include <regex.h>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsGrep GdsGrep.h "YmGds/GdsGrep.h"
+/// @brief GDS-II ファイル中の文字列レコードを正規表現で検索するクラス
+///
+/// データ構造は作らずに GdsScanner でレコードを読むだけで検索する．
+/// ファイルは mmap() で読み込み，まずレコードの先頭だけをたどって
+/// 構造の境界を求める．構造の境界で区切ったかたまりごとに
+/// 並列に検索し，結果はファイル中の順に並べる．
+/// 圧縮されたファイルは扱えない．
+///
+/// 対象のレコードは STRING(TEXT の本体), SNAME, STRNAME, PROPVALUE で，
+/// パタンは POSIX の拡張正規表現で指定する．
+/// どれか一つのパタンに合えば一致とみなす．
+//////////////////////////////////////////////////////////////////////
+class GdsGrep
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsGrep();
+
+  /// @brief デストラクタ
+  ~GdsGrep();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief 大文字と小文字を区別しないようにする．
+  /// @param[in] flag true の時区別しない
+  ///
+  /// add_pattern() の前に設定しなければならない．
+  void
+  set_ignore_case(bool flag);
+
+  /// @brief 対象のレコードの型を設定する．
+  /// @param[in] rtype レコードの型 ( STRING/SNAME/STRNAME/PROPVALUE )
+  /// @param[in] flag true の時対象とする
+  ///
+  /// 既定ではすべて対象となる．
+  void
+  set_target(GdsRtype rtype,
+	     bool flag);
+
+  /// @brief パタンを追加する．
+  /// @param[in] pattern 正規表現
+  /// @retval true 成功した．
+  /// @retval false 正規表現が正しくなかった．
+  bool
+  add_pattern(const char* pattern);
+
+  /// @brief ファイルを検索する．
+  /// @param[in] filename ファイル名
+  /// @retval true 成功した．
+  /// @retval false ファイルが読めないか形式が正しくなかった．
+  bool
+  scan(const char* filename);
+
+  /// @brief 読み込んだレコードの数を返す．
+  ymuint64
+  record_num() const;
+
+  /// @brief 一致したレコードの数を返す．
+  ymuint
+  hit_num() const;
+
+  /// @brief 一致したレコードの先頭のファイル上の位置を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+  ymuint64
+  hit_offset(ymuint pos) const;
+
+  /// @brief 一致したレコードの型を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+  GdsRtype
+  hit_rtype(ymuint pos) const;
+
+  /// @brief 一致したレコードを含む構造の名前を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+  ///
+  /// 構造の外にある場合には空文字列を返す．
+  const string&
+  hit_struct(ymuint pos) const;
+
+  /// @brief 一致したレコードの文字列を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+  const string&
+  hit_text(ymuint pos) const;
+
+  /// @brief 一致したパタンの番号を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+  ///
+  /// 複数のパタンに一致した場合には最初のものを返す．
+  ymuint
+  hit_pattern(ymuint pos) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 一致したレコード
+  struct Hit
+  {
+    // ファイル上の位置
+    ymuint64 mOffset;
+
+    // レコードの型
+    GdsRtype mRtype;
+
+    // パタンの番号
+    ymuint32 mPattern;
+
+    // 構造名
+    string mStruct;
+
+    // 文字列
+    string mText;
+  };
+
+  // 並列に処理するかたまり
+  struct Chunk
+  {
+    // ファイル上の先頭位置
+    ymuint64 mBegin;
+
+    // サイズ
+    ymuint32 mSize;
+
+    // 読み込んだレコード数
+    ymuint64 mRecordNum;
+
+    // 結果
+    vector<Hit> mHitList;
+
+    // 成功した時 true
+    bool mOk;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 一つのかたまりを検索する．
+  /// @param[in] data ファイルの先頭
+  /// @param[inout] chunk 対象のかたまり
+  void
+  scan_chunk(const ymuint8* data,
+	     Chunk& chunk) const;
+
+  /// @brief 文字列がどのパタンに一致するか調べる．
+  /// @param[in] str 文字列
+  /// @return 一致したパタンの番号を返す．
+  ///
+  /// どれにも一致しなければ pattern の数を返す．
+  ymuint
+  match(const char* str) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // 大文字と小文字を区別しない時 true
+  bool mIgnoreCase;
+
+  // 対象のレコードの型のフラグ
+  // レコードの型の番号でビットを指す．
+  ymuint64 mTargetMask;
+
+  // パタンのリスト
+  vector<regex_t*> mPatternList;
+
+  // 読み込んだレコードの数
+  ymuint64 mRecordNum;
+
+  // 結果のリスト
+  vector<Hit> mHitList;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSGREP_H
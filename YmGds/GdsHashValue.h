@@ -0,0 +1,186 @@
+﻿#ifndef GDS_GDSHASHVALUE_H
+#define GDS_GDSHASHVALUE_H
+
+/// @file YmGds/GdsHashValue.h
+/// @brief GdsHashValue のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsHashValue GdsHashValue.h "YmGds/GdsHashValue.h"
+/// @brief 128 ビットのハッシュ値を表すクラス
+///
+/// 上位と下位の 64 ビットに分けて持つ．
+//////////////////////////////////////////////////////////////////////
+class GdsHashValue
+{
+public:
+
+  /// @brief 0 を表すコンストラクタ
+  GdsHashValue();
+
+  /// @brief 値を指定したコンストラクタ
+  /// @param[in] hi 上位 64 ビット
+  /// @param[in] lo 下位 64 ビット
+  GdsHashValue(ymuint64 hi,
+	       ymuint64 lo);
+
+  /// @brief デストラクタ
+  ~GdsHashValue();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 上位 64 ビットを返す．
+  ymuint64
+  hi() const;
+
+  /// @brief 下位 64 ビットを返す．
+  ymuint64
+  lo() const;
+
+  /// @brief 0 の時 true を返す．
+  bool
+  is_zero() const;
+
+  /// @brief ハッシュ表用のハッシュ値を返す．
+  ymuint
+  hash() const;
+
+  /// @brief 等価比較
+  bool
+  operator==(const GdsHashValue& right) const;
+
+  /// @brief 非等価比較
+  bool
+  operator!=(const GdsHashValue& right) const;
+
+  /// @brief 小なり比較
+  bool
+  operator<(const GdsHashValue& right) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 上位 64 ビット
+  ymuint64 mHi;
+
+  // 下位 64 ビット
+  ymuint64 mLo;
+
+};
+
+/// @brief 32 桁の16進数で出力する．
+/// @param[in] s 出力先のストリーム
+/// @param[in] hv ハッシュ値
+ostream&
+operator<<(ostream& s,
+	   const GdsHashValue& hv);
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief 0 を表すコンストラクタ
+inline
+GdsHashValue::GdsHashValue() :
+  mHi(0),
+  mLo(0)
+{
+}
+
+// @brief 値を指定したコンストラクタ
+// @param[in] hi 上位 64 ビット
+// @param[in] lo 下位 64 ビット
+inline
+GdsHashValue::GdsHashValue(ymuint64 hi,
+			   ymuint64 lo) :
+  mHi(hi),
+  mLo(lo)
+{
+}
+
+// @brief デストラクタ
+inline
+GdsHashValue::~GdsHashValue()
+{
+}
+
+// @brief 上位 64 ビットを返す．
+inline
+ymuint64
+GdsHashValue::hi() const
+{
+  return mHi;
+}
+
+// @brief 下位 64 ビットを返す．
+inline
+ymuint64
+GdsHashValue::lo() const
+{
+  return mLo;
+}
+
+// @brief 0 の時 true を返す．
+inline
+bool
+GdsHashValue::is_zero() const
+{
+  return mHi == 0 && mLo == 0;
+}
+
+// @brief ハッシュ表用のハッシュ値を返す．
+inline
+ymuint
+GdsHashValue::hash() const
+{
+  // 各ビットは十分に混ざっているので下位をそのまま用いる．
+  return static_cast<ymuint>(mLo);
+}
+
+// @brief 等価比較
+inline
+bool
+GdsHashValue::operator==(const GdsHashValue& right) const
+{
+  return mHi == right.mHi && mLo == right.mLo;
+}
+
+// @brief 非等価比較
+inline
+bool
+GdsHashValue::operator!=(const GdsHashValue& right) const
+{
+  return !operator==(right);
+}
+
+// @brief 小なり比較
+inline
+bool
+GdsHashValue::operator<(const GdsHashValue& right) const
+{
+  if ( mHi != right.mHi ) {
+    return mHi < right.mHi;
+  }
+  return mLo < right.mLo;
+}
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSHASHVALUE_H
@@ -0,0 +1,163 @@
+﻿#ifndef GDS_GDSHIER_H
+#define GDS_GDSHIER_H
+
+/// @file YmGds/GdsHier.h
+/// @brief GdsHier のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsHier GdsHier.h "YmGds/GdsHier.h"
+/// @brief 構造の参照関係(階層)を表すクラス
+///
+/// SREF/AREF による親子関係を保持し，最上位の構造の下での各構造の
+/// 配置数を求める．
+/// AREF は column 数 x row 数 回の配置として数える．
+//////////////////////////////////////////////////////////////////////
+class GdsHier
+{
+public:
+
+  /// @brief コンストラクタ
+  /// @param[in] data 対象のデータ
+  ///
+  /// data はこのオブジェクトより長く存在しなければならない．
+  explicit
+  GdsHier(const GdsData& data);
+
+  /// @brief デストラクタ
+  ~GdsHier();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 対象のデータを返す．
+  const GdsData&
+  data() const;
+
+  /// @brief どこからも参照されていない構造の数を返す．
+  ymuint
+  top_num() const;
+
+  /// @brief どこからも参照されていない構造を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < top_num() )
+  const GdsStruct*
+  top(ymuint pos) const;
+
+  /// @brief 子供の構造の参照数を返す．
+  /// @param[in] id 親の構造のID番号
+  ///
+  /// 同じ構造への複数の参照は一つにまとめられている．
+  ymuint
+  child_num(ymuint id) const;
+
+  /// @brief 子供の構造を返す．
+  /// @param[in] id 親の構造のID番号
+  /// @param[in] pos 位置番号 ( 0 <= pos < child_num(id) )
+  const GdsStruct*
+  child(ymuint id,
+	ymuint pos) const;
+
+  /// @brief 子供の構造の配置数を返す．
+  /// @param[in] id 親の構造のID番号
+  /// @param[in] pos 位置番号 ( 0 <= pos < child_num(id) )
+  ///
+  /// 親の構造の中に直接置かれている数を返す．
+  ymuint64
+  child_count(ymuint id,
+	      ymuint pos) const;
+
+  /// @brief 配置数を求める．
+  /// @param[in] top 最上位の構造
+  /// @retval true 成功した．
+  /// @retval false 階層が循環していた．
+  ///
+  /// top が NULL の時は top() で得られる構造をすべて最上位とみなす．
+  bool
+  calc_count(const GdsStruct* top = NULL);
+
+  /// @brief 配置数を返す．
+  /// @param[in] id 構造のID番号
+  ///
+  /// calc_count() で指定した最上位の構造の下で何回使われているかを返す．
+  /// 最上位の構造自身は 1 となる．
+  /// 最上位から到達できない構造は 0 となる．
+  ymuint64
+  count(ymuint id) const;
+
+  /// @brief 最上位から到達可能な構造の数を返す．
+  ymuint
+  order_num() const;
+
+  /// @brief 最上位から到達可能な構造をトポロジカル順に返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < order_num() )
+  ///
+  /// 親は必ず子供よりも前に現れる．
+  const GdsStruct*
+  order(ymuint pos) const;
+
+  /// @brief 最上位から到達できない構造の数を返す．
+  ymuint
+  orphan_num() const;
+
+  /// @brief 最上位から到達できない構造を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < orphan_num() )
+  const GdsStruct*
+  orphan(ymuint pos) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 親子関係を表す枝
+  struct Edge
+  {
+    // 子供の構造のID番号
+    ymuint32 mChild;
+
+    // 配置数
+    ymuint64 mCount;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 対象のデータ
+  const GdsData& mData;
+
+  // 構造ごとの子供への枝のリスト
+  vector<vector<Edge> > mEdgeArray;
+
+  // どこからも参照されていない構造のリスト
+  vector<const GdsStruct*> mTopList;
+
+  // 構造ごとの配置数
+  vector<ymuint64> mCountArray;
+
+  // トポロジカル順に並べた構造のID番号のリスト
+  vector<ymuint32> mOrderList;
+
+  // 最上位から到達できない構造のリスト
+  vector<const GdsStruct*> mOrphanList;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSHIER_H
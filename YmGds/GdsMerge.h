@@ -0,0 +1,309 @@
+﻿#ifndef GDS_GDSMERGE_H
+#define GDS_GDSMERGE_H
+
+/// @file YmGds/GdsMerge.h
+/// @brief GdsMerge のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsHashValue.h"
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsMerge GdsMerge.h "YmGds/GdsMerge.h"
+/// @brief 複数の GDS-II ライブラリを一つにまとめるクラス
+///
+/// 各ファイルは GdsStructIndex で索引を作り，構造のバイト列を直接扱う．
+///
+/// 単位はもっとも細かいものに合わせ，それより粗いファイルの座標は拡大する．
+/// 名前の衝突した構造は内容のハッシュ値(子孫の内容も含む)が
+/// 既に出力した同名の構造(名前を変えたものも含む)のどれかと等しければ
+/// 一つにまとめ，どれとも異なれば後から現れた方の名前を変える．
+/// まとめた構造の下にしか現れない構造は出力しない．
+/// 参照の循環の中にあって最上位から到達できない構造も警告を出して出力する．
+///
+/// 名前も座標も変わらない構造はバイト列をそのまま書き出し，
+/// それ以外の構造だけレコードを書き換える．
+//////////////////////////////////////////////////////////////////////
+class GdsMerge
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsMerge();
+
+  /// @brief デストラクタ
+  ~GdsMerge();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief 出力するライブラリ名を設定する．
+  /// @param[in] name ライブラリ名
+  ///
+  /// 設定しない時は最初のファイルのものを用いる．
+  void
+  set_libname(const char* name);
+
+  /// @brief ファイルを追加する．
+  /// @param[in] filename ファイル名
+  /// @retval true 成功した．
+  /// @retval false ファイルが読めないか形式が正しくなかった．
+  ///
+  /// 保存された索引 ( <filename>.sidx ) があれば用いる．
+  bool
+  add_file(const char* filename);
+
+  /// @brief まとめたライブラリを書き出す．
+  /// @param[in] writer 出力先
+  /// @retval true 成功した．
+  /// @retval false 失敗した．
+  ///
+  /// HEADER から ENDLIB までを書き出す．
+  bool
+  write(GdsWriter& writer);
+
+  /// @brief 出力の UNITS のユーザー単位を返す．
+  double
+  user_unit() const;
+
+  /// @brief 出力の UNITS のメートル単位を返す．
+  double
+  meter_unit() const;
+
+  /// @brief ファイルの数を返す．
+  ymuint
+  file_num() const;
+
+  /// @brief ファイルの座標の倍率を返す．
+  /// @param[in] pos ファイル番号 ( 0 <= pos < file_num() )
+  double
+  scale(ymuint pos) const;
+
+  /// @brief 書き出した構造の数を返す．
+  ymuint
+  struct_num() const;
+
+  /// @brief バイト列をそのまま書き出した構造の数を返す．
+  ymuint
+  copy_num() const;
+
+  /// @brief 一つにまとめた構造の数を返す．
+  ymuint
+  dedup_num() const;
+
+  /// @brief 名前を変えた構造の数を返す．
+  ymuint
+  rename_num() const;
+
+  /// @brief 名前を変えた構造のファイル番号を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < rename_num() )
+  ymuint
+  rename_file(ymuint pos) const;
+
+  /// @brief 名前を変えた構造の元の名前を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < rename_num() )
+  const string&
+  rename_from(ymuint pos) const;
+
+  /// @brief 名前を変えた構造の新しい名前を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < rename_num() )
+  const string&
+  rename_to(ymuint pos) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 構造の扱い
+  enum {
+    kUndecided,
+    kNew,
+    kDedup,
+    kRename
+  };
+
+  // 構造の情報
+  struct Cell
+  {
+    // 参照している構造名のリスト(現れた順)
+    vector<string> mRefList;
+
+    // 参照している構造を除いた内容のハッシュ値
+    GdsHashValue mLocalHash;
+
+    // 子孫の内容も含めたハッシュ値
+    GdsHashValue mHash;
+
+    // mHash を求めた時 true
+    bool mHashDone;
+
+    // 扱い
+    ymuint8 mState;
+
+    // 出力する時 true
+    bool mEmit;
+
+    // 出力する名前
+    string mOutName;
+
+    // 読み込みに成功した時 true
+    bool mOk;
+  };
+
+  // ファイルの情報
+  struct Lib
+  {
+    // ファイル名
+    string mFileName;
+
+    // 索引
+    GdsStructIndex* mIndex;
+
+    // UNITS のユーザー単位
+    double mUserUnit;
+
+    // UNITS のメートル単位
+    double mMeterUnit;
+
+    // 座標の倍率
+    double mScale;
+
+    // 構造の情報の配列
+    vector<Cell> mCellArray;
+  };
+
+  // 名前を変えた構造
+  struct Rename
+  {
+    // ファイル番号
+    ymuint mFile;
+
+    // 元の名前
+    string mFrom;
+
+    // 新しい名前
+    string mTo;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 構造の内容を読んで mRefList と mLocalHash を求める．
+  /// @param[in] lib ファイル
+  /// @param[in] id 構造番号
+  void
+  scan_cell(Lib& lib,
+	    ymuint id);
+
+  /// @brief 子孫の内容も含めたハッシュ値を求める．
+  /// @param[in] lib ファイル
+  /// @param[in] id 構造番号
+  const GdsHashValue&
+  calc_hash(Lib& lib,
+	    ymuint id);
+
+  /// @brief 構造の扱いを決める．
+  /// @param[in] lib_id ファイル番号
+  /// @param[in] id 構造番号
+  ///
+  /// 出力する構造の子供も再帰的に決める．
+  void
+  decide(ymuint lib_id,
+	 ymuint id);
+
+  /// @brief 重ならない新しい名前を作る．
+  /// @param[in] name 元の名前
+  string
+  new_name(const string& name);
+
+  /// @brief ヘッダ部分を書き出す．
+  /// @param[in] writer 出力先
+  bool
+  write_header(GdsWriter& writer);
+
+  /// @brief 構造のレコードを書き換えながら書き出す．
+  /// @param[in] lib ファイル
+  /// @param[in] id 構造番号
+  /// @param[in] writer 出力先
+  bool
+  rewrite_cell(const Lib& lib,
+	       ymuint id,
+	       GdsWriter& writer);
+
+  /// @brief 構造を書き換える必要があるか調べる．
+  /// @param[in] lib ファイル
+  /// @param[in] id 構造番号
+  bool
+  need_rewrite(const Lib& lib,
+	       ymuint id) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // 出力するライブラリ名
+  string mLibName;
+
+  // ファイルのリスト
+  vector<Lib*> mLibList;
+
+  // 出力の UNITS のユーザー単位
+  double mUserUnit;
+
+  // 出力の UNITS のメートル単位
+  double mMeterUnit;
+
+  // 出力した構造名の辞書
+  std::map<string, bool> mOutName;
+
+  // 元の構造名とハッシュ値の組をキーにして出力した構造名を保持する辞書
+  std::map<std::pair<string, GdsHashValue>, string> mOutMap;
+
+  // 使われている名前の辞書
+  std::map<string, bool> mUsedName;
+
+  // 書き出した構造の数
+  ymuint32 mStructNum;
+
+  // そのまま書き出した構造の数
+  ymuint32 mCopyNum;
+
+  // 一つにまとめた構造の数
+  ymuint32 mDedupNum;
+
+  // 名前を変えた構造のリスト
+  vector<Rename> mRenameList;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSMERGE_H
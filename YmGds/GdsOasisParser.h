@@ -0,0 +1,609 @@
+﻿#ifndef GDS_GDSOASISPARSER_H
+#define GDS_GDSOASISPARSER_H
+
+/// @file YmGds/GdsOasisParser.h
+/// @brief GdsOasisParser のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsBuilder.h"
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsOasisParser GdsOasisParser.h "YmGds/GdsOasisParser.h"
+/// @brief OASIS ファイルを読み込んで GdsData を作るクラス
+///
+/// 結果は GdsParser と同じ GdsData/GdsStruct/GdsElement で表すので，
+/// その上の処理は GDS-II と OASIS の区別なく使える．
+///
+/// 読み込みは次のように行う．
+///  - 名前の表 (CELLNAME, TEXTSTRING, PROPNAME, PROPSTRING) は
+///    START/END に書かれた位置から読む．
+///  - 名前の表が strict で，すべての CELLNAME に S_CELL_OFFSET が
+///    あれば，各構造をその位置から独立に読む．
+///    そうでなければファイルを先頭から一度たどって構造の範囲を求める．
+///    この時 CBLOCK は範囲を調べる前にまとめて並列に展開する．
+///  - 構造ごとの読み込み(CBLOCK の展開を含む)は並列に行い，
+///    最後にファイル中の順番に GdsStruct を作る．
+///
+/// GDS-II で表せないものは次のように扱う．
+///  - RECTANGLE, POLYGON, TRAPEZOID, CTRAPEZOID, CIRCLE は BOUNDARY にする．
+///    CIRCLE は多角形で近似する．
+///  - PATH の延長は pathtype 0, 2, 4 のいずれかにする．
+///  - PLACEMENT の規則的な repetition は AREF にする．
+///    それ以外の repetition は要素を一つずつ作る．
+///  - S_GDS_PROPERTY 以外のプロパティと XELEMENT, XGEOMETRY は読み捨てる．
+///  - ライブラリ名はファイル名から拡張子を除いたものにする．
+//////////////////////////////////////////////////////////////////////
+class GdsOasisParser
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsOasisParser();
+
+  /// @brief デストラクタ
+  ~GdsOasisParser();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief OASIS ファイルかどうか調べる．
+  /// @param[in] filename ファイル名
+  ///
+  /// 先頭のマジック文字列だけを調べる．
+  static
+  bool
+  is_oasis(const string& filename);
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief repetition をすべて展開するか設定する．
+  /// @param[in] flag true の時は AREF を作らずに SREF に展開する．
+  ///
+  /// 既定では規則的な配置は AREF にする．
+  void
+  set_expand_repetition(bool flag);
+
+  /// @brief ファイルを読み込む．
+  /// @param[in] filename ファイル名
+  /// @retval true 読み込みが成功した．
+  /// @retval false 読み込みが失敗した．
+  bool
+  parse(const string& filename);
+
+  /// @brief 読み込んだデータを返す．
+  ///
+  /// parse() が失敗した場合には NULL を返す．
+  /// 返り値はこのオブジェクトが破壊されるまで有効．
+  const GdsData*
+  data() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 読み込み中の要素
+  // 名前の参照は 0 以上なら表の参照番号，負なら -1 - (mStrList 中の位置)
+  struct Elem
+  {
+    // 種類 ( kGdsBOUNDARY, kGdsPATH, kGdsSREF, kGdsAREF, kGdsTEXT )
+    GdsRtype mType;
+
+    // 層番号とデータ型(TEXT の時は texttype)
+    ymint16 mLayer;
+    ymint16 mDatatype;
+
+    // PATH の pathtype
+    ymint16 mPathtype;
+
+    // PATH の幅と延長
+    ymint32 mWidth;
+    ymint32 mBgnExtn;
+    ymint32 mEndExtn;
+
+    // SREF/AREF の参照先の構造名，TEXT の文字列
+    ymint64 mRef;
+
+    // SREF/AREF の変換
+    bool mFlip;
+    double mMag;
+    double mAngle;
+
+    // AREF の列と行の数
+    ymuint32 mColRow;
+
+    // 座標の mXYList 中の位置と点の数
+    ymuint32 mXYPos;
+    ymuint32 mXYNum;
+
+    // プロパティの mPropList 中の位置と数
+    ymuint32 mPropPos;
+    ymuint32 mPropNum;
+  };
+
+  // 読み込み中のプロパティ
+  struct Prop
+  {
+    // PROPATTR の値
+    ymuint32 mAttr;
+
+    // PROPVALUE の mStrList 中の位置
+    ymuint32 mValue;
+  };
+
+  // 構造の範囲の一部
+  struct Segment
+  {
+    // 先頭
+    const ymuint8* mBegin;
+
+    // 末尾
+    const ymuint8* mEnd;
+  };
+
+  // 読み込み中の構造
+  struct Cell
+  {
+    // 範囲のリスト
+    // 先頭は CELL レコード
+    vector<Segment> mSegList;
+
+    // CELL レコードのファイル中の位置(エラーメッセージ用)
+    ymuint64 mOffset;
+
+    // 構造名
+    ymint64 mName;
+
+    // 要素のリスト
+    vector<Elem> mElemList;
+
+    // 座標の配列
+    vector<ymint32> mXYList;
+
+    // 文字列の配列
+    vector<string> mStrList;
+
+    // プロパティの配列
+    vector<Prop> mPropList;
+
+    // 最後に読んだ要素の範囲 (repetition で複数になる)
+    ymuint32 mLastBegin;
+    ymuint32 mLastEnd;
+
+    // 要素を作らずに読み飛ばす時 true
+    bool mSkip;
+
+    // エラーメッセージ (空なら成功)
+    string mError;
+  };
+
+  // バイト列を読むためのカーソル
+  // 範囲外を読もうとした時や形式が正しくない時は mError を true にして
+  // 0 を返す．
+  struct Reader
+  {
+    // 1バイト読む．
+    ymuint
+    read_byte();
+
+    // 符号なし整数を読む．
+    ymuint64
+    read_uint();
+
+    // 符号つき整数を読む．
+    ymint64
+    read_sint();
+
+    // 実数を読む．
+    double
+    read_real();
+
+    // 型を読んだ後の実数を読む．
+    double
+    read_real_body(ymuint64 type);
+
+    // 文字列を読む．
+    void
+    read_string(string& str);
+
+    // g-delta を読む．
+    void
+    read_gdelta(ymint64& dx,
+		ymint64& dy);
+
+    // point-list を読む．
+    // polygon が true の時は型 0/1 で省略された頂点を補う．
+    // 結果は始点からの変位 ( dx1, dy1, dx2, dy2, ... ) で始点は含まない．
+    void
+    read_point_list(bool polygon,
+		    vector<ymint64>& pts);
+
+    // n バイト読み飛ばす．
+    void
+    skip(ymuint64 n);
+
+    // 現在位置
+    const ymuint8* mCur;
+
+    // 末尾
+    const ymuint8* mEnd;
+
+    // エラーが起きた時 true
+    bool mError;
+  };
+
+  // repetition
+  struct Rep
+  {
+    // 種類 ( 0 で repetition なし )
+    ymuint32 mType;
+
+    // 格子状 (型 1, 2, 3, 8, 9) の時の列と行の数
+    ymuint64 mNx;
+    ymuint64 mNy;
+
+    // 格子状の時の列と行の変位
+    ymint64 mCx;
+    ymint64 mCy;
+    ymint64 mRx;
+    ymint64 mRy;
+
+    // それ以外の時の位置のリスト (先頭は (0, 0))
+    vector<std::pair<ymint64, ymint64> > mPosList;
+  };
+
+  // プロパティの値
+  struct PropValue
+  {
+    // 型 ( 0 - 15 )
+    ymuint64 mType;
+
+    // 整数と参照番号の値 (実数の値は保持しない)
+    ymuint64 mUint;
+
+    // 文字列の値
+    string mStr;
+  };
+
+  // 一つの構造(あるいは名前の表)を読む時のモーダル変数
+  // 未定義の値は 0 として扱う．
+  struct Modal
+  {
+    // すべてを未定義にする．
+    void
+    clear();
+
+    // XYRELATIVE の時 true
+    bool mRelative;
+
+    // placement-x, placement-y
+    ymint64 mPlacementX;
+    ymint64 mPlacementY;
+
+    // placement-cell
+    ymint64 mPlacementCell;
+
+    // layer, datatype
+    ymuint64 mLayer;
+    ymuint64 mDatatype;
+
+    // textlayer, texttype
+    ymuint64 mTextLayer;
+    ymuint64 mTextType;
+
+    // text-x, text-y
+    ymint64 mTextX;
+    ymint64 mTextY;
+
+    // text-string
+    ymint64 mTextString;
+
+    // geometry-x, geometry-y
+    ymint64 mGeomX;
+    ymint64 mGeomY;
+
+    // geometry-w, geometry-h
+    ymuint64 mGeomW;
+    ymuint64 mGeomH;
+
+    // path-halfwidth
+    ymuint64 mHalfWidth;
+
+    // path-start-extension, path-end-extension
+    ymint64 mStartExt;
+    ymint64 mEndExt;
+
+    // polygon-point-list と path-point-list (始点からの変位)
+    vector<ymint64> mPolygonList;
+    vector<ymint64> mPathList;
+
+    // circle-radius
+    ymuint64 mRadius;
+
+    // ctrapezoid-type
+    ymuint64 mCtrapType;
+
+    // repetition
+    Rep mRep;
+
+    // last-property-name
+    // mPropNameRef が true の時は PROPNAME の参照番号 mPropNameNum，
+    // false の時は文字列 mPropNameStr
+    bool mPropNameDef;
+    bool mPropNameRef;
+    ymuint64 mPropNameNum;
+    string mPropNameStr;
+
+    // last-value-list
+    vector<PropValue> mPropValues;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief START と END を読む．
+  bool
+  read_start_end();
+
+  /// @brief 名前の表を読む．
+  /// @param[in] table 表の番号 ( CELLNAME から順に 0 - 3 )
+  bool
+  read_table(ymuint table);
+
+  /// @brief 名前のレコードを続けて読む．
+  /// @param[in] r カーソル
+  /// @param[inout] modal モーダル変数
+  /// @param[in] table 登録する表の番号
+  /// @retval true 名前以外のレコードか末尾に達した．
+  /// @retval false 形式が正しくなかった．
+  ///
+  /// CBLOCK は展開して中を読む．
+  /// 表が隣り合っている場合があるので，他の表の名前は読み飛ばす．
+  bool
+  read_names(Reader& r,
+	     Modal& modal,
+	     ymuint table);
+
+  /// @brief 名前のレコードを一つ読む．
+  /// @param[in] rtype レコード番号
+  /// @param[in] r カーソル
+  /// @param[inout] modal モーダル変数
+  /// @param[in] store false の時は読み飛ばす．
+  bool
+  read_name_record(ymuint64 rtype,
+		   Reader& r,
+		   Modal& modal,
+		   bool store);
+
+  /// @brief S_CELL_OFFSET から構造の範囲を求める．
+  ///
+  /// 使えない時は false を返す．
+  bool
+  locate_cells();
+
+  /// @brief ファイルを先頭からたどって構造の範囲を求める．
+  bool
+  scan_cells();
+
+  /// @brief 構造を一つ読む．
+  /// @param[in] cell 対象の構造
+  void
+  read_cell(Cell& cell) const;
+
+  /// @brief 構造の中身を読む．
+  /// @param[in] r カーソル
+  /// @param[inout] modal モーダル変数
+  /// @param[inout] cell 結果を追加する構造
+  /// @param[inout] first 先頭の CELL レコードを読むまで true
+  /// @param[in] in_block CBLOCK の中の時 true
+  /// @retval 0 末尾に達した．
+  /// @retval 1 構造の終わりに達した．
+  /// @retval 2 形式が正しくなかった．
+  ymuint
+  read_body(Reader& r,
+	    Modal& modal,
+	    Cell& cell,
+	    bool& first,
+	    bool in_block) const;
+
+  /// @brief 構造の中のレコードを一つ読む．
+  /// @param[in] rtype レコード番号
+  /// @param[in] r カーソル
+  /// @param[inout] modal モーダル変数
+  /// @param[inout] cell 結果を追加する構造
+  /// @retval true 成功した．
+  /// @retval false 形式が正しくなかった．
+  bool
+  read_record(ymuint64 rtype,
+	      Reader& r,
+	      Modal& modal,
+	      Cell& cell) const;
+
+  /// @brief repetition を読む．
+  /// @param[in] r カーソル
+  /// @param[inout] modal モーダル変数
+  /// @param[inout] cell エラーメッセージを設定する構造
+  ///
+  /// 結果は modal.mRep に入る．
+  bool
+  read_repetition(Reader& r,
+		  Modal& modal,
+		  Cell& cell) const;
+
+  /// @brief PROPERTY の名前と値を読む．
+  /// @param[in] rtype レコード番号 ( 28 か 29 )
+  /// @param[in] r カーソル
+  /// @param[inout] modal モーダル変数
+  ///
+  /// 結果は modal の last-property-name と last-value-list に入る．
+  bool
+  read_prop_values(ymuint64 rtype,
+		   Reader& r,
+		   Modal& modal) const;
+
+  /// @brief 構造の中の PROPERTY を読む．
+  /// @param[in] rtype レコード番号 ( 28 か 29 )
+  /// @param[in] r カーソル
+  /// @param[inout] modal モーダル変数
+  /// @param[inout] cell 結果を追加する構造
+  ///
+  /// S_GDS_PROPERTY なら直前の要素に付ける．
+  bool
+  read_property(ymuint64 rtype,
+		Reader& r,
+		Modal& modal,
+		Cell& cell) const;
+
+  /// @brief 要素を repetition に従って複製しながら追加する．
+  /// @param[in] elem 要素
+  /// @param[in] x, y 基準点
+  /// @param[in] pts 基準点からの変位 ( dx1, dy1, dx2, dy2, ... )
+  /// @param[in] close 基準点を末尾に追加する時 true
+  /// @param[in] rep repetition
+  /// @param[inout] cell 結果を追加する構造
+  bool
+  add_elem(Elem& elem,
+	   ymint64 x,
+	   ymint64 y,
+	   const vector<ymint64>& pts,
+	   bool close,
+	   const Rep& rep,
+	   Cell& cell) const;
+
+  /// @brief 多角形を追加する．
+  /// @param[in] modal モーダル変数 ( layer, datatype を用いる )
+  /// @param[in] x, y 基準点
+  /// @param[in] verts 基準点からの頂点の位置 ( x0, y0, x1, y1, ... )
+  /// @param[in] rep repetition
+  /// @param[inout] cell 結果を追加する構造
+  bool
+  add_polygon(const Modal& modal,
+	      ymint64 x,
+	      ymint64 y,
+	      const vector<ymint64>& verts,
+	      const Rep& rep,
+	      Cell& cell) const;
+
+  /// @brief GdsData を作る．
+  /// @param[in] filename ファイル名
+  bool
+  make_data(const string& filename);
+
+  /// @brief 構造の要素を作る．
+  /// @param[in] cell 読み込んだ構造
+  /// @param[in] str 要素を追加する構造
+  bool
+  make_elements(const Cell& cell,
+		GdsStruct* str);
+
+  /// @brief GdsString を作る．
+  /// @param[in] str 文字列
+  GdsString*
+  new_string(const string& str);
+
+  /// @brief 名前の参照から文字列を求める．
+  /// @param[in] cell 構造
+  /// @param[in] table 参照番号の時の表
+  /// @param[in] ref 名前の参照
+  /// @param[out] name 結果
+  /// @retval false 表にない参照番号だった．
+  bool
+  ref_name(const Cell& cell,
+	   const std::map<ymuint64, string>& table,
+	   ymint64 ref,
+	   string& name) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // データを作るオブジェクト
+  GdsBuilder mBuilder;
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // repetition をすべて展開する時 true
+  bool mExpand;
+
+  // ファイルの内容
+  const ymuint8* mData;
+
+  // ファイルサイズ
+  ymuint64 mFileSize;
+
+  // START の次のレコードの位置
+  ymuint64 mBodyPos;
+
+  // END レコードの位置
+  ymuint64 mEndPos;
+
+  // 1 ミクロンあたりの格子の数
+  double mUnit;
+
+  // 表の情報 ( strict フラグと位置 )
+  // CELLNAME, TEXTSTRING, PROPNAME, PROPSTRING, LAYERNAME, XNAME の順
+  ymuint64 mTableFlag[6];
+  ymuint64 mTableOffset[6];
+
+  // 名前の表を START/END の位置から読んだ時 true
+  bool mTableLoaded;
+
+  // 参照番号を省略した名前の次の参照番号
+  // CELLNAME, TEXTSTRING, PROPNAME, PROPSTRING の順
+  ymuint64 mNextRef[4];
+
+  // 直前のレコードが CELLNAME の時の参照番号 (それ以外は -1)
+  ymint64 mLastCellName;
+
+  // 参照番号をキーにした名前の表
+  std::map<ymuint64, string> mCellName;
+  std::map<ymuint64, string> mTextString;
+  std::map<ymuint64, string> mPropName;
+  std::map<ymuint64, string> mPropString;
+
+  // CELLNAME の参照番号をキーにした S_CELL_OFFSET の値
+  std::map<ymuint64, ymuint64> mCellOffset;
+
+  // CELLNAME に付いた参照番号で名前を与えたプロパティ
+  // ( CELLNAME の参照番号，PROPNAME の参照番号，最初の値 )
+  // PROPNAME の表を読む前に現れることがあるので後でまとめて調べる．
+  vector<std::pair<ymuint64, std::pair<ymuint64, ymuint64> > > mCellProp;
+
+  // 展開した CBLOCK の内容
+  vector<vector<ymuint8> > mBlockList;
+
+  // 構造のリスト(ファイル中の順)
+  vector<Cell> mCellList;
+
+  // 作成した GdsData
+  GdsData* mCurData;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSOASISPARSER_H
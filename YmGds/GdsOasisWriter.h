@@ -0,0 +1,346 @@
+﻿#ifndef GDS_GDSOASISWRITER_H
+#define GDS_GDSOASISWRITER_H
+
+/// @file YmGds/GdsOasisWriter.h
+/// @brief GdsOasisWriter のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsOasisWriter GdsOasisWriter.h "YmGds/GdsOasisWriter.h"
+/// @brief GdsData を OASIS 形式で書き出すクラス
+///
+/// 出力を小さくするために以下のことを行う．
+///  - 座標は XYRELATIVE で書き，層や形状などはモーダル変数で省略する．
+///    要素は種類と層ごとに並べ替えてから書く．
+///  - AREF は repetition に置き換える．同じ構造を同じ変換で置いた
+///    SREF は一つの PLACEMENT にまとめ，格子状なら規則的な repetition，
+///    そうでなければ変位のリストの repetition で表す．
+///  - 多角形と PATH の点列は manhattan/octangular/一般の中から
+///    もっとも短い表現を選ぶ．
+///  - 構造の中身は CBLOCK (deflate) で圧縮する．
+/// 構造ごとの符号化と圧縮は並列に行う．
+///
+/// 名前の表のうち TEXTSTRING と PROPNAME は START の直後に，CELLNAME は
+/// 構造の後に置き，表の位置は END に書く．CELLNAME には構造の位置を表す
+/// S_CELL_OFFSET を付けるので，読む側は構造を直接読める．
+/// GDS-II の要素のプロパティは S_GDS_PROPERTY で表す．
+///
+/// OASIS で表せないものは次のように扱う．
+///  - pathtype 1 の PATH と幅が奇数の PATH は多角形にする．
+///  - TEXT の presentation, strans, width は書かない．
+///  - NODE は書かない．
+///  - 幅が負 (絶対値で指定) の PATH は幅の絶対値を用いる．
+///    拡大して置かれた構造の中では図形が変わる．
+///  - SREF/AREF の absolute magnification/angle のビットは無視する．
+/// この二つは構造ごとに該当する要素の数を警告として出力する．
+//////////////////////////////////////////////////////////////////////
+class GdsOasisWriter
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsOasisWriter();
+
+  /// @brief デストラクタ
+  ~GdsOasisWriter();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief CBLOCK による圧縮を行うか設定する．
+  /// @param[in] flag true の時圧縮する．
+  /// @param[in] level 圧縮レベル ( 1 - 9 )
+  ///
+  /// 既定では level 6 で圧縮する．
+  void
+  set_compress(bool flag,
+	       int level = 6);
+
+  /// @brief SREF を repetition にまとめるか設定する．
+  /// @param[in] flag true の時まとめる．
+  ///
+  /// 既定ではまとめる．
+  void
+  set_merge_placement(bool flag);
+
+  /// @brief ファイルに書き出す．
+  /// @param[in] data 対象のデータ
+  /// @param[in] filename ファイル名
+  /// @retval true 成功した．
+  /// @retval false 書き込みに失敗した．
+  bool
+  write(const GdsData& data,
+	const string& filename);
+
+  /// @brief 書き出したバイト数を返す．
+  ymuint64
+  file_size() const;
+
+  /// @brief 書き出した PLACEMENT レコードの数を返す．
+  ymuint64
+  placement_num() const;
+
+  /// @brief 書き出した PLACEMENT が表す配置の数を返す．
+  ymuint64
+  instance_num() const;
+
+  /// @brief 書き出した図形のレコードの数を返す．
+  ymuint64
+  shape_num() const;
+
+  /// @brief 書き出さなかった要素の数を返す．
+  ///
+  /// NODE と面積を持たない図形の数
+  ymuint64
+  skip_num() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 一つの構造を符号化する時のモーダル変数
+  struct Modal
+  {
+    // placement-x, placement-y
+    ymint64 mPlacementX;
+    ymint64 mPlacementY;
+
+    // placement-cell (-1 で未定義)
+    ymint64 mPlacementCell;
+
+    // layer, datatype (-1 で未定義)
+    ymint64 mLayer;
+    ymint64 mDatatype;
+
+    // textlayer, texttype (-1 で未定義)
+    ymint64 mTextLayer;
+    ymint64 mTextType;
+
+    // text-x, text-y
+    ymint64 mTextX;
+    ymint64 mTextY;
+
+    // text-string の参照番号 (-1 で未定義)
+    ymint64 mTextString;
+
+    // geometry-x, geometry-y
+    ymint64 mGeomX;
+    ymint64 mGeomY;
+
+    // geometry-w, geometry-h (-1 で未定義)
+    ymint64 mGeomW;
+    ymint64 mGeomH;
+
+    // path-halfwidth (-1 で未定義)
+    ymint64 mHalfWidth;
+
+    // path-start-extension, path-end-extension
+    // 方式 ( 1: flush, 2: half-width, 3: 明示 ) と値 (-1 で未定義)
+    ymint64 mStartScheme;
+    ymint64 mStartExt;
+    ymint64 mEndScheme;
+    ymint64 mEndExt;
+
+    // polygon-point-list と path-point-list (空で未定義)
+    vector<ymuint8> mPolygonList;
+    vector<ymuint8> mPathList;
+
+    // repetition (空で未定義)
+    vector<ymuint8> mRepetition;
+
+    // last-property-name が定義されている時 true
+    bool mPropName;
+  };
+
+  // 構造の符号化の結果
+  struct CellCode
+  {
+    // 符号化したバイト列(CBLOCK による圧縮後)
+    vector<ymuint8> mBuf;
+
+    // PLACEMENT レコードの数
+    ymuint64 mPlacementNum;
+
+    // 配置の数
+    ymuint64 mInstanceNum;
+
+    // 図形のレコードの数
+    ymuint64 mShapeNum;
+
+    // 書き出さなかった要素の数
+    ymuint64 mSkipNum;
+
+    // 幅の絶対値で書いた PATH の数
+    ymuint64 mAbsWidthNum;
+
+    // absolute magnification/angle を無視した配置の数
+    ymuint64 mAbsTransNum;
+
+    // 成功した時 true
+    bool mOk;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 名前の表を作る．
+  /// @param[in] data 対象のデータ
+  void
+  make_tables(const GdsData& data);
+
+  /// @brief 構造を一つ符号化する．
+  /// @param[in] str 対象の構造
+  /// @param[out] code 結果
+  void
+  encode_cell(const GdsStruct* str,
+	      CellCode& code) const;
+
+  /// @brief 図形の要素を一つ符号化する．
+  /// @param[in] elem 対象の要素 ( BOUNDARY, BOX, PATH )
+  /// @param[inout] modal モーダル変数
+  /// @param[out] buf 出力先
+  /// @param[inout] code 結果の統計を更新する．
+  void
+  encode_shape(const GdsElement* elem,
+	       Modal& modal,
+	       vector<ymuint8>& buf,
+	       CellCode& code) const;
+
+  /// @brief 多角形を一つ符号化する．
+  /// @param[in] layer, datatype 層番号とデータ型
+  /// @param[in] xy 座標の配列 ( x0, y0, x1, y1, ... )
+  /// @param[in] n 頂点数 ( 始点と同じ終点は含まない )
+  /// @param[inout] modal モーダル変数
+  /// @param[out] buf 出力先
+  /// @retval true 書き出した．
+  /// @retval false 頂点が少ないので書き出さなかった．
+  bool
+  encode_polygon(int layer,
+		 int datatype,
+		 const ymint64* xy,
+		 ymuint n,
+		 Modal& modal,
+		 vector<ymuint8>& buf) const;
+
+  /// @brief TEXT を一つ符号化する．
+  /// @param[in] elem 対象の要素
+  /// @param[inout] modal モーダル変数
+  /// @param[out] buf 出力先
+  void
+  encode_text(const GdsElement* elem,
+	      Modal& modal,
+	      vector<ymuint8>& buf) const;
+
+  /// @brief PLACEMENT を一つ符号化する．
+  /// @param[in] elem 変換を与える要素 ( SREF, AREF )
+  /// @param[in] x, y 配置位置
+  /// @param[in] rep repetition の符号 (空の時は repetition なし)
+  /// @param[inout] modal モーダル変数
+  /// @param[out] buf 出力先
+  void
+  encode_placement(const GdsElement* elem,
+		   ymint64 x,
+		   ymint64 y,
+		   const vector<ymuint8>& rep,
+		   Modal& modal,
+		   vector<ymuint8>& buf) const;
+
+  /// @brief 要素のプロパティを符号化する．
+  /// @param[in] elem 対象の要素
+  /// @param[inout] modal モーダル変数
+  /// @param[out] buf 出力先
+  void
+  encode_property(const GdsElement* elem,
+		  Modal& modal,
+		  vector<ymuint8>& buf) const;
+
+  /// @brief 構造の参照番号を返す．
+  /// @param[in] elem SREF/AREF 要素
+  ymuint
+  cell_ref(const GdsElement* elem) const;
+
+  /// @brief ファイルに書き出す．
+  /// @param[in] s 出力先のストリーム
+  /// @param[in] buf バイト列
+  ///
+  /// buf は空にする．
+  bool
+  put_file(ostream& s,
+	   vector<ymuint8>& buf);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // 圧縮する時 true
+  bool mCompress;
+
+  // 圧縮レベル
+  int mLevel;
+
+  // SREF をまとめる時 true
+  bool mMergePlacement;
+
+  // CELLNAME の表の構造の数以降に登録した名前
+  // (定義されていない構造への参照)
+  vector<string> mExtraName;
+
+  // 定義されていない構造名をキーにして参照番号を保持する辞書
+  std::map<string, ymuint> mExtraMap;
+
+  // 構造の数
+  ymuint32 mStructNum;
+
+  // TEXTSTRING の表
+  vector<string> mTextList;
+
+  // 文字列をキーにして TEXTSTRING の参照番号を保持する辞書
+  std::map<string, ymuint> mTextMap;
+
+  // プロパティを持つ要素がある時 true
+  bool mHasProperty;
+
+  // 書き出したバイト数
+  ymuint64 mFileSize;
+
+  // 統計
+  ymuint64 mPlacementNum;
+  ymuint64 mInstanceNum;
+  ymuint64 mShapeNum;
+  ymuint64 mSkipNum;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSOASISWRITER_H
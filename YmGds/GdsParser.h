@@ -11,7 +11,7 @@
 
 #include "YmGds/gds_nsdef.h"
 #include "YmGds/GdsScanner.h"
-#include "YmUtils/SimpleAlloc.h"
+#include "YmGds/GdsBuilder.h"
 
 
 BEGIN_NAMESPACE_YM_GDS
@@ -43,12 +43,74 @@ public:
   bool
   parse(const string& filename);
 
+  /// @brief 読み込んだデータを返す．
+  ///
+  /// parse() が失敗した場合には NULL を返す．
+  /// 返り値はこのオブジェクトが破壊されるまで有効．
+  const GdsData*
+  data() const;
+
+  /// @brief 回復モードを設定する．
+  /// @param[in] flag true の時誤りのある構造を捨てて読み込みを続ける．
+  ///
+  /// 不正なレコードは GdsScanner の回復モードで読み飛ばす．
+  /// 文法の誤りのある構造は捨てて次の BGNSTR から読み直す．
+  /// 末尾に ENDLIB がなくてもそれまでに読めた構造を返す．
+  /// HEADER から UNITS までに誤りがある場合は回復しない．
+  void
+  set_recover(bool flag);
+
+  /// @brief 直前の parse() で捨てた構造の数を返す．
+  ymuint
+  drop_num() const;
+
+  /// @brief 直前の parse() で不正なレコードを読み飛ばした回数を返す．
+  ymuint
+  skip_num() const;
+
+  /// @brief 進み具合を受け取るハンドラを登録する．
+  /// @param[in] handler ハンドラ (NULL の時は登録を解除する)
+  /// @param[in] interval ハンドラを呼ぶ最小の間隔 (秒)
+  ///
+  /// ハンドラは parse() を呼んだスレッドから呼ばれる．
+  /// 読み込みの最後には間隔に関係なく一度呼ばれる．
+  /// ハンドラが false を返すと cancel() を呼んだのと同じになる．
+  void
+  set_progress(GdsProgressHandler* handler,
+	       double interval = 0.1);
+
+  /// @brief 読み込みを中断する．
+  ///
+  /// 他のスレッドから呼んでもよい．
+  /// レコードの区切りで中断し，parse() は false を返す．
+  /// parse() の前に呼んだ場合は何も読まずに false を返す．
+  /// 中断は reset_cancel() を呼ぶまで解除されない．
+  void
+  cancel();
+
+  /// @brief 中断を解除する．
+  ///
+  /// 中断した後で同じオブジェクトで parse() をやり直す時に呼ぶ．
+  void
+  reset_cancel();
+
+  /// @brief 中断されていたら true を返す．
+  bool
+  cancelled() const;
+
 
 private:
   //////////////////////////////////////////////////////////////////////
   // 内部で用いられる関数
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief 誤りのあった構造の後で次の構造を探す．
+  /// @param[in] offset 誤りのあった構造の BGNSTR のオフセット
+  /// @retval true 次の BGNSTR か ENDLIB が見つかった．
+  /// @retval false 末尾に達した．
+  bool
+  recover(ymuint32 offset);
+
   /// @brief HEADER の読み込み
   ///
   /// エラーが起きたら false を返す．
@@ -125,6 +187,12 @@ private:
   void
   add_element(GdsElement* elem);
 
+  /// @brief 構造の表を作り，参照を解決する．
+  ///
+  /// 全ての構造を読み込んだ後で呼ばれる．
+  void
+  make_struct_table();
+
   /// @brief GdsProperty を作成し，property リストに追加する．
   /// @param[in] attr PROPATTR の値
   /// @param[in] value PROPVALUE の値
@@ -199,8 +267,8 @@ private:
   // データメンバ
   //////////////////////////////////////////////////////////////////////
 
-  // 領域確保用のオブジェクト
-  SimpleAlloc mAlloc;
+  // データを作るオブジェクト
+  GdsBuilder mBuilder;
 
   // 字句解析器
   GdsScanner mScanner;
@@ -217,11 +285,20 @@ private:
   // 現在の GdsProperty の末尾
   GdsProperty* mCurProperty;
 
+  // new_xy() で用いる座標のバッファ
+  vector<ymint32> mXYBuff;
+
   // フォーマット番号
   ymuint8 mFormatType;
 
   // マスクのリスト
   vector<GdsString*> mMasks;
+
+  // 回復モードの時 true
+  bool mRecover;
+
+  // 捨てた構造の数
+  ymuint32 mDropNum;
 };
 
 END_NAMESPACE_YM_GDS
@@ -0,0 +1,171 @@
+﻿#ifndef GDS_GDSPATHEXPANDER_H
+#define GDS_GDSPATHEXPANDER_H
+
+/// @file YmGds/GdsPathExpander.h
+/// @brief GdsPathExpander のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsPathExpander GdsPathExpander.h "YmGds/GdsPathExpander.h"
+/// @brief PATH の輪郭の多角形を求めるクラス
+///
+/// pathtype ごとの端点の扱いは以下の通り．
+/// - 0: 端点で切り落とす．
+/// - 1: 幅を直径とする半円をつける(折れ線で近似する)．
+/// - 2: 幅の半分だけ延長する．
+/// - 4: BGNEXTN/ENDEXTN だけ延長する．
+///
+/// 折れ曲がり部分は留め継ぎ(miter)とするが，90度より鋭い角では
+/// 外側の角を中心線から幅の半分の位置で切り落とす．
+/// 負の幅は絶対値として扱う．
+/// 結果の多角形は反時計回りで，終点を重複させない．
+/// 頂点は一つの配列(プール)に連続して格納される．
+//////////////////////////////////////////////////////////////////////
+class GdsPathExpander
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsPathExpander();
+
+  /// @brief デストラクタ
+  ~GdsPathExpander();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 半円を近似する辺の数を設定する．
+  /// @param[in] num 辺の数 ( 2 以上 )
+  void
+  set_round_segments(ymuint num);
+
+  /// @brief 結果をクリアする．
+  void
+  clear();
+
+  /// @brief PATH を一つ展開して結果に追加する．
+  /// @param[in] elem 対象の要素 ( PATH )
+  /// @retval true 多角形を追加した．
+  /// @retval false 面積を持たないので追加しなかった．
+  bool
+  expand(const GdsElement* elem);
+
+  /// @brief 構造中のすべての PATH を展開して結果に追加する．
+  /// @param[in] str 対象の構造
+  void
+  expand_struct(const GdsStruct* str);
+
+  /// @brief 多角形の数を返す．
+  ymuint
+  polygon_num() const;
+
+  /// @brief 多角形の頂点数を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+  ymuint
+  point_num(ymuint pos) const;
+
+  /// @brief 多角形の座標の配列を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+  ///
+  /// x0, y0, x1, y1, ... の順に point_num(pos) * 2 個の要素を持つ．
+  /// 次に expand() を呼ぶまで有効．
+  const ymint32*
+  polygon_data(ymuint pos) const;
+
+  /// @brief 多角形の元になった要素を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+  const GdsElement*
+  polygon_elem(ymuint pos) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 多角形
+  struct Polygon
+  {
+    // プール中の先頭位置(頂点単位)
+    ymuint32 mPos;
+
+    // 頂点数
+    ymuint32 mNum;
+
+    // 元の要素
+    const GdsElement* mElem;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 点をプールに追加する．
+  /// @param[in] x, y 座標
+  void
+  put_point(double x,
+	    double y);
+
+  /// @brief 円弧をプールに追加する．
+  /// @param[in] cx, cy 中心の座標
+  /// @param[in] r 半径
+  /// @param[in] theta 開始角度(ラジアン)
+  ///
+  /// 開始点と終了点を除いて theta から反時計回りに半周する．
+  void
+  put_arc(double cx,
+	  double cy,
+	  double r,
+	  double theta);
+
+  /// @brief 片側の折れ曲がり部分の点をプールに追加する．
+  /// @param[in] px, py 中心線上の点
+  /// @param[in] dx1, dy1 前の辺の単位方向ベクトル
+  /// @param[in] dx2, dy2 次の辺の単位方向ベクトル
+  /// @param[in] hw 中心線からの符号付き距離(左側が正)
+  void
+  put_join(double px,
+	   double py,
+	   double dx1,
+	   double dy1,
+	   double dx2,
+	   double dy2,
+	   double hw);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 半円を近似する辺の数
+  ymuint32 mRoundSegments;
+
+  // 頂点のプール
+  vector<ymint32> mPool;
+
+  // 多角形のリスト
+  vector<Polygon> mPolygonList;
+
+  // 作業用の中心線の座標
+  vector<double> mCenter;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSPATHEXPANDER_H
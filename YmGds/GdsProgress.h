@@ -0,0 +1,199 @@
+﻿#ifndef GDS_GDSPROGRESS_H
+#define GDS_GDSPROGRESS_H
+
+/// @file YmGds/GdsProgress.h
+/// @brief GdsProgress と GdsProgressHandler のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsProgress GdsProgress.h "YmGds/GdsProgress.h"
+/// @brief 読み込みの進み具合を表すクラス
+///
+/// GdsScanner が作って GdsProgressHandler に渡す．
+//////////////////////////////////////////////////////////////////////
+class GdsProgress
+{
+  friend class GdsScanner;
+
+public:
+
+  /// @brief コンストラクタ
+  GdsProgress();
+
+  /// @brief デストラクタ
+  ~GdsProgress();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 読み込んだバイト数を返す．
+  ymuint64
+  byte_num() const;
+
+  /// @brief 全体のバイト数を返す．
+  ///
+  /// 分からない時は 0 を返す．
+  ymuint64
+  total_size() const;
+
+  /// @brief 読み込んだレコード数を返す．
+  ymuint64
+  record_num() const;
+
+  /// @brief 読み込んだ構造の数を返す．
+  ///
+  /// ENDSTR の数を数える．
+  ymuint64
+  struct_num() const;
+
+  /// @brief 読み込みを始めてからの時間を返す．
+  ///
+  /// 単位は秒
+  double
+  time() const;
+
+  /// @brief 1秒あたりの読み込んだバイト数を返す．
+  double
+  throughput() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 読み込んだバイト数
+  ymuint64 mByteNum;
+
+  // 全体のバイト数
+  ymuint64 mTotalSize;
+
+  // 読み込んだレコード数
+  ymuint64 mRecordNum;
+
+  // 読み込んだ構造の数
+  ymuint64 mStructNum;
+
+  // 経過時間
+  double mTime;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsProgressHandler GdsProgress.h "YmGds/GdsProgress.h"
+/// @brief 読み込みの進み具合を受け取るクラスの基底クラス
+///
+/// GdsScanner::set_progress() か GdsParser::set_progress() で登録する．
+/// 呼び出しの間隔は登録する時に指定した時間以上になる．
+/// 読み込みを行っているスレッドから呼ばれる．
+//////////////////////////////////////////////////////////////////////
+class GdsProgressHandler
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsProgressHandler() { }
+
+  /// @brief デストラクタ
+  virtual
+  ~GdsProgressHandler() { }
+
+  /// @brief 進み具合を受け取る．
+  /// @param[in] progress 進み具合
+  /// @retval true 読み込みを続ける．
+  /// @retval false 読み込みを中断する．
+  virtual
+  bool
+  operator()(const GdsProgress& progress) = 0;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+inline
+GdsProgress::GdsProgress() :
+  mByteNum(0),
+  mTotalSize(0),
+  mRecordNum(0),
+  mStructNum(0),
+  mTime(0.0)
+{
+}
+
+// @brief デストラクタ
+inline
+GdsProgress::~GdsProgress()
+{
+}
+
+// @brief 読み込んだバイト数を返す．
+inline
+ymuint64
+GdsProgress::byte_num() const
+{
+  return mByteNum;
+}
+
+// @brief 全体のバイト数を返す．
+inline
+ymuint64
+GdsProgress::total_size() const
+{
+  return mTotalSize;
+}
+
+// @brief 読み込んだレコード数を返す．
+inline
+ymuint64
+GdsProgress::record_num() const
+{
+  return mRecordNum;
+}
+
+// @brief 読み込んだ構造の数を返す．
+inline
+ymuint64
+GdsProgress::struct_num() const
+{
+  return mStructNum;
+}
+
+// @brief 読み込みを始めてからの時間を返す．
+inline
+double
+GdsProgress::time() const
+{
+  return mTime;
+}
+
+// @brief 1秒あたりの読み込んだバイト数を返す．
+inline
+double
+GdsProgress::throughput() const
+{
+  if ( mTime <= 0.0 ) {
+    return 0.0;
+  }
+  return mByteNum / mTime;
+}
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSPROGRESS_H
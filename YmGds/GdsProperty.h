@@ -21,7 +21,7 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 class GdsProperty
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 private:
 
@@ -50,7 +50,7 @@ public:
 
   /// @brief 次の要素を返す．
   const GdsProperty*
-  next();
+  next() const;
 
 
 private:
@@ -111,7 +111,7 @@ GdsProperty::value() const
 // @brief 次の要素を返す．
 inline
 const GdsProperty*
-GdsProperty::next()
+GdsProperty::next() const
 {
   return mLink;
 }
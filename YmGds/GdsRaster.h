@@ -0,0 +1,349 @@
+﻿#ifndef GDS_GDSRASTER_H
+#define GDS_GDSRASTER_H
+
+/// @file YmGds/GdsRaster.h
+/// @brief GdsRaster のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsBBox.h"
+#include "YmGds/GdsTrans.h"
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsRaster GdsRaster.h "YmGds/GdsRaster.h"
+/// @brief レイアウトの一部を画像に描画するクラス
+///
+/// 画像は横長の帯に分けて並列に描画する．
+/// 帯ごとに，その帯と重なる配置だけを階層をたどって求め，
+/// 多角形をスキャンラインで塗りつぶす．
+/// 変換後の外接矩形が指定した画素数より小さい配置は
+/// 子孫をたどらずに層ごとの外接矩形で塗りつぶす．
+/// 1画素より小さい図形も外接矩形で塗りつぶす．
+///
+/// 層は層番号の順に重ねる．最初の層はそのままの色で，
+/// 以降の層は下の色と半分ずつ混ぜて描く．
+//////////////////////////////////////////////////////////////////////
+class GdsRaster
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsRaster();
+
+  /// @brief デストラクタ
+  ~GdsRaster();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief 画像の大きさを設定する．
+  /// @param[in] width 幅(画素数)
+  /// @param[in] height 高さ(画素数)
+  ///
+  /// 一方が 0 の時は描画する領域の縦横比から決める．
+  void
+  set_size(ymuint width,
+	   ymuint height);
+
+  /// @brief 描画する領域を設定する．
+  /// @param[in] window 領域
+  ///
+  /// 空の矩形の時は最上位の構造の外接矩形を用いる．
+  /// 画像の縦横比と合わない場合には中央に寄せて描く．
+  void
+  set_window(const GdsBBox& window);
+
+  /// @brief 詳細を省略する配置の大きさを設定する．
+  /// @param[in] pixels 画素数
+  ///
+  /// 変換後の外接矩形の幅と高さがともに pixels 未満の配置は
+  /// 外接矩形で描く．0 の時は省略しない．既定値は 1 ．
+  void
+  set_lod(ymuint pixels);
+
+  /// @brief 背景色を設定する．
+  /// @param[in] rgb 色 ( 0xRRGGBB )
+  void
+  set_background(ymuint32 rgb);
+
+  /// @brief 層の色を設定する．
+  /// @param[in] layer 層番号
+  /// @param[in] datatype データ型
+  /// @param[in] rgb 色 ( 0xRRGGBB )
+  ///
+  /// 設定しなかった層には既定の色を順に割り当てる．
+  void
+  set_color(int layer,
+	    int datatype,
+	    ymuint32 rgb);
+
+  /// @brief 描画する．
+  /// @param[in] data 対象のデータ
+  /// @param[in] top_name 最上位の構造名
+  /// @retval true 成功した．
+  /// @retval false 最上位の構造が決まらないか階層が循環していた．
+  ///
+  /// top_name が NULL の時は唯一の最上位の構造を用いる．
+  bool
+  render(const GdsData& data,
+	 const char* top_name);
+
+  /// @brief 画像の幅を返す．
+  ymuint
+  width() const;
+
+  /// @brief 画像の高さを返す．
+  ymuint
+  height() const;
+
+  /// @brief 実際に描画した領域を返す．
+  ///
+  /// 画像の縦横比に合わせて広げたものになる．
+  const GdsBBox&
+  window() const;
+
+  /// @brief 画素の値を返す．
+  ///
+  /// 上の行から順に1画素あたり R, G, B の3バイトが並ぶ．
+  const ymuint8*
+  image() const;
+
+  /// @brief 描画のためにたどった配置の数を返す．
+  ymuint64
+  instance_num() const;
+
+  /// @brief 外接矩形で描いた配置の数を返す．
+  ymuint64
+  lod_num() const;
+
+  /// @brief PPM(P6) 形式で書き出す．
+  /// @param[in] s 出力先のストリーム
+  /// @retval true 成功した．
+  /// @retval false 書き込みに失敗した．
+  bool
+  write_ppm(ostream& s) const;
+
+  /// @brief PNG 形式で書き出す．
+  /// @param[in] s 出力先のストリーム
+  /// @retval true 成功した．
+  /// @retval false 圧縮か書き込みに失敗した．
+  bool
+  write_png(ostream& s) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 構造中の一つの多角形
+  struct CellShape
+  {
+    // 層の位置番号
+    ymuint32 mLayer;
+
+    // 頂点のプール中の先頭位置(頂点単位)
+    ymuint32 mPos;
+
+    // 頂点数
+    ymuint32 mNum;
+
+    // 外接矩形
+    GdsBBox mBBox;
+  };
+
+  // 一つの構造の描画用のデータ
+  struct Cell
+  {
+    // 頂点のプール
+    vector<ymint32> mPool;
+
+    // 多角形のリスト
+    vector<CellShape> mShapeList;
+
+    // 子孫を含めた層ごとの外接矩形のリスト
+    vector<std::pair<ymuint32, GdsBBox> > mLayerBBoxList;
+
+    // 子孫を含めた外接矩形
+    GdsBBox mBBox;
+  };
+
+  // 一つの帯の描画用の作業領域
+  struct Band
+  {
+    // 先頭の行
+    ymuint32 mRow0;
+
+    // 行数
+    ymuint32 mRowNum;
+
+    // 帯に対応する矩形
+    GdsBBox mBBox;
+
+    // 層ごとの塗りつぶしのフラグ
+    // ( layer * mRowNum + row ) * mWidth + col 番めの要素が対応する．
+    vector<ymuint8> mCover;
+
+    // たどった配置の数
+    ymuint64 mInstanceNum;
+
+    // 外接矩形で描いた配置の数
+    ymuint64 mLodNum;
+
+    // 多角形の頂点の作業領域
+    vector<double> mPointBuf;
+
+    // スキャンラインとの交点の作業領域
+    vector<double> mCrossBuf;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 構造中の図形を集める．
+  /// @param[in] str 対象の構造
+  /// @param[out] cell 結果を格納するオブジェクト
+  void
+  make_cell(const GdsStruct* str,
+	    Cell& cell) const;
+
+  /// @brief 一つの帯を描画する．
+  /// @param[in] top 最上位の構造
+  /// @param[in] band 帯
+  ///
+  /// band の mRow0 と mRowNum は設定されているものとする．
+  void
+  render_band(const GdsStruct* top,
+	      Band& band);
+
+  /// @brief 構造を帯に描画する．
+  /// @param[in] str 対象の構造
+  /// @param[in] trans 座標変換
+  /// @param[in] band 帯
+  void
+  draw_struct(const GdsStruct* str,
+	      const GdsTrans& trans,
+	      Band& band) const;
+
+  /// @brief 多角形を帯に描画する．
+  /// @param[in] layer 層の位置番号
+  /// @param[in] data 頂点座標の配列
+  /// @param[in] n 頂点数
+  /// @param[in] trans 座標変換
+  /// @param[in] band 帯
+  void
+  fill_polygon(ymuint layer,
+	       const ymint32* data,
+	       ymuint n,
+	       const GdsTrans& trans,
+	       Band& band) const;
+
+  /// @brief 矩形を帯に描画する．
+  /// @param[in] layer 層の位置番号
+  /// @param[in] bbox 矩形
+  /// @param[in] band 帯
+  ///
+  /// 少しでも重なる画素を塗りつぶす．
+  void
+  fill_rect(ymuint layer,
+	    const GdsBBox& bbox,
+	    Band& band) const;
+
+  /// @brief X 座標を画素の単位に変換する．
+  double
+  to_col(double x) const;
+
+  /// @brief Y 座標を画素の単位に変換する．
+  double
+  to_row(double y) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // 指定された幅
+  ymuint32 mReqWidth;
+
+  // 指定された高さ
+  ymuint32 mReqHeight;
+
+  // 指定された領域
+  GdsBBox mReqWindow;
+
+  // 詳細を省略する配置の大きさ(画素数)
+  ymuint32 mLod;
+
+  // 背景色
+  ymuint32 mBackground;
+
+  // 指定された色の辞書
+  // キーは (layer << 16) | datatype
+  std::map<ymuint32, ymuint32> mColorMap;
+
+  // 画像の幅
+  ymuint32 mWidth;
+
+  // 画像の高さ
+  ymuint32 mHeight;
+
+  // 実際に描画した領域
+  GdsBBox mWindow;
+
+  // 1画素あたりの長さ(database unit)
+  double mScale;
+
+  // 画像の左端の X 座標
+  double mLeft;
+
+  // 画像の上端の Y 座標
+  double mTop;
+
+  // 描画する (layer, datatype) のリスト
+  vector<ymuint32> mKeyList;
+
+  // 層ごとの色
+  vector<ymuint32> mColorList;
+
+  // 構造のID番号をキーにした描画用のデータの配列
+  vector<Cell> mCellArray;
+
+  // 画素の値
+  vector<ymuint8> mImage;
+
+  // たどった配置の数
+  ymuint64 mInstanceNum;
+
+  // 外接矩形で描いた配置の数
+  ymuint64 mLodNum;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSRASTER_H
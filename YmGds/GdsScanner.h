@@ -10,6 +10,7 @@
 
 
 #include "YmGds/gds_nsdef.h"
+#include <atomic>
 
 
 BEGIN_NAMESPACE_YM_GDS
@@ -17,6 +18,17 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 /// @class GdsScanner GdsScanner.h "YmGds/GdsScanner.h"
 /// @brief GDS-II の読み込みを行うクラス
+///
+/// set_recover() で回復モードにすると，不正なレコードを見つけた時に
+/// エラーを出力した後で読み込みを続ける．その際には以降で
+/// 続けていくつかのレコードが正しく読める BGNSTR か ENDLIB を探して，
+/// そこから読み直す．構造の途中から読み直しても要素の並びが
+/// 分からないので，BGNSTR を優先する．
+///
+/// set_progress() でハンドラを登録すると，読み込みの進み具合を
+/// 一定の時間間隔で知らせる．cancel() は他のスレッドから呼んでもよく，
+/// 次のレコードを読む前に読み込みを中断する．どちらも使わない時の
+/// 負荷はレコードごとにフラグを一つ調べるだけである．
 //////////////////////////////////////////////////////////////////////
 class GdsScanner
 {
@@ -41,10 +53,88 @@ public:
   bool
   open_file(const string& filename);
 
+  /// @brief メモリ上のデータを読み込む対象にする．
+  /// @param[in] data データの先頭
+  /// @param[in] size データのサイズ
+  /// @param[in] base data の先頭のファイル上の位置
+  ///
+  /// data は読み込みが終わるまで有効でなければならない．
+  /// mmap() した領域の一部を読む時などに用いる．
+  /// cur_offset() と cur_pos() は data の先頭からの位置となる．
+  /// base はエラーメッセージに出す位置にだけ用いる．
+  void
+  open_memory(const ymuint8* data,
+	      ymuint32 size,
+	      ymuint64 base = 0);
+
   /// @brief ファイルを閉じる．
   void
   close_file();
 
+  /// @brief 回復モードを設定する．
+  /// @param[in] flag true の時不正なレコードを読み飛ばして続ける．
+  void
+  set_recover(bool flag);
+
+  /// @brief 次の BGNSTR か ENDLIB まで読み飛ばして読み込む．
+  /// @retval true 見つかった．
+  /// @retval false 末尾に達した．
+  ///
+  /// 直前に読んだレコードの次から探す．
+  /// 見つかったレコードは read_rec() で読んだものと同様に扱える．
+  /// パーサーが文法の誤りから回復する時に用いる．
+  bool
+  skip_to_structure();
+
+  /// @brief 読み飛ばしを行った回数を返す．
+  ymuint
+  recover_num() const;
+
+  /// @brief 読み飛ばしたバイト数の合計を返す．
+  ymuint64
+  skip_size() const;
+
+  /// @brief 進み具合を受け取るハンドラを登録する．
+  /// @param[in] handler ハンドラ (NULL の時は登録を解除する)
+  /// @param[in] interval ハンドラを呼ぶ最小の間隔 (秒)
+  ///
+  /// ハンドラが false を返すと cancel() を呼んだのと同じになる．
+  void
+  set_progress(GdsProgressHandler* handler,
+	       double interval = 0.1);
+
+  /// @brief 現在の進み具合をハンドラに渡す．
+  ///
+  /// 間隔に関係なく呼ぶ．読み込みの最後に用いる．
+  /// ハンドラが登録されていなければ何もしない．
+  void
+  report_progress();
+
+  /// @brief 読み込みを中断する．
+  ///
+  /// 他のスレッドから呼んでもよい．
+  /// 以降の read_rec() は false を返す．
+  /// ファイルを開く前に呼んでも有効で，reset_cancel() を呼ぶまで解除されない．
+  void
+  cancel();
+
+  /// @brief 中断を解除する．
+  ///
+  /// 他のスレッドからの cancel() と競合しないよう，
+  /// 読み込みを始める前に呼び出し側で呼ぶ．
+  void
+  reset_cancel();
+
+  /// @brief 読み込みが中断されていたら true を返す．
+  bool
+  cancelled() const;
+
+  /// @brief 読み込んだバイト数を返す．
+  ///
+  /// cur_pos() と異なり 4GB を超えても正しい値を返す．
+  ymuint64
+  byte_num() const;
+
   /// @brief レコード一つ分の読み込みを行う．
   /// @retval true 読み込みが成功した．
   /// @retval false エラーが起った場合や末尾に達した場合
@@ -105,6 +195,43 @@ private:
   // 内部で用いられる関数
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief レコード一つ分の読み込みを行う．
+  /// @retval 0 読み込みが成功した．
+  /// @retval 1 末尾に達した．
+  /// @retval 2 不正なレコードだった．
+  int
+  read_rec_sub();
+
+  /// @brief 進み具合の記録を初期化する．
+  void
+  init_progress();
+
+  /// @brief 前回から interval 以上経っていたらハンドラを呼ぶ．
+  void
+  check_progress();
+
+  /// @brief BGNSTR か ENDLIB の先頭まで読み飛ばす．
+  /// @retval true 見つかった．
+  /// @retval false 末尾に達した．
+  ///
+  /// 見つかったレコードの先頭からは mPending から読み出す．
+  bool
+  resync();
+
+  /// @brief resync() 用に window の大きさが size 以上になるまで読み込む．
+  /// @retval true 読み込めた．
+  /// @retval false 末尾に達した．
+  bool
+  fill_window(vector<ymuint8>& window,
+	      ymuint64 size);
+
+  /// @brief window 上の pos から始まるレコードのヘッダを調べる．
+  /// @return 正しければレコードのサイズを，そうでなければ 0 を返す．
+  static
+  ymuint
+  check_header(const vector<ymuint8>& window,
+	       ymuint64 pos);
+
   /// @brief 2バイト読んで符号なし整数に変換する．
   /// @param[out] val 読み込んだ値を格納する変数
   /// @retval true 読み込みが成功した．
@@ -144,6 +271,26 @@ private:
   // 入力のファイル記述子
   int mFd;
 
+  // 入力のメモリ領域
+  // open_memory() の時のみ NULL 以外の値を持つ．
+  const ymuint8* mMemData;
+
+  // mMemData のサイズ
+  ymuint32 mMemSize;
+
+  // mMemData の読み出し位置
+  ymuint32 mMemPos;
+
+  // 全体のバイト数
+  // 分からない時は 0
+  ymuint64 mTotalSize;
+
+  // raw_read() で読み込んだバイト数
+  ymuint64 mRawPos;
+
+  // メッセージに出す位置に足す値
+  ymuint64 mMsgBase;
+
   // ファイルバッファ
   ymuint8 mBuff[4096];
 
@@ -174,6 +321,47 @@ private:
   // mCurData のサイズ
   ymuint32 mBuffSize;
 
+  // 回復モードの時 true
+  bool mRecover;
+
+  // resync() で先読みして読み戻すデータ
+  vector<ymuint8> mPending;
+
+  // mPending の読み出し位置
+  ymuint32 mPendPos;
+
+  // 読み飛ばしを行った回数
+  ymuint32 mRecoverNum;
+
+  // 読み飛ばしたバイト数の合計
+  ymuint64 mSkipSize;
+
+  // 進み具合を受け取るハンドラ
+  GdsProgressHandler* mProgress;
+
+  // ハンドラを呼ぶ最小の間隔 (秒)
+  double mInterval;
+
+  // 読み込みを始めた時刻 (秒)
+  double mStartTime;
+
+  // 前回ハンドラを呼んだ時刻 (秒)
+  double mLastTime;
+
+  // 次に時刻を調べるバイト数
+  ymuint64 mNextCheck;
+
+  // 読み込んだレコード数
+  // ハンドラが登録されている時のみ数える．
+  ymuint64 mRecordNum;
+
+  // 読み込んだ構造の数
+  // ハンドラが登録されている時のみ数える．
+  ymuint64 mStructNum;
+
+  // 中断を表すフラグ
+  std::atomic<bool> mCancel;
+
 };
 
 
@@ -237,6 +425,62 @@ GdsScanner::cur_data() const
   return mDataBuff;
 }
 
+// @brief 回復モードを設定する．
+inline
+void
+GdsScanner::set_recover(bool flag)
+{
+  mRecover = flag;
+}
+
+// @brief 読み飛ばしを行った回数を返す．
+inline
+ymuint
+GdsScanner::recover_num() const
+{
+  return mRecoverNum;
+}
+
+// @brief 読み飛ばしたバイト数の合計を返す．
+inline
+ymuint64
+GdsScanner::skip_size() const
+{
+  return mSkipSize;
+}
+
+// @brief 読み込みを中断する．
+inline
+void
+GdsScanner::cancel()
+{
+  mCancel.store(true, std::memory_order_relaxed);
+}
+
+// @brief 中断を解除する．
+inline
+void
+GdsScanner::reset_cancel()
+{
+  mCancel.store(false, std::memory_order_relaxed);
+}
+
+// @brief 読み込みが中断されていたら true を返す．
+inline
+bool
+GdsScanner::cancelled() const
+{
+  return mCancel.load(std::memory_order_relaxed);
+}
+
+// @brief 読み込んだバイト数を返す．
+inline
+ymuint64
+GdsScanner::byte_num() const
+{
+  return mRawPos - (mEndPos - mReadPos) - (mPending.size() - mPendPos);
+}
+
 END_NAMESPACE_YM_GDS
 
 #endif // GDS_GDSSCANNER_H
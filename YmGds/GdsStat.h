@@ -0,0 +1,288 @@
+﻿#ifndef GDS_GDSSTAT_H
+#define GDS_GDSSTAT_H
+
+/// @file YmGds/GdsStat.h
+/// @brief GdsStat のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsBBox.h"
+#include "YmGds/GdsGeom.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsLayerStat GdsStat.h "YmGds/GdsStat.h"
+/// @brief (layer, datatype) ごとの統計情報を表すクラス
+///
+/// BOX の場合は boxtype を，TEXT の場合は texttype を datatype とみなす．
+//////////////////////////////////////////////////////////////////////
+class GdsLayerStat
+{
+  friend class GdsStat;
+
+public:
+
+  /// @brief コンストラクタ
+  GdsLayerStat();
+
+  /// @brief デストラクタ
+  ~GdsLayerStat();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 層番号を返す．
+  int
+  layer() const;
+
+  /// @brief データ型を返す．
+  int
+  datatype() const;
+
+  /// @brief ファイル中の BOUNDARY の数を返す．
+  ymuint64
+  boundary_num() const;
+
+  /// @brief ファイル中の PATH の数を返す．
+  ymuint64
+  path_num() const;
+
+  /// @brief ファイル中の BOX の数を返す．
+  ymuint64
+  box_num() const;
+
+  /// @brief ファイル中の TEXT の数を返す．
+  ymuint64
+  text_num() const;
+
+  /// @brief ファイル中の頂点数の合計を返す．
+  ymuint64
+  vertex_num() const;
+
+  /// @brief 展開後の図形(BOUNDARY/PATH/BOX)の数を返す．
+  ymuint64
+  flat_num() const;
+
+  /// @brief 展開後の面積の合計を返す．
+  ///
+  /// 単位は database unit の2乗．
+  /// 図形どうしの重なりは考慮しない．
+  double
+  area() const;
+
+  /// @brief 展開後の面積の合計の2倍を返す．
+  ///
+  /// PATH は GdsPathExpander で求めた輪郭の面積を数える．
+  /// 整数で計算しているので誤差はない．
+  tGdsInt128
+  polygon_area2() const;
+
+  /// @brief 展開後の周囲長の合計を返す．
+  ///
+  /// PATH は輪郭の長さを数える．
+  double
+  perimeter() const;
+
+  /// @brief 展開後の外接矩形を返す．
+  const GdsBBox&
+  bbox() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 層番号
+  ymint16 mLayer;
+
+  // データ型
+  ymint16 mDataType;
+
+  // BOUNDARY の数
+  ymuint64 mBoundaryNum;
+
+  // PATH の数
+  ymuint64 mPathNum;
+
+  // BOX の数
+  ymuint64 mBoxNum;
+
+  // TEXT の数
+  ymuint64 mTextNum;
+
+  // 頂点数
+  ymuint64 mVertexNum;
+
+  // 展開後の図形数
+  ymuint64 mFlatNum;
+
+  // 展開後の面積の2倍
+  tGdsInt128 mPolygonArea2;
+
+  // 展開後の周囲長
+  double mPerimeter;
+
+  // 展開後の外接矩形
+  GdsBBox mBBox;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsStat GdsStat.h "YmGds/GdsStat.h"
+/// @brief GdsData の統計情報を求めるクラス
+///
+/// 構造ごとの集計は複数のスレッドで並列に行う．
+/// 展開後の値は階層を展開せずに，各構造の配置数を掛けて求める．
+//////////////////////////////////////////////////////////////////////
+class GdsStat
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsStat();
+
+  /// @brief デストラクタ
+  ~GdsStat();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief 統計情報を求める．
+  /// @param[in] data 対象のデータ
+  /// @param[in] top_name 最上位の構造名
+  /// @retval true 成功した．
+  /// @retval false 失敗した．
+  ///
+  /// top_name が NULL の時はどこからも参照されていない構造をすべて
+  /// 最上位とみなす．
+  /// top_name が見つからない場合や階層が循環している場合は失敗する．
+  bool
+  compute(const GdsData& data,
+	  const char* top_name = NULL);
+
+  /// @brief (layer, datatype) の種類の数を返す．
+  ymuint
+  layer_num() const;
+
+  /// @brief (layer, datatype) ごとの統計情報を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  ///
+  /// (layer, datatype) の昇順に並んでいる．
+  const GdsLayerStat&
+  layer_stat(ymuint pos) const;
+
+  /// @brief 最上位の構造の数を返す．
+  ymuint
+  top_num() const;
+
+  /// @brief 最上位の構造を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < top_num() )
+  const GdsStruct*
+  top(ymuint pos) const;
+
+  /// @brief 構造の配置数を返す．
+  /// @param[in] id 構造のID番号
+  ///
+  /// 最上位の構造の下で何回使われているかを返す．
+  /// 最上位の構造自身は 1 となる．
+  ymuint64
+  instance_count(ymuint id) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 一つの構造内の (layer, datatype) ごとの集計値
+  struct LocalStat
+  {
+    // (layer << 16) | datatype
+    ymuint32 mKey;
+
+    // BOUNDARY の数
+    ymuint64 mBoundaryNum;
+
+    // PATH の数
+    ymuint64 mPathNum;
+
+    // BOX の数
+    ymuint64 mBoxNum;
+
+    // TEXT の数
+    ymuint64 mTextNum;
+
+    // 頂点数
+    ymuint64 mVertexNum;
+
+    // 面積の2倍
+    tGdsInt128 mPolygonArea2;
+
+    // 周囲長
+    double mPerimeter;
+
+    // 外接矩形
+    GdsBBox mBBox;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 一つの構造内の集計を行う．
+  /// @param[in] str 対象の構造
+  /// @param[out] stat_list 結果を格納するリスト
+  ///
+  /// 結果は mKey の昇順に並ぶ．
+  static
+  void
+  calc_local(const GdsStruct* str,
+	     vector<LocalStat>& stat_list);
+
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint mThreadNum;
+
+  // (layer, datatype) ごとの統計情報
+  vector<GdsLayerStat> mLayerStatList;
+
+  // 最上位の構造のリスト
+  vector<const GdsStruct*> mTopList;
+
+  // 構造ごとの配置数
+  vector<ymuint64> mCountArray;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSSTAT_H
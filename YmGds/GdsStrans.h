@@ -20,7 +20,7 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 class GdsStrans
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 private:
 
@@ -53,6 +53,18 @@ public:
   double
   angle() const;
 
+  /// @brief reflection ビットが立っていたら true を返す．
+  bool
+  reflection() const;
+
+  /// @brief absolute magnification ビットが立っていたら true を返す．
+  bool
+  absolute_magnification() const;
+
+  /// @brief absolute angle ビットが立っていたら true を返す．
+  bool
+  absolute_angle() const;
+
 
 private:
   //////////////////////////////////////////////////////////////////////
@@ -119,6 +131,33 @@ GdsStrans::angle() const
   return mAngle;
 }
 
+// @brief reflection ビットが立っていたら true を返す．
+inline
+bool
+GdsStrans::reflection() const
+{
+  // bit 0 (MSB)
+  return static_cast<bool>((mFlags >> 15) & 1U);
+}
+
+// @brief absolute magnification ビットが立っていたら true を返す．
+inline
+bool
+GdsStrans::absolute_magnification() const
+{
+  // bit 13
+  return static_cast<bool>((mFlags >> 2) & 1U);
+}
+
+// @brief absolute angle ビットが立っていたら true を返す．
+inline
+bool
+GdsStrans::absolute_angle() const
+{
+  // bit 14
+  return static_cast<bool>((mFlags >> 1) & 1U);
+}
+
 END_NAMESPACE_YM_GDS
 
 #endif // GDS_GDSSTRANS_H
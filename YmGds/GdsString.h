@@ -20,7 +20,7 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 class GdsString
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 private:
 
@@ -20,7 +20,8 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 class GdsStruct
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
+  friend class GdsData;
 
 private:
 
@@ -39,6 +40,12 @@ public:
   // 外部インターフェイス
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief ID番号を返す．
+  ///
+  /// ID番号はファイル中の出現順に 0 から振られる．
+  ymuint
+  id() const;
+
   /// @brief生成日時を返す．
   const GdsDate&
   creation_time() const;
@@ -65,6 +72,9 @@ private:
   // データメンバ
   //////////////////////////////////////////////////////////////////////
 
+  // ID番号
+  ymuint32 mId;
+
   // 生成日時
   GdsDate* mCreationTime;
 
@@ -80,6 +90,9 @@ private:
   // 次の要素
   GdsStruct* mLink;
 
+  // ハッシュ表中の次の要素
+  GdsStruct* mHashLink;
+
 };
 
 END_NAMESPACE_YM_GDS
@@ -0,0 +1,151 @@
+﻿#ifndef GDS_GDSSTRUCTHASH_H
+#define GDS_GDSSTRUCTHASH_H
+
+/// @file YmGds/GdsStructHash.h
+/// @brief GdsStructHash のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsHashValue.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsStructHash GdsStructHash.h "YmGds/GdsStructHash.h"
+/// @brief 構造の内容から 128 ビットのハッシュ値を求めるクラス
+///
+/// 構造のハッシュ値は要素の内容(プロパティを含む)から求める．
+/// SREF/AREF は参照先の構造の名前ではなくハッシュ値を用いるので，
+/// 名前だけが異なる構造は同じハッシュ値を持ち，
+/// 子孫の構造が変化すると祖先の構造のハッシュ値も変化する．
+/// 構造自身の名前と日付は含まない．
+///
+/// 子供の構造から順に，段ごとに並列に求める．
+//////////////////////////////////////////////////////////////////////
+class GdsStructHash
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsStructHash();
+
+  /// @brief デストラクタ
+  ~GdsStructHash();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief 要素の順番を無視するかどうかを設定する．
+  /// @param[in] flag true の時は要素の順番を無視する．
+  ///
+  /// デフォルトは false
+  void
+  set_order_insensitive(bool flag);
+
+  /// @brief 構造ごとのハッシュ値を求める．
+  /// @param[in] data 対象のデータ
+  /// @retval true 成功した．
+  /// @retval false 階層が循環していた．
+  bool
+  compute(const GdsData& data);
+
+  /// @brief 構造数を返す．
+  ymuint
+  struct_num() const;
+
+  /// @brief 構造のハッシュ値を返す．
+  /// @param[in] id 構造のID番号 ( 0 <= id < struct_num() )
+  const GdsHashValue&
+  hash(ymuint id) const;
+
+  /// @brief 要素のハッシュ値を返す．
+  /// @param[in] elem 対象の要素
+  ///
+  /// SREF/AREF の参照先の構造は compute() で求めたハッシュ値を用いる．
+  GdsHashValue
+  elem_hash(const GdsElement* elem) const;
+
+  /// @brief SREF/AREF の配置のハッシュ値を返す．
+  /// @param[in] elem 対象の要素 ( SREF/AREF )
+  ///
+  /// 参照先の構造は内容ではなく名前で区別する．
+  static
+  GdsHashValue
+  place_hash(const GdsElement* elem);
+
+  /// @brief プロパティを除いた要素のハッシュ値を返す．
+  /// @param[in] elem 対象の要素
+  ///
+  /// SREF/AREF は place_hash() と同じ値を返す．
+  static
+  GdsHashValue
+  shape_hash(const GdsElement* elem);
+
+  /// @brief 要素のプロパティのハッシュ値を返す．
+  /// @param[in] elem 対象の要素
+  static
+  GdsHashValue
+  property_hash(const GdsElement* elem);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 構造のハッシュ値を求める．
+  /// @param[in] str 対象の構造
+  ///
+  /// 子供の構造のハッシュ値は求められていなければならない．
+  GdsHashValue
+  calc_struct(const GdsStruct* str) const;
+
+  /// @brief SREF/AREF のハッシュ値を求める．
+  /// @param[in] elem 対象の要素
+  /// @param[in] child_hash 参照先の構造を表すハッシュ値
+  static
+  GdsHashValue
+  ref_hash(const GdsElement* elem,
+	   const GdsHashValue& child_hash);
+
+  /// @brief SREF/AREF 以外の要素のプロパティを除いたハッシュ値を求める．
+  /// @param[in] elem 対象の要素
+  static
+  GdsHashValue
+  body_hash(const GdsElement* elem);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // 要素の順番を無視する時 true
+  bool mOrderInsensitive;
+
+  // 構造のID番号をキーにしたハッシュ値の配列
+  vector<GdsHashValue> mHashArray;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSSTRUCTHASH_H
@@ -0,0 +1,265 @@
+﻿#ifndef GDS_GDSSTRUCTINDEX_H
+#define GDS_GDSSTRUCTINDEX_H
+
+/// @file YmGds/GdsStructIndex.h
+/// @brief GdsStructIndex のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsStructIndex GdsStructIndex.h "YmGds/GdsStructIndex.h"
+/// @brief GDS-II ファイル中の構造の位置を表す索引
+///
+/// ファイルは mmap() で読み込み，構造ごとにファイル上の範囲
+/// ( BGNSTR から ENDSTR まで ) と名前を記録する．
+/// 要素は解釈しないので，必要な構造のバイト列だけを読めばよい．
+///
+/// 索引はファイルに保存しておくことができる．
+/// 保存した索引は元のファイルのサイズと更新時刻 (ナノ秒まで) が一致し，
+/// さらに記録した位置に同じ名前の構造が実際にある時のみ読み込む．
+/// 保存した索引を使えば元のファイルのうち必要な構造の部分しか読まない．
+/// 圧縮されたファイルは扱えない．
+//////////////////////////////////////////////////////////////////////
+class GdsStructIndex
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsStructIndex();
+
+  /// @brief デストラクタ
+  ~GdsStructIndex();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief ファイルを開く．
+  /// @param[in] filename ファイル名
+  /// @retval true 成功した．
+  /// @retval false ファイルが読めなかった．
+  ///
+  /// この時点では索引は作らない．
+  bool
+  open(const char* filename);
+
+  /// @brief ファイルを閉じる．
+  void
+  close();
+
+  /// @brief ファイルをたどって索引を作る．
+  /// @retval true 成功した．
+  /// @retval false 形式が正しくなかった．
+  ///
+  /// レコードの先頭だけをたどるので要素は解釈しない．
+  bool
+  build();
+
+  /// @brief 保存した索引を読み込む．
+  /// @param[in] filename 索引のファイル名
+  /// @retval true 成功した．
+  /// @retval false 索引が読めないか元のファイルと一致しなかった．
+  ///
+  /// 失敗してもエラーメッセージは出力しない．
+  /// 各構造の位置に BGNSTR と記録した名前の STRNAME があり，
+  /// 末尾が ENDSTR であることを元のファイル上で確かめる．
+  bool
+  read_index(const char* filename);
+
+  /// @brief 索引を保存する．
+  /// @param[in] filename 索引のファイル名
+  /// @retval true 成功した．
+  /// @retval false 書き込みに失敗した．
+  bool
+  write_index(const char* filename) const;
+
+  /// @brief 保存した索引を読み込み，使えなければ作り直す．
+  /// @param[in] filename 索引のファイル名 (NULL の時は保存した索引を用いない)
+  /// @param[in] save true の時は作り直した索引を filename に保存する．
+  /// @retval true 成功した．
+  /// @retval false 形式が正しくなかった．
+  ///
+  /// 索引を保存できなくても true を返す．
+  bool
+  read_or_build(const char* filename,
+		bool save);
+
+  /// @brief 索引のファイル名の既定値を返す．
+  /// @param[in] filename GDS-II ファイル名
+  static
+  string
+  default_index_name(const string& filename);
+
+  /// @brief ファイルの先頭を返す．
+  const ymuint8*
+  data() const;
+
+  /// @brief ファイルのサイズを返す．
+  ymuint64
+  file_size() const;
+
+  /// @brief 最初の構造の前のヘッダ部分のサイズを返す．
+  ymuint64
+  header_size() const;
+
+  /// @brief 構造の数を返す．
+  ymuint
+  struct_num() const;
+
+  /// @brief 構造の名前を返す．
+  /// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+  const string&
+  struct_name(ymuint id) const;
+
+  /// @brief 構造のファイル上の先頭位置を返す．
+  /// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+  ymuint64
+  struct_offset(ymuint id) const;
+
+  /// @brief 構造のサイズを返す．
+  /// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+  ///
+  /// BGNSTR から ENDSTR までのバイト数
+  ymuint64
+  struct_size(ymuint id) const;
+
+  /// @brief 名前から構造を探す．
+  /// @param[in] name 構造名
+  /// @return 構造番号を返す．
+  ///
+  /// 見つからない時は struct_num() を返す．
+  ymuint
+  find(const string& name) const;
+
+  /// @brief 構造が参照している構造名のリストを得る．
+  /// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+  /// @param[out] name_list 構造名のリスト
+  /// @retval true 成功した．
+  /// @retval false 形式が正しくなかった．
+  ///
+  /// 構造の SNAME レコードだけを読む．
+  /// name_list は重複を除いて現れた順に並ぶ．
+  bool
+  ref_list(ymuint id,
+	   vector<string>& name_list) const;
+
+  /// @brief 指定した構造とその子孫の構造を求める．
+  /// @param[in] root_list 根の構造番号のリスト
+  /// @param[out] id_list 結果の構造番号のリスト
+  /// @retval true 成功した．
+  /// @retval false 形式が正しくなかった．
+  ///
+  /// id_list はファイル中の順に並ぶ．
+  /// ファイル中にない構造を参照していたら警告を出して無視する．
+  bool
+  closure(const vector<ymuint>& root_list,
+	  vector<ymuint>& id_list) const;
+
+  /// @brief ヘッダ部分をそのまま書き出す．
+  /// @param[in] writer 出力先
+  /// @retval true 成功した．
+  /// @retval false 書き込みに失敗した．
+  bool
+  copy_header(GdsWriter& writer) const;
+
+  /// @brief 構造のバイト列をそのまま書き出す．
+  /// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+  /// @param[in] writer 出力先
+  /// @retval true 成功した．
+  /// @retval false 書き込みに失敗した．
+  bool
+  copy_struct(ymuint id,
+	      GdsWriter& writer) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 構造の情報
+  struct StructInfo
+  {
+    // 名前
+    string mName;
+
+    // ファイル上の先頭位置
+    ymuint64 mOffset;
+
+    // サイズ
+    ymuint64 mSize;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief mStructMap を作る．
+  void
+  make_map();
+
+  /// @brief 構造の情報が元のファイルの内容と一致するか調べる．
+  /// @param[in] data ファイルの先頭
+  /// @param[in] size ファイルのサイズ
+  /// @param[in] info 構造の情報
+  static
+  bool
+  check_info(const ymuint8* data,
+	     ymuint64 size,
+	     const StructInfo& info);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // ファイルの先頭
+  const ymuint8* mData;
+
+  // ファイルのサイズ
+  ymuint64 mFileSize;
+
+  // ファイルの更新時刻 (秒)
+  ymint64 mMtime;
+
+  // ファイルの更新時刻の秒未満の部分 (ナノ秒)
+  ymint64 mMtimeNsec;
+
+  // ヘッダ部分のサイズ
+  ymuint64 mHeaderSize;
+
+  // 構造の情報のリスト
+  vector<StructInfo> mStructList;
+
+  // 名前をキーにして構造番号を保持する辞書
+  std::map<string, ymuint> mStructMap;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSSTRUCTINDEX_H
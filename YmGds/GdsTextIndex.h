@@ -0,0 +1,219 @@
+﻿#ifndef GDS_GDSTEXTINDEX_H
+#define GDS_GDSTEXTINDEX_H
+
+/// @file YmGds/GdsTextIndex.h
+/// @brief GdsTextIndex のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsTrans.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsTextIndex GdsTextIndex.h "YmGds/GdsTextIndex.h"
+/// @brief TEXT 要素の文字列の索引
+///
+/// すべての構造の TEXT 要素を文字列の順に整列して持つ．
+/// 検索は二分探索で行うので，完全一致と前方一致は
+/// 該当する要素の数に比例する時間で終わる．
+/// ワイルドカードによる検索は先頭の固定部分で範囲を絞ってから
+/// 一つずつ照合する．
+///
+/// set_top() で最上位の構造を指定すると，各構造が最上位の
+/// 構造の下に置かれているすべての配置の座標変換を求められる．
+/// 索引を作った後の検索はすべて const で，複数のスレッドから
+/// 同時に呼び出してもよい．
+//////////////////////////////////////////////////////////////////////
+class GdsTextIndex
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsTextIndex();
+
+  /// @brief デストラクタ
+  ~GdsTextIndex();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief 索引を作る．
+  /// @param[in] data 対象のデータ
+  ///
+  /// data はこのオブジェクトより長く存在しなければならない．
+  void
+  build(const GdsData& data);
+
+  /// @brief 最上位の構造を設定する．
+  /// @param[in] top_name 最上位の構造名
+  /// @retval true 成功した．
+  /// @retval false 最上位の構造が決まらないか階層が循環していた．
+  ///
+  /// top_name が NULL の時は唯一の最上位の構造を用いる．
+  /// build() の後で呼ばなければならない．
+  bool
+  set_top(const char* top_name);
+
+  /// @brief 登録されている TEXT 要素の数を返す．
+  ymuint
+  text_num() const;
+
+  /// @brief 文字列を返す．
+  /// @param[in] id 番号 ( 0 <= id < text_num() )
+  ///
+  /// 番号は文字列の順に振られている．
+  const char*
+  text(ymuint id) const;
+
+  /// @brief TEXT 要素を含む構造を返す．
+  /// @param[in] id 番号 ( 0 <= id < text_num() )
+  const GdsStruct*
+  text_struct(ymuint id) const;
+
+  /// @brief TEXT 要素を返す．
+  /// @param[in] id 番号 ( 0 <= id < text_num() )
+  const GdsElement*
+  text_elem(ymuint id) const;
+
+  /// @brief 文字列が一致する要素を探す．
+  /// @param[in] str 文字列
+  /// @param[out] id_list 見つかった要素の番号のリスト
+  void
+  find(const char* str,
+       vector<ymuint>& id_list) const;
+
+  /// @brief 文字列が指定した文字列で始まる要素を探す．
+  /// @param[in] prefix 先頭の文字列
+  /// @param[out] id_list 見つかった要素の番号のリスト
+  void
+  find_prefix(const char* prefix,
+	      vector<ymuint>& id_list) const;
+
+  /// @brief 文字列がパタンに合う要素を探す．
+  /// @param[in] pattern パタン
+  /// @param[out] id_list 見つかった要素の番号のリスト
+  ///
+  /// パタンには '*', '?', '[...]' ('[!...]' は否定) が使える．
+  /// '\' の次の文字はそのままの文字として扱う．
+  void
+  find_glob(const char* pattern,
+	    vector<ymuint>& id_list) const;
+
+  /// @brief 最上位の構造を返す．
+  ///
+  /// set_top() を呼んでいない時は NULL を返す．
+  const GdsStruct*
+  top() const;
+
+  /// @brief 最上位の構造の下での配置数を返す．
+  /// @param[in] str 対象の構造
+  ///
+  /// 最上位から到達できない構造は 0 となる．
+  ymuint64
+  placement_num(const GdsStruct* str) const;
+
+  /// @brief 最上位の構造の下でのすべての配置の座標変換を求める．
+  /// @param[in] str 対象の構造
+  /// @param[out] trans_list str の座標を最上位の座標に移す変換のリスト
+  ///
+  /// 結果の数は placement_num(str) に等しい．
+  void
+  placement_list(const GdsStruct* str,
+		 vector<GdsTrans>& trans_list) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 索引の要素
+  struct Entry
+  {
+    // 文字列
+    const char* mText;
+
+    // TEXT 要素を含む構造
+    const GdsStruct* mStruct;
+
+    // TEXT 要素
+    const GdsElement* mElem;
+
+    // 構造中での順番
+    ymuint32 mSeq;
+  };
+
+  // 親の構造からの参照
+  struct ParentRef
+  {
+    // 親の構造
+    const GdsStruct* mParent;
+
+    // SREF/AREF 要素
+    const GdsElement* mElem;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 文字列が str 以上の最初の位置を返す．
+  ymuint
+  lower_bound(const char* str) const;
+
+  /// @brief 親の構造をたどって配置の座標変換を求める．
+  /// @param[in] str 対象の構造
+  /// @param[in] trans 元の構造の座標を str の座標に移す変換
+  /// @param[out] trans_list 結果を格納するリスト
+  void
+  walk_up(const GdsStruct* str,
+	  const GdsTrans& trans,
+	  vector<GdsTrans>& trans_list) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // 対象のデータ
+  const GdsData* mData;
+
+  // 文字列の順に整列した要素のリスト
+  vector<Entry> mEntryList;
+
+  // 構造のID番号をキーにした親からの参照のリスト
+  vector<vector<ParentRef> > mParentArray;
+
+  // 最上位の構造
+  const GdsStruct* mTop;
+
+  // 構造のID番号をキーにした配置数の配列
+  vector<ymuint64> mCountArray;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSTEXTINDEX_H
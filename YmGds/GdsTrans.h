@@ -0,0 +1,105 @@
+﻿#ifndef GDS_GDSTRANS_H
+#define GDS_GDSTRANS_H
+
+/// @file YmGds/GdsTrans.h
+/// @brief GdsTrans のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsBBox.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsTrans GdsTrans.h "YmGds/GdsTrans.h"
+/// @brief 座標変換を表すクラス
+///
+/// ( x, y ) を ( a * x + b * y + tx, c * x + d * y + ty ) に写す．
+/// SREF/AREF/TEXT の変換は X 軸に関する反転，拡大，回転，平行移動の
+/// 順で適用される．
+/// absolute magnification/absolute angle は考慮しない．
+//////////////////////////////////////////////////////////////////////
+class GdsTrans
+{
+public:
+
+  /// @brief 恒等変換を表すコンストラクタ
+  GdsTrans();
+
+  /// @brief 要素の変換を表すコンストラクタ
+  /// @param[in] elem 対象の要素 ( SREF/AREF/TEXT )
+  /// @param[in] col AREF の column 番号
+  /// @param[in] row AREF の row 番号
+  ///
+  /// SREF と TEXT の場合には col, row は無視される．
+  explicit
+  GdsTrans(const GdsElement* elem,
+	   ymuint col = 0,
+	   ymuint row = 0);
+
+  /// @brief デストラクタ
+  ~GdsTrans();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 点を変換する．
+  /// @param[in] x, y 元の座標
+  /// @param[out] ox, oy 変換後の座標
+  ///
+  /// 結果は最も近い整数に丸められる．
+  void
+  apply(ymint32 x,
+	ymint32 y,
+	ymint32& ox,
+	ymint32& oy) const;
+
+  /// @brief 矩形を変換した結果の外接矩形を求める．
+  /// @param[in] bbox 元の矩形
+  GdsBBox
+  apply(const GdsBBox& bbox) const;
+
+  /// @brief 合成した変換を返す．
+  /// @param[in] right 先に適用する変換
+  ///
+  /// 結果は right を適用してから自身を適用する変換となる．
+  GdsTrans
+  operator*(const GdsTrans& right) const;
+
+  /// @brief 回転が 90 度の倍数で拡大率が 1 の時 true を返す．
+  bool
+  is_orthogonal() const;
+
+  /// @brief 拡大率を返す．
+  double
+  mag() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 変換行列
+  double mA;
+  double mB;
+  double mC;
+  double mD;
+
+  // 平行移動量
+  double mTx;
+  double mTy;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSTRANS_H
@@ -0,0 +1,173 @@
+﻿#ifndef GDS_GDSVALIDATOR_H
+#define GDS_GDSVALIDATOR_H
+
+/// @file YmGds/GdsValidator.h
+/// @brief GdsValidator のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsValidator GdsValidator.h "YmGds/GdsValidator.h"
+/// @brief GDS-II ファイルの内容を検査するクラス
+///
+/// パーサーが調べない次の項目を検査する．
+///  - BOUNDARY の頂点数 ( 4 以上 ) と閉じていること
+///  - PATH の頂点数 ( 2 以上 )
+///  - BOX の頂点数 ( 5 ) と閉じていること
+///  - SREF, TEXT, NODE の XY の数
+///  - AREF の XY の数 ( 3 ) と COLROW の範囲 ( 1 以上 32767 以下 )
+///  - STRANS, ELFLAGS, PRESENTATION の未定義のビット
+///  - 定義されていない構造の参照
+///  - 構造の再帰的な参照
+///  - 構造名の重複
+///
+/// GdsStructIndex の範囲を使って構造ごとにレコードを並列に読む．
+/// 要素のデータ構造は作らない．
+/// 見つかった誤りは構造ごとに溜めておき，最後にファイル上の順に
+/// レコードの先頭位置をつけて Msg で出力する．
+//////////////////////////////////////////////////////////////////////
+class GdsValidator
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsValidator();
+
+  /// @brief デストラクタ
+  ~GdsValidator();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief 検査を行う．
+  /// @param[in] index 索引 ( build() か read_index() を済ませておく )
+  /// @retval true 誤りがなかった．
+  /// @retval false 誤りが見つかった．
+  bool
+  check(const GdsStructIndex& index);
+
+  /// @brief 直前の check() で見つかった誤りの数を返す．
+  ymuint
+  error_num() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 見つかった誤り
+  struct Issue
+  {
+    // レコードのファイル上の先頭位置
+    ymuint64 mOffset;
+
+    // メッセージ
+    string mMsg;
+  };
+
+  // SNAME による参照
+  struct Ref
+  {
+    // 参照する構造名
+    string mName;
+
+    // SNAME のファイル上の先頭位置
+    ymuint64 mOffset;
+  };
+
+  // 構造ごとの検査結果
+  struct StructResult
+  {
+    // 見つかった誤りのリスト
+    vector<Issue> mIssueList;
+
+    // 参照のリスト
+    vector<Ref> mRefList;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 一つの構造の中を検査する．
+  /// @param[in] index 索引
+  /// @param[in] id 構造番号
+  /// @param[out] result 結果
+  ///
+  /// 異なる構造に対して並列に呼ばれる．
+  static
+  void
+  check_struct(const GdsStructIndex& index,
+	       ymuint id,
+	       StructResult& result);
+
+  /// @brief XY の点の数を検査する．
+  /// @param[in] scanner XY を読んだスキャナ
+  /// @param[in] elem_type 要素の種類
+  /// @param[in] offset XY のファイル上の先頭位置
+  /// @param[out] issue_list 見つかった誤りを追加するリスト
+  static
+  void
+  check_xy(const GdsScanner& scanner,
+	   GdsRtype elem_type,
+	   ymuint64 offset,
+	   vector<Issue>& issue_list);
+
+  /// @brief 構造の再帰的な参照を検査する．
+  /// @param[in] index 索引
+  /// @param[in] child_list 構造ごとの子の構造番号のリスト
+  /// @param[inout] result_list 構造ごとの検査結果
+  static
+  void
+  check_cycle(const GdsStructIndex& index,
+	      const vector<vector<ymuint> >& child_list,
+	      vector<StructResult>& result_list);
+
+  /// @brief 誤りを追加する．
+  /// @param[in] issue_list 追加するリスト
+  /// @param[in] offset ファイル上の位置
+  /// @param[in] msg メッセージ
+  static
+  void
+  add_issue(vector<Issue>& issue_list,
+	    ymuint64 offset,
+	    const string& msg);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // 見つかった誤りの数
+  ymuint32 mErrorNum;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSVALIDATOR_H
@@ -0,0 +1,328 @@
+﻿#ifndef GDS_GDSWRITER_H
+#define GDS_GDSWRITER_H
+
+/// @file YmGds/GdsWriter.h
+/// @brief GdsWriter のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include <thread>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsWriter GdsWriter.h "YmGds/GdsWriter.h"
+/// @brief GDS-II の書き出しを行うクラス
+///
+/// GdsScanner と対になるレコード単位の出力クラス．
+/// kGdsCompGzip を指定すると出力を gzip 形式で圧縮する．
+/// この場合，出力はブロック(既定で 1MB)ごとに独立した gzip メンバー
+/// として圧縮され，複数のブロックを複数のスレッドで並列に圧縮する．
+/// 連結された gzip メンバーは gzip/zcat や zlib で通常通り読める．
+//////////////////////////////////////////////////////////////////////
+class GdsWriter
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsWriter();
+
+  /// @brief デストラクタ
+  ~GdsWriter();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief ファイルを開く
+  /// @param[in] filename ファイル名
+  /// @param[in] comp_type 圧縮形式
+  /// @param[in] level 圧縮レベル ( 0 - 9 )
+  /// @param[in] thread_num 圧縮に用いるスレッド数
+  /// @retval true オープンに成功した．
+  /// @retval false オープンに失敗した．
+  ///
+  /// level と thread_num は comp_type が kGdsCompGzip の時のみ意味を持つ．
+  bool
+  open_file(const string& filename,
+	    GdsCompType comp_type = kGdsCompNone,
+	    int level = 6,
+	    ymuint thread_num = 1);
+
+  /// @brief ファイルを閉じる．
+  /// @retval true 残りのデータの書き出しに成功した．
+  /// @retval false 書き出しに失敗した．
+  bool
+  close_file();
+
+  /// @brief 圧縮の単位となるブロックサイズを設定する．
+  /// @param[in] size ブロックサイズ(バイト)
+  /// @retval true 設定した．
+  /// @retval false ファイルを開いているので設定しなかった．
+  ///
+  /// open_file() の前に呼ぶ必要がある．
+  bool
+  set_block_size(ymuint32 size);
+
+  /// @brief データを持たないレコードを書き出す．
+  /// @param[in] rtype レコード型
+  bool
+  write_nodata(GdsRtype rtype);
+
+  /// @brief 2バイト整数のレコードを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] val 値
+  bool
+  write_2int(GdsRtype rtype,
+	     ymint16 val);
+
+  /// @brief 2バイト整数の配列のレコードを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] vals 値の配列
+  /// @param[in] n 要素数
+  bool
+  write_2int(GdsRtype rtype,
+	     const ymint16* vals,
+	     ymuint n);
+
+  /// @brief BitArray のレコードを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] val 値
+  bool
+  write_bitarray(GdsRtype rtype,
+		 ymuint16 val);
+
+  /// @brief 4バイト整数のレコードを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] val 値
+  bool
+  write_4int(GdsRtype rtype,
+	     ymint32 val);
+
+  /// @brief 4バイト整数の配列のレコードを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] vals 値の配列
+  /// @param[in] n 要素数
+  bool
+  write_4int(GdsRtype rtype,
+	     const ymint32* vals,
+	     ymuint n);
+
+  /// @brief 8バイト浮動小数点数の配列のレコードを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] vals 値の配列
+  /// @param[in] n 要素数
+  bool
+  write_8real(GdsRtype rtype,
+	      const double* vals,
+	      ymuint n);
+
+  /// @brief 文字列のレコードを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] str 文字列
+  ///
+  /// 奇数長の場合には '\\0' を補って偶数長にする．
+  bool
+  write_string(GdsRtype rtype,
+	       const char* str);
+
+  /// @brief 任意のレコードを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] dtype データ型
+  /// @param[in] data データ(ビッグエンディアンに変換済みのもの)
+  /// @param[in] dsize データサイズ
+  bool
+  write_rec(GdsRtype rtype,
+	    GdsDtype dtype,
+	    const ymuint8* data,
+	    ymuint32 dsize);
+
+  /// @brief GdsScanner が直前に読み込んだレコードをそのまま書き出す．
+  /// @param[in] scanner 字句解析器
+  bool
+  copy_rec(const GdsScanner& scanner);
+
+  /// @brief バイト列をそのまま書き出す．
+  /// @param[in] buf バイト列
+  /// @param[in] size サイズ
+  bool
+  write_raw(const ymuint8* buf,
+	    ymuint64 size);
+
+  /// @brief HEADER から UNITS までを書き出す．
+  /// @param[in] libname ライブラリ名
+  /// @param[in] user_unit user unit
+  /// @param[in] meter_unit unit in meters
+  ///
+  /// 日時は現在時刻を用いる．
+  bool
+  write_header(const char* libname,
+	       double user_unit,
+	       double meter_unit);
+
+  /// @brief BGNSTR と STRNAME を書き出す．
+  /// @param[in] name 構造名
+  ///
+  /// 日時は現在時刻を用いる．
+  bool
+  write_bgnstr(const char* name);
+
+  /// @brief BOUNDARY 要素を書き出す．
+  /// @param[in] layer 層番号
+  /// @param[in] datatype データ型
+  /// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+  /// @param[in] n 点数
+  ///
+  /// 閉じていない場合には始点を末尾に補う．
+  bool
+  write_boundary(int layer,
+		 int datatype,
+		 const ymint32* data,
+		 ymuint n);
+
+  /// @brief これまでに書き出した(圧縮前の)バイト数を返す．
+  ymuint64
+  cur_pos() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 圧縮ブロック
+  struct Block
+  {
+    // 圧縮前のデータ
+    vector<ymuint8> mSrc;
+
+    // 圧縮後のデータ
+    vector<ymuint8> mDst;
+
+    // 圧縮に成功したら true
+    bool mStat;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief レコードヘッダを書き出す．
+  /// @param[in] rtype レコード型
+  /// @param[in] dtype データ型
+  /// @param[in] dsize データサイズ
+  bool
+  put_header(GdsRtype rtype,
+	     GdsDtype dtype,
+	     ymuint32 dsize);
+
+  /// @brief バッファにデータを書き込む．
+  /// @param[in] buf データ
+  /// @param[in] size サイズ
+  bool
+  put_bytes(const ymuint8* buf,
+	    ymuint64 size);
+
+  /// @brief 現在のバッファの内容を掃き出す．
+  bool
+  flush_buff();
+
+  /// @brief 圧縮中のブロックの完了を待って書き出す．
+  bool
+  wait_blocks();
+
+  /// @brief ブロックを gzip のメンバーとして圧縮する．
+  /// @param[in] block 対象のブロック
+  /// @param[in] level 圧縮レベル
+  static
+  void
+  compress_block(Block* block,
+		 int level);
+
+  /// @brief fd にデータを書き出す．
+  /// @param[in] buf データ
+  /// @param[in] size サイズ
+  bool
+  raw_write(const ymuint8* buf,
+	    ymuint64 size);
+
+  /// @brief 現在時刻を BGNLIB/BGNSTR 用の配列に設定する．
+  /// @param[out] buf 結果を格納する配列(12要素)
+  static
+  void
+  set_date(ymint16 buf[]);
+
+  /// @brief 浮動小数点数を 8バイトの実数形式に変換する．
+  /// @param[in] val 値
+  /// @param[out] buf 結果を格納する配列(8要素)
+  static
+  void
+  conv_8byte_real(double val,
+		  ymuint8 buf[]);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 出力のファイル記述子
+  int mFd;
+
+  // 圧縮形式
+  GdsCompType mCompType;
+
+  // 圧縮レベル
+  int mLevel;
+
+  // スレッド数
+  ymuint mThreadNum;
+
+  // ブロックサイズ
+  ymuint32 mBlockSize;
+
+  // 書き込み用のバッファ
+  vector<ymuint8> mBuff;
+
+  // mBuff の書き込み位置
+  ymuint32 mBuffPos;
+
+  // 圧縮待ちのブロックのリスト
+  vector<Block*> mPendingList;
+
+  // 圧縮中のブロックのリスト
+  vector<Block*> mRunningList;
+
+  // 圧縮を行っているスレッド
+  vector<std::thread> mWorkerList;
+
+  // 書き出したバイト数
+  ymuint64 mCurPos;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief これまでに書き出した(圧縮前の)バイト数を返す．
+inline
+ymuint64
+GdsWriter::cur_pos() const
+{
+  return mCurPos;
+}
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSWRITER_H
@@ -20,7 +20,7 @@ BEGIN_NAMESPACE_YM_GDS
 //////////////////////////////////////////////////////////////////////
 class GdsXY
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 private:
 
@@ -50,6 +50,12 @@ public:
   ymint32
   y(ymuint pos) const;
 
+  /// @brief 座標の配列の先頭を返す．
+  ///
+  /// x0, y0, x1, y1, ... の順に num() * 2 個の要素を持つ．
+  const ymint32*
+  data() const;
+
 
 private:
   //////////////////////////////////////////////////////////////////////
@@ -107,6 +113,16 @@ GdsXY::y(ymuint pos) const
   return mData[pos * 2 + 1];
 }
 
+// @brief 座標の配列の先頭を返す．
+//
+// x0, y0, x1, y1, ... の順に num() * 2 個の要素を持つ．
+inline
+const ymint32*
+GdsXY::data() const
+{
+  return mData;
+}
+
 END_NAMESPACE_YM_GDS
 
 #endif // GDS_GDSXY_H
@@ -0,0 +1,406 @@
+﻿#ifndef GDS_GDSXOR_H
+#define GDS_GDSXOR_H
+
+/// @file YmGds/GdsXor.h
+/// @brief GdsXor のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsGeom.h"
+#include "YmGds/GdsBBox.h"
+#include "YmGds/GdsTrans.h"
+#include "YmGds/GdsPathExpander.h"
+#include "YmGds/GdsStructHash.h"
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+/// @class GdsXor GdsXor.h "YmGds/GdsXor.h"
+/// @brief 二つのレイアウトの差分(XOR)を求めるクラス
+///
+/// まず GdsStructHash で求めた構造のハッシュ値を比較し，
+/// 同一の構造の配置は比較を省略する．
+/// 同じ名前の構造を同じ位置に置いた配置は階層を保ったまま比較し，
+/// 一致しない図形だけを展開する．
+/// 残った図形は (layer, datatype) ごとに正方形のタイルに振り分け，
+/// 図形を含むタイルだけを並列に GdsBoolean で XOR する．
+/// 一致して取り除いた図形や配置も，残った図形を覆い隠すことがあるので
+/// そのタイルと重なる部分は両側に加えてから XOR する．
+/// 結果の多角形はタイルの境界で分割されている．
+///
+/// 対象は BOUNDARY/BOX と PATH の輪郭で，TEXT/NODE は無視する．
+//////////////////////////////////////////////////////////////////////
+class GdsXor
+{
+public:
+
+  /// @brief コンストラクタ
+  GdsXor();
+
+  /// @brief デストラクタ
+  ~GdsXor();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 0 の時はハードウェアのスレッド数を用いる．
+  void
+  set_thread_num(ymuint num);
+
+  /// @brief タイルの一辺の長さを設定する．
+  /// @param[in] size 長さ(database unit)
+  ///
+  /// 0 の時は全体の外接矩形の長辺の 1/16 とする．
+  void
+  set_tile_size(ymint32 size);
+
+  /// @brief 差分を求める．
+  /// @param[in] data1, data2 対象のデータ
+  /// @param[in] top_name1, top_name2 最上位の構造名
+  /// @retval true 成功した．
+  /// @retval false 最上位の構造が決まらないか階層が循環していた．
+  ///
+  /// top_name1 が NULL の時は data1 の唯一の最上位の構造を用いる．
+  /// top_name2 が NULL の時は top_name1 と同じ名前の構造を用いる．
+  /// ともに NULL の時は data2 の唯一の最上位の構造を用いる．
+  bool
+  compute(const GdsData& data1,
+	  const char* top_name1,
+	  const GdsData& data2,
+	  const char* top_name2);
+
+  /// @brief 差分のある (layer, datatype) の数を返す．
+  ymuint
+  layer_num() const;
+
+  /// @brief 層番号を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  int
+  layer(ymuint pos) const;
+
+  /// @brief データ型を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  int
+  datatype(ymuint pos) const;
+
+  /// @brief 差分の多角形の数を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  ymuint
+  polygon_num(ymuint pos) const;
+
+  /// @brief 差分の多角形の頂点数を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  /// @param[in] idx 多角形の番号 ( 0 <= idx < polygon_num(pos) )
+  ymuint
+  point_num(ymuint pos,
+	    ymuint idx) const;
+
+  /// @brief 差分の多角形の座標の配列を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  /// @param[in] idx 多角形の番号 ( 0 <= idx < polygon_num(pos) )
+  ///
+  /// x0, y0, x1, y1, ... の順に point_num(pos, idx) * 2 個の要素を持つ．
+  /// 頂点は反時計回りに並ぶ．
+  const ymint32*
+  polygon_data(ymuint pos,
+	       ymuint idx) const;
+
+  /// @brief 差分の面積の2倍を返す．
+  /// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+  tGdsInt128
+  area2(ymuint pos) const;
+
+  /// @brief 同一と判定して比較を省略した配置の数を返す．
+  ///
+  /// AREF は要素数を数える．
+  ymuint64
+  skip_num() const;
+
+  /// @brief タイルの総数を返す．
+  ymuint64
+  tile_num() const;
+
+  /// @brief 実際に XOR を行った (layer, datatype, タイル) の数を返す．
+  ymuint64
+  dirty_tile_num() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 多角形のリスト
+  struct PolygonList
+  {
+    // 頂点のプール
+    vector<ymint32> mPool;
+
+    // 多角形の先頭位置(頂点単位)のリスト
+    // 末尾に番兵を持つ．
+    vector<ymuint32> mPosList;
+
+    // 多角形の外接矩形のリスト
+    vector<GdsBBox> mBBoxList;
+  };
+
+  // (layer, datatype) ごとのデータ
+  struct LayerData
+  {
+    // (layer << 16) | datatype
+    ymuint32 mKey;
+
+    // 比較が必要な図形
+    PolygonList mInput[2];
+
+    // 結果
+    PolygonList mResult;
+
+    // 結果の面積の2倍
+    tGdsInt128 mArea2;
+
+    // 両側に共通な図形のうち XOR を行うタイルと重なるもの
+    PolygonList mCommon;
+
+    // タイル番号から mJobList 中の位置を求める辞書
+    std::map<ymuint64, ymuint> mJobMap;
+  };
+
+  // 両側で一致して取り除いた図形または配置
+  // 要素は data1 側のものを持つ．
+  struct CommonItem
+  {
+    // 図形か SREF/AREF の要素 (構造全体の時は NULL)
+    const GdsElement* mElem;
+
+    // 構造全体の時の構造
+    const GdsStruct* mStruct;
+
+    // mCommonTransList 中の座標変換の位置
+    ymuint32 mTrans;
+  };
+
+  // (layer, datatype, タイル) ごとの作業
+  struct Job
+  {
+    // mLayerList 中の位置
+    ymuint32 mLayer;
+
+    // タイル番号
+    ymuint64 mTile;
+
+    // 多角形のリスト
+    // 多角形は (side << 31) | 番号 で表す．
+    vector<ymuint32> mPolygonList;
+
+    // 両側に加える LayerData::mCommon 中の多角形の番号のリスト
+    vector<ymuint32> mCommonList;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 最上位の構造を求める．
+  /// @param[in] data 対象のデータ
+  /// @param[in] top_name 構造名
+  ///
+  /// 見つからない時はエラーを出力して NULL を返す．
+  static
+  const GdsStruct*
+  find_top(const GdsData& data,
+	   const char* top_name);
+
+  /// @brief 構造ごとの外接矩形を求める．
+  /// @param[in] side 0 なら data1 側，1 なら data2 側
+  /// @param[in] data 対象のデータ
+  /// @param[in] top 最上位の構造
+  /// @retval false 階層が循環していた．
+  bool
+  make_bbox(ymuint side,
+	    const GdsData& data,
+	    const GdsStruct* top);
+
+  /// @brief 図形の座標を求める．
+  /// @param[in] elem 対象の要素 ( BOUNDARY/BOX/PATH )
+  /// @param[out] n 頂点数
+  ///
+  /// PATH の場合は輪郭を返す．頂点がない時は NULL を返す．
+  const ymint32*
+  shape_data(const GdsElement* elem,
+	     ymuint& n);
+
+  /// @brief 一致して取り除いた図形か配置を記録する．
+  /// @param[in] elem 要素 (構造全体の時は NULL)
+  /// @param[in] str 構造全体の時の構造
+  /// @param[in] trans_id mCommonTransList 中の座標変換の位置
+  void
+  add_common(const GdsElement* elem,
+	     const GdsStruct* str,
+	     ymuint32 trans_id);
+
+  /// @brief 二つの構造の差分となる図形を集める．
+  /// @param[in] str1, str2 対象の構造
+  /// @param[in] trans 座標変換
+  void
+  diff_struct(const GdsStruct* str1,
+	      const GdsStruct* str2,
+	      const GdsTrans& trans);
+
+  /// @brief 構造中の図形をすべて集める．
+  /// @param[in] side 0 なら data1 側，1 なら data2 側
+  /// @param[in] str 対象の構造
+  /// @param[in] trans 座標変換
+  void
+  flatten_struct(ymuint side,
+		 const GdsStruct* str,
+		 const GdsTrans& trans);
+
+  /// @brief SREF/AREF の参照先の図形をすべて集める．
+  /// @param[in] side 0 なら data1 側，1 なら data2 側
+  /// @param[in] elem 対象の要素 ( SREF/AREF )
+  /// @param[in] trans 座標変換
+  void
+  flatten_ref(ymuint side,
+	      const GdsElement* elem,
+	      const GdsTrans& trans);
+
+  /// @brief 図形を一つ集める．
+  /// @param[in] side 0 なら data1 側，1 なら data2 側
+  /// @param[in] elem 対象の要素 ( BOUNDARY/BOX/PATH )
+  /// @param[in] trans 座標変換
+  void
+  add_elem(ymuint side,
+	   const GdsElement* elem,
+	   const GdsTrans& trans);
+
+  /// @brief 多角形を一つ追加する．
+  /// @param[in] key (layer << 16) | datatype
+  /// @param[in] side 0 なら data1 側，1 なら data2 側
+  /// @param[in] data 座標の配列
+  /// @param[in] n 頂点数
+  /// @param[in] trans 座標変換
+  void
+  add_polygon(ymuint32 key,
+	      ymuint side,
+	      const ymint32* data,
+	      ymuint n,
+	      const GdsTrans& trans);
+
+  /// @brief タイルに分割して XOR を行う．
+  /// @param[in] top1, top2 最上位の構造
+  void
+  compute_tiles(const GdsStruct* top1,
+		const GdsStruct* top2);
+
+  /// @brief 矩形と重なるタイルの範囲を求める．
+  /// @param[in] bbox 矩形
+  /// @param[out] tx0, ty0, tx1, ty1 タイルの範囲
+  /// @retval false 重なるタイルがない．
+  bool
+  tile_range(const GdsBBox& bbox,
+	     ymuint64& tx0,
+	     ymuint64& ty0,
+	     ymuint64& tx1,
+	     ymuint64& ty1) const;
+
+  /// @brief 矩形が XOR を行うタイルと重なる時 true を返す．
+  /// @param[in] bbox 矩形
+  bool
+  is_dirty(const GdsBBox& bbox) const;
+
+  /// @brief 共通な構造中の図形のうち XOR を行うタイルと重なるものを集める．
+  /// @param[in] str 対象の構造
+  /// @param[in] trans 座標変換
+  void
+  collect_common_struct(const GdsStruct* str,
+			const GdsTrans& trans);
+
+  /// @brief 共通な要素のうち XOR を行うタイルと重なるものを集める．
+  /// @param[in] elem 対象の要素 ( BOUNDARY/BOX/PATH/SREF/AREF )
+  /// @param[in] trans 座標変換
+  void
+  collect_common(const GdsElement* elem,
+		 const GdsTrans& trans);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // スレッド数
+  ymuint32 mThreadNum;
+
+  // タイルの一辺の長さ
+  ymint32 mTileSize;
+
+  // 構造ごとのハッシュ値
+  GdsStructHash mHash[2];
+
+  // 構造のID番号をキーにした外接矩形の配列
+  vector<GdsBBox> mBBoxArray[2];
+
+  // 両側で一致して取り除いた図形と配置のリスト
+  vector<CommonItem> mCommonList;
+
+  // mCommonList で用いる座標変換のリスト
+  vector<GdsTrans> mCommonTransList;
+
+  // (layer, datatype) ごとのデータ
+  vector<LayerData> mLayerList;
+
+  // キーから mLayerList 中の位置を求める辞書
+  std::map<ymuint32, ymuint> mLayerMap;
+
+  // PATH の展開に用いるオブジェクト
+  GdsPathExpander mExpander;
+
+  // タイルの原点
+  ymint64 mTileX0;
+  ymint64 mTileY0;
+
+  // 実際に用いたタイルの一辺の長さ
+  ymint64 mTileStep;
+
+  // X 方向のタイル数
+  ymuint64 mTileXNum;
+
+  // Y 方向のタイル数
+  ymuint64 mTileYNum;
+
+  // XOR を行うタイルの数の2次元の累積和
+  // ( mTileXNum + 1 ) * ( mTileYNum + 1 ) 個の要素を持つ．
+  vector<ymuint32> mDirtySum;
+
+  // 作業のリスト
+  vector<Job> mJobList;
+
+  // 比較を省略した配置の数
+  ymuint64 mSkipNum;
+
+  // タイルの総数
+  ymuint64 mTileNum;
+
+  // XOR を行ったタイルの数
+  ymuint64 mDirtyTileNum;
+
+};
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDS_GDSXOR_H
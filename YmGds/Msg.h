@@ -10,6 +10,7 @@
 
 
 #include "YmGds/gds_nsdef.h"
+#include <atomic>
 
 
 BEGIN_NAMESPACE_YM_GDS
@@ -100,6 +101,9 @@ private:
   // 本文
   string mBody;
 
+  // MsgMgr のキューでの次の要素
+  Msg* mLink;
+
 };
 
 
@@ -203,6 +207,13 @@ private:
 
 //////////////////////////////////////////////////////////////////////
 // メッセージを管理するクラス
+//
+// XXX_header() と msg_end() は複数のスレッドから同時に呼んでもよい．
+// 本文の整形はスレッドごとのバッファで行い，できたメッセージは
+// ロックを用いないキューに入れる．ハンドラを呼ぶのは一度に一つの
+// スレッドだけなので，ハンドラはスレッドセーフでなくてもよい．
+// どのハンドラのマスクにも含まれない種類のメッセージは整形しない．
+// reg_handler() は並列処理を始める前に済ませておくこと．
 //////////////////////////////////////////////////////////////////////
 class MsgMgr
 {
@@ -318,6 +329,21 @@ public:
   void
   reg_handler(MsgHandler* handler);
 
+  // メッセージをファイル位置の順に並べるかどうかを設定する．
+  // true の間はメッセージを溜めておき，flush() か set_ordered(false) の
+  // 時にファイル位置の順に並べてハンドラに渡す．
+  // 並列処理の結果のメッセージの順番を一定にするために用いる．
+  void
+  set_ordered(bool flag);
+
+  // メッセージをファイル位置の順に並べている時 true を返す．
+  bool
+  ordered() const;
+
+  // 溜めておいたメッセージをファイル位置の順にハンドラに渡す．
+  void
+  flush();
+
 
 private:
 
@@ -334,6 +360,24 @@ private:
   void
   put_msg();
 
+  // ハンドラのマスクの和を返す．
+  size_t
+  handler_mask() const;
+
+  // キューのメッセージを取り出してハンドラに渡す．
+  // 他のスレッドが取り出している時は何もしない．
+  void
+  deliver();
+
+  // キューのメッセージを届いた順に mHeldList に移す．
+  // mDelivering を確保してから呼ぶ．
+  void
+  take_queue();
+
+  // メッセージをハンドラに渡して削除する．
+  void
+  dispatch(Msg* msg);
+
 
 private:
   //////////////////////////////////////////////////////////////////////
@@ -341,37 +385,39 @@ private:
   //////////////////////////////////////////////////////////////////////
 
   // 全メッセージ数
-  size_t mAllMsgNum;
+  std::atomic<size_t> mAllMsgNum;
 
   // エラーメッセージ数
-  size_t mErrorMsgNum;
+  std::atomic<size_t> mErrorMsgNum;
 
   // 警告メッセージ数
-  size_t mWarningMsgNum;
+  std::atomic<size_t> mWarningMsgNum;
 
   // 情報メッセージ数
-  size_t mInfoMsgNum;
+  std::atomic<size_t> mInfoMsgNum;
 
   // 失敗メッセージ数
-  size_t mFailMsgNum;
+  std::atomic<size_t> mFailMsgNum;
 
   // デバッグメッセージ数
-  size_t mDebugMsgNum;
-
-  // メッセージ出力用のヘルパーオブジェクト
-  MsgHelper* mMsgHelper;
+  std::atomic<size_t> mDebugMsgNum;
 
   // メッセージハンドラのリスト
   list<MsgHandler*> mHandlerList;
 
+  // ハンドラに渡していないメッセージのキュー
+  // 新しいものが先頭になる．
+  std::atomic<Msg*> mQueue;
 
-private:
-  //////////////////////////////////////////////////////////////////////
-  // 静的データメンバ
-  //////////////////////////////////////////////////////////////////////
+  // ハンドラを呼んでいるスレッドがある時に立つフラグ
+  std::atomic_flag mDelivering;
+
+  // ファイル位置の順に並べる時 true
+  std::atomic<bool> mOrdered;
 
-  // 唯一のオブジェクト
-  static MsgMgr* mTheMgr;
+  // 取り出したメッセージのリスト
+  // mDelivering を確保したスレッドだけが触る．
+  vector<Msg*> mHeldList;
 
 };
 
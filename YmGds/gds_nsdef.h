@@ -139,23 +139,89 @@ enum GdsDtype {
 };
 
 
+//////////////////////////////////////////////////////////////////////
+/// @brief 出力の圧縮形式
+//////////////////////////////////////////////////////////////////////
+enum GdsCompType {
+  kGdsCompNone = 0,
+  kGdsCompGzip = 1
+};
+
+
+//////////////////////////////////////////////////////////////////////
+/// @brief 図形の論理演算の種類
+//////////////////////////////////////////////////////////////////////
+enum GdsBoolOp {
+  kGdsBoolOr = 0,	// A | B
+  kGdsBoolAnd = 1,	// A & B
+  kGdsBoolXor = 2,	// A ^ B
+  kGdsBoolNot = 3	// A & ~B
+};
+
+
+//////////////////////////////////////////////////////////////////////
+/// @brief 要素の差分の種類
+//////////////////////////////////////////////////////////////////////
+enum GdsDiffType {
+  kGdsDiffRemoved = 0,	// 旧い方にだけある．
+  kGdsDiffAdded = 1,	// 新しい方にだけある．
+  kGdsDiffPlacement = 2,	// 同じ構造の配置が変わった．
+  kGdsDiffProperty = 3	// プロパティだけが変わった．
+};
+
+
+//////////////////////////////////////////////////////////////////////
+/// @brief 要素の書き出しの形式
+//////////////////////////////////////////////////////////////////////
+enum GdsExportFormat {
+  kGdsExportJson = 0,	// 一行一要素の JSON
+  kGdsExportCsv = 1	// 先頭に項目名の行を持つ CSV
+};
+
+
 //////////////////////////////////////////////////////////////////////
 // クラスの先行宣言
 //////////////////////////////////////////////////////////////////////
 
 class GdsRecord;
 class GdsRecMgr;
+class GdsBuilder;
 class GdsParser;
 class GdsScanner;
 class GdsDumper;
+class GdsWriter;
+class GdsFilter;
+class GdsExporter;
+class GdsStat;
+class GdsGrep;
+class GdsMerge;
+class GdsOasisParser;
+class GdsOasisWriter;
+class GdsStructIndex;
+class GdsValidator;
+class GdsHier;
+class GdsPathExpander;
+class GdsProgress;
+class GdsProgressHandler;
+class GdsStructHash;
+class GdsXor;
+class GdsLayerStat;
 
 class GdsACL;
+class GdsBBox;
+class GdsBoolean;
 class GdsData;
 class GdsDate;
+class GdsDensity;
+class GdsDiff;
+class GdsHashValue;
 class GdsStruct;
+class GdsTextIndex;
+class GdsTrans;
 class GdsElement;
 class GdsFormat;
 class GdsProperty;
+class GdsRaster;
 class GdsStrans;
 class GdsString;
 class GdsUnits;
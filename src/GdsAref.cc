@@ -41,6 +41,13 @@ GdsAref::~GdsAref()
 {
 }
 
+// @brief 要素の種類を返す．
+GdsRtype
+GdsAref::type() const
+{
+  return kGdsAREF;
+}
+
 // @brief column 数を返す．
 int
 GdsAref::column() const
@@ -21,7 +21,7 @@ BEGIN_NAMESPACE_YM_GDS
 class GdsAref :
   public GdsRefBase
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 private:
 
@@ -49,15 +49,23 @@ public:
   // 外部インターフェイス
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief 要素の種類を返す．
+  virtual
+  GdsRtype
+  type() const;
+
   /// @brief column 数を返す．
+  virtual
   int
   column() const;
 
   /// @brief row 数を返す．
+  virtual
   int
   row() const;
 
   /// @brief XY 座標を返す．
+  virtual
   GdsXY*
   xy() const;
 
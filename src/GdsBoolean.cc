@@ -0,0 +1,989 @@
+﻿
+/// @file GdsBoolean.cc
+/// @brief GdsBoolean の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsBoolean.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsPathExpander.h"
+#include "YmGds/GdsTrans.h"
+#include "YmGds/GdsXY.h"
+#include "GdsParallel.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief 演算結果を返す．
+// @param[in] op 演算の種類
+// @param[in] a, b 各集合の内部にある時 true
+static
+inline
+bool
+eval_op(GdsBoolOp op,
+	bool a,
+	bool b)
+{
+  switch ( op ) {
+  case kGdsBoolOr: return a || b;
+  case kGdsBoolAnd: return a && b;
+  case kGdsBoolXor: return a != b;
+  case kGdsBoolNot: return a && !b;
+  }
+  return false;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsBoolean
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsBoolean::GdsBoolean() :
+  mThreadNum(0),
+  mTileNum(0)
+{
+  mPosList.push_back(0);
+}
+
+// @brief デストラクタ
+GdsBoolean::~GdsBoolean()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsBoolean::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief タイル数を設定する．
+// @param[in] num タイル数
+//
+// 0 の時はスレッド数から決める．
+void
+GdsBoolean::set_tile_num(ymuint num)
+{
+  mTileNum = num;
+}
+
+// @brief 結果を切り出す矩形を設定する．
+// @param[in] bbox 矩形
+//
+// 空の矩形を与えると切り出しを行わない．
+void
+GdsBoolean::set_clip(const GdsBBox& bbox)
+{
+  mClip = bbox;
+}
+
+// @brief 登録した多角形と結果をクリアする．
+//
+// 切り出す矩形はクリアしない．
+void
+GdsBoolean::clear()
+{
+  mEdgeList.clear();
+  mWorkEdgeList.clear();
+  mPool.clear();
+  mPosList.clear();
+  mPosList.push_back(0);
+}
+
+// @brief 多角形を登録する．
+// @param[in] set_id 集合番号 ( 0 or 1 )
+// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 頂点数
+//
+// 頂点の向きはどちらでもよい．
+void
+GdsBoolean::add_polygon(ymuint set_id,
+			const ymint32* data,
+			ymuint n)
+{
+  ASSERT_COND( set_id < 2 );
+
+  // 時計回りの多角形は辺の向きを逆にして扱う．
+  tGdsInt128 area2 = polygon_area2(data, n);
+  if ( area2 == 0 ) {
+    return;
+  }
+  int dir = area2 > 0 ? 1 : -1;
+
+  for (ymuint i = 0; i < n; ++ i) {
+    ymuint j = ( i + 1 < n ) ? i + 1 : 0;
+    ymint32 xa = data[i * 2 + 0];
+    ymint32 ya = data[i * 2 + 1];
+    ymint32 xb = data[j * 2 + 0];
+    ymint32 yb = data[j * 2 + 1];
+    if ( ya == yb ) {
+      continue;
+    }
+    Edge edge;
+    if ( ya < yb ) {
+      edge.mX0 = xa;
+      edge.mY0 = ya;
+      edge.mX1 = xb;
+      edge.mY1 = yb;
+      edge.mWind = dir;
+    }
+    else {
+      edge.mX0 = xb;
+      edge.mY0 = yb;
+      edge.mX1 = xa;
+      edge.mY1 = ya;
+      edge.mWind = -dir;
+    }
+    edge.mSet = set_id;
+    mEdgeList.push_back(edge);
+  }
+}
+
+// @brief 変換を施した多角形を登録する．
+// @param[in] set_id 集合番号 ( 0 or 1 )
+// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 頂点数
+// @param[in] trans 座標変換
+void
+GdsBoolean::add_polygon(ymuint set_id,
+			const ymint32* data,
+			ymuint n,
+			const GdsTrans& trans)
+{
+  vector<ymint32> buf(n * 2);
+  for (ymuint i = 0; i < n; ++ i) {
+    trans.apply(data[i * 2 + 0], data[i * 2 + 1], buf[i * 2 + 0], buf[i * 2 + 1]);
+  }
+  add_polygon(set_id, &buf[0], n);
+}
+
+// @brief 構造中の図形を登録する．
+// @param[in] set_id 集合番号 ( 0 or 1 )
+// @param[in] str 対象の構造
+// @param[in] layer 層番号
+// @param[in] datatype データ型 ( 負の時は任意 )
+// @param[in] flatten true の時は SREF/AREF を展開する．
+//
+// BOUNDARY/BOX と PATH の輪郭を対象とする．
+void
+GdsBoolean::add_struct(ymuint set_id,
+		       const GdsStruct* str,
+		       int layer,
+		       int datatype,
+		       bool flatten)
+{
+  GdsPathExpander expander;
+  add_struct_sub(set_id, str, layer, datatype, flatten, GdsTrans(), expander);
+}
+
+// @brief 構造中の図形を登録する．
+// @param[in] set_id 集合番号 ( 0 or 1 )
+// @param[in] str 対象の構造
+// @param[in] layer 層番号
+// @param[in] datatype データ型 ( 負の時は任意 )
+// @param[in] flatten true の時は SREF/AREF を展開する．
+// @param[in] trans 座標変換
+// @param[in] expander PATH の展開に用いるオブジェクト
+void
+GdsBoolean::add_struct_sub(ymuint set_id,
+			   const GdsStruct* str,
+			   int layer,
+			   int datatype,
+			   bool flatten,
+			   const GdsTrans& trans,
+			   GdsPathExpander& expander)
+{
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    switch ( elem->type() ) {
+    case kGdsBOUNDARY:
+    case kGdsBOX:
+      {
+	if ( elem->layer() != layer ) {
+	  break;
+	}
+	int dt = elem->type() == kGdsBOX ? elem->boxtype() : elem->datatype();
+	if ( datatype >= 0 && dt != datatype ) {
+	  break;
+	}
+	const GdsXY* xy = elem->xy();
+	add_polygon(set_id, xy->data(), xy->num(), trans);
+      }
+      break;
+
+    case kGdsPATH:
+      if ( elem->layer() != layer ) {
+	break;
+      }
+      if ( datatype >= 0 && elem->datatype() != datatype ) {
+	break;
+      }
+      expander.clear();
+      if ( expander.expand(elem) ) {
+	add_polygon(set_id, expander.polygon_data(0), expander.point_num(0), trans);
+      }
+      break;
+
+    case kGdsSREF:
+    case kGdsAREF:
+      {
+	const GdsStruct* child = elem->ref_struct();
+	if ( !flatten || child == NULL ) {
+	  break;
+	}
+	ymuint ncol = elem->column();
+	ymuint nrow = elem->row();
+	for (ymuint r = 0; r < nrow; ++ r) {
+	  for (ymuint c = 0; c < ncol; ++ c) {
+	    GdsTrans child_trans = trans * GdsTrans(elem, c, r);
+	    add_struct_sub(set_id, child, layer, datatype, flatten,
+			   child_trans, expander);
+	  }
+	}
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+}
+
+// @brief 論理演算を行う．
+// @param[in] op 演算の種類
+//
+// 登録された多角形はそのまま残る．
+void
+GdsBoolean::compute(GdsBoolOp op)
+{
+  mPool.clear();
+  mPosList.clear();
+  mPosList.push_back(0);
+
+  if ( mClip.is_empty() ) {
+    mWorkEdgeList = mEdgeList;
+  }
+  else {
+    // 矩形の上下にはみ出した辺は不要
+    mWorkEdgeList.clear();
+    for (ymuint i = 0; i < mEdgeList.size(); ++ i) {
+      const Edge& edge = mEdgeList[i];
+      if ( edge.mY1 > mClip.ymin() && edge.mY0 < mClip.ymax() ) {
+	mWorkEdgeList.push_back(edge);
+      }
+    }
+    if ( mWorkEdgeList.empty() ||
+	 mClip.xmin() == mClip.xmax() || mClip.ymin() == mClip.ymax() ) {
+      return;
+    }
+    // 矩形の左右の辺を加える．
+    Edge edge;
+    edge.mY0 = mClip.ymin();
+    edge.mY1 = mClip.ymax();
+    edge.mSet = 2;
+    edge.mX0 = edge.mX1 = mClip.xmin();
+    edge.mWind = -1;
+    mWorkEdgeList.push_back(edge);
+    edge.mX0 = edge.mX1 = mClip.xmax();
+    edge.mWind = 1;
+    mWorkEdgeList.push_back(edge);
+  }
+  if ( mWorkEdgeList.empty() ) {
+    return;
+  }
+
+  bool manhattan = true;
+  for (ymuint i = 0; i < mWorkEdgeList.size(); ++ i) {
+    if ( mWorkEdgeList[i].mX0 != mWorkEdgeList[i].mX1 ) {
+      manhattan = false;
+      break;
+    }
+  }
+
+  vector<ymint32> bound_list;
+  vector<vector<ymuint32> > tile_edge_array;
+
+  if ( !manhattan ) {
+    // 交差している辺を交点で分割する．
+    // 交点を丸めたことで新たな交差が生じることがあるので何回か繰り返す．
+    // 残った交差は sweep() の中で近似的に扱われる．
+    for (ymuint pass = 0; pass < 4; ++ pass) {
+      make_tiles(bound_list, tile_edge_array);
+      ymuint nt = tile_edge_array.size();
+      vector<vector<Crossing> > tile_crossing_array(nt);
+      parallel_for(nt, mThreadNum, [&](ymuint t) {
+	  find_crossings(tile_edge_array[t], bound_list[t], bound_list[t + 1],
+			 tile_crossing_array[t]);
+	});
+      vector<Crossing> crossing_list;
+      for (ymuint t = 0; t < nt; ++ t) {
+	crossing_list.insert(crossing_list.end(),
+			     tile_crossing_array[t].begin(), tile_crossing_array[t].end());
+      }
+      if ( crossing_list.empty() ) {
+	break;
+      }
+      split_edges(crossing_list);
+    }
+  }
+
+  make_tiles(bound_list, tile_edge_array);
+  ymuint nt = tile_edge_array.size();
+  vector<vector<Trap> > tile_trap_array(nt);
+  parallel_for(nt, mThreadNum, [&](ymuint t) {
+      sweep(tile_edge_array[t], bound_list[t], bound_list[t + 1], op, manhattan,
+	    tile_trap_array[t]);
+    });
+
+  // タイルの境界で分断された台形をつなぎ合わせる．
+  vector<Trap> trap_list;
+  // 上端が現在の境界にある台形の番号
+  vector<ymuint32> pending_list;
+  for (ymuint t = 0; t < nt; ++ t) {
+    ymint32 ylo = bound_list[t];
+    ymint32 yhi = bound_list[t + 1];
+    std::map<std::pair<ymint64, ymint64>, ymuint32> seam_map;
+    for (ymuint i = 0; i < pending_list.size(); ++ i) {
+      const Trap& trap = trap_list[pending_list[i]];
+      ymint64 xl = x_at(mWorkEdgeList[trap.mLeft], ylo);
+      ymint64 xr = x_at(mWorkEdgeList[trap.mRight], ylo);
+      seam_map.insert(std::make_pair(std::make_pair(xl, xr), pending_list[i]));
+    }
+    pending_list.clear();
+    const vector<Trap>& tile_trap_list = tile_trap_array[t];
+    for (ymuint i = 0; i < tile_trap_list.size(); ++ i) {
+      const Trap& trap = tile_trap_list[i];
+      ymint32 id = -1;
+      if ( trap.mYb == ylo && !seam_map.empty() ) {
+	ymint64 xl = x_at(mWorkEdgeList[trap.mLeft], ylo);
+	ymint64 xr = x_at(mWorkEdgeList[trap.mRight], ylo);
+	std::map<std::pair<ymint64, ymint64>, ymuint32>::iterator p
+	  = seam_map.find(std::make_pair(xl, xr));
+	if ( p != seam_map.end() ) {
+	  Trap& lower = trap_list[p->second];
+	  if ( collinear(mWorkEdgeList[lower.mLeft], mWorkEdgeList[trap.mLeft]) &&
+	       collinear(mWorkEdgeList[lower.mRight], mWorkEdgeList[trap.mRight]) ) {
+	    lower.mYt = trap.mYt;
+	    id = p->second;
+	    seam_map.erase(p);
+	  }
+	}
+      }
+      if ( id < 0 ) {
+	id = trap_list.size();
+	trap_list.push_back(trap);
+      }
+      if ( trap.mYt == yhi ) {
+	pending_list.push_back(id);
+      }
+    }
+  }
+
+  // 台形を多角形に変換する．
+  mPool.reserve(trap_list.size() * 8);
+  mPosList.reserve(trap_list.size() + 1);
+  for (ymuint i = 0; i < trap_list.size(); ++ i) {
+    const Trap& trap = trap_list[i];
+    const Edge& left = mWorkEdgeList[trap.mLeft];
+    const Edge& right = mWorkEdgeList[trap.mRight];
+    ymint32 pts[8];
+    pts[0] = x_at(left, trap.mYb);
+    pts[1] = trap.mYb;
+    pts[2] = x_at(right, trap.mYb);
+    pts[3] = trap.mYb;
+    pts[4] = x_at(right, trap.mYt);
+    pts[5] = trap.mYt;
+    pts[6] = x_at(left, trap.mYt);
+    pts[7] = trap.mYt;
+    // 1 より細かい範囲で辺が交差している場合は左右が逆転するので
+    // 中点につぶす．
+    if ( pts[0] > pts[2] ) {
+      pts[0] = pts[2] = pts[0] + (pts[2] - pts[0]) / 2;
+    }
+    if ( pts[6] > pts[4] ) {
+      pts[6] = pts[4] = pts[6] + (pts[4] - pts[6]) / 2;
+    }
+    ymuint start = mPool.size();
+    for (ymuint k = 0; k < 4; ++ k) {
+      ymuint n = mPool.size();
+      if ( n > start && mPool[n - 2] == pts[k * 2] && mPool[n - 1] == pts[k * 2 + 1] ) {
+	continue;
+      }
+      if ( k == 3 && mPool[start] == pts[6] && mPool[start + 1] == pts[7] ) {
+	continue;
+      }
+      mPool.push_back(pts[k * 2 + 0]);
+      mPool.push_back(pts[k * 2 + 1]);
+    }
+    if ( mPool.size() - start < 6 ) {
+      // 面積を持たない．
+      mPool.resize(start);
+      continue;
+    }
+    mPosList.push_back(mPool.size() / 2);
+  }
+}
+
+// @brief 結果の多角形の数を返す．
+ymuint
+GdsBoolean::polygon_num() const
+{
+  return mPosList.size() - 1;
+}
+
+// @brief 結果の多角形の頂点数を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+ymuint
+GdsBoolean::point_num(ymuint pos) const
+{
+  ASSERT_COND( pos < polygon_num() );
+  return mPosList[pos + 1] - mPosList[pos];
+}
+
+// @brief 結果の多角形の座標の配列を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+//
+// x0, y0, x1, y1, ... の順に point_num(pos) * 2 個の要素を持つ．
+// 頂点は反時計回りに並ぶ．
+const ymint32*
+GdsBoolean::polygon_data(ymuint pos) const
+{
+  ASSERT_COND( pos < polygon_num() );
+  return &mPool[mPosList[pos] * 2];
+}
+
+// @brief 結果の面積の2倍を返す．
+tGdsInt128
+GdsBoolean::area2() const
+{
+  tGdsInt128 area2 = 0;
+  for (ymuint i = 0; i < polygon_num(); ++ i) {
+    area2 += polygon_area2(polygon_data(i), point_num(i));
+  }
+  return area2;
+}
+
+// @brief y 方向のタイルに分割する．
+// @param[out] bound_list タイルの境界の y 座標のリスト
+// @param[out] tile_edge_array タイルごとの辺の番号のリスト
+//
+// タイルの境界は辺の下端の y 座標の分布から決める．
+// tile_edge_array の各リストは max(mY0, ylo) の昇順に並ぶ．
+void
+GdsBoolean::make_tiles(vector<ymint32>& bound_list,
+		       vector<vector<ymuint32> >& tile_edge_array) const
+{
+  ymuint ne = mWorkEdgeList.size();
+  vector<ymuint32> order(ne);
+  for (ymuint i = 0; i < ne; ++ i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](ymuint32 a, ymuint32 b) {
+      return mWorkEdgeList[a].mY0 < mWorkEdgeList[b].mY0;
+    });
+
+  ymint32 ymin = mWorkEdgeList[order[0]].mY0;
+  ymint32 ymax = ymin;
+  for (ymuint i = 0; i < ne; ++ i) {
+    ymax = std::max(ymax, mWorkEdgeList[i].mY1);
+  }
+  ymuint tile_num = mTileNum;
+  if ( tile_num == 0 ) {
+    tile_num = get_thread_num(mThreadNum, ne) * 4;
+  }
+  bound_list.clear();
+  bound_list.push_back(ymin);
+  for (ymuint k = 1; k < tile_num; ++ k) {
+    ymint32 y = mWorkEdgeList[order[static_cast<ymuint64>(ne) * k / tile_num]].mY0;
+    if ( y > bound_list.back() ) {
+      bound_list.push_back(y);
+    }
+  }
+  if ( ymax > bound_list.back() ) {
+    bound_list.push_back(ymax);
+  }
+  ymuint nt = bound_list.size() - 1;
+
+  // order の順に入れるので max(mY0, ylo) の昇順になる．
+  tile_edge_array.clear();
+  tile_edge_array.resize(nt);
+  for (ymuint i = 0; i < ne; ++ i) {
+    ymuint32 id = order[i];
+    const Edge& edge = mWorkEdgeList[id];
+    ymuint t = std::upper_bound(bound_list.begin(), bound_list.end(), edge.mY0)
+      - bound_list.begin();
+    t = t > 0 ? t - 1 : 0;
+    for ( ; t < nt && bound_list[t] < edge.mY1; ++ t) {
+      tile_edge_array[t].push_back(id);
+    }
+  }
+}
+
+// @brief 走査線を止める y 座標のリストを作る．
+// @param[in] edge_list 対象の辺の番号のリスト
+// @param[in] ylo, yhi タイルの範囲
+// @param[out] event_list 結果を格納するリスト
+//
+// event_list は昇順に並び，ylo と yhi を含む．
+void
+GdsBoolean::make_events(const vector<ymuint32>& edge_list,
+			ymint32 ylo,
+			ymint32 yhi,
+			vector<ymint32>& event_list) const
+{
+  event_list.clear();
+  event_list.reserve(edge_list.size() * 2 + 2);
+  event_list.push_back(ylo);
+  event_list.push_back(yhi);
+  for (ymuint i = 0; i < edge_list.size(); ++ i) {
+    const Edge& edge = mWorkEdgeList[edge_list[i]];
+    if ( edge.mY0 > ylo ) {
+      event_list.push_back(edge.mY0);
+    }
+    if ( edge.mY1 < yhi ) {
+      event_list.push_back(edge.mY1);
+    }
+  }
+  std::sort(event_list.begin(), event_list.end());
+  event_list.erase(std::unique(event_list.begin(), event_list.end()), event_list.end());
+}
+
+// @brief 一つのタイルの中で辺の交差を求める．
+// @param[in] edge_list 対象の辺の番号のリスト
+// @param[in] ylo, yhi タイルの範囲
+// @param[out] crossing_list 結果を格納するリスト
+//
+// 各スラブの下端での順序を上端での順序に並べ替える時に
+// 入れ替わる組が交差している辺の組となる．
+// 端点での接触は交差とみなさない．
+void
+GdsBoolean::find_crossings(const vector<ymuint32>& edge_list,
+			   ymint32 ylo,
+			   ymint32 yhi,
+			   vector<Crossing>& crossing_list) const
+{
+  vector<ymint32> event_list;
+  make_events(edge_list, ylo, yhi, event_list);
+
+  vector<ymuint32> active;
+  ymuint rpos = 0;
+  for (ymuint epos = 0; epos + 1 < event_list.size(); ++ epos) {
+    ymint64 y = event_list[epos];
+    ymint64 ny = event_list[epos + 1];
+
+    ymuint wpos = 0;
+    for (ymuint i = 0; i < active.size(); ++ i) {
+      if ( mWorkEdgeList[active[i]].mY1 > y ) {
+	active[wpos] = active[i];
+	++ wpos;
+      }
+    }
+    active.resize(wpos);
+    for ( ; rpos < edge_list.size(); ++ rpos) {
+      const Edge& edge = mWorkEdgeList[edge_list[rpos]];
+      if ( std::max(edge.mY0, ylo) > y ) {
+	break;
+      }
+      if ( edge.mY1 > y ) {
+	active.push_back(edge_list[rpos]);
+      }
+    }
+
+    // 下端での順に並べる．
+    std::sort(active.begin(), active.end(), [&](ymuint32 a, ymuint32 b) {
+	int c = compare_at(mWorkEdgeList[a], mWorkEdgeList[b], y);
+	if ( c == 0 ) {
+	  c = compare_at(mWorkEdgeList[a], mWorkEdgeList[b], ny);
+	}
+	return c < 0;
+      });
+
+    // 挿入ソートで上端での順に並べ替える．
+    // 上端で一致する組は入れ替えない．
+    for (ymuint i = 1; i < active.size(); ++ i) {
+      ymuint32 id = active[i];
+      const Edge& edge = mWorkEdgeList[id];
+      ymuint j = i;
+      for ( ; j > 0; -- j) {
+	ymuint32 id1 = active[j - 1];
+	const Edge& edge1 = mWorkEdgeList[id1];
+	if ( compare_at(edge1, edge, ny) <= 0 ) {
+	  break;
+	}
+	Crossing crossing;
+	crossing.mEdge1 = id1;
+	crossing.mEdge2 = id;
+	crossing_point(edge1, edge, crossing.mX, crossing.mY);
+	crossing_list.push_back(crossing);
+	active[j] = id1;
+      }
+      active[j] = id;
+    }
+  }
+}
+
+// @brief 辺を交点で分割する．
+// @param[in] crossing_list 交差のリスト
+//
+// 分割によって水平になった部分は取り除く．
+void
+GdsBoolean::split_edges(const vector<Crossing>& crossing_list)
+{
+  // ( 辺の番号, 交点 ) のリスト
+  vector<std::pair<ymuint32, std::pair<ymint32, ymint32> > > point_list;
+  point_list.reserve(crossing_list.size() * 2);
+  for (ymuint i = 0; i < crossing_list.size(); ++ i) {
+    const Crossing& crossing = crossing_list[i];
+    std::pair<ymint32, ymint32> pt(crossing.mX, crossing.mY);
+    point_list.push_back(std::make_pair(crossing.mEdge1, pt));
+    point_list.push_back(std::make_pair(crossing.mEdge2, pt));
+  }
+  // 辺ごとに下端から順に並べる．
+  std::sort(point_list.begin(), point_list.end(),
+	    [&](const std::pair<ymuint32, std::pair<ymint32, ymint32> >& a,
+		const std::pair<ymuint32, std::pair<ymint32, ymint32> >& b) {
+	      if ( a.first != b.first ) {
+		return a.first < b.first;
+	      }
+	      if ( a.second.second != b.second.second ) {
+		return a.second.second < b.second.second;
+	      }
+	      const Edge& edge = mWorkEdgeList[a.first];
+	      if ( edge.mX0 < edge.mX1 ) {
+		return a.second.first < b.second.first;
+	      }
+	      return a.second.first > b.second.first;
+	    });
+
+  vector<Edge> new_list;
+  new_list.reserve(mWorkEdgeList.size() + point_list.size());
+  ymuint ppos = 0;
+  for (ymuint id = 0; id < mWorkEdgeList.size(); ++ id) {
+    const Edge& edge = mWorkEdgeList[id];
+    Edge piece = edge;
+    for ( ; ppos < point_list.size() && point_list[ppos].first == id; ++ ppos) {
+      ymint32 x = point_list[ppos].second.first;
+      ymint32 y = point_list[ppos].second.second;
+      if ( x == piece.mX0 && y == piece.mY0 ) {
+	continue;
+      }
+      if ( y > piece.mY0 ) {
+	piece.mX1 = x;
+	piece.mY1 = y;
+	new_list.push_back(piece);
+      }
+      piece.mX0 = x;
+      piece.mY0 = y;
+    }
+    piece.mX1 = edge.mX1;
+    piece.mY1 = edge.mY1;
+    if ( piece.mY1 > piece.mY0 ) {
+      new_list.push_back(piece);
+    }
+  }
+  mWorkEdgeList.swap(new_list);
+}
+
+// @brief 一つのタイルの中を走査する．
+// @param[in] edge_list 対象の辺の番号のリスト
+// @param[in] ylo, yhi タイルの範囲
+// @param[in] op 演算の種類
+// @param[in] manhattan すべての辺が垂直の時 true
+// @param[out] trap_list 結果の台形を格納するリスト
+//
+// edge_list は max(mY0, ylo) の昇順に並んでいなければならない．
+void
+GdsBoolean::sweep(const vector<ymuint32>& edge_list,
+		  ymint32 ylo,
+		  ymint32 yhi,
+		  GdsBoolOp op,
+		  bool manhattan,
+		  vector<Trap>& trap_list) const
+{
+  vector<ymint32> event_list;
+  make_events(edge_list, ylo, yhi, event_list);
+
+  // 辺の y における x 座標(実数)
+  auto xd_at = [&](const Edge& edge,
+		   double y) -> double {
+    return edge.mX0 + (y - edge.mY0) * static_cast<double>(edge.mX1 - edge.mX0)
+      / static_cast<double>(edge.mY1 - edge.mY0);
+  };
+
+  vector<ymuint32> active;
+  vector<ymuint32> open_list;
+  vector<ymuint32> new_open_list;
+  // 今回のスラブで得られた区間 ( 左の辺，右の辺 )
+  vector<std::pair<ymuint32, ymuint32> > span_list;
+  bool use_clip = !mClip.is_empty();
+  ymuint rpos = 0;
+  ymuint epos = 0;
+  ymint64 y = ylo;
+  while ( y < yhi ) {
+    // 走査線の下にある辺を取り除いて，新しい辺を加える．
+    ymuint wpos = 0;
+    for (ymuint i = 0; i < active.size(); ++ i) {
+      if ( mWorkEdgeList[active[i]].mY1 > y ) {
+	active[wpos] = active[i];
+	++ wpos;
+      }
+    }
+    active.resize(wpos);
+    for ( ; rpos < edge_list.size(); ++ rpos) {
+      const Edge& edge = mWorkEdgeList[edge_list[rpos]];
+      if ( std::max(edge.mY0, ylo) > y ) {
+	break;
+      }
+      if ( edge.mY1 > y ) {
+	active.push_back(edge_list[rpos]);
+      }
+    }
+
+    while ( event_list[epos] <= y ) {
+      ++ epos;
+    }
+    ymint64 ny = event_list[epos];
+
+    if ( active.empty() ) {
+      open_list.clear();
+      y = ny;
+      continue;
+    }
+
+    if ( manhattan ) {
+      std::sort(active.begin(), active.end(), [&](ymuint32 a, ymuint32 b) {
+	  return mWorkEdgeList[a].mX0 < mWorkEdgeList[b].mX0;
+	});
+    }
+    else {
+      std::sort(active.begin(), active.end(), [&](ymuint32 a, ymuint32 b) {
+	  int c = compare_at(mWorkEdgeList[a], mWorkEdgeList[b], y);
+	  if ( c == 0 ) {
+	    c = compare_at(mWorkEdgeList[a], mWorkEdgeList[b], ny);
+	  }
+	  return c < 0;
+	});
+      // 交差が残っている場合は交点の手前でスラブを区切る．
+      // 交点は整数に丸めるので，1 より細かい範囲の交差は無視される．
+      ymint64 split = ny;
+      for (ymuint i = 0; i + 1 < active.size(); ++ i) {
+	const Edge& edge1 = mWorkEdgeList[active[i]];
+	const Edge& edge2 = mWorkEdgeList[active[i + 1]];
+	if ( compare_at(edge1, edge2, ny) <= 0 ) {
+	  continue;
+	}
+	double f0 = xd_at(edge1, y) - xd_at(edge2, y);
+	double f1 = xd_at(edge1, ny) - xd_at(edge2, ny);
+	double yc = y + (ny - y) * (-f0) / (f1 - f0);
+	ymint64 cand = static_cast<ymint64>(floor(yc));
+	if ( cand <= y ) {
+	  cand = y + 1;
+	}
+	if ( cand < split ) {
+	  split = cand;
+	}
+      }
+      ny = split;
+    }
+
+    // 結果の内部になる区間を求める．
+    // 同じ位置にある辺はまとめて処理する．
+    span_list.clear();
+    int wind_a = 0;
+    int wind_b = 0;
+    int wind_c = 0;
+    bool prev_in = false;
+    ymuint32 left = 0;
+    for (ymuint i = 0; i < active.size(); ) {
+      const Edge& edge = mWorkEdgeList[active[i]];
+      ymuint j = i;
+      for ( ; j < active.size(); ++ j) {
+	const Edge& edge1 = mWorkEdgeList[active[j]];
+	if ( j > i ) {
+	  if ( manhattan ) {
+	    if ( edge1.mX0 != edge.mX0 ) {
+	      break;
+	    }
+	  }
+	  else if ( compare_at(edge, edge1, y) != 0 || compare_at(edge, edge1, ny) != 0 ) {
+	    break;
+	  }
+	}
+	if ( edge1.mSet == 0 ) {
+	  wind_a += edge1.mWind;
+	}
+	else if ( edge1.mSet == 1 ) {
+	  wind_b += edge1.mWind;
+	}
+	else {
+	  wind_c += edge1.mWind;
+	}
+      }
+      bool cur_in = eval_op(op, wind_a != 0, wind_b != 0);
+      if ( use_clip && wind_c == 0 ) {
+	cur_in = false;
+      }
+      if ( cur_in && !prev_in ) {
+	left = active[i];
+      }
+      else if ( !cur_in && prev_in ) {
+	span_list.push_back(std::make_pair(left, active[i]));
+      }
+      prev_in = cur_in;
+      i = j;
+    }
+
+    // 直前のスラブの台形と左右の辺が同一直線上にあれば延長する．
+    // どちらも x の昇順に並んでいる．
+    new_open_list.clear();
+    ymuint opos = 0;
+    for (ymuint i = 0; i < span_list.size(); ++ i) {
+      const Edge& l_edge = mWorkEdgeList[span_list[i].first];
+      const Edge& r_edge = mWorkEdgeList[span_list[i].second];
+      ymint64 xl = x_at(l_edge, y);
+      for ( ; opos < open_list.size(); ++ opos) {
+	if ( x_at(mWorkEdgeList[trap_list[open_list[opos]].mLeft], y) >= xl ) {
+	  break;
+	}
+      }
+      if ( opos < open_list.size() ) {
+	Trap& trap = trap_list[open_list[opos]];
+	if ( collinear(mWorkEdgeList[trap.mLeft], l_edge) &&
+	     collinear(mWorkEdgeList[trap.mRight], r_edge) ) {
+	  trap.mYt = ny;
+	  new_open_list.push_back(open_list[opos]);
+	  ++ opos;
+	  continue;
+	}
+      }
+      Trap trap;
+      trap.mYb = y;
+      trap.mYt = ny;
+      trap.mLeft = span_list[i].first;
+      trap.mRight = span_list[i].second;
+      new_open_list.push_back(trap_list.size());
+      trap_list.push_back(trap);
+    }
+    open_list.swap(new_open_list);
+
+    y = ny;
+  }
+}
+
+// @brief 辺の y における x 座標を返す．
+// @param[in] edge 辺
+// @param[in] y y 座標
+//
+// 最も近い整数に丸める．
+ymint64
+GdsBoolean::x_at(const Edge& edge,
+		 ymint64 y)
+{
+  if ( edge.mX0 == edge.mX1 || y == edge.mY0 ) {
+    return edge.mX0;
+  }
+  if ( y == edge.mY1 ) {
+    return edge.mX1;
+  }
+  tGdsInt128 num = static_cast<tGdsInt128>(y - edge.mY0) * (edge.mX1 - edge.mX0);
+  return edge.mX0 + round_div(num, edge.mY1 - edge.mY0);
+}
+
+// @brief 二つの辺の y における x 座標を比較する．
+// @param[in] edge1, edge2 辺
+// @param[in] y y 座標
+// @return edge1 が左なら負，右なら正，一致していたら 0 を返す．
+//
+// 分母を払って 128 ビット整数で比べるので誤差はない．
+int
+GdsBoolean::compare_at(const Edge& edge1,
+		       const Edge& edge2,
+		       ymint64 y)
+{
+  tGdsInt128 dy1 = edge1.mY1 - edge1.mY0;
+  tGdsInt128 dy2 = edge2.mY1 - edge2.mY0;
+  tGdsInt128 n1 = edge1.mX0 * dy1
+    + (y - edge1.mY0) * static_cast<tGdsInt128>(edge1.mX1 - edge1.mX0);
+  tGdsInt128 n2 = edge2.mX0 * dy2
+    + (y - edge2.mY0) * static_cast<tGdsInt128>(edge2.mX1 - edge2.mX0);
+  tGdsInt128 l = n1 * dy2;
+  tGdsInt128 r = n2 * dy1;
+  if ( l < r ) {
+    return -1;
+  }
+  if ( l > r ) {
+    return 1;
+  }
+  return 0;
+}
+
+// @brief 二つの辺の交点を求める．
+// @param[in] edge1, edge2 辺
+// @param[out] x, y 交点の座標
+//
+// 二つの辺は平行であってはならない．
+// 結果は最も近い整数に丸める．
+void
+GdsBoolean::crossing_point(const Edge& edge1,
+			   const Edge& edge2,
+			   ymint32& x,
+			   ymint32& y)
+{
+  ymint64 rx = static_cast<ymint64>(edge1.mX1) - edge1.mX0;
+  ymint64 ry = static_cast<ymint64>(edge1.mY1) - edge1.mY0;
+  ymint64 sx = static_cast<ymint64>(edge2.mX1) - edge2.mX0;
+  ymint64 sy = static_cast<ymint64>(edge2.mY1) - edge2.mY0;
+  ymint64 qx = static_cast<ymint64>(edge2.mX0) - edge1.mX0;
+  ymint64 qy = static_cast<ymint64>(edge2.mY0) - edge1.mY0;
+  tGdsInt128 den = static_cast<tGdsInt128>(rx) * sy - static_cast<tGdsInt128>(ry) * sx;
+  tGdsInt128 num = static_cast<tGdsInt128>(qx) * sy - static_cast<tGdsInt128>(qy) * sx;
+  ASSERT_COND( den != 0 );
+  x = edge1.mX0 + round_div(num * rx, den);
+  y = edge1.mY0 + round_div(num * ry, den);
+}
+
+// @brief 除算の結果を最も近い整数に丸める．
+// @param[in] num 分子
+// @param[in] den 分母 ( 0 以外 )
+ymint64
+GdsBoolean::round_div(tGdsInt128 num,
+		      tGdsInt128 den)
+{
+  if ( den < 0 ) {
+    num = -num;
+    den = -den;
+  }
+  num = num * 2 + den;
+  den *= 2;
+  tGdsInt128 q = num / den;
+  if ( num % den != 0 && num < 0 ) {
+    -- q;
+  }
+  return static_cast<ymint64>(q);
+}
+
+// @brief 二つの辺が同一直線上にある時 true を返す．
+bool
+GdsBoolean::collinear(const Edge& edge1,
+		      const Edge& edge2)
+{
+  ymint64 dx = static_cast<ymint64>(edge1.mX1) - edge1.mX0;
+  ymint64 dy = static_cast<ymint64>(edge1.mY1) - edge1.mY0;
+  tGdsInt128 c0 = static_cast<tGdsInt128>(dx) * (static_cast<ymint64>(edge2.mY0) - edge1.mY0)
+    - static_cast<tGdsInt128>(dy) * (static_cast<ymint64>(edge2.mX0) - edge1.mX0);
+  tGdsInt128 c1 = static_cast<tGdsInt128>(dx) * (static_cast<ymint64>(edge2.mY1) - edge1.mY0)
+    - static_cast<tGdsInt128>(dy) * (static_cast<ymint64>(edge2.mX1) - edge1.mX0);
+  return c0 == 0 && c1 == 0;
+}
+
+END_NAMESPACE_YM_GDS
@@ -39,6 +39,13 @@ GdsBoundary::~GdsBoundary()
 {
 }
 
+// @brief 要素の種類を返す．
+GdsRtype
+GdsBoundary::type() const
+{
+  return kGdsBOUNDARY;
+}
+
 // @brief 層番号を返す．
 int
 GdsBoundary::layer() const
@@ -21,7 +21,7 @@ BEGIN_NAMESPACE_YM_GDS
 class GdsBoundary :
   public GdsElement
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 private:
 
@@ -47,6 +47,11 @@ public:
   // 外部インターフェイス
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief 要素の種類を返す．
+  virtual
+  GdsRtype
+  type() const;
+
   /// @brief 層番号を返す．
   virtual
   int
@@ -39,6 +39,13 @@ GdsBox::~GdsBox()
 {
 }
 
+// @brief 要素の種類を返す．
+GdsRtype
+GdsBox::type() const
+{
+  return kGdsBOX;
+}
+
 // @brief 層番号を返す．
 int
 GdsBox::layer() const
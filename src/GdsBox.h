@@ -21,7 +21,7 @@ BEGIN_NAMESPACE_YM_GDS
 class GdsBox :
   public GdsElement
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 private:
 
   /// @brief コンストラクタ
@@ -46,6 +46,11 @@ public:
   // 外部インターフェイス
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief 要素の種類を返す．
+  virtual
+  GdsRtype
+  type() const;
+
   /// @brief 層番号を返す．
   virtual
   int
@@ -0,0 +1,383 @@
+﻿
+/// @file GdsBuilder.cc
+/// @brief GdsBuilder の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsBuilder.h"
+
+#include "YmGds/GdsACL.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsDate.h"
+#include "YmGds/GdsFormat.h"
+#include "YmGds/GdsProperty.h"
+#include "YmGds/GdsStrans.h"
+#include "YmGds/GdsString.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsUnits.h"
+#include "YmGds/GdsXY.h"
+
+#include "GdsAref.h"
+#include "GdsBoundary.h"
+#include "GdsBox.h"
+#include "GdsNode.h"
+#include "GdsPath.h"
+#include "GdsSref.h"
+#include "GdsText.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsBuilder
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsBuilder::GdsBuilder() :
+  mAlloc(4096)
+{
+}
+
+// @brief デストラクタ
+GdsBuilder::~GdsBuilder()
+{
+}
+
+// @brief GdsData を作る．
+GdsData*
+GdsBuilder::new_data(ymint16 version,
+		     GdsDate* date,
+		     ymint16 libdirsize,
+		     GdsString* srfname,
+		     GdsACL* acl,
+		     GdsString* libname,
+		     GdsString* reflibs,
+		     GdsString* fonts,
+		     GdsString* attrtable,
+		     ymint16 generations,
+		     GdsFormat* format,
+		     GdsUnits* units)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsData));
+  return new (p) GdsData(version, date, libdirsize, srfname, acl, libname,
+			 reflibs, fonts, attrtable, generations, format, units);
+}
+
+// @brief 2つの日時の配列を作る．
+GdsDate*
+GdsBuilder::new_date()
+{
+  void* p = mAlloc.get_memory(sizeof(GdsDate[2]));
+  return new (p) GdsDate[2];
+}
+
+// @brief GdsString を作る．
+// @param[in] str 文字列の先頭
+// @param[in] len 文字列の長さ
+GdsString*
+GdsBuilder::new_string(const char* str,
+		       ymuint len)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsString) + len);
+  GdsString* gstr = new (p) GdsString;
+  for (ymuint i = 0; i < len; ++ i) {
+    gstr->mStr[i] = str[i];
+  }
+  gstr->mStr[len] = '\0';
+  return gstr;
+}
+
+// @brief GdsXY を作る．
+// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] num 点の数
+GdsXY*
+GdsBuilder::new_xy(const ymint32* data,
+		   ymuint num)
+{
+  ymuint n = num * 2;
+  ymuint extra = n > 0 ? n - 1 : 0;
+  void* p = mAlloc.get_memory(sizeof(GdsXY) + sizeof(ymint32) * extra);
+  GdsXY* xy = new (p) GdsXY();
+  xy->mNum = num;
+  for (ymuint i = 0; i < n; ++ i) {
+    xy->mData[i] = data[i];
+  }
+  return xy;
+}
+
+// @brief GdsUnits を作る．
+// @param[in] user user unit
+// @param[in] meter meter unit
+GdsUnits*
+GdsBuilder::new_units(double user,
+		      double meter)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsUnits));
+  return new (p) GdsUnits(user, meter);
+}
+
+// @brief GdsACL を作る．
+// @param[in] group グループ番号
+// @param[in] user ユーザー番号
+// @param[in] access アクセス権
+// @param[in] next 次の要素
+GdsACL*
+GdsBuilder::new_acl(ymuint group,
+		    ymuint user,
+		    ymuint access,
+		    GdsACL* next)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsACL));
+  GdsACL* acl = new (p) GdsACL(group, user, access);
+  acl->mNext = next;
+  return acl;
+}
+
+// @brief GdsFormat を作る．
+// @param[in] type FORMAT の値
+// @param[in] masks MASK の値のリスト
+GdsFormat*
+GdsBuilder::new_format(ymint16 type,
+		       const vector<GdsString*>& masks)
+{
+  ymuint nm = masks.size();
+  ymuint extra = nm > 0 ? nm - 1 : 0;
+  void* p = mAlloc.get_memory(sizeof(GdsFormat) + extra * sizeof(GdsString*));
+  GdsFormat* format = new (p) GdsFormat(type);
+  format->mMaskNum = nm;
+  for (ymuint i = 0; i < nm; ++ i) {
+    format->mMasks[i] = masks[i];
+  }
+  return format;
+}
+
+// @brief GdsStrans を作る．
+// @param[in] flags STRANS の値
+// @param[in] mag MAG の値
+// @param[in] angle ANGLE の値
+GdsStrans*
+GdsBuilder::new_strans(ymuint16 flags,
+		       double mag,
+		       double angle)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsStrans));
+  return new (p) GdsStrans(flags, mag, angle);
+}
+
+// @brief GdsStruct を作る．
+// @param[in] date 2つの日時の配列
+// @param[in] name 構造名
+GdsStruct*
+GdsBuilder::new_struct(GdsDate* date,
+		       GdsString* name)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsStruct));
+  return new (p) GdsStruct(date, name);
+}
+
+// @brief BOUNDARY を作る．
+GdsElement*
+GdsBuilder::new_boundary(ymuint16 elflags,
+			 ymint32 plex,
+			 ymint16 layer,
+			 ymint16 datatype,
+			 GdsXY* xy)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsBoundary));
+  return new (p) GdsBoundary(elflags, plex, layer, datatype, xy);
+}
+
+// @brief PATH を作る．
+GdsElement*
+GdsBuilder::new_path(ymuint16 elflags,
+		     ymint32 plex,
+		     ymint16 layer,
+		     ymint16 datatype,
+		     ymint16 pathtype,
+		     ymint32 width,
+		     ymint32 bgn_extn,
+		     ymint32 end_extn,
+		     GdsXY* xy)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsPath));
+  return new (p) GdsPath(elflags, plex, layer, datatype, pathtype,
+			 width, bgn_extn, end_extn, xy);
+}
+
+// @brief SREF を作る．
+GdsElement*
+GdsBuilder::new_sref(ymuint16 elflags,
+		     ymint32 plex,
+		     GdsString* strname,
+		     GdsStrans* strans,
+		     GdsXY* xy)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsSref));
+  return new (p) GdsSref(elflags, plex, strname, strans, xy);
+}
+
+// @brief AREF を作る．
+GdsElement*
+GdsBuilder::new_aref(ymuint16 elflags,
+		     ymint32 plex,
+		     GdsString* strname,
+		     GdsStrans* strans,
+		     ymuint32 colrow,
+		     GdsXY* xy)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsAref));
+  return new (p) GdsAref(elflags, plex, strname, strans, colrow, xy);
+}
+
+// @brief TEXT を作る．
+GdsElement*
+GdsBuilder::new_text(ymuint16 elflags,
+		     ymint32 plex,
+		     ymint16 layer,
+		     ymint16 texttype,
+		     ymuint16 presentation,
+		     ymint16 pathtype,
+		     ymint32 width,
+		     GdsStrans* strans,
+		     GdsXY* xy,
+		     GdsString* body)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsText));
+  return new (p) GdsText(elflags, plex, layer, texttype, presentation,
+			 pathtype, width, strans, xy, body);
+}
+
+// @brief NODE を作る．
+GdsElement*
+GdsBuilder::new_node(ymuint16 elflags,
+		     ymint32 plex,
+		     ymint16 layer,
+		     ymint16 nodetype,
+		     GdsXY* xy)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsNode));
+  return new (p) GdsNode(elflags, plex, layer, nodetype, xy);
+}
+
+// @brief BOX を作る．
+GdsElement*
+GdsBuilder::new_box(ymuint16 elflags,
+		    ymint32 plex,
+		    ymint16 layer,
+		    ymint16 boxtype,
+		    GdsXY* xy)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsBox));
+  return new (p) GdsBox(elflags, plex, layer, boxtype, xy);
+}
+
+// @brief GdsProperty を作る．
+// @param[in] attr PROPATTR の値
+// @param[in] value PROPVALUE の値
+GdsProperty*
+GdsBuilder::new_property(ymuint attr,
+			 GdsString* value)
+{
+  void* p = mAlloc.get_memory(sizeof(GdsProperty));
+  return new (p) GdsProperty(attr, value);
+}
+
+// @brief 構造をつなぐ．
+// @param[in] data 対象のデータ
+// @param[in] prev 直前の構造 (NULL の時は先頭につなぐ)
+// @param[in] str つなぐ構造
+void
+GdsBuilder::link_struct(GdsData* data,
+			GdsStruct* prev,
+			GdsStruct* str)
+{
+  if ( prev ) {
+    prev->mLink = str;
+  }
+  else {
+    data->mStruct = str;
+  }
+}
+
+// @brief 要素をつなぐ．
+// @param[in] str 対象の構造
+// @param[in] prev 直前の要素 (NULL の時は先頭につなぐ)
+// @param[in] elem つなぐ要素
+void
+GdsBuilder::link_element(GdsStruct* str,
+			 GdsElement* prev,
+			 GdsElement* elem)
+{
+  if ( prev ) {
+    prev->mLink = elem;
+  }
+  else {
+    str->mElement = elem;
+  }
+}
+
+// @brief プロパティをつなぐ．
+// @param[in] elem 対象の要素
+// @param[in] prev 直前のプロパティ (NULL の時は先頭につなぐ)
+// @param[in] prop つなぐプロパティ
+void
+GdsBuilder::link_property(GdsElement* elem,
+			  GdsProperty* prev,
+			  GdsProperty* prop)
+{
+  if ( prev ) {
+    prev->mLink = prop;
+  }
+  else {
+    elem->mProperty = prop;
+  }
+}
+
+// @brief 構造の表を作り，参照を解決する．
+// @param[in] data 対象のデータ
+//
+// 全ての構造をつないだ後で呼ぶ．
+void
+GdsBuilder::make_struct_table(GdsData* data)
+{
+  ymuint n = 0;
+  for (GdsStruct* str = data->mStruct; str; str = str->mLink) {
+    str->mId = n;
+    ++ n;
+  }
+
+  void* p = mAlloc.get_memory(sizeof(GdsStruct*) * n);
+  GdsStruct** str_array = new (p) GdsStruct*[n];
+  ymuint hash_size = n * 2 + 1;
+  void* q = mAlloc.get_memory(sizeof(GdsStruct*) * hash_size);
+  GdsStruct** hash_table = new (q) GdsStruct*[hash_size];
+  for (ymuint i = 0; i < hash_size; ++ i) {
+    hash_table[i] = NULL;
+  }
+  for (GdsStruct* str = data->mStruct; str; str = str->mLink) {
+    str_array[str->mId] = str;
+    ymuint pos = GdsData::hash_func(str->name()) % hash_size;
+    str->mHashLink = hash_table[pos];
+    hash_table[pos] = str;
+  }
+  data->mStructNum = n;
+  data->mStructArray = str_array;
+  data->mHashSize = hash_size;
+  data->mHashTable = hash_table;
+
+  // SREF/AREF の参照先を解決する．
+  for (GdsStruct* str = data->mStruct; str; str = str->mLink) {
+    for (GdsElement* elem = str->mElement; elem; elem = elem->mLink) {
+      if ( elem->type() == kGdsSREF || elem->type() == kGdsAREF ) {
+	GdsRefBase* ref = static_cast<GdsRefBase*>(elem);
+	const GdsStruct* ref_str = data->find_struct(ref->strname());
+	ref->mRefStruct = const_cast<GdsStruct*>(ref_str);
+      }
+    }
+  }
+}
+
+END_NAMESPACE_YM_GDS
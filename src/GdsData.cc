@@ -10,6 +10,7 @@
 #include "YmGds/GdsData.h"
 #include "YmGds/GdsDate.h"
 #include "YmGds/GdsString.h"
+#include "YmGds/GdsStruct.h"
 #include "YmGds/GdsUnits.h"
 
 
@@ -56,7 +57,11 @@ GdsData::GdsData(ymint16 version,
   mGenerations(generations),
   mFormat(format),
   mUnits(units),
-  mStruct(NULL)
+  mStruct(NULL),
+  mStructNum(0),
+  mStructArray(NULL),
+  mHashSize(0),
+  mHashTable(NULL)
 {
 }
 
@@ -170,4 +175,50 @@ GdsData::struct_top() const
   return mStruct;
 }
 
+// @brief GdsStruct の数を返す．
+ymuint
+GdsData::struct_num() const
+{
+  return mStructNum;
+}
+
+// @brief GdsStruct を返す．
+// @param[in] id ID番号 ( 0 <= id < struct_num() )
+const GdsStruct*
+GdsData::structure(ymuint id) const
+{
+  ASSERT_COND( id < mStructNum );
+  return mStructArray[id];
+}
+
+// @brief 名前から GdsStruct を探す．
+// @param[in] name 構造名
+//
+// 見つからなければ NULL を返す．
+const GdsStruct*
+GdsData::find_struct(const char* name) const
+{
+  if ( mHashSize == 0 ) {
+    return NULL;
+  }
+  ymuint pos = hash_func(name) % mHashSize;
+  for (GdsStruct* str = mHashTable[pos]; str; str = str->mHashLink) {
+    if ( strcmp(str->name(), name) == 0 ) {
+      return str;
+    }
+  }
+  return NULL;
+}
+
+// @brief 構造名のハッシュ値を計算する．
+ymuint
+GdsData::hash_func(const char* name)
+{
+  ymuint h = 0;
+  for (const char* p = name; *p; ++ p) {
+    h = h * 37 + static_cast<ymuint8>(*p);
+  }
+  return h;
+}
+
 END_NAMESPACE_YM_GDS
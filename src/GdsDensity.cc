@@ -0,0 +1,521 @@
+﻿
+/// @file GdsDensity.cc
+/// @brief GdsDensity の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsDensity.h"
+#include "YmGds/GdsBoolean.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsHier.h"
+#include "YmGds/GdsPathExpander.h"
+#include "YmGds/GdsXY.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <algorithm>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief 図形の (layer, datatype) を表すキーを返す．
+// @param[in] elem 対象の要素 ( BOUNDARY/BOX/PATH )
+static
+ymuint32
+elem_key(const GdsElement* elem)
+{
+  int dt = elem->type() == kGdsBOX ? elem->boxtype() : elem->datatype();
+  return (static_cast<ymuint32>(elem->layer() & 0xFFFF) << 16) |
+    static_cast<ymuint32>(dt & 0xFFFF);
+}
+
+// @brief 図形の要素の時 true を返す．
+static
+bool
+is_shape(const GdsElement* elem)
+{
+  GdsRtype type = elem->type();
+  return type == kGdsBOUNDARY || type == kGdsBOX || type == kGdsPATH;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsDensity
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsDensity::GdsDensity() :
+  mThreadNum(0),
+  mTileWidth(0),
+  mTileHeight(0),
+  mXNum(0),
+  mYNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsDensity::~GdsDensity()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsDensity::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief タイルの大きさを設定する．
+// @param[in] width 幅(database unit)
+// @param[in] height 高さ(database unit)
+void
+GdsDensity::set_tile_size(ymint32 width,
+			  ymint32 height)
+{
+  mTileWidth = width;
+  mTileHeight = height;
+}
+
+// @brief 対象の領域を設定する．
+// @param[in] region 領域
+//
+// 空の矩形の時は最上位の構造の外接矩形を用いる．
+void
+GdsDensity::set_region(const GdsBBox& region)
+{
+  mReqRegion = region;
+}
+
+// @brief 対象の (layer, datatype) を追加する．
+// @param[in] layer 層番号
+// @param[in] datatype データ型
+//
+// 一つも追加しなかった場合はすべての (layer, datatype) を対象とする．
+void
+GdsDensity::add_layer(int layer,
+		      int datatype)
+{
+  ymuint32 key = (static_cast<ymuint32>(layer & 0xFFFF) << 16) |
+    static_cast<ymuint32>(datatype & 0xFFFF);
+  vector<ymuint32>::iterator p = std::lower_bound(mKeyList.begin(), mKeyList.end(), key);
+  if ( p == mKeyList.end() || *p != key ) {
+    mKeyList.insert(p, key);
+  }
+}
+
+// @brief 被覆率を求める．
+// @param[in] data 対象のデータ
+// @param[in] top_name 最上位の構造名
+// @retval true 成功した．
+// @retval false 最上位の構造が決まらないか階層が循環していた．
+//
+// top_name が NULL の時は唯一の最上位の構造を用いる．
+bool
+GdsDensity::compute(const GdsData& data,
+		    const char* top_name)
+{
+  mRegion = GdsBBox();
+  mXNum = 0;
+  mYNum = 0;
+  mCellArray.clear();
+  mBBoxArray.clear();
+  mAreaArray.clear();
+
+  if ( mTileWidth <= 0 || mTileHeight <= 0 ) {
+    error_header(__FILE__, __LINE__, "GdsDensity", 0)
+      << "Tile size is not specified";
+    msg_end();
+    return false;
+  }
+
+  // 最上位の構造を求める．
+  GdsHier hier(data);
+  const GdsStruct* top = NULL;
+  if ( top_name != NULL ) {
+    top = data.find_struct(top_name);
+    if ( top == NULL ) {
+      error_header(__FILE__, __LINE__, "GdsDensity", 0)
+	<< top_name << ": No such structure";
+      msg_end();
+      return false;
+    }
+  }
+  else {
+    if ( hier.top_num() != 1 ) {
+      error_header(__FILE__, __LINE__, "GdsDensity", 0)
+	<< hier.top_num() << " top structures. Specify one of them";
+      msg_end();
+      return false;
+    }
+    top = hier.top(0);
+  }
+  if ( !hier.calc_count(top) ) {
+    return false;
+  }
+
+  // 対象の (layer, datatype) が指定されていなければ
+  // 最上位から到達可能な構造中のものをすべて用いる．
+  ymuint order_num = hier.order_num();
+  if ( mKeyList.empty() ) {
+    for (ymuint pos = 0; pos < order_num; ++ pos) {
+      for (const GdsElement* elem = hier.order(pos)->element();
+	   elem; elem = elem->next()) {
+	if ( is_shape(elem) ) {
+	  mKeyList.push_back(elem_key(elem));
+	}
+      }
+    }
+    std::sort(mKeyList.begin(), mKeyList.end());
+    mKeyList.erase(std::unique(mKeyList.begin(), mKeyList.end()), mKeyList.end());
+  }
+
+  // 構造ごとの図形の和を並列に求める．
+  ymuint n = data.struct_num();
+  mCellArray.resize(n);
+  parallel_for(order_num, mThreadNum, [&](ymuint pos) {
+      const GdsStruct* str = hier.order(pos);
+      make_cell(str, mCellArray[str->id()]);
+    });
+
+  // 外接矩形を子供の構造から順に求める．
+  // AREF の外接矩形は四隅の配置の外接矩形で決まる．
+  mBBoxArray.resize(n);
+  for (ymuint pos = order_num; pos -- > 0; ) {
+    const GdsStruct* str = hier.order(pos);
+    GdsBBox& bbox = mBBoxArray[str->id()];
+    const vector<CellLayer>& cell_list = mCellArray[str->id()];
+    for (ymuint i = 0; i < cell_list.size(); ++ i) {
+      const vector<ymint32>& pool = cell_list[i].mPool;
+      for (ymuint j = 0; j < pool.size(); j += 2) {
+	bbox.add_point(pool[j], pool[j + 1]);
+      }
+    }
+    for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+      if ( elem->type() != kGdsSREF && elem->type() != kGdsAREF ) {
+	continue;
+      }
+      const GdsStruct* child = elem->ref_struct();
+      if ( child == NULL || mBBoxArray[child->id()].is_empty() ) {
+	continue;
+      }
+      if ( elem->column() < 1 || elem->row() < 1 ) {
+	// 不正な COLROW
+	continue;
+      }
+      const GdsBBox& child_bbox = mBBoxArray[child->id()];
+      ymuint col_list[2] = { 0, static_cast<ymuint>(elem->column() - 1) };
+      ymuint row_list[2] = { 0, static_cast<ymuint>(elem->row() - 1) };
+      for (ymuint r = 0; r < 2; ++ r) {
+	for (ymuint c = 0; c < 2; ++ c) {
+	  bbox.merge(GdsTrans(elem, col_list[c], row_list[r]).apply(child_bbox));
+	}
+      }
+    }
+  }
+
+  mRegion = mReqRegion.is_empty() ? mBBoxArray[top->id()] : mReqRegion;
+  if ( mRegion.is_empty() ) {
+    return true;
+  }
+
+  ymint64 w = static_cast<ymint64>(mRegion.xmax()) - mRegion.xmin();
+  ymint64 h = static_cast<ymint64>(mRegion.ymax()) - mRegion.ymin();
+  mXNum = w > 0 ? (w + mTileWidth - 1) / mTileWidth : 1;
+  mYNum = h > 0 ? (h + mTileHeight - 1) / mTileHeight : 1;
+  mAreaArray.clear();
+  mAreaArray.resize(static_cast<ymuint64>(mKeyList.size()) * mXNum * mYNum, 0.0);
+
+  // 行ごとに並列に求める．
+  parallel_for(mYNum, mThreadNum, [&](ymuint iy) {
+      compute_band(top, iy);
+    });
+
+  return true;
+}
+
+// @brief 対象の (layer, datatype) の数を返す．
+ymuint
+GdsDensity::layer_num() const
+{
+  return mKeyList.size();
+}
+
+// @brief 層番号を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+int
+GdsDensity::layer(ymuint pos) const
+{
+  ASSERT_COND( pos < layer_num() );
+  return static_cast<ymint16>(mKeyList[pos] >> 16);
+}
+
+// @brief データ型を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+int
+GdsDensity::datatype(ymuint pos) const
+{
+  ASSERT_COND( pos < layer_num() );
+  return static_cast<ymint16>(mKeyList[pos] & 0xFFFF);
+}
+
+// @brief 実際に用いた領域を返す．
+const GdsBBox&
+GdsDensity::region() const
+{
+  return mRegion;
+}
+
+// @brief X 方向のタイル数を返す．
+ymuint
+GdsDensity::x_num() const
+{
+  return mXNum;
+}
+
+// @brief Y 方向のタイル数を返す．
+ymuint
+GdsDensity::y_num() const
+{
+  return mYNum;
+}
+
+// @brief タイルの矩形を返す．
+// @param[in] ix X 方向の位置 ( 0 <= ix < x_num() )
+// @param[in] iy Y 方向の位置 ( 0 <= iy < y_num() )
+//
+// 右端と上端のタイルは領域で切り取られている．
+GdsBBox
+GdsDensity::tile(ymuint ix,
+		 ymuint iy) const
+{
+  ASSERT_COND( ix < x_num() );
+  ASSERT_COND( iy < y_num() );
+  ymint64 x0 = mRegion.xmin() + static_cast<ymint64>(ix) * mTileWidth;
+  ymint64 y0 = mRegion.ymin() + static_cast<ymint64>(iy) * mTileHeight;
+  ymint64 x1 = std::min(x0 + mTileWidth, static_cast<ymint64>(mRegion.xmax()));
+  ymint64 y1 = std::min(y0 + mTileHeight, static_cast<ymint64>(mRegion.ymax()));
+  return GdsBBox(x0, y0, x1, y1);
+}
+
+// @brief タイル中の図形の面積を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+// @param[in] ix X 方向の位置 ( 0 <= ix < x_num() )
+// @param[in] iy Y 方向の位置 ( 0 <= iy < y_num() )
+double
+GdsDensity::area(ymuint pos,
+		 ymuint ix,
+		 ymuint iy) const
+{
+  ASSERT_COND( pos < layer_num() );
+  ASSERT_COND( ix < x_num() );
+  ASSERT_COND( iy < y_num() );
+  return mAreaArray[(static_cast<ymuint64>(pos) * mYNum + iy) * mXNum + ix];
+}
+
+// @brief タイルの被覆率を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+// @param[in] ix X 方向の位置 ( 0 <= ix < x_num() )
+// @param[in] iy Y 方向の位置 ( 0 <= iy < y_num() )
+//
+// 0.0 以上 1.0 以下の値をとる．
+double
+GdsDensity::density(ymuint pos,
+		    ymuint ix,
+		    ymuint iy) const
+{
+  GdsBBox bbox = tile(ix, iy);
+  double tile_area = static_cast<double>(static_cast<ymint64>(bbox.xmax()) - bbox.xmin()) *
+    static_cast<double>(static_cast<ymint64>(bbox.ymax()) - bbox.ymin());
+  if ( tile_area == 0.0 ) {
+    return 0.0;
+  }
+  return std::min(area(pos, ix, iy) / tile_area, 1.0);
+}
+
+// @brief 構造中の図形の和を求める．
+// @param[in] str 対象の構造
+// @param[out] cell_list 結果を格納するリスト
+void
+GdsDensity::make_cell(const GdsStruct* str,
+		      vector<CellLayer>& cell_list) const
+{
+  // 層ごとに図形を集める．
+  ymuint nl = mKeyList.size();
+  vector<GdsBoolean*> boolean_array(nl, NULL);
+  GdsPathExpander expander;
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    if ( !is_shape(elem) ) {
+      continue;
+    }
+    vector<ymuint32>::const_iterator p =
+      std::lower_bound(mKeyList.begin(), mKeyList.end(), elem_key(elem));
+    if ( p == mKeyList.end() || *p != elem_key(elem) ) {
+      continue;
+    }
+    ymuint pos = p - mKeyList.begin();
+    if ( boolean_array[pos] == NULL ) {
+      boolean_array[pos] = new GdsBoolean;
+      boolean_array[pos]->set_thread_num(1);
+      boolean_array[pos]->set_tile_num(1);
+    }
+    if ( elem->type() == kGdsPATH ) {
+      expander.clear();
+      expander.expand(elem);
+      for (ymuint i = 0; i < expander.polygon_num(); ++ i) {
+	boolean_array[pos]->add_polygon(0, expander.polygon_data(i),
+					expander.point_num(i));
+      }
+    }
+    else {
+      const GdsXY* xy = elem->xy();
+      boolean_array[pos]->add_polygon(0, xy->data(), xy->num());
+    }
+  }
+
+  // 重なりを取り除く．
+  for (ymuint pos = 0; pos < nl; ++ pos) {
+    GdsBoolean* boolean = boolean_array[pos];
+    if ( boolean == NULL ) {
+      continue;
+    }
+    boolean->compute(kGdsBoolOr);
+    if ( boolean->polygon_num() > 0 ) {
+      cell_list.push_back(CellLayer());
+      CellLayer& cell = cell_list.back();
+      cell.mLayer = pos;
+      cell.mPosList.push_back(0);
+      for (ymuint i = 0; i < boolean->polygon_num(); ++ i) {
+	const ymint32* data = boolean->polygon_data(i);
+	cell.mPool.insert(cell.mPool.end(), data, data + boolean->point_num(i) * 2);
+	cell.mPosList.push_back(cell.mPool.size() / 2);
+      }
+    }
+    delete boolean;
+  }
+}
+
+// @brief 行と重なる図形を集める．
+// @param[in] str 対象の構造
+// @param[in] trans 座標変換
+// @param[in] band 行の矩形
+// @param[out] pool_array 層ごとの頂点のプール
+// @param[out] polygon_array 層ごとの多角形のリスト
+void
+GdsDensity::collect(const GdsStruct* str,
+		    const GdsTrans& trans,
+		    const GdsBBox& band,
+		    vector<vector<ymint32> >& pool_array,
+		    vector<vector<BandPolygon> >& polygon_array) const
+{
+  const vector<CellLayer>& cell_list = mCellArray[str->id()];
+  for (ymuint i = 0; i < cell_list.size(); ++ i) {
+    const CellLayer& cell = cell_list[i];
+    vector<ymint32>& pool = pool_array[cell.mLayer];
+    vector<BandPolygon>& polygon_list = polygon_array[cell.mLayer];
+    for (ymuint j = 0; j + 1 < cell.mPosList.size(); ++ j) {
+      BandPolygon polygon;
+      polygon.mPos = pool.size() / 2;
+      polygon.mNum = cell.mPosList[j + 1] - cell.mPosList[j];
+      const ymint32* data = &cell.mPool[cell.mPosList[j] * 2];
+      for (ymuint k = 0; k < polygon.mNum; ++ k) {
+	ymint32 x;
+	ymint32 y;
+	trans.apply(data[k * 2 + 0], data[k * 2 + 1], x, y);
+	pool.push_back(x);
+	pool.push_back(y);
+	polygon.mBBox.add_point(x, y);
+      }
+      if ( polygon.mBBox.intersect(band) ) {
+	polygon_list.push_back(polygon);
+      }
+      else {
+	pool.resize(polygon.mPos * 2);
+      }
+    }
+  }
+
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    if ( elem->type() != kGdsSREF && elem->type() != kGdsAREF ) {
+      continue;
+    }
+    const GdsStruct* child = elem->ref_struct();
+    if ( child == NULL || mBBoxArray[child->id()].is_empty() ) {
+      continue;
+    }
+    const GdsBBox& child_bbox = mBBoxArray[child->id()];
+    ymuint ncol = elem->column();
+    ymuint nrow = elem->row();
+    for (ymuint r = 0; r < nrow; ++ r) {
+      for (ymuint c = 0; c < ncol; ++ c) {
+	GdsTrans child_trans = trans * GdsTrans(elem, c, r);
+	if ( child_trans.apply(child_bbox).intersect(band) ) {
+	  collect(child, child_trans, band, pool_array, polygon_array);
+	}
+      }
+    }
+  }
+}
+
+// @brief 一つの行の面積を求める．
+// @param[in] top 最上位の構造
+// @param[in] iy Y 方向の位置
+void
+GdsDensity::compute_band(const GdsStruct* top,
+			 ymuint iy)
+{
+  GdsBBox band(mRegion.xmin(), tile(0, iy).ymin(), mRegion.xmax(), tile(0, iy).ymax());
+  ymuint nl = mKeyList.size();
+  vector<vector<ymint32> > pool_array(nl);
+  vector<vector<BandPolygon> > polygon_array(nl);
+  if ( mBBoxArray[top->id()].intersect(band) ) {
+    collect(top, GdsTrans(), band, pool_array, polygon_array);
+  }
+
+  for (ymuint pos = 0; pos < nl; ++ pos) {
+    const vector<ymint32>& pool = pool_array[pos];
+    const vector<BandPolygon>& polygon_list = polygon_array[pos];
+    if ( polygon_list.empty() ) {
+      continue;
+    }
+
+    // 多角形をタイルに振り分ける．
+    vector<vector<ymuint32> > tile_list(mXNum);
+    for (ymuint i = 0; i < polygon_list.size(); ++ i) {
+      const GdsBBox& bbox = polygon_list[i].mBBox;
+      ymint64 tx0 = (static_cast<ymint64>(bbox.xmin()) - mRegion.xmin()) / mTileWidth;
+      ymint64 tx1 = (static_cast<ymint64>(bbox.xmax()) - mRegion.xmin()) / mTileWidth;
+      tx0 = std::max(tx0, static_cast<ymint64>(0));
+      tx1 = std::min(tx1, static_cast<ymint64>(mXNum) - 1);
+      for (ymint64 tx = tx0; tx <= tx1; ++ tx) {
+	tile_list[tx].push_back(i);
+      }
+    }
+
+    for (ymuint ix = 0; ix < mXNum; ++ ix) {
+      const vector<ymuint32>& id_list = tile_list[ix];
+      if ( id_list.empty() ) {
+	continue;
+      }
+      GdsBoolean boolean;
+      boolean.set_thread_num(1);
+      boolean.set_tile_num(1);
+      for (ymuint i = 0; i < id_list.size(); ++ i) {
+	const BandPolygon& polygon = polygon_list[id_list[i]];
+	boolean.add_polygon(0, &pool[polygon.mPos * 2], polygon.mNum);
+      }
+      boolean.set_clip(tile(ix, iy));
+      boolean.compute(kGdsBoolOr);
+      mAreaArray[(static_cast<ymuint64>(pos) * mYNum + iy) * mXNum + ix] =
+	static_cast<double>(boolean.area2()) * 0.5;
+    }
+  }
+}
+
+END_NAMESPACE_YM_GDS
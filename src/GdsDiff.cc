@@ -0,0 +1,485 @@
+﻿
+/// @file GdsDiff.cc
+/// @brief GdsDiff の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsDiff.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "GdsParallel.h"
+#include <algorithm>
+#include <cstring>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// 比較に用いる要素の情報
+struct DiffItem
+{
+  // プロパティを除いたハッシュ値
+  GdsHashValue mShape;
+
+  // プロパティのハッシュ値
+  GdsHashValue mProp;
+
+  // 構造中の位置
+  ymuint32 mIndex;
+
+  // 要素
+  const GdsElement* mElem;
+};
+
+// @brief 形とプロパティで比較する．
+static
+bool
+less_full(const DiffItem& a,
+	  const DiffItem& b)
+{
+  if ( a.mShape != b.mShape ) {
+    return a.mShape < b.mShape;
+  }
+  return a.mProp < b.mProp;
+}
+
+// @brief 形だけで比較する．
+static
+bool
+less_shape(const DiffItem& a,
+	   const DiffItem& b)
+{
+  return a.mShape < b.mShape;
+}
+
+// @brief 参照先の構造名だけで比較する．
+//
+// SREF/AREF 以外の要素は参照先の構造名が空の要素とみなす．
+static
+bool
+less_strname(const DiffItem& a,
+	     const DiffItem& b)
+{
+  const char* name1 = a.mElem->strname();
+  const char* name2 = b.mElem->strname();
+  return strcmp(name1 != NULL ? name1 : "", name2 != NULL ? name2 : "") < 0;
+}
+
+// @brief 位置で比較する．
+static
+bool
+less_index(const DiffItem& a,
+	   const DiffItem& b)
+{
+  return a.mIndex < b.mIndex;
+}
+
+// @brief 等しい要素の組を求める．
+// @param[inout] list1, list2 要素のリスト
+// @param[in] less 比較関数
+// @param[out] pair_list 等しい要素の組のリスト
+//
+// list1, list2 には等しいものが見つからなかった要素が
+// 元の位置の順に残る．
+template<typename Less>
+static
+void
+match_items(vector<DiffItem>& list1,
+	    vector<DiffItem>& list2,
+	    Less less,
+	    vector<std::pair<DiffItem, DiffItem> >& pair_list)
+{
+  // 等しい要素どうしは元の位置の順に対応づける．
+  std::stable_sort(list1.begin(), list1.end(), less);
+  std::stable_sort(list2.begin(), list2.end(), less);
+
+  vector<DiffItem> rest1;
+  vector<DiffItem> rest2;
+  ymuint i1 = 0;
+  ymuint i2 = 0;
+  ymuint n1 = list1.size();
+  ymuint n2 = list2.size();
+  while ( i1 < n1 && i2 < n2 ) {
+    if ( less(list1[i1], list2[i2]) ) {
+      rest1.push_back(list1[i1]);
+      ++ i1;
+    }
+    else if ( less(list2[i2], list1[i1]) ) {
+      rest2.push_back(list2[i2]);
+      ++ i2;
+    }
+    else {
+      pair_list.push_back(std::make_pair(list1[i1], list2[i2]));
+      ++ i1;
+      ++ i2;
+    }
+  }
+  rest1.insert(rest1.end(), list1.begin() + i1, list1.end());
+  rest2.insert(rest2.end(), list2.begin() + i2, list2.end());
+  std::sort(rest1.begin(), rest1.end(), less_index);
+  std::sort(rest2.begin(), rest2.end(), less_index);
+  list1.swap(rest1);
+  list2.swap(rest2);
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsDiff
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsDiff::GdsDiff() :
+  mThreadNum(0),
+  mSameNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsDiff::~GdsDiff()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsDiff::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief 差分を求める．
+// @param[in] data1 旧いデータ
+// @param[in] data2 新しいデータ
+// @retval true 成功した．
+// @retval false 階層が循環していた．
+bool
+GdsDiff::compute(const GdsData& data1,
+		 const GdsData& data2)
+{
+  mSameNum = 0;
+  mRemovedList.clear();
+  mAddedList.clear();
+  mRenamedList.clear();
+  mChangedList.clear();
+
+  const GdsData* data_array[2] = { &data1, &data2 };
+  for (ymuint side = 0; side < 2; ++ side) {
+    mHash[side].set_thread_num(mThreadNum);
+    mHash[side].set_order_insensitive(true);
+    if ( !mHash[side].compute(*data_array[side]) ) {
+      return false;
+    }
+  }
+
+  // 名前で対応づける．
+  vector<const GdsStruct*> only_list[2];
+  vector<StructDiff> cand_list;
+  for (ymuint id = 0; id < data1.struct_num(); ++ id) {
+    const GdsStruct* str1 = data1.structure(id);
+    const GdsStruct* str2 = data2.find_struct(str1->name());
+    if ( str2 == NULL ) {
+      only_list[0].push_back(str1);
+    }
+    else if ( mHash[0].hash(str1->id()) == mHash[1].hash(str2->id()) ) {
+      ++ mSameNum;
+    }
+    else {
+      cand_list.push_back(StructDiff());
+      StructDiff& sdiff = cand_list.back();
+      sdiff.mStruct1 = str1;
+      sdiff.mStruct2 = str2;
+    }
+  }
+  for (ymuint id = 0; id < data2.struct_num(); ++ id) {
+    const GdsStruct* str2 = data2.structure(id);
+    if ( data1.find_struct(str2->name()) == NULL ) {
+      only_list[1].push_back(str2);
+    }
+  }
+
+  // 一方にしかない構造のうちハッシュ値の等しいものは名前が変わったとみなす．
+  typedef std::pair<GdsHashValue, const GdsStruct*> HashPair;
+  vector<HashPair> hash_list[2];
+  for (ymuint side = 0; side < 2; ++ side) {
+    for (ymuint i = 0; i < only_list[side].size(); ++ i) {
+      const GdsStruct* str = only_list[side][i];
+      hash_list[side].push_back(HashPair(mHash[side].hash(str->id()), str));
+    }
+    std::stable_sort(hash_list[side].begin(), hash_list[side].end(),
+		     [](const HashPair& a, const HashPair& b) { return a.first < b.first; });
+  }
+  {
+    ymuint i1 = 0;
+    ymuint i2 = 0;
+    ymuint n1 = hash_list[0].size();
+    ymuint n2 = hash_list[1].size();
+    while ( i1 < n1 || i2 < n2 ) {
+      if ( i2 == n2 || (i1 < n1 && hash_list[0][i1].first < hash_list[1][i2].first) ) {
+	mRemovedList.push_back(hash_list[0][i1].second);
+	++ i1;
+      }
+      else if ( i1 == n1 || hash_list[1][i2].first < hash_list[0][i1].first ) {
+	mAddedList.push_back(hash_list[1][i2].second);
+	++ i2;
+      }
+      else {
+	mRenamedList.push_back(std::make_pair(hash_list[0][i1].second,
+					      hash_list[1][i2].second));
+	++ i1;
+	++ i2;
+      }
+    }
+  }
+  // 結果は ID 番号の順に並べる．
+  auto comp = [](const GdsStruct* a, const GdsStruct* b) { return a->id() < b->id(); };
+  std::sort(mRemovedList.begin(), mRemovedList.end(), comp);
+  std::sort(mAddedList.begin(), mAddedList.end(), comp);
+  std::sort(mRenamedList.begin(), mRenamedList.end(),
+	    [](const std::pair<const GdsStruct*, const GdsStruct*>& a,
+	       const std::pair<const GdsStruct*, const GdsStruct*>& b) {
+	      return a.first->id() < b.first->id();
+	    });
+
+  // 同じ名前でハッシュ値の異なる構造の要素を並列に比較する．
+  parallel_for(cand_list.size(), mThreadNum, [&](ymuint i) {
+      diff_elements(cand_list[i]);
+    });
+  for (ymuint i = 0; i < cand_list.size(); ++ i) {
+    StructDiff& sdiff = cand_list[i];
+    if ( sdiff.mElemDiffList.empty() ) {
+      // 子孫の構造だけが変化した．
+      ++ mSameNum;
+    }
+    else {
+      mChangedList.push_back(StructDiff());
+      StructDiff& dst = mChangedList.back();
+      dst.mStruct1 = sdiff.mStruct1;
+      dst.mStruct2 = sdiff.mStruct2;
+      dst.mElemDiffList.swap(sdiff.mElemDiffList);
+    }
+  }
+
+  return true;
+}
+
+// @brief 両方にあって要素に差分のない構造の数を返す．
+//
+// 子孫の構造だけが変化したものも含む．
+ymuint
+GdsDiff::same_num() const
+{
+  return mSameNum;
+}
+
+// @brief data1 にだけある構造の数を返す．
+ymuint
+GdsDiff::removed_num() const
+{
+  return mRemovedList.size();
+}
+
+// @brief data1 にだけある構造を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < removed_num() )
+const GdsStruct*
+GdsDiff::removed(ymuint pos) const
+{
+  ASSERT_COND( pos < removed_num() );
+  return mRemovedList[pos];
+}
+
+// @brief data2 にだけある構造の数を返す．
+ymuint
+GdsDiff::added_num() const
+{
+  return mAddedList.size();
+}
+
+// @brief data2 にだけある構造を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < added_num() )
+const GdsStruct*
+GdsDiff::added(ymuint pos) const
+{
+  ASSERT_COND( pos < added_num() );
+  return mAddedList[pos];
+}
+
+// @brief 名前が変わった構造の数を返す．
+ymuint
+GdsDiff::renamed_num() const
+{
+  return mRenamedList.size();
+}
+
+// @brief 名前が変わった構造の data1 側を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < renamed_num() )
+const GdsStruct*
+GdsDiff::renamed1(ymuint pos) const
+{
+  ASSERT_COND( pos < renamed_num() );
+  return mRenamedList[pos].first;
+}
+
+// @brief 名前が変わった構造の data2 側を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < renamed_num() )
+const GdsStruct*
+GdsDiff::renamed2(ymuint pos) const
+{
+  ASSERT_COND( pos < renamed_num() );
+  return mRenamedList[pos].second;
+}
+
+// @brief 要素が変化した構造の数を返す．
+ymuint
+GdsDiff::changed_num() const
+{
+  return mChangedList.size();
+}
+
+// @brief 要素が変化した構造の data1 側を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < changed_num() )
+const GdsStruct*
+GdsDiff::changed1(ymuint pos) const
+{
+  ASSERT_COND( pos < changed_num() );
+  return mChangedList[pos].mStruct1;
+}
+
+// @brief 要素が変化した構造の data2 側を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < changed_num() )
+const GdsStruct*
+GdsDiff::changed2(ymuint pos) const
+{
+  ASSERT_COND( pos < changed_num() );
+  return mChangedList[pos].mStruct2;
+}
+
+// @brief 要素の差分の数を返す．
+// @param[in] pos 構造の位置番号 ( 0 <= pos < changed_num() )
+ymuint
+GdsDiff::elem_diff_num(ymuint pos) const
+{
+  ASSERT_COND( pos < changed_num() );
+  return mChangedList[pos].mElemDiffList.size();
+}
+
+// @brief 要素の差分の種類を返す．
+// @param[in] pos 構造の位置番号 ( 0 <= pos < changed_num() )
+// @param[in] idx 差分の番号 ( 0 <= idx < elem_diff_num(pos) )
+GdsDiffType
+GdsDiff::elem_diff_type(ymuint pos,
+			ymuint idx) const
+{
+  ASSERT_COND( idx < elem_diff_num(pos) );
+  return mChangedList[pos].mElemDiffList[idx].mType;
+}
+
+// @brief 差分の data1 側の要素を返す．
+// @param[in] pos 構造の位置番号 ( 0 <= pos < changed_num() )
+// @param[in] idx 差分の番号 ( 0 <= idx < elem_diff_num(pos) )
+//
+// kGdsDiffAdded の時は NULL を返す．
+const GdsElement*
+GdsDiff::elem_diff1(ymuint pos,
+		    ymuint idx) const
+{
+  ASSERT_COND( idx < elem_diff_num(pos) );
+  return mChangedList[pos].mElemDiffList[idx].mElem1;
+}
+
+// @brief 差分の data2 側の要素を返す．
+// @param[in] pos 構造の位置番号 ( 0 <= pos < changed_num() )
+// @param[in] idx 差分の番号 ( 0 <= idx < elem_diff_num(pos) )
+//
+// kGdsDiffRemoved の時は NULL を返す．
+const GdsElement*
+GdsDiff::elem_diff2(ymuint pos,
+		    ymuint idx) const
+{
+  ASSERT_COND( idx < elem_diff_num(pos) );
+  return mChangedList[pos].mElemDiffList[idx].mElem2;
+}
+
+// @brief 同じ名前の構造の要素を比較する．
+// @param[inout] sdiff 対象の構造と結果
+void
+GdsDiff::diff_elements(StructDiff& sdiff)
+{
+  vector<DiffItem> item_list[2];
+  const GdsStruct* str_array[2] = { sdiff.mStruct1, sdiff.mStruct2 };
+  for (ymuint side = 0; side < 2; ++ side) {
+    ymuint32 index = 0;
+    for (const GdsElement* elem = str_array[side]->element();
+	 elem; elem = elem->next(), ++ index) {
+      DiffItem item;
+      item.mShape = GdsStructHash::shape_hash(elem);
+      item.mProp = GdsStructHash::property_hash(elem);
+      item.mIndex = index;
+      item.mElem = elem;
+      item_list[side].push_back(item);
+    }
+  }
+
+  // まったく同じ要素を取り除く．
+  vector<std::pair<DiffItem, DiffItem> > pair_list;
+  match_items(item_list[0], item_list[1], less_full, pair_list);
+
+  vector<ElemDiff>& diff_list = sdiff.mElemDiffList;
+
+  // 形が同じ要素はプロパティだけが変わったとみなす．
+  pair_list.clear();
+  match_items(item_list[0], item_list[1], less_shape, pair_list);
+  for (ymuint i = 0; i < pair_list.size(); ++ i) {
+    ElemDiff ediff;
+    ediff.mType = kGdsDiffProperty;
+    ediff.mElem1 = pair_list[i].first.mElem;
+    ediff.mElem2 = pair_list[i].second.mElem;
+    diff_list.push_back(ediff);
+  }
+
+  // 同じ構造の SREF/AREF は配置が変わったとみなす．
+  vector<DiffItem> ref_list[2];
+  for (ymuint side = 0; side < 2; ++ side) {
+    vector<DiffItem> rest;
+    for (ymuint i = 0; i < item_list[side].size(); ++ i) {
+      const DiffItem& item = item_list[side][i];
+      GdsRtype type = item.mElem->type();
+      if ( type == kGdsSREF || type == kGdsAREF ) {
+	ref_list[side].push_back(item);
+      }
+      else {
+	rest.push_back(item);
+      }
+    }
+    item_list[side].swap(rest);
+  }
+  pair_list.clear();
+  match_items(ref_list[0], ref_list[1], less_strname, pair_list);
+  for (ymuint i = 0; i < pair_list.size(); ++ i) {
+    ElemDiff ediff;
+    ediff.mType = kGdsDiffPlacement;
+    ediff.mElem1 = pair_list[i].first.mElem;
+    ediff.mElem2 = pair_list[i].second.mElem;
+    diff_list.push_back(ediff);
+  }
+
+  // 残りは削除と追加
+  for (ymuint side = 0; side < 2; ++ side) {
+    item_list[side].insert(item_list[side].end(),
+			   ref_list[side].begin(), ref_list[side].end());
+    std::sort(item_list[side].begin(), item_list[side].end(), less_index);
+    for (ymuint i = 0; i < item_list[side].size(); ++ i) {
+      ElemDiff ediff;
+      ediff.mType = side == 0 ? kGdsDiffRemoved : kGdsDiffAdded;
+      ediff.mElem1 = side == 0 ? item_list[side][i].mElem : NULL;
+      ediff.mElem2 = side == 1 ? item_list[side][i].mElem : NULL;
+      diff_list.push_back(ediff);
+    }
+  }
+}
+
+END_NAMESPACE_YM_GDS
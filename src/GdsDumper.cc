@@ -10,24 +10,72 @@
 #include "YmGds/GdsDumper.h"
 #include "YmGds/GdsRecord.h"
 #include "YmGds/GdsScanner.h"
+#include "YmGds/Msg.h"
 #include "GdsRecTable.h"
+#include "GdsParallel.h"
+#include <cstdio>
+#include <strings.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 BEGIN_NAMESPACE_YM_GDS
 
+// バッファがこの大きさを超えたらストリームに書き出す．
+static
+const ymuint32 kFlushSize = 1 << 20;
+
+// dump_file() で区切るかたまりの大きさの目安
+static
+const ymuint64 kChunkSize = 1 << 18;
+
+// dump_file() で一度に整形するかたまりの数の上限
+static
+const ymuint kMaxChunkNum = 256;
+
+// dump_range() でレコードの先頭とみなすために続けて正しく読める
+// べきレコードの数
+static
+const ymuint kSyncNum = 4;
+
+// 16進数の数字
+static
+const char kHexChar[] = "0123456789abcdef";
+
+// 0 から 99 までの2桁の数字
+static
+const char kDigitPair[] =
+  "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+  "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
 //////////////////////////////////////////////////////////////////////
 // GDS-II ファイルの中身をダンプするためのクラス
 //////////////////////////////////////////////////////////////////////
 
 // コンストラクタ
 GdsDumper::GdsDumper(ostream& os) :
-  mOs(os)
+  mOs(&os),
+  mThreadNum(0),
+  mSelect(false)
+{
+  mBuf.reserve(kFlushSize + 4096);
+}
+
+// @brief ストリームを持たないコンストラクタ
+//
+// 結果は mBuf に溜めたままにする．
+GdsDumper::GdsDumper() :
+  mOs(NULL),
+  mThreadNum(0),
+  mSelect(false)
 {
 }
 
 // デストラクタ
 GdsDumper::~GdsDumper()
 {
+  flush();
 }
 
 // record の内容を出力する．
@@ -49,6 +97,312 @@ GdsDumper::operator()(const GdsScanner& scanner)
 	      scanner.cur_data());
 }
 
+// @brief 出力するレコードの型を選ぶ．
+// @param[in] rtype レコードの型
+//
+// 一度も呼ばなければすべての型を出力する．
+void
+GdsDumper::select_rtype(GdsRtype rtype)
+{
+  if ( !mSelect ) {
+    for (ymuint i = 0; i < 256; ++ i) {
+      mRtypeFlag[i] = false;
+    }
+    mSelect = true;
+  }
+  mRtypeFlag[static_cast<ymuint8>(rtype)] = true;
+}
+
+// @brief dump_file() で用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsDumper::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief ファイルの中身をすべて出力する．
+// @param[in] filename ファイル名
+// @retval true 末尾まで読めた．
+// @retval false ファイルが読めないか形式が正しくなかった．
+//
+// 形式が正しくない場合にはその直前のレコードまで出力する．
+bool
+GdsDumper::dump_file(const string& filename)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if ( fd < 0 ) {
+    error_header(__FILE__, __LINE__, "GdsDumper", 0)
+      << filename << ": Could not open";
+    msg_end();
+    return false;
+  }
+  struct stat st;
+  if ( fstat(fd, &st) < 0 ) {
+    error_header(__FILE__, __LINE__, "GdsDumper", 0)
+      << "error occured in 'fstat()'";
+    msg_end();
+    close(fd);
+    return false;
+  }
+  ymuint64 size = st.st_size;
+  if ( size == 0 ) {
+    close(fd);
+    return true;
+  }
+  void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if ( addr == MAP_FAILED ) {
+    error_header(__FILE__, __LINE__, "GdsDumper", 0)
+      << "error occured in 'mmap()'";
+    msg_end();
+    return false;
+  }
+  madvise(addr, size, MADV_SEQUENTIAL);
+  const ymuint8* data = static_cast<const ymuint8*>(addr);
+
+  bool stat = dump_range(data, size, 0, size);
+
+  munmap(addr, size);
+  return stat;
+}
+
+// @brief メモリ上のレコード列の一部を出力する．
+// @param[in] data 先頭
+// @param[in] size サイズ
+// @param[in] begin 範囲の先頭
+// @param[in] end 範囲の末尾
+// @retval true 範囲の末尾まで読めた．
+// @retval false 形式が正しくなかった．
+//
+// 先頭が begin 以上 end 未満のレコードを出力する．
+// begin がレコードの先頭でない時は，そこから続くいくつかのレコードが
+// 正しく読める最初の位置をレコードの先頭とみなす．
+// オフセットは data からの位置で表す．
+bool
+GdsDumper::dump_range(const ymuint8* data,
+		      ymuint64 size,
+		      ymuint64 begin,
+		      ymuint64 end)
+{
+  if ( end > size ) {
+    end = size;
+  }
+
+  // 整形した結果を溜めすぎないように，スレッド数の数倍ずつのかたまりを
+  // 並列に整形しては書き出す．
+  ymuint batch_num = get_thread_num(mThreadNum, kMaxChunkNum) * 4;
+  if ( batch_num > kMaxChunkNum ) {
+    batch_num = kMaxChunkNum;
+  }
+  flush();
+  vector<Chunk> chunk_list;
+  ymuint64 pos = begin;
+  if ( pos > 0 ) {
+    pos = find_record(data, size, pos);
+  }
+  bool stat = true;
+  bool bad = false;
+  while ( stat && pos < end && !bad ) {
+    // レコードの先頭だけをたどってかたまりに分ける．
+    // 変なサイズのレコードがあればそこまでをかたまりにして，
+    // エラーの処理は GdsScanner に任せる．
+    chunk_list.clear();
+    while ( chunk_list.size() < batch_num && pos < end && !bad ) {
+      ymuint64 chunk_begin = pos;
+      while ( pos < end && pos - chunk_begin < kChunkSize ) {
+	if ( pos + 2 > size ) {
+	  pos = size;
+	  break;
+	}
+	ymuint rsize = (data[pos] << 8) | data[pos + 1];
+	if ( rsize == 0 ) {
+	  // null word をスキップする．
+	  pos += 2;
+	  continue;
+	}
+	if ( rsize < 4 || (rsize & 1) || pos + rsize > size ) {
+	  pos = (pos + rsize > size) ? size : pos + 2;
+	  bad = true;
+	  break;
+	}
+	pos += rsize;
+      }
+      chunk_list.push_back(Chunk());
+      Chunk& chunk = chunk_list.back();
+      chunk.mBegin = chunk_begin;
+      chunk.mSize = pos - chunk_begin;
+    }
+
+    parallel_for(chunk_list.size(), mThreadNum, [&](ymuint i) {
+	dump_chunk(data, chunk_list[i]);
+      });
+
+    for (ymuint i = 0; i < chunk_list.size(); ++ i) {
+      Chunk& chunk = chunk_list[i];
+      if ( mOs != NULL ) {
+	mOs->write(chunk.mText.c_str(), chunk.mText.size());
+      }
+      else {
+	mBuf += chunk.mText;
+      }
+      if ( !chunk.mOk ) {
+	stat = false;
+	break;
+      }
+    }
+  }
+
+  return stat;
+}
+
+// @brief レコードの型の名前から型を求める．
+// @param[in] name 名前 ( "XY" など．大文字と小文字は区別しない )
+// @param[out] rtype 結果の型
+// @retval true 見つかった．
+// @retval false 該当する型がなかった．
+bool
+GdsDumper::find_rtype(const string& name,
+		      GdsRtype& rtype)
+{
+  const GdsRecTable& table = GdsRecTable::obj();
+  for (ymuint i = 0; i <= kGdsLast; ++ i) {
+    GdsRtype rtype1 = static_cast<GdsRtype>(i);
+    const char* str = table.rtype_string(rtype1);
+    if ( str != NULL && strcasecmp(str, name.c_str()) == 0 ) {
+      rtype = rtype1;
+      return true;
+    }
+  }
+  return false;
+}
+
+// @brief バッファに溜まった内容をストリームに書き出す．
+void
+GdsDumper::flush()
+{
+  if ( mOs != NULL && !mBuf.empty() ) {
+    mOs->write(mBuf.c_str(), mBuf.size());
+    mBuf.clear();
+  }
+}
+
+// @brief 一つのかたまりを整形する．
+// @param[in] data ファイルの先頭
+// @param[inout] chunk 対象のかたまり
+void
+GdsDumper::dump_chunk(const ymuint8* data,
+		      Chunk& chunk) const
+{
+  GdsDumper dumper;
+  dumper.mSelect = mSelect;
+  if ( mSelect ) {
+    for (ymuint i = 0; i < 256; ++ i) {
+      dumper.mRtypeFlag[i] = mRtypeFlag[i];
+    }
+  }
+  dumper.mBuf.reserve(static_cast<ymuint64>(chunk.mSize) * 8);
+  GdsScanner scanner;
+  scanner.open_memory(data + chunk.mBegin, chunk.mSize, chunk.mBegin);
+  for ( ; ; ) {
+    if ( !scanner.read_rec() ) {
+      // 末尾まで読めていれば正常終了
+      chunk.mOk = scanner.cur_pos() >= chunk.mSize;
+      break;
+    }
+    dumper.dump_common(chunk.mBegin + scanner.cur_offset(), scanner.cur_size(),
+		       scanner.cur_rtype(), scanner.cur_dtype(),
+		       scanner.cur_data());
+  }
+  chunk.mText.swap(dumper.mBuf);
+}
+
+// @brief pos から始まるレコードのヘッダが正しいか調べる．
+// @param[in] data 先頭
+// @param[in] size サイズ
+// @param[in] pos 位置
+// @return 正しければレコードのサイズを，そうでなければ 0 を返す．
+//
+// GdsScanner::read_rec() と同じ検査を行う．
+ymuint
+GdsDumper::check_header(const ymuint8* data,
+			ymuint64 size,
+			ymuint64 pos)
+{
+  if ( pos + 4 > size ) {
+    return 0;
+  }
+  ymuint rsize = (data[pos] << 8) | data[pos + 1];
+  if ( rsize < 4 || (rsize & 1) || pos + rsize > size ) {
+    return 0;
+  }
+  ymuint rt = data[pos + 2];
+  if ( rt > kGdsLast ) {
+    return 0;
+  }
+  GdsRtype rtype = static_cast<GdsRtype>(rt);
+  GdsDtype dtype = static_cast<GdsDtype>(data[pos + 3]);
+  const GdsRecTable& table = GdsRecTable::obj();
+  if ( table.rtype_string(rtype) == NULL || table.dtype(rtype) != dtype ) {
+    return 0;
+  }
+  int unit_size = 1;
+  switch ( dtype ) {
+  case kGdsNodata:                   break;
+  case kGdsBitArray: unit_size =  2; break;
+  case kGds2Int:     unit_size =  2; break;
+  case kGds4Int:     unit_size =  4; break;
+  case kGds4Real:    unit_size =  4; break;
+  case kGds8Real:    unit_size =  8; break;
+  case kGdsString:   unit_size = -2; break;
+  default: return 0;
+  }
+  int dsize = rsize - 4;
+  int exp_dsize = unit_size * table.data_num(rtype);
+  if ( exp_dsize >= 0 ) {
+    if ( exp_dsize != dsize ) {
+      return 0;
+    }
+  }
+  else if ( dsize % (-exp_dsize) != 0 ) {
+    return 0;
+  }
+  return rsize;
+}
+
+// @brief pos 以降で最初のレコードの先頭を探す．
+// @param[in] data 先頭
+// @param[in] size サイズ
+// @param[in] pos 探し始める位置
+// @return レコードの先頭を返す．見つからない時は size を返す．
+//
+// 正しいファイルではレコードは偶数の位置から始まるので，
+// 偶数の位置について kSyncNum 個のレコードが続けて
+// (あるいは末尾まで)正しく読めるか調べる．
+ymuint64
+GdsDumper::find_record(const ymuint8* data,
+		       ymuint64 size,
+		       ymuint64 pos)
+{
+  for (pos = (pos + 1) & ~1ULL; pos + 4 <= size; pos += 2) {
+    ymuint64 pos1 = pos;
+    ymuint n = 0;
+    for ( ; n < kSyncNum && pos1 < size; ++ n) {
+      ymuint rsize = check_header(data, size, pos1);
+      if ( rsize == 0 ) {
+	break;
+      }
+      pos1 += rsize;
+    }
+    if ( n == kSyncNum || pos1 == size ) {
+      return pos;
+    }
+  }
+  return size;
+}
+
 // @brief record の共通部分の出力
 // @param[in] data データ
 // @param[in] offset オフセット
@@ -57,41 +411,65 @@ GdsDumper::operator()(const GdsScanner& scanner)
 // @param[in] dtype レコードのデータ型
 // @param[in] data データ
 void
-GdsDumper::dump_common(ymuint32 offset,
+GdsDumper::dump_common(ymuint64 offset,
 		       ymuint32 size,
 		       GdsRtype rtype,
 		       GdsDtype dtype,
 		       const ymuint8 data[])
 {
+  if ( mSelect && !mRtypeFlag[static_cast<ymuint8>(rtype)] ) {
+    return;
+  }
+
   // オフセット : サイズ 生データ
-  mOs << endl
-      << hex << setw(7) << offset << dec << ": ";
+  put_char('\n');
+  put_hex(offset, 7);
+  put_str(": ");
   ymuint us = size >> 8;
   ymuint ls = size & 255;
   dump_byte(us);
   dump_byte(ls);
-  mOs << " ";
+  put_char(' ');
   ymuint rt = static_cast<ymuint8>(rtype);
   ymuint dt = static_cast<ymuint8>(dtype);
   dump_byte(rt);
   dump_byte(dt);
-  mOs << " ";
+  put_char(' ');
   ymuint dsize = size - 4;
   for (ymuint i = 0; i < dsize; ++ i) {
     dump_byte(data[i]);
     if ( (i + 4) % 24 == 23 ) {
-      mOs << " " << endl << "         ";
+      put_str(" \n         ");
     }
     else if ( i % 2 == 1 ) {
-      mOs << " ";
+      put_char(' ');
     }
   }
-  mOs << endl;
+  put_char('\n');
 
+  dump_body(rtype, dtype, dsize, data);
+
+  if ( mOs != NULL && mBuf.size() >= kFlushSize ) {
+    flush();
+  }
+}
+
+// @brief record の整形された部分の出力
+// @param[in] rtype レコードの型
+// @param[in] dtype レコードのデータ型
+// @param[in] dsize データサイズ
+// @param[in] data データ
+void
+GdsDumper::dump_body(GdsRtype rtype,
+		     GdsDtype dtype,
+		     ymuint dsize,
+		     const ymuint8 data[])
+{
   const GdsRecTable& table = GdsRecTable::obj();
 
   // 整形された出力
-  mOs << "  " << table.rtype_string(rtype);
+  put_str("  ");
+  put_str(table.rtype_string(rtype));
   switch ( rtype ) {
   case kGdsHEADER:       dump_HEADER(data);          return;
   case kGdsBGNLIB:       dump_BGNLIB(data);          return;
@@ -108,7 +486,7 @@ GdsDumper::dump_common(ymuint32 offset,
     break;
   }
   if ( dtype == kGdsNodata ) {
-    mOs << endl;
+    put_char('\n');
     return;
   }
 
@@ -123,7 +501,7 @@ GdsDumper::dump_common(ymuint32 offset,
     }
   }
 
-  mOs << "Error: no handler for this record type" << endl;
+  put_str("Error: no handler for this record type\n");
 }
 
 // HEADER の出力
@@ -131,7 +509,9 @@ void
 GdsDumper::dump_HEADER(const ymuint8 data[])
 {
   int version = conv_2byte_int(data, 0);
-  mOs << "  Release " << version << endl;
+  put_str("  Release ");
+  put_int(version);
+  put_char('\n');
 }
 
 // BGNLIB の出力
@@ -143,13 +523,11 @@ GdsDumper::dump_BGNLIB(const ymuint8 data[])
     buf[i] = conv_2byte_int(data, i);
   }
 
-  mOs << endl
-      << "    Last modified ";
+  put_str("\n    Last modified ");
   dump_date(buf);
-  mOs << endl
-      << "    Last accessed ";
+  put_str("\n    Last accessed ");
   dump_date(buf + 6);
-  mOs << endl;
+  put_char('\n');
 }
 
 // UNITS の出力
@@ -159,9 +537,11 @@ GdsDumper::dump_UNITS(const ymuint8 data[])
   double uu = conv_8byte_real(data, 0);
   double mu = conv_8byte_real(data, 1);
 
-  mOs << endl << scientific
-      << "    1 database unit = " << uu << " user units" << endl
-      << "    1 database unit = " << mu << " meters" << endl;
+  put_str("\n    1 database unit = ");
+  put_real(uu, true);
+  put_str(" user units\n    1 database unit = ");
+  put_real(mu, true);
+  put_str(" meters\n");
 }
 
 // BGNSTR の出力
@@ -172,13 +552,11 @@ GdsDumper::dump_BGNSTR(const ymuint8 data[])
   for (ymuint i = 0; i < 12; ++ i) {
     buf[i] = conv_2byte_int(data, i);
   }
-  mOs << endl
-      << "    Creation time ";
+  put_str("\n    Creation time ");
   dump_date(buf);
-  mOs << endl
-      << "    Last modified ";
+  put_str("\n    Last modified ");
   dump_date(buf + 6);
-  mOs << endl;
+  put_char('\n');
 }
 
 // XY の出力
@@ -186,13 +564,16 @@ void
 GdsDumper::dump_XY(const ymuint8 data[],
 		   ymuint dsize)
 {
-  mOs << endl;
+  put_char('\n');
   ymuint n = dsize / 8;
   for (ymuint i = 0; i < n; ++ i) {
     int x = conv_4byte_int(data, i * 2 + 0);
     int y = conv_4byte_int(data, i * 2 + 1);
-    mOs << "    (" << x << " , " << y << ")"
-	<< endl;
+    put_str("    (");
+    put_int(x);
+    put_str(" , ");
+    put_int(y);
+    put_str(")\n");
   }
 }
 
@@ -202,8 +583,11 @@ GdsDumper::dump_COLROW(const ymuint8 data[])
 {
   int col = conv_2byte_int(data, 0);
   int row = conv_2byte_int(data, 1);
-  mOs << " " << col << " cols, " << row << " rows"
-      << endl;
+  put_char(' ');
+  put_int(col);
+  put_str(" cols, ");
+  put_int(row);
+  put_str(" rows\n");
 }
 
 // PRESENTATION の出力
@@ -235,8 +619,13 @@ GdsDumper::dump_PRESENTATION(const ymuint8 data[])
   case 2: hj = "right"; break;
   }
 
-  mOs << "  font " << font << "  vert: " << vj << "  horiz: " << hj
-      << endl;
+  put_str("  font ");
+  put_uint(font);
+  put_str("  vert: ");
+  put_str(vj);
+  put_str("  horiz: ");
+  put_str(hj);
+  put_char('\n');
 }
 
 // STRANS の出力
@@ -245,24 +634,24 @@ GdsDumper::dump_STRANS(const ymuint8 data[])
 {
   // reflection
   if ( conv_bitarray(data, 0, 1) ) {
-    mOs << "  reflect";
+    put_str("  reflect");
   }
 
-  mOs << " ";
+  put_char(' ');
 
   // absolute magnification
   if ( conv_bitarray(data, 13, 1) ) {
-    mOs << "absolute magnificaion";
+    put_str("absolute magnificaion");
   }
 
-  mOs << " ";
+  put_char(' ');
 
   // absolute angle
   if ( conv_bitarray(data, 14, 1) ) {
-    mOs << "absolute angle";
+    put_str("absolute angle");
   }
 
-  mOs << endl;
+  put_char('\n');
 }
 
 // ELFLAGS の出力
@@ -271,15 +660,15 @@ GdsDumper::dump_ELFLAGS(const ymuint8 data[])
 {
   // Template data
   if ( conv_bitarray(data, 15, 1) ) {
-    mOs << " template data";
+    put_str(" template data");
   }
 
   // External data
   if ( conv_bitarray(data, 14, 1) ) {
-    mOs << " external data";
+    put_str(" external data");
   }
 
-  mOs << endl;
+  put_char('\n');
 }
 
 // LIBSECUR の出力
@@ -288,14 +677,19 @@ GdsDumper::dump_LIBSECUR(const ymuint8 data[],
 			 ymuint dsize)
 {
   // 実は良く分かっていない．
-  mOs << endl;
+  put_char('\n');
   ymuint n = dsize / 6;
   for (ymuint i = 0; i < n; ++ i) {
     ymuint g = conv_2byte_int(data, i * 3 + 0);
     ymuint u = conv_2byte_int(data, i * 3 + 1);
     ymuint a = conv_2byte_int(data, i * 3 + 2);
-    mOs << "    group: " << g << "  user: " << u << "  access: "
-	<< oct << a << dec << endl;
+    put_str("    group: ");
+    put_uint(g);
+    put_str("  user: ");
+    put_uint(u);
+    put_str("  access: ");
+    put_oct(a);
+    put_char('\n');
   }
 }
 
@@ -312,23 +706,27 @@ GdsDumper::dump_PATHTYPE(const ymuint8 data[])
   case 2: type_str = "extended square ends"; break;
   case 3: type_str = "variable square ends"; break;
   }
-  mOs << " " << type_str << endl;
+  put_char(' ');
+  put_str(type_str);
+  put_char('\n');
 }
 
 // data type が 2 byte integer 一つの場合の出力
 void
 GdsDumper::dump_2int(const ymuint8 data[])
 {
-  mOs << " " << conv_2byte_int(data, 0)
-      << endl;
+  put_char(' ');
+  put_int(conv_2byte_int(data, 0));
+  put_char('\n');
 }
 
 // data type が 4 byte integer 一つの場合の出力
 void
 GdsDumper::dump_4int(const ymuint8 data[])
 {
-  mOs << " " << conv_4byte_int(data, 0)
-      << endl;
+  put_char(' ');
+  put_int(conv_4byte_int(data, 0));
+  put_char('\n');
 }
 
 // data type が 8 byte real 一つの場合の出力
@@ -336,15 +734,9 @@ void
 GdsDumper::dump_8real(const ymuint8 data[],
 		      bool s_form)
 {
-  mOs << " ";
-  if ( s_form ) {
-    mOs << scientific;
-  }
-  else {
-    mOs << fixed;
-  }
-  mOs << conv_8byte_real(data, 0)
-      << endl;
+  put_char(' ');
+  put_real(conv_8byte_real(data, 0), s_form);
+  put_char('\n');
 }
 
 // data type が ASCII String の場合の出力
@@ -352,8 +744,9 @@ void
 GdsDumper::dump_string(const ymuint8 data[],
 		       ymuint n)
 {
-  mOs << " " << conv_string(data, n)
-      << endl;
+  put_char(' ');
+  mBuf += conv_string(data, n);
+  put_char('\n');
 }
 
 // 時刻のデータを出力する．
@@ -361,15 +754,15 @@ void
 GdsDumper::dump_date(ymuint16 buf[])
 {
   dump_2digit(buf[1]);  // month;
-  mOs << "/";
+  put_char('/');
   dump_2digit(buf[2]);  // day;
-  mOs << "/"
-     << buf[0] + 1900   // year
-     << " ";
+  put_char('/');
+  put_int(buf[0] + 1900); // year
+  put_char(' ');
   dump_2digit(buf[3]);  // hour
-  mOs << ":";
+  put_char(':');
   dump_2digit(buf[4]);  // minute
-  mOs << ":";
+  put_char(':');
   dump_2digit(buf[5]);  // second
 }
 
@@ -379,25 +772,118 @@ GdsDumper::dump_2digit(ymuint num)
 {
   ymuint u = num / 10;
   ymuint l = num - u * 10;
-  mOs << u << l;
+  put_uint(u);
+  put_char('0' + l);
 }
 
 // 1バイトのデータを出力する．
 void
 GdsDumper::dump_byte(ymuint8 byte)
 {
-  ymuint hb[2];
-  hb[0] = byte >> 4;
-  hb[1] = byte & 15;
-  for (ymuint i = 0; i < 2; ++ i) {
-    int x = hb[i];
-    if ( x >= 10 ) {
-      mOs << static_cast<char>('a' + x - 10);
-    }
-    else {
-      mOs << static_cast<char>('0' + x);
-    }
+  put_char(kHexChar[byte >> 4]);
+  put_char(kHexChar[byte & 15]);
+}
+
+// @brief 1文字出力する．
+void
+GdsDumper::put_char(char c)
+{
+  mBuf.push_back(c);
+}
+
+// @brief 文字列を出力する．
+void
+GdsDumper::put_str(const char* str)
+{
+  mBuf.append(str);
+}
+
+// @brief 符号なし整数を10進数で出力する．
+void
+GdsDumper::put_uint(ymuint64 val)
+{
+  // 下の桁から2桁ずつ表を引いて作る．
+  char tmp[24];
+  char* p = tmp + sizeof(tmp);
+  while ( val >= 100 ) {
+    ymuint r = val % 100;
+    val /= 100;
+    p -= 2;
+    p[0] = kDigitPair[r * 2 + 0];
+    p[1] = kDigitPair[r * 2 + 1];
+  }
+  if ( val >= 10 ) {
+    p -= 2;
+    p[0] = kDigitPair[val * 2 + 0];
+    p[1] = kDigitPair[val * 2 + 1];
   }
+  else {
+    -- p;
+    *p = '0' + val;
+  }
+  mBuf.append(p, tmp + sizeof(tmp) - p);
+}
+
+// @brief 符号つき整数を10進数で出力する．
+void
+GdsDumper::put_int(ymint64 val)
+{
+  ymuint64 u = val;
+  if ( val < 0 ) {
+    put_char('-');
+    u = 0 - u;
+  }
+  put_uint(u);
+}
+
+// @brief 符号なし整数を16進数で出力する．
+// @param[in] val 値
+// @param[in] width 幅 ( 足りない分は左に空白を詰める )
+void
+GdsDumper::put_hex(ymuint64 val,
+		   ymuint width)
+{
+  char tmp[16];
+  char* p = tmp + sizeof(tmp);
+  do {
+    -- p;
+    *p = kHexChar[val & 15];
+    val >>= 4;
+  } while ( val > 0 );
+  ymuint n = tmp + sizeof(tmp) - p;
+  if ( n < width ) {
+    mBuf.append(width - n, ' ');
+  }
+  mBuf.append(p, n);
+}
+
+// @brief 符号なし整数を8進数で出力する．
+void
+GdsDumper::put_oct(ymuint64 val)
+{
+  char tmp[24];
+  char* p = tmp + sizeof(tmp);
+  do {
+    -- p;
+    *p = '0' + (val & 7);
+    val >>= 3;
+  } while ( val > 0 );
+  mBuf.append(p, tmp + sizeof(tmp) - p);
+}
+
+// @brief 浮動小数点数を出力する．
+// @param[in] val 値
+// @param[in] s_form 科学形式で出力する時 true にするフラグ
+//
+// 精度は ostream の既定値と同じ 6桁とする．
+void
+GdsDumper::put_real(double val,
+		    bool s_form)
+{
+  // 固定小数点形式では 10^308 程度まで桁が並ぶ．
+  char tmp[512];
+  int n = snprintf(tmp, sizeof(tmp), s_form ? "%e" : "%f", val);
+  mBuf.append(tmp, n);
 }
 
 // @brief data を 2バイト整数の配列とみなして pos 番めの要素を返す．
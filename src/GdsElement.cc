@@ -23,7 +23,8 @@ GdsElement::GdsElement(ymuint16 elflags,
 		       ymint32 plex) :
   mElFlags(elflags),
   mPlex(plex),
-  mProperty(NULL)
+  mProperty(NULL),
+  mLink(NULL)
 {
 }
 
@@ -160,6 +161,36 @@ GdsElement::text() const
   return NULL;
 }
 
+// @brief 参照している構造名を返す．
+const char*
+GdsElement::strname() const
+{
+  return NULL;
+}
+
+// @brief 参照している構造を返す．
+//
+// 該当する構造が存在しない場合には NULL を返す．
+const GdsStruct*
+GdsElement::ref_struct() const
+{
+  return NULL;
+}
+
+// @brief column 数を返す．
+int
+GdsElement::column() const
+{
+  return 0;
+}
+
+// @brief row 数を返す．
+int
+GdsElement::row() const
+{
+  return 0;
+}
+
 // @brief property の先頭要素を返す．
 const GdsProperty*
 GdsElement::property() const
@@ -169,7 +200,7 @@ GdsElement::property() const
 
 // @brief 次の要素を返す．
 const GdsElement*
-GdsElement::next()
+GdsElement::next() const
 {
   return mLink;
 }
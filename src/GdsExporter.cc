@@ -0,0 +1,651 @@
+﻿
+/// @file GdsExporter.cc
+/// @brief GdsExporter の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsExporter.h"
+#include "YmGds/GdsScanner.h"
+#include <cstdio>
+#include <cstring>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// 出力用のバッファのサイズ
+static
+const ymuint32 kBufSize = 1 << 20;
+
+// 一度に書き出す文字数の上限
+// バッファの残りがこれより少なくなったら書き出す．
+static
+const ymuint32 kMaxPut = 64;
+
+// Elem::mFlags のビット
+static
+const ymuint32 kHasLayer    = 1U << 0;
+static
+const ymuint32 kHasDatatype = 1U << 1;
+static
+const ymuint32 kHasPathtype = 1U << 2;
+static
+const ymuint32 kHasWidth    = 1U << 3;
+static
+const ymuint32 kHasBgnExtn  = 1U << 4;
+static
+const ymuint32 kHasEndExtn  = 1U << 5;
+static
+const ymuint32 kHasSname    = 1U << 6;
+static
+const ymuint32 kHasStrans   = 1U << 7;
+static
+const ymuint32 kHasMag      = 1U << 8;
+static
+const ymuint32 kHasAngle    = 1U << 9;
+static
+const ymuint32 kHasColRow   = 1U << 10;
+static
+const ymuint32 kHasString   = 1U << 11;
+
+// CSV の項目名
+static
+const char* kCsvHeader =
+  "struct,type,layer,datatype,pathtype,width,bgnextn,endextn,"
+  "sname,reflection,mag,angle,cols,rows,string,properties,xy\n";
+
+// @brief 要素の先頭のレコードの名前を返す．
+//
+// 要素の先頭でなければ NULL を返す．
+static
+const char*
+elem_name(GdsRtype rtype)
+{
+  switch ( rtype ) {
+  case kGdsBOUNDARY: return "boundary";
+  case kGdsPATH:     return "path";
+  case kGdsSREF:     return "sref";
+  case kGdsAREF:     return "aref";
+  case kGdsTEXT:     return "text";
+  case kGdsNODE:     return "node";
+  case kGdsBOX:      return "box";
+  default: break;
+  }
+  return NULL;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsExporter
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+// @param[in] os 出力先のストリーム
+GdsExporter::GdsExporter(ostream& os) :
+  mOs(os),
+  mFormat(kGdsExportJson),
+  mBuf(kBufSize),
+  mBufPos(0),
+  mFirstKey(true),
+  mRecordNum(0),
+  mStructNum(0),
+  mElemNum(0),
+  mByteNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsExporter::~GdsExporter()
+{
+}
+
+// @brief 出力形式を設定する．
+// @param[in] format 出力形式
+//
+// 既定では kGdsExportJson となる．
+void
+GdsExporter::set_format(GdsExportFormat format)
+{
+  mFormat = format;
+}
+
+// @brief レコード列を読んで書き出す．
+// @param[in] scanner 入力
+// @retval true 成功した．
+// @retval false 読み込みか書き出しに失敗した．
+//
+// scanner の末尾 ( ENDLIB の後) まで読む．
+bool
+GdsExporter::write(GdsScanner& scanner)
+{
+  mRecordNum = 0;
+  mStructNum = 0;
+  mElemNum = 0;
+  mByteNum = 0;
+  mBufPos = 0;
+  mStructName.clear();
+
+  if ( mFormat == kGdsExportCsv ) {
+    put_csv_header();
+  }
+
+  bool in_elem = false;
+  bool endlib = false;
+  while ( scanner.read_rec() ) {
+    ++ mRecordNum;
+    GdsRtype rtype = scanner.cur_rtype();
+    if ( !in_elem ) {
+      if ( elem_name(rtype) != NULL ) {
+	mElem.mRtype = rtype;
+	mElem.mFlags = 0U;
+	mElem.mXY.clear();
+	mElem.mPropAttr.clear();
+	mElem.mPropValue.clear();
+	in_elem = true;
+      }
+      else if ( rtype == kGdsSTRNAME ) {
+	mStructName = rec_string(scanner);
+	++ mStructNum;
+      }
+      else if ( rtype == kGdsENDSTR ) {
+	mStructName.clear();
+      }
+      else if ( rtype == kGdsENDLIB ) {
+	endlib = true;
+      }
+      continue;
+    }
+
+    switch ( rtype ) {
+    case kGdsLAYER:
+      mElem.mLayer = scanner.conv_2byte_int(0);
+      mElem.mFlags |= kHasLayer;
+      break;
+
+    case kGdsDATATYPE:
+    case kGdsTEXTTYPE:
+    case kGdsNODETYPE:
+    case kGdsBOXTYPE:
+      mElem.mDatatype = scanner.conv_2byte_int(0);
+      mElem.mFlags |= kHasDatatype;
+      break;
+
+    case kGdsPATHTYPE:
+      mElem.mPathtype = scanner.conv_2byte_int(0);
+      mElem.mFlags |= kHasPathtype;
+      break;
+
+    case kGdsWIDTH:
+      mElem.mWidth = scanner.conv_4byte_int(0);
+      mElem.mFlags |= kHasWidth;
+      break;
+
+    case kGdsBGNEXTN:
+      mElem.mBgnExtn = scanner.conv_4byte_int(0);
+      mElem.mFlags |= kHasBgnExtn;
+      break;
+
+    case kGdsENDEXTN:
+      mElem.mEndExtn = scanner.conv_4byte_int(0);
+      mElem.mFlags |= kHasEndExtn;
+      break;
+
+    case kGdsSNAME:
+      mElem.mSname = rec_string(scanner);
+      mElem.mFlags |= kHasSname;
+      break;
+
+    case kGdsSTRANS:
+      mElem.mStrans = static_cast<ymuint16>(scanner.conv_2byte_int(0));
+      mElem.mFlags |= kHasStrans;
+      break;
+
+    case kGdsMAG:
+      mElem.mMag = scanner.conv_8byte_real(0);
+      mElem.mFlags |= kHasMag;
+      break;
+
+    case kGdsANGLE:
+      mElem.mAngle = scanner.conv_8byte_real(0);
+      mElem.mFlags |= kHasAngle;
+      break;
+
+    case kGdsCOLROW:
+      mElem.mCols = static_cast<ymuint16>(scanner.conv_2byte_int(0));
+      mElem.mRows = static_cast<ymuint16>(scanner.conv_2byte_int(1));
+      mElem.mFlags |= kHasColRow;
+      break;
+
+    case kGdsSTRING:
+      mElem.mString = rec_string(scanner);
+      mElem.mFlags |= kHasString;
+      break;
+
+    case kGdsXY:
+      {
+	ymuint n = scanner.cur_dsize() / 4;
+	mElem.mXY.reserve(mElem.mXY.size() + n);
+	for (ymuint i = 0; i < n; ++ i) {
+	  mElem.mXY.push_back(scanner.conv_4byte_int(i));
+	}
+      }
+      break;
+
+    case kGdsPROPATTR:
+      mElem.mPropAttr.push_back(scanner.conv_2byte_int(0));
+      mElem.mPropValue.push_back(string());
+      break;
+
+    case kGdsPROPVALUE:
+      if ( !mElem.mPropValue.empty() ) {
+	mElem.mPropValue.back() = rec_string(scanner);
+      }
+      break;
+
+    case kGdsENDEL:
+      put_elem();
+      in_elem = false;
+      break;
+
+    default:
+      break;
+    }
+    if ( !mOs ) {
+      return false;
+    }
+  }
+  flush();
+
+  return endlib && !in_elem && mOs;
+}
+
+// @brief 読み込んだレコードの数を返す．
+ymuint64
+GdsExporter::record_num() const
+{
+  return mRecordNum;
+}
+
+// @brief 読み込んだ構造の数を返す．
+ymuint64
+GdsExporter::struct_num() const
+{
+  return mStructNum;
+}
+
+// @brief 書き出した要素の数を返す．
+ymuint64
+GdsExporter::elem_num() const
+{
+  return mElemNum;
+}
+
+// @brief 書き出したバイト数を返す．
+ymuint64
+GdsExporter::byte_num() const
+{
+  return mByteNum;
+}
+
+// @brief 要素を一行書き出す．
+void
+GdsExporter::put_elem()
+{
+  ++ mElemNum;
+  if ( mFormat == kGdsExportCsv ) {
+    put_csv();
+  }
+  else {
+    put_json();
+  }
+}
+
+// @brief JSON の形式で要素を一行書き出す．
+void
+GdsExporter::put_json()
+{
+  const Elem& e = mElem;
+  ymuint32 flags = e.mFlags;
+
+  put_char('{');
+  mFirstKey = true;
+  put_key("struct");
+  put_json_string(mStructName);
+  put_key("type");
+  put_char('"');
+  put_str(elem_name(e.mRtype));
+  put_char('"');
+  if ( flags & kHasLayer ) {
+    put_key("layer");
+    put_int(e.mLayer);
+  }
+  if ( flags & kHasDatatype ) {
+    put_key("datatype");
+    put_int(e.mDatatype);
+  }
+  if ( flags & kHasPathtype ) {
+    put_key("pathtype");
+    put_int(e.mPathtype);
+  }
+  if ( flags & kHasWidth ) {
+    put_key("width");
+    put_int(e.mWidth);
+  }
+  if ( flags & kHasBgnExtn ) {
+    put_key("bgnextn");
+    put_int(e.mBgnExtn);
+  }
+  if ( flags & kHasEndExtn ) {
+    put_key("endextn");
+    put_int(e.mEndExtn);
+  }
+  if ( flags & kHasSname ) {
+    put_key("sname");
+    put_json_string(e.mSname);
+  }
+  if ( flags & kHasStrans ) {
+    put_key("reflection");
+    put_str((e.mStrans & 0x8000) ? "true" : "false");
+  }
+  if ( flags & kHasMag ) {
+    put_key("mag");
+    put_real(e.mMag);
+  }
+  if ( flags & kHasAngle ) {
+    put_key("angle");
+    put_real(e.mAngle);
+  }
+  if ( flags & kHasColRow ) {
+    put_key("cols");
+    put_int(e.mCols);
+    put_key("rows");
+    put_int(e.mRows);
+  }
+  if ( flags & kHasString ) {
+    put_key("string");
+    put_json_string(e.mString);
+  }
+  if ( !e.mPropAttr.empty() ) {
+    put_key("properties");
+    put_char('[');
+    for (ymuint i = 0; i < e.mPropAttr.size(); ++ i) {
+      if ( i > 0 ) {
+	put_char(',');
+      }
+      put_char('[');
+      put_int(e.mPropAttr[i]);
+      put_char(',');
+      put_json_string(e.mPropValue[i]);
+      put_char(']');
+    }
+    put_char(']');
+  }
+  put_key("xy");
+  put_char('[');
+  for (ymuint i = 0; i < e.mXY.size(); ++ i) {
+    if ( i > 0 ) {
+      put_char(',');
+    }
+    put_int(e.mXY[i]);
+  }
+  put_char(']');
+  put_char('}');
+  put_char('\n');
+}
+
+// @brief CSV の形式で要素を一行書き出す．
+void
+GdsExporter::put_csv()
+{
+  const Elem& e = mElem;
+  ymuint32 flags = e.mFlags;
+
+  put_csv_string(mStructName);
+  put_char(',');
+  put_str(elem_name(e.mRtype));
+  put_char(',');
+  if ( flags & kHasLayer ) {
+    put_int(e.mLayer);
+  }
+  put_char(',');
+  if ( flags & kHasDatatype ) {
+    put_int(e.mDatatype);
+  }
+  put_char(',');
+  if ( flags & kHasPathtype ) {
+    put_int(e.mPathtype);
+  }
+  put_char(',');
+  if ( flags & kHasWidth ) {
+    put_int(e.mWidth);
+  }
+  put_char(',');
+  if ( flags & kHasBgnExtn ) {
+    put_int(e.mBgnExtn);
+  }
+  put_char(',');
+  if ( flags & kHasEndExtn ) {
+    put_int(e.mEndExtn);
+  }
+  put_char(',');
+  if ( flags & kHasSname ) {
+    put_csv_string(e.mSname);
+  }
+  put_char(',');
+  if ( flags & kHasStrans ) {
+    put_char((e.mStrans & 0x8000) ? '1' : '0');
+  }
+  put_char(',');
+  if ( flags & kHasMag ) {
+    put_real(e.mMag);
+  }
+  put_char(',');
+  if ( flags & kHasAngle ) {
+    put_real(e.mAngle);
+  }
+  put_char(',');
+  if ( flags & kHasColRow ) {
+    put_int(e.mCols);
+  }
+  put_char(',');
+  if ( flags & kHasColRow ) {
+    put_int(e.mRows);
+  }
+  put_char(',');
+  if ( flags & kHasString ) {
+    put_csv_string(e.mString);
+  }
+  put_char(',');
+  if ( !e.mPropAttr.empty() ) {
+    string props;
+    for (ymuint i = 0; i < e.mPropAttr.size(); ++ i) {
+      if ( i > 0 ) {
+	props += ';';
+      }
+      char buf[16];
+      snprintf(buf, sizeof(buf), "%d=", e.mPropAttr[i]);
+      props += buf;
+      props += e.mPropValue[i];
+    }
+    put_csv_string(props);
+  }
+  put_char(',');
+  for (ymuint i = 0; i < e.mXY.size(); ++ i) {
+    if ( i > 0 ) {
+      put_char(' ');
+    }
+    put_int(e.mXY[i]);
+  }
+  put_char('\n');
+}
+
+// @brief CSV の項目名の行を書き出す．
+void
+GdsExporter::put_csv_header()
+{
+  put_str(kCsvHeader);
+}
+
+// @brief JSON の項目名を書き出す．
+// @param[in] key 項目名
+//
+// 2番め以降の項目の前には ',' を置く．
+void
+GdsExporter::put_key(const char* key)
+{
+  if ( mFirstKey ) {
+    mFirstKey = false;
+  }
+  else {
+    put_char(',');
+  }
+  put_char('"');
+  put_str(key);
+  put_char('"');
+  put_char(':');
+}
+
+// @brief JSON の文字列を書き出す．
+// @param[in] str 文字列
+void
+GdsExporter::put_json_string(const string& str)
+{
+  static const char* hex = "0123456789abcdef";
+
+  put_char('"');
+  for (ymuint i = 0; i < str.size(); ++ i) {
+    ymuint8 c = static_cast<ymuint8>(str[i]);
+    if ( c == '"' || c == '\\' ) {
+      put_char('\\');
+      put_char(c);
+    }
+    else if ( c < 0x20 || c >= 0x7F ) {
+      // 制御文字と ASCII 以外の文字は \u00XX で表す．
+      put_str("\\u00");
+      put_char(hex[c >> 4]);
+      put_char(hex[c & 15]);
+    }
+    else {
+      put_char(c);
+    }
+  }
+  put_char('"');
+}
+
+// @brief CSV の文字列を書き出す．
+// @param[in] str 文字列
+//
+// 必要なら '"' で囲む．
+void
+GdsExporter::put_csv_string(const string& str)
+{
+  if ( str.find_first_of(",\"\n\r") == string::npos ) {
+    for (ymuint i = 0; i < str.size(); ++ i) {
+      put_char(str[i]);
+    }
+    return;
+  }
+  put_char('"');
+  for (ymuint i = 0; i < str.size(); ++ i) {
+    if ( str[i] == '"' ) {
+      put_char('"');
+    }
+    put_char(str[i]);
+  }
+  put_char('"');
+}
+
+// @brief 文字列を書き出す．
+// @param[in] str 文字列
+void
+GdsExporter::put_str(const char* str)
+{
+  for ( ; *str; ++ str) {
+    put_char(*str);
+  }
+}
+
+// @brief 1文字書き出す．
+// @param[in] c 文字
+void
+GdsExporter::put_char(char c)
+{
+  if ( mBufPos == kBufSize ) {
+    flush();
+  }
+  mBuf[mBufPos] = c;
+  ++ mBufPos;
+}
+
+// @brief 整数を書き出す．
+// @param[in] val 値
+void
+GdsExporter::put_int(ymint64 val)
+{
+  if ( mBufPos + kMaxPut > kBufSize ) {
+    flush();
+  }
+  char* p = &mBuf[mBufPos];
+  ymuint64 u = val;
+  if ( val < 0 ) {
+    *p = '-';
+    ++ p;
+    u = 0 - u;
+  }
+  // 下の桁から逆順に作ってから並べ替える．
+  char tmp[24];
+  ymuint n = 0;
+  do {
+    tmp[n] = '0' + (u % 10);
+    ++ n;
+    u /= 10;
+  } while ( u > 0 );
+  while ( n > 0 ) {
+    -- n;
+    *p = tmp[n];
+    ++ p;
+  }
+  mBufPos = p - &mBuf[0];
+}
+
+// @brief 実数を書き出す．
+// @param[in] val 値
+void
+GdsExporter::put_real(double val)
+{
+  if ( mBufPos + kMaxPut > kBufSize ) {
+    flush();
+  }
+  int n = snprintf(&mBuf[mBufPos], kMaxPut, "%.15g", val);
+  mBufPos += n;
+}
+
+// @brief バッファの中身をストリームに書き出す．
+void
+GdsExporter::flush()
+{
+  if ( mBufPos > 0 ) {
+    mOs.write(&mBuf[0], mBufPos);
+    mByteNum += mBufPos;
+    mBufPos = 0;
+  }
+}
+
+// @brief 直前のレコードの文字列を取り出す．
+// @param[in] scanner 入力
+//
+// 末尾の詰め物の '\0' は除く．
+string
+GdsExporter::rec_string(const GdsScanner& scanner)
+{
+  const char* str = reinterpret_cast<const char*>(scanner.cur_data());
+  ymuint len = scanner.cur_dsize();
+  while ( len > 0 && str[len - 1] == '\0' ) {
+    -- len;
+  }
+  return string(str, len);
+}
+
+END_NAMESPACE_YM_GDS
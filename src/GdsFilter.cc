@@ -0,0 +1,352 @@
+﻿
+/// @file GdsFilter.cc
+/// @brief GdsFilter の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsFilter.h"
+#include "YmGds/GdsScanner.h"
+#include "YmGds/GdsWriter.h"
+#include <cstring>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// すべてのデータ型を表すキーの印
+// 実際のデータ型 0xFFFF と区別するために 16 ビットの外に置く．
+static
+const ymuint64 kAnyType = 1ULL << 32;
+
+// @brief 層番号とデータ型からキーを作る．
+static
+inline
+ymuint64
+layer_key(int layer,
+	  int datatype)
+{
+  return (static_cast<ymuint64>(layer & 0xFFFF) << 16) |
+    static_cast<ymuint64>(datatype & 0xFFFF);
+}
+
+// @brief 指定された層番号とデータ型からキーを作る．
+//
+// データ型が負の時はすべてのデータ型を表すキーになる．
+static
+inline
+ymuint64
+rule_key(int layer,
+	 int datatype)
+{
+  if ( datatype < 0 ) {
+    return kAnyType | layer_key(layer, 0);
+  }
+  return layer_key(layer, datatype);
+}
+
+// @brief キーのデータ型をすべてを表すものに置き換える．
+static
+inline
+ymuint64
+any_key(ymuint64 key)
+{
+  return kAnyType | (key & 0xFFFF0000ULL);
+}
+
+// @brief 要素の先頭のレコードの時 true を返す．
+static
+inline
+bool
+is_elem_start(GdsRtype rtype)
+{
+  switch ( rtype ) {
+  case kGdsBOUNDARY:
+  case kGdsPATH:
+  case kGdsSREF:
+  case kGdsAREF:
+  case kGdsTEXT:
+  case kGdsNODE:
+  case kGdsBOX:
+    return true;
+
+  default:
+    break;
+  }
+  return false;
+}
+
+// @brief 要素の型を表すレコードの時 true を返す．
+static
+inline
+bool
+is_type_rec(GdsRtype rtype)
+{
+  return rtype == kGdsDATATYPE || rtype == kGdsTEXTTYPE ||
+    rtype == kGdsBOXTYPE || rtype == kGdsNODETYPE;
+}
+
+// @brief 2バイトの整数をビッグエンディアンで書き込む．
+static
+inline
+void
+put_2int(ymuint8* buf,
+	 ymuint val)
+{
+  buf[0] = (val >> 8) & 0xFF;
+  buf[1] = val & 0xFF;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsFilter
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsFilter::GdsFilter() :
+  mDropElemMask(0ULL),
+  mRecordNum(0),
+  mElemNum(0),
+  mDropNum(0),
+  mMapNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsFilter::~GdsFilter()
+{
+}
+
+// @brief 層の付け替えを追加する．
+// @param[in] layer 元の層番号
+// @param[in] datatype 元のデータ型 ( -1 ですべて )
+// @param[in] new_layer 新しい層番号
+// @param[in] new_datatype 新しいデータ型 ( -1 で元のまま )
+void
+GdsFilter::add_map(int layer,
+		   int datatype,
+		   int new_layer,
+		   int new_datatype)
+{
+  // 付け替え先では kAnyType はデータ型を元のままにすることを表す．
+  mMap[rule_key(layer, datatype)] = rule_key(new_layer, new_datatype);
+}
+
+// @brief 残す層を追加する．
+// @param[in] layer 層番号
+// @param[in] datatype データ型 ( -1 ですべて )
+void
+GdsFilter::add_keep(int layer,
+		    int datatype)
+{
+  mKeep[rule_key(layer, datatype)] = true;
+}
+
+// @brief 削除する層を追加する．
+// @param[in] layer 層番号
+// @param[in] datatype データ型 ( -1 ですべて )
+void
+GdsFilter::add_drop(int layer,
+		    int datatype)
+{
+  mDrop[rule_key(layer, datatype)] = true;
+}
+
+// @brief 削除する要素の種類を追加する．
+// @param[in] rtype 要素の先頭のレコード型
+//
+// kGdsBOUNDARY, kGdsPATH, kGdsSREF, kGdsAREF, kGdsTEXT, kGdsNODE, kGdsBOX
+// のいずれか
+void
+GdsFilter::drop_element(GdsRtype rtype)
+{
+  ASSERT_COND( is_elem_start(rtype) );
+  mDropElemMask |= 1ULL << static_cast<ymuint>(rtype);
+}
+
+// @brief レコード列を写す．
+// @param[in] scanner 入力
+// @param[in] writer 出力
+// @retval true 成功した．
+// @retval false 読み込みか書き出しに失敗した．
+//
+// scanner の末尾 ( ENDLIB の後) まで読む．
+bool
+GdsFilter::filter(GdsScanner& scanner,
+		  GdsWriter& writer)
+{
+  mRecordNum = 0;
+  mElemNum = 0;
+  mDropNum = 0;
+  mMapNum = 0;
+
+  // 要素の外，要素の先頭部分，写す要素，読み捨てる要素
+  enum {
+    kOutside,
+    kHead,
+    kPass,
+    kSkip
+  } state = kOutside;
+
+  bool has_layer = false;
+  bool has_type = false;
+  int layer = 0;
+  int datatype = 0;
+  ymuint layer_pos = 0;
+  ymuint type_pos = 0;
+  bool endlib = false;
+  while ( scanner.read_rec() ) {
+    ++ mRecordNum;
+    GdsRtype rtype = scanner.cur_rtype();
+    bool stat = true;
+    switch ( state ) {
+    case kOutside:
+      if ( is_elem_start(rtype) ) {
+	++ mElemNum;
+	if ( (mDropElemMask >> static_cast<ymuint>(rtype)) & 1 ) {
+	  ++ mDropNum;
+	  state = kSkip;
+	}
+	else if ( rtype == kGdsSREF || rtype == kGdsAREF ) {
+	  // 層を持たないのでそのまま写す．
+	  stat = writer.copy_rec(scanner);
+	  state = kPass;
+	}
+	else {
+	  mElemBuf.clear();
+	  push_rec(scanner);
+	  has_layer = false;
+	  has_type = false;
+	  state = kHead;
+	}
+      }
+      else {
+	if ( rtype == kGdsENDLIB ) {
+	  endlib = true;
+	}
+	stat = writer.copy_rec(scanner);
+      }
+      break;
+
+    case kHead:
+      if ( rtype == kGdsLAYER ) {
+	layer = scanner.conv_2byte_int(0);
+	layer_pos = mElemBuf.size() + 4;
+	has_layer = true;
+      }
+      else if ( is_type_rec(rtype) ) {
+	datatype = scanner.conv_2byte_int(0);
+	type_pos = mElemBuf.size() + 4;
+	has_type = true;
+      }
+      push_rec(scanner);
+      if ( rtype == kGdsENDEL ) {
+	// 層が決まらなかった要素はそのまま写す．
+	stat = writer.write_raw(&mElemBuf[0], mElemBuf.size());
+	state = kOutside;
+      }
+      else if ( has_layer && has_type ) {
+	ymuint64 key = layer_key(layer, datatype);
+	if ( !check_layer(key) ) {
+	  ++ mDropNum;
+	  state = kSkip;
+	  break;
+	}
+	std::map<ymuint64, ymuint64>::const_iterator p = mMap.find(key);
+	if ( p == mMap.end() ) {
+	  p = mMap.find(any_key(key));
+	}
+	if ( p != mMap.end() ) {
+	  ymuint64 new_key = p->second;
+	  put_2int(&mElemBuf[layer_pos], (new_key >> 16) & 0xFFFF);
+	  if ( (new_key & kAnyType) == 0 ) {
+	    put_2int(&mElemBuf[type_pos], new_key & 0xFFFF);
+	  }
+	  ++ mMapNum;
+	}
+	stat = writer.write_raw(&mElemBuf[0], mElemBuf.size());
+	state = kPass;
+      }
+      break;
+
+    case kPass:
+      stat = writer.copy_rec(scanner);
+      if ( rtype == kGdsENDEL ) {
+	state = kOutside;
+      }
+      break;
+
+    case kSkip:
+      if ( rtype == kGdsENDEL ) {
+	state = kOutside;
+      }
+      break;
+    }
+    if ( !stat ) {
+      return false;
+    }
+  }
+
+  return endlib && state == kOutside;
+}
+
+// @brief 読み込んだレコードの数を返す．
+ymuint64
+GdsFilter::record_num() const
+{
+  return mRecordNum;
+}
+
+// @brief 読み込んだ要素の数を返す．
+ymuint64
+GdsFilter::elem_num() const
+{
+  return mElemNum;
+}
+
+// @brief 削除した要素の数を返す．
+ymuint64
+GdsFilter::drop_num() const
+{
+  return mDropNum;
+}
+
+// @brief 層を付け替えた要素の数を返す．
+ymuint64
+GdsFilter::map_num() const
+{
+  return mMapNum;
+}
+
+// @brief 層を残すかどうか調べる．
+// @param[in] key 層番号とデータ型を表すキー
+bool
+GdsFilter::check_layer(ymuint64 key) const
+{
+  if ( mDrop.count(key) > 0 || mDrop.count(any_key(key)) > 0 ) {
+    return false;
+  }
+  if ( !mKeep.empty() ) {
+    return mKeep.count(key) > 0 || mKeep.count(any_key(key)) > 0;
+  }
+  return true;
+}
+
+// @brief 直前のレコードを mElemBuf に追加する．
+void
+GdsFilter::push_rec(const GdsScanner& scanner)
+{
+  ymuint dsize = scanner.cur_dsize();
+  ymuint pos = mElemBuf.size();
+  mElemBuf.resize(pos + dsize + 4);
+  ymuint8* buf = &mElemBuf[pos];
+  put_2int(buf, dsize + 4);
+  buf[2] = static_cast<ymuint8>(scanner.cur_rtype());
+  buf[3] = static_cast<ymuint8>(scanner.cur_dtype());
+  if ( dsize > 0 ) {
+    memcpy(buf + 4, scanner.cur_data(), dsize);
+  }
+}
+
+END_NAMESPACE_YM_GDS
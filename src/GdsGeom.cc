@@ -0,0 +1,264 @@
+﻿
+/// @file GdsGeom.cc
+/// @brief 多角形の幾何計算を行う関数の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsGeom.h"
+#include <cmath>
+
+// x86 では実行時に AVX2 が使えるか調べて切り替える．
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GDS_USE_AVX2 1
+#include <immintrin.h>
+#endif
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+#if GDS_USE_AVX2
+
+// @brief AVX2 が使える時 true を返す．
+static
+bool
+has_avx2()
+{
+  static const bool result = __builtin_cpu_supports("avx2");
+  return result;
+}
+
+// @brief 4つの辺の外積の和を求める．(AVX2版)
+// @param[in] data 座標の配列
+// @param[in] n 処理する辺の数(4の倍数)
+//
+// i 番めの辺の項 x[i] * y[i + 1] - x[i + 1] * y[i] の和を返す．
+// data は n + 1 個の頂点を持たなければならない．
+// 各項を上位と下位の 32 ビットに分けて 64 ビットで累積するので
+// 桁あふれは起こらない．
+__attribute__((target("avx2")))
+static
+tGdsInt128
+cross_sum_avx2(const ymint32* data,
+	       ymuint n)
+{
+  const __m256i mask_lo = _mm256_set1_epi64x(0xFFFFFFFFLL);
+  const __m256i sign_bit = _mm256_set1_epi64x(0x80000000LL);
+  __m256i acc_lo = _mm256_setzero_si256();
+  __m256i acc_hi = _mm256_setzero_si256();
+  for (ymuint i = 0; i < n; i += 4) {
+    // 各 64 ビットレーンの下位に x，上位に y が入る．
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 2));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 2 + 2));
+    __m256i m1 = _mm256_mul_epi32(a, _mm256_srli_epi64(b, 32));
+    __m256i m2 = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), b);
+    __m256i t = _mm256_sub_epi64(m1, m2);
+    // t = hi * 2^32 + lo ( lo は符号なし，hi は符号付き )
+    __m256i lo = _mm256_and_si256(t, mask_lo);
+    __m256i hi = _mm256_srli_epi64(t, 32);
+    hi = _mm256_sub_epi64(_mm256_xor_si256(hi, sign_bit), sign_bit);
+    acc_lo = _mm256_add_epi64(acc_lo, lo);
+    acc_hi = _mm256_add_epi64(acc_hi, hi);
+  }
+  ymint64 lo_buf[4];
+  ymint64 hi_buf[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo_buf), acc_lo);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi_buf), acc_hi);
+  tGdsInt128 sum = 0;
+  for (ymuint i = 0; i < 4; ++ i) {
+    sum += static_cast<tGdsInt128>(hi_buf[i]) * (static_cast<ymint64>(1) << 32);
+    sum += lo_buf[i];
+  }
+  return sum;
+}
+
+// @brief 2つの辺の長さの和を求める．(AVX2版)
+// @param[in] data 座標の配列
+// @param[in] n 処理する辺の数(2の倍数)
+//
+// data は n + 1 個の頂点を持たなければならない．
+__attribute__((target("avx2")))
+static
+double
+length_sum_avx2(const ymint32* data,
+		ymuint n)
+{
+  __m256d acc = _mm256_setzero_pd();
+  for (ymuint i = 0; i < n; i += 2) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2 + 2));
+    __m256d d = _mm256_sub_pd(_mm256_cvtepi32_pd(b), _mm256_cvtepi32_pd(a));
+    __m256d sq = _mm256_mul_pd(d, d);
+    // [ dx0^2 + dy0^2, 同左, dx1^2 + dy1^2, 同左 ]
+    __m256d h = _mm256_hadd_pd(sq, sq);
+    acc = _mm256_add_pd(acc, _mm256_sqrt_pd(h));
+  }
+  double buf[4];
+  _mm256_storeu_pd(buf, acc);
+  return buf[0] + buf[2];
+}
+
+#endif
+
+// @brief 辺の外積の和を求める．
+// @param[in] data 座標の配列
+// @param[in] begin, end 対象の辺の範囲
+//
+// data は end + 1 個の頂点を持たなければならない．
+static
+tGdsInt128
+cross_sum(const ymint32* data,
+	  ymuint begin,
+	  ymuint end)
+{
+  tGdsInt128 sum = 0;
+#if GDS_USE_AVX2
+  if ( end - begin >= 8 && has_avx2() ) {
+    ymuint n = (end - begin) & ~3U;
+    sum += cross_sum_avx2(data + begin * 2, n);
+    begin += n;
+  }
+#endif
+  for (ymuint i = begin; i < end; ++ i) {
+    ymint64 x0 = data[i * 2 + 0];
+    ymint64 y0 = data[i * 2 + 1];
+    ymint64 x1 = data[i * 2 + 2];
+    ymint64 y1 = data[i * 2 + 3];
+    sum += x0 * y1 - x1 * y0;
+  }
+  return sum;
+}
+
+// @brief 辺の長さの和を求める．
+// @param[in] data 座標の配列
+// @param[in] n 辺の数
+//
+// data は n + 1 個の頂点を持たなければならない．
+static
+double
+length_sum(const ymint32* data,
+	   ymuint n)
+{
+  double sum = 0.0;
+  ymuint begin = 0;
+#if GDS_USE_AVX2
+  if ( n >= 4 && has_avx2() ) {
+    begin = n & ~1U;
+    sum += length_sum_avx2(data, begin);
+  }
+#endif
+  for (ymuint i = begin; i < n; ++ i) {
+    ymint64 dx = static_cast<ymint64>(data[i * 2 + 2]) - data[i * 2 + 0];
+    ymint64 dy = static_cast<ymint64>(data[i * 2 + 3]) - data[i * 2 + 1];
+    if ( dx == 0 ) {
+      sum += std::abs(dy);
+    }
+    else if ( dy == 0 ) {
+      sum += std::abs(dx);
+    }
+    else {
+      sum += sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy);
+    }
+  }
+  return sum;
+}
+
+// @brief 多角形の符号付き面積の2倍を求める．
+// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 頂点数
+//
+// 頂点が反時計回りの時に正となる．
+// 始点と終点が一致していてもいなくてもよい．
+// 計算は整数で行うので誤差はない．
+tGdsInt128
+polygon_area2(const ymint32* data,
+	      ymuint n)
+{
+  if ( n >= 2 && data[0] == data[n * 2 - 2] && data[1] == data[n * 2 - 1] ) {
+    // 閉じている場合は終点を除く．
+    -- n;
+  }
+  if ( n < 3 ) {
+    return 0;
+  }
+
+  if ( n == 4 ) {
+    // 座標軸に平行な矩形の場合
+    ymint64 x0 = data[0];
+    ymint64 y0 = data[1];
+    ymint64 x1 = data[2];
+    ymint64 y1 = data[3];
+    ymint64 x2 = data[4];
+    ymint64 y2 = data[5];
+    ymint64 x3 = data[6];
+    ymint64 y3 = data[7];
+    // 辺の長さは 32 ビットを超えうるので積は 128 ビットで求める．
+    if ( y0 == y1 && x1 == x2 && y2 == y3 && x3 == x0 ) {
+      return static_cast<tGdsInt128>(x1 - x0) * static_cast<tGdsInt128>(y2 - y1) * 2;
+    }
+    if ( x0 == x1 && y1 == y2 && x2 == x3 && y3 == y0 ) {
+      return static_cast<tGdsInt128>(y1 - y0) * static_cast<tGdsInt128>(x2 - x1) * -2;
+    }
+  }
+
+  // 最後の辺 ( n - 1 -> 0 ) は別に計算する．
+  tGdsInt128 sum = cross_sum(data, 0, n - 1);
+  ymint64 xl = data[n * 2 - 2];
+  ymint64 yl = data[n * 2 - 1];
+  sum += xl * data[1] - static_cast<ymint64>(data[0]) * yl;
+  return sum;
+}
+
+// @brief 多角形の周囲長を求める．
+// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 頂点数
+//
+// 始点と終点が一致していない場合には閉じた多角形とみなす．
+double
+polygon_perimeter(const ymint32* data,
+		  ymuint n)
+{
+  if ( n < 2 ) {
+    return 0.0;
+  }
+  double len = length_sum(data, n - 1);
+  ymint64 dx = static_cast<ymint64>(data[0]) - data[n * 2 - 2];
+  ymint64 dy = static_cast<ymint64>(data[1]) - data[n * 2 - 1];
+  if ( dx != 0 || dy != 0 ) {
+    len += sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy);
+  }
+  return len;
+}
+
+// @brief 折れ線の長さを求める．
+// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 頂点数
+double
+polyline_length(const ymint32* data,
+		ymuint n)
+{
+  if ( n < 2 ) {
+    return 0.0;
+  }
+  return length_sum(data, n - 1);
+}
+
+// @brief すべての辺が座標軸に平行な時 true を返す．
+// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 頂点数
+bool
+is_manhattan(const ymint32* data,
+	     ymuint n)
+{
+  for (ymuint i = 0; i < n; ++ i) {
+    ymuint j = ( i + 1 < n ) ? i + 1 : 0;
+    if ( data[i * 2] != data[j * 2] && data[i * 2 + 1] != data[j * 2 + 1] ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+END_NAMESPACE_YM_GDS
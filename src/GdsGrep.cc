@@ -0,0 +1,361 @@
+﻿
+/// @file GdsGrep.cc
+/// @brief GdsGrep の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsGrep.h"
+#include "YmGds/GdsScanner.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// かたまりの大きさの目安
+// 構造の境界でしか区切らないので，実際にはこれより大きくなる．
+static
+const ymuint64 kChunkSize = 1 << 20;
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsGrep
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsGrep::GdsGrep() :
+  mThreadNum(0),
+  mIgnoreCase(false),
+  mRecordNum(0)
+{
+  mTargetMask =
+    (1ULL << kGdsSTRING) |
+    (1ULL << kGdsSNAME) |
+    (1ULL << kGdsSTRNAME) |
+    (1ULL << kGdsPROPVALUE);
+}
+
+// @brief デストラクタ
+GdsGrep::~GdsGrep()
+{
+  for (ymuint i = 0; i < mPatternList.size(); ++ i) {
+    regfree(mPatternList[i]);
+    delete mPatternList[i];
+  }
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsGrep::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief 大文字と小文字を区別しないようにする．
+// @param[in] flag true の時区別しない
+//
+// add_pattern() の前に設定しなければならない．
+void
+GdsGrep::set_ignore_case(bool flag)
+{
+  mIgnoreCase = flag;
+}
+
+// @brief 対象のレコードの型を設定する．
+// @param[in] rtype レコードの型 ( STRING/SNAME/STRNAME/PROPVALUE )
+// @param[in] flag true の時対象とする
+//
+// 既定ではすべて対象となる．
+void
+GdsGrep::set_target(GdsRtype rtype,
+		    bool flag)
+{
+  ymuint64 bit = 1ULL << static_cast<ymuint>(rtype);
+  if ( flag ) {
+    mTargetMask |= bit;
+  }
+  else {
+    mTargetMask &= ~bit;
+  }
+}
+
+// @brief パタンを追加する．
+// @param[in] pattern 正規表現
+// @retval true 成功した．
+// @retval false 正規表現が正しくなかった．
+bool
+GdsGrep::add_pattern(const char* pattern)
+{
+  regex_t* re = new regex_t;
+  int flags = REG_EXTENDED | REG_NOSUB;
+  if ( mIgnoreCase ) {
+    flags |= REG_ICASE;
+  }
+  int stat = regcomp(re, pattern, flags);
+  if ( stat != 0 ) {
+    char buf[256];
+    regerror(stat, re, buf, sizeof(buf));
+    error_header(__FILE__, __LINE__, "GdsGrep", 0)
+      << pattern << ": " << buf;
+    msg_end();
+    delete re;
+    return false;
+  }
+  mPatternList.push_back(re);
+  return true;
+}
+
+// @brief ファイルを検索する．
+// @param[in] filename ファイル名
+// @retval true 成功した．
+// @retval false ファイルが読めないか形式が正しくなかった．
+bool
+GdsGrep::scan(const char* filename)
+{
+  mRecordNum = 0;
+  mHitList.clear();
+
+  int fd = open(filename, O_RDONLY);
+  if ( fd < 0 ) {
+    error_header(__FILE__, __LINE__, "GdsGrep", 0)
+      << filename << ": Could not open";
+    msg_end();
+    return false;
+  }
+  struct stat st;
+  if ( fstat(fd, &st) < 0 ) {
+    error_header(__FILE__, __LINE__, "GdsGrep", 0)
+      << "error occured in 'fstat()'";
+    msg_end();
+    close(fd);
+    return false;
+  }
+  ymuint64 size = st.st_size;
+  if ( size == 0 ) {
+    close(fd);
+    return true;
+  }
+  void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if ( addr == MAP_FAILED ) {
+    error_header(__FILE__, __LINE__, "GdsGrep", 0)
+      << "error occured in 'mmap()'";
+    msg_end();
+    return false;
+  }
+  madvise(addr, size, MADV_WILLNEED);
+  const ymuint8* data = static_cast<const ymuint8*>(addr);
+
+  // レコードの先頭だけをたどってかたまりに分ける．
+  vector<Chunk> chunk_list;
+  ymuint64 chunk_begin = 0;
+  ymuint64 pos = 0;
+  bool stat = true;
+  while ( pos + 4 <= size ) {
+    ymuint rsize = (data[pos] << 8) | data[pos + 1];
+    if ( rsize == 0 ) {
+      // null word をスキップする．
+      pos += 2;
+      continue;
+    }
+    if ( rsize < 4 || (rsize & 1) || pos + rsize > size ) {
+      error_header(__FILE__, __LINE__, "GdsGrep", pos)
+	<< "illegal size (" << rsize << ")";
+      msg_end();
+      stat = false;
+      break;
+    }
+    if ( data[pos + 2] == kGdsBGNSTR && pos - chunk_begin >= kChunkSize ) {
+      Chunk chunk;
+      chunk.mBegin = chunk_begin;
+      chunk.mSize = pos - chunk_begin;
+      chunk_list.push_back(chunk);
+      chunk_begin = pos;
+    }
+    pos += rsize;
+    if ( pos - chunk_begin > 0xFFFF0000ULL ) {
+      error_header(__FILE__, __LINE__, "GdsGrep", chunk_begin)
+	<< "too large structure";
+      msg_end();
+      stat = false;
+      break;
+    }
+  }
+  if ( stat && pos > chunk_begin ) {
+    Chunk chunk;
+    chunk.mBegin = chunk_begin;
+    chunk.mSize = pos - chunk_begin;
+    chunk_list.push_back(chunk);
+  }
+
+  // かたまりごとに並列に検索する．
+  if ( stat ) {
+    parallel_for(chunk_list.size(), mThreadNum, [&](ymuint i) {
+	scan_chunk(data, chunk_list[i]);
+      });
+    for (ymuint i = 0; i < chunk_list.size(); ++ i) {
+      Chunk& chunk = chunk_list[i];
+      if ( !chunk.mOk ) {
+	error_header(__FILE__, __LINE__, "GdsGrep", chunk.mBegin)
+	  << "format error in the block starting at offset " << chunk.mBegin;
+	msg_end();
+	stat = false;
+	break;
+      }
+      mRecordNum += chunk.mRecordNum;
+      mHitList.insert(mHitList.end(), chunk.mHitList.begin(), chunk.mHitList.end());
+    }
+  }
+
+  munmap(addr, size);
+  return stat;
+}
+
+// @brief 読み込んだレコードの数を返す．
+ymuint64
+GdsGrep::record_num() const
+{
+  return mRecordNum;
+}
+
+// @brief 一致したレコードの数を返す．
+ymuint
+GdsGrep::hit_num() const
+{
+  return mHitList.size();
+}
+
+// @brief 一致したレコードの先頭のファイル上の位置を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+ymuint64
+GdsGrep::hit_offset(ymuint pos) const
+{
+  ASSERT_COND( pos < hit_num() );
+  return mHitList[pos].mOffset;
+}
+
+// @brief 一致したレコードの型を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+GdsRtype
+GdsGrep::hit_rtype(ymuint pos) const
+{
+  ASSERT_COND( pos < hit_num() );
+  return mHitList[pos].mRtype;
+}
+
+// @brief 一致したレコードを含む構造の名前を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+//
+// 構造の外にある場合には空文字列を返す．
+const string&
+GdsGrep::hit_struct(ymuint pos) const
+{
+  ASSERT_COND( pos < hit_num() );
+  return mHitList[pos].mStruct;
+}
+
+// @brief 一致したレコードの文字列を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+const string&
+GdsGrep::hit_text(ymuint pos) const
+{
+  ASSERT_COND( pos < hit_num() );
+  return mHitList[pos].mText;
+}
+
+// @brief 一致したパタンの番号を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < hit_num() )
+//
+// 複数のパタンに一致した場合には最初のものを返す．
+ymuint
+GdsGrep::hit_pattern(ymuint pos) const
+{
+  ASSERT_COND( pos < hit_num() );
+  return mHitList[pos].mPattern;
+}
+
+// @brief 一つのかたまりを検索する．
+// @param[in] data ファイルの先頭
+// @param[inout] chunk 対象のかたまり
+void
+GdsGrep::scan_chunk(const ymuint8* data,
+		    Chunk& chunk) const
+{
+  chunk.mRecordNum = 0;
+  chunk.mOk = true;
+
+  GdsScanner scanner;
+  scanner.open_memory(data + chunk.mBegin, chunk.mSize, chunk.mBegin);
+  string cur_struct;
+  for ( ; ; ) {
+    if ( !scanner.read_rec() ) {
+      // 末尾まで読めていれば正常終了
+      chunk.mOk = scanner.cur_pos() >= chunk.mSize;
+      break;
+    }
+    ++ chunk.mRecordNum;
+
+    GdsRtype rtype = scanner.cur_rtype();
+    if ( rtype == kGdsENDSTR ) {
+      cur_struct.clear();
+      continue;
+    }
+    bool target = (mTargetMask >> static_cast<ymuint>(rtype)) & 1;
+    if ( !target && rtype != kGdsSTRNAME ) {
+      continue;
+    }
+
+    // 末尾の詰め物の '\0' は除く．
+    const char* str = reinterpret_cast<const char*>(scanner.cur_data());
+    ymuint len = scanner.cur_dsize();
+    while ( len > 0 && str[len - 1] == '\0' ) {
+      -- len;
+    }
+    string text(str, len);
+    if ( rtype == kGdsSTRNAME ) {
+      cur_struct = text;
+    }
+    if ( !target ) {
+      continue;
+    }
+    ymuint pat = match(text.c_str());
+    if ( pat < mPatternList.size() ) {
+      chunk.mHitList.push_back(Hit());
+      Hit& hit = chunk.mHitList.back();
+      // cur_offset() はサイズの直後を指している．
+      hit.mOffset = chunk.mBegin + scanner.cur_offset() - 2;
+      hit.mRtype = rtype;
+      hit.mPattern = pat;
+      hit.mStruct = cur_struct;
+      hit.mText = text;
+    }
+  }
+}
+
+// @brief 文字列がどのパタンに一致するか調べる．
+// @param[in] str 文字列
+// @return 一致したパタンの番号を返す．
+//
+// どれにも一致しなければ pattern の数を返す．
+ymuint
+GdsGrep::match(const char* str) const
+{
+  ymuint n = mPatternList.size();
+  for (ymuint i = 0; i < n; ++ i) {
+    if ( regexec(mPatternList[i], str, 0, NULL, 0) == 0 ) {
+      return i;
+    }
+  }
+  return n;
+}
+
+END_NAMESPACE_YM_GDS
@@ -0,0 +1,269 @@
+﻿
+/// @file GdsHier.cc
+/// @brief GdsHier の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsHier.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/Msg.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsHier
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+// @param[in] data 対象のデータ
+//
+// data はこのオブジェクトより長く存在しなければならない．
+GdsHier::GdsHier(const GdsData& data) :
+  mData(data)
+{
+  ymuint n = data.struct_num();
+  mEdgeArray.resize(n);
+  vector<bool> referenced(n, false);
+  // 同じ子供への枝をまとめるための作業領域
+  vector<ymint> edge_pos(n, -1);
+  for (ymuint id = 0; id < n; ++ id) {
+    const GdsStruct* str = data.structure(id);
+    vector<Edge>& edge_list = mEdgeArray[id];
+    for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+      const GdsStruct* child = elem->ref_struct();
+      if ( child == NULL ) {
+	continue;
+      }
+      ymuint cid = child->id();
+      referenced[cid] = true;
+      ymuint64 mult = static_cast<ymuint64>(elem->column()) * elem->row();
+      if ( edge_pos[cid] < 0 ) {
+	edge_pos[cid] = edge_list.size();
+	Edge edge;
+	edge.mChild = cid;
+	edge.mCount = mult;
+	edge_list.push_back(edge);
+      }
+      else {
+	edge_list[edge_pos[cid]].mCount += mult;
+      }
+    }
+    for (ymuint i = 0; i < edge_list.size(); ++ i) {
+      edge_pos[edge_list[i].mChild] = -1;
+    }
+  }
+  for (ymuint id = 0; id < n; ++ id) {
+    if ( !referenced[id] ) {
+      mTopList.push_back(data.structure(id));
+    }
+  }
+}
+
+// @brief デストラクタ
+GdsHier::~GdsHier()
+{
+}
+
+// @brief 対象のデータを返す．
+const GdsData&
+GdsHier::data() const
+{
+  return mData;
+}
+
+// @brief どこからも参照されていない構造の数を返す．
+ymuint
+GdsHier::top_num() const
+{
+  return mTopList.size();
+}
+
+// @brief どこからも参照されていない構造を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < top_num() )
+const GdsStruct*
+GdsHier::top(ymuint pos) const
+{
+  ASSERT_COND( pos < top_num() );
+  return mTopList[pos];
+}
+
+// @brief 子供の構造の参照数を返す．
+// @param[in] id 親の構造のID番号
+//
+// 同じ構造への複数の参照は一つにまとめられている．
+ymuint
+GdsHier::child_num(ymuint id) const
+{
+  ASSERT_COND( id < mEdgeArray.size() );
+  return mEdgeArray[id].size();
+}
+
+// @brief 子供の構造を返す．
+// @param[in] id 親の構造のID番号
+// @param[in] pos 位置番号 ( 0 <= pos < child_num(id) )
+const GdsStruct*
+GdsHier::child(ymuint id,
+	       ymuint pos) const
+{
+  ASSERT_COND( pos < child_num(id) );
+  return mData.structure(mEdgeArray[id][pos].mChild);
+}
+
+// @brief 子供の構造の配置数を返す．
+// @param[in] id 親の構造のID番号
+// @param[in] pos 位置番号 ( 0 <= pos < child_num(id) )
+//
+// 親の構造の中に直接置かれている数を返す．
+ymuint64
+GdsHier::child_count(ymuint id,
+		     ymuint pos) const
+{
+  ASSERT_COND( pos < child_num(id) );
+  return mEdgeArray[id][pos].mCount;
+}
+
+// @brief 配置数を求める．
+// @param[in] top 最上位の構造
+// @retval true 成功した．
+// @retval false 階層が循環していた．
+//
+// top が NULL の時は top() で得られる構造をすべて最上位とみなす．
+bool
+GdsHier::calc_count(const GdsStruct* top)
+{
+  ymuint n = mEdgeArray.size();
+
+  vector<ymuint32> top_list;
+  if ( top != NULL ) {
+    top_list.push_back(top->id());
+  }
+  else {
+    for (ymuint i = 0; i < mTopList.size(); ++ i) {
+      top_list.push_back(mTopList[i]->id());
+    }
+  }
+
+  // 最上位から到達可能な構造について入次数を数える．
+  vector<ymuint32> indeg(n, 0);
+  vector<bool> reachable(n, false);
+  vector<ymuint32> queue;
+  queue.reserve(n);
+  for (ymuint i = 0; i < top_list.size(); ++ i) {
+    ymuint id = top_list[i];
+    reachable[id] = true;
+    queue.push_back(id);
+  }
+  for (ymuint rpos = 0; rpos < queue.size(); ++ rpos) {
+    const vector<Edge>& edge_list = mEdgeArray[queue[rpos]];
+    for (ymuint i = 0; i < edge_list.size(); ++ i) {
+      ymuint cid = edge_list[i].mChild;
+      ++ indeg[cid];
+      if ( !reachable[cid] ) {
+	reachable[cid] = true;
+	queue.push_back(cid);
+      }
+    }
+  }
+
+  mOrphanList.clear();
+  for (ymuint id = 0; id < n; ++ id) {
+    if ( !reachable[id] ) {
+      mOrphanList.push_back(mData.structure(id));
+    }
+  }
+
+  // トポロジカル順に配置数を伝搬させる．
+  mCountArray.clear();
+  mCountArray.resize(n, 0);
+  mOrderList.clear();
+  mOrderList.reserve(queue.size());
+  for (ymuint i = 0; i < top_list.size(); ++ i) {
+    ymuint id = top_list[i];
+    if ( indeg[id] == 0 ) {
+      mCountArray[id] = 1;
+      mOrderList.push_back(id);
+    }
+  }
+  for (ymuint rpos = 0; rpos < mOrderList.size(); ++ rpos) {
+    ymuint id = mOrderList[rpos];
+    ymuint64 count = mCountArray[id];
+    const vector<Edge>& edge_list = mEdgeArray[id];
+    for (ymuint i = 0; i < edge_list.size(); ++ i) {
+      const Edge& edge = edge_list[i];
+      ymuint cid = edge.mChild;
+      mCountArray[cid] += count * edge.mCount;
+      -- indeg[cid];
+      if ( indeg[cid] == 0 ) {
+	mOrderList.push_back(cid);
+      }
+    }
+  }
+
+  // top が NULL の時は参照されていない構造から始めているので，
+  // 階層が循環していなければすべての構造に到達できる．
+  // 到達できない構造は参照されていない構造の下にない循環の中にある．
+  if ( mOrderList.size() < queue.size() ||
+       ( top == NULL && queue.size() < n ) ) {
+    error_header(__FILE__, __LINE__, "GdsHier", 0)
+      << "recursive hierarchy detected";
+    msg_end();
+    return false;
+  }
+
+  return true;
+}
+
+// @brief 配置数を返す．
+// @param[in] id 構造のID番号
+//
+// calc_count() で指定した最上位の構造の下で何回使われているかを返す．
+// 最上位の構造自身は 1 となる．
+// 最上位から到達できない構造は 0 となる．
+ymuint64
+GdsHier::count(ymuint id) const
+{
+  ASSERT_COND( id < mCountArray.size() );
+  return mCountArray[id];
+}
+
+// @brief 最上位から到達可能な構造の数を返す．
+ymuint
+GdsHier::order_num() const
+{
+  return mOrderList.size();
+}
+
+// @brief 最上位から到達可能な構造をトポロジカル順に返す．
+// @param[in] pos 位置番号 ( 0 <= pos < order_num() )
+//
+// 親は必ず子供よりも前に現れる．
+const GdsStruct*
+GdsHier::order(ymuint pos) const
+{
+  ASSERT_COND( pos < order_num() );
+  return mData.structure(mOrderList[pos]);
+}
+
+// @brief 最上位から到達できない構造の数を返す．
+ymuint
+GdsHier::orphan_num() const
+{
+  return mOrphanList.size();
+}
+
+// @brief 最上位から到達できない構造を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < orphan_num() )
+const GdsStruct*
+GdsHier::orphan(ymuint pos) const
+{
+  ASSERT_COND( pos < orphan_num() );
+  return mOrphanList[pos];
+}
+
+END_NAMESPACE_YM_GDS
@@ -0,0 +1,723 @@
+﻿
+/// @file GdsMerge.cc
+/// @brief GdsMerge の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsMerge.h"
+#include "YmGds/GdsStructIndex.h"
+#include "YmGds/GdsScanner.h"
+#include "YmGds/GdsWriter.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <algorithm>
+#include <cmath>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief 64 ビットの値をかき混ぜる．
+//
+// GdsStructHash と同じ方法を用いる．
+static
+inline
+ymuint64
+hash_fmix(ymuint64 k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+// @brief ハッシュ値に値を一つ加える．
+static
+inline
+GdsHashValue
+hash_add(const GdsHashValue& h,
+	 ymuint64 v)
+{
+  ymuint64 hi = h.hi();
+  ymuint64 lo = h.lo();
+  ymuint64 lo1 = hash_fmix(lo ^ (v + 0x9e3779b97f4a7c15ULL + (lo << 6) + (lo >> 2)));
+  ymuint64 hi1 = hash_fmix(hi ^ (v * 0xc2b2ae3d27d4eb4fULL + lo1 + (hi << 7) + (hi >> 3)));
+  return GdsHashValue(hi1, lo1);
+}
+
+// @brief バイト列のハッシュ値を加える．
+static
+GdsHashValue
+hash_add_bytes(const GdsHashValue& h,
+	       const ymuint8* data,
+	       ymuint64 len)
+{
+  GdsHashValue h1 = hash_add(h, len);
+  // 8 バイトずつまとめて加える．
+  for (ymuint64 i = 0; i < len; i += 8) {
+    ymuint64 v = 0;
+    for (ymuint64 j = i; j < i + 8 && j < len; ++ j) {
+      v = (v << 8) | data[j];
+    }
+    h1 = hash_add(h1, v);
+  }
+  return h1;
+}
+
+// @brief 座標を表すレコードの時 true を返す．
+static
+inline
+bool
+is_coord_rec(GdsRtype rtype)
+{
+  return rtype == kGdsXY || rtype == kGdsWIDTH ||
+    rtype == kGdsBGNEXTN || rtype == kGdsENDEXTN;
+}
+
+// @brief 座標を拡大する．
+// @param[in] v 元の値
+// @param[in] scale 倍率
+// @param[out] ok 範囲を超えたら false にする．
+static
+inline
+ymint32
+scale_coord(ymint32 v,
+	    double scale,
+	    bool& ok)
+{
+  if ( scale == 1.0 ) {
+    return v;
+  }
+  double d = static_cast<double>(v) * scale;
+  if ( d > 2147483647.0 || d < -2147483648.0 ) {
+    ok = false;
+    return v;
+  }
+  return static_cast<ymint32>(llround(d));
+}
+
+// @brief 末尾の詰め物を除いた文字列を得る．
+static
+string
+rec_string(const GdsScanner& scanner)
+{
+  const char* str = reinterpret_cast<const char*>(scanner.cur_data());
+  ymuint len = scanner.cur_dsize();
+  while ( len > 0 && str[len - 1] == '\0' ) {
+    -- len;
+  }
+  return string(str, len);
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsMerge
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsMerge::GdsMerge() :
+  mThreadNum(0),
+  mUserUnit(0.0),
+  mMeterUnit(0.0),
+  mStructNum(0),
+  mCopyNum(0),
+  mDedupNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsMerge::~GdsMerge()
+{
+  for (ymuint i = 0; i < mLibList.size(); ++ i) {
+    delete mLibList[i]->mIndex;
+    delete mLibList[i];
+  }
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsMerge::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief 出力するライブラリ名を設定する．
+// @param[in] name ライブラリ名
+//
+// 設定しない時は最初のファイルのものを用いる．
+void
+GdsMerge::set_libname(const char* name)
+{
+  mLibName = name;
+}
+
+// @brief ファイルを追加する．
+// @param[in] filename ファイル名
+// @retval true 成功した．
+// @retval false ファイルが読めないか形式が正しくなかった．
+//
+// 保存された索引 ( <filename>.sidx ) があれば用いる．
+bool
+GdsMerge::add_file(const char* filename)
+{
+  GdsStructIndex* index = new GdsStructIndex;
+  index->set_thread_num(mThreadNum);
+  string idx_name = string(filename) + ".sidx";
+  if ( !index->open(filename) ||
+       (!index->read_index(idx_name.c_str()) && !index->build()) ) {
+    delete index;
+    return false;
+  }
+
+  // ヘッダ部分から UNITS を探す．
+  double user_unit = 0.0;
+  double meter_unit = 0.0;
+  GdsScanner scanner;
+  scanner.open_memory(index->data(), index->header_size());
+  while ( scanner.read_rec() ) {
+    if ( scanner.cur_rtype() == kGdsUNITS && scanner.cur_dsize() == 16 ) {
+      user_unit = scanner.conv_8byte_real(0);
+      meter_unit = scanner.conv_8byte_real(1);
+      break;
+    }
+  }
+  if ( meter_unit <= 0.0 ) {
+    error_header(__FILE__, __LINE__, "GdsMerge", 0)
+      << filename << ": UNITS not found";
+    msg_end();
+    delete index;
+    return false;
+  }
+
+  Lib* lib = new Lib;
+  lib->mFileName = filename;
+  lib->mIndex = index;
+  lib->mUserUnit = user_unit;
+  lib->mMeterUnit = meter_unit;
+  lib->mScale = 1.0;
+  ymuint n = index->struct_num();
+  lib->mCellArray.resize(n);
+  for (ymuint id = 0; id < n; ++ id) {
+    Cell& cell = lib->mCellArray[id];
+    cell.mHashDone = false;
+    cell.mState = kUndecided;
+    cell.mEmit = false;
+    cell.mOk = true;
+    mUsedName[index->struct_name(id)] = true;
+  }
+  mLibList.push_back(lib);
+  return true;
+}
+
+// @brief まとめたライブラリを書き出す．
+// @param[in] writer 出力先
+// @retval true 成功した．
+// @retval false 失敗した．
+//
+// HEADER から ENDLIB までを書き出す．
+bool
+GdsMerge::write(GdsWriter& writer)
+{
+  if ( mLibList.empty() ) {
+    error_header(__FILE__, __LINE__, "GdsMerge", 0)
+      << "no input files";
+    msg_end();
+    return false;
+  }
+
+  // もっとも細かい単位に合わせる．
+  // ユーザー単位の大きさは最初のファイルのものを保つ．
+  mMeterUnit = mLibList[0]->mMeterUnit;
+  for (ymuint i = 1; i < mLibList.size(); ++ i) {
+    mMeterUnit = std::min(mMeterUnit, mLibList[i]->mMeterUnit);
+  }
+  mUserUnit = mLibList[0]->mUserUnit * (mMeterUnit / mLibList[0]->mMeterUnit);
+  for (ymuint i = 0; i < mLibList.size(); ++ i) {
+    Lib& lib = *mLibList[i];
+    lib.mScale = lib.mMeterUnit / mMeterUnit;
+    if ( fabs(lib.mScale - 1.0) < 1e-9 ) {
+      lib.mScale = 1.0;
+    }
+    else if ( fabs(lib.mScale - floor(lib.mScale + 0.5)) > 1e-6 ) {
+      warning_header(__FILE__, __LINE__, "GdsMerge", 0)
+	<< lib.mFileName << ": coordinates are scaled by "
+	<< lib.mScale << " and rounded";
+      msg_end();
+    }
+  }
+
+  // 構造の内容を並列に読んでハッシュ値を求める．
+  for (ymuint i = 0; i < mLibList.size(); ++ i) {
+    Lib& lib = *mLibList[i];
+    ymuint n = lib.mCellArray.size();
+    for (ymuint id = 0; id < n; ++ id) {
+      Cell& cell = lib.mCellArray[id];
+      cell.mRefList.clear();
+      cell.mHashDone = false;
+      cell.mState = kUndecided;
+      cell.mEmit = false;
+    }
+    parallel_for(n, mThreadNum, [&](ymuint id) {
+	scan_cell(lib, id);
+      });
+    for (ymuint id = 0; id < n; ++ id) {
+      if ( !lib.mCellArray[id].mOk ) {
+	error_header(__FILE__, __LINE__, "GdsMerge", lib.mIndex->struct_offset(id))
+	  << lib.mFileName << ": " << lib.mIndex->struct_name(id)
+	  << ": format error or coordinate overflow";
+	msg_end();
+	return false;
+      }
+    }
+    for (ymuint id = 0; id < n; ++ id) {
+      calc_hash(lib, id);
+    }
+  }
+
+  // ファイルごとに最上位の構造から扱いを決める．
+  mStructNum = 0;
+  mCopyNum = 0;
+  mDedupNum = 0;
+  mRenameList.clear();
+  mOutName.clear();
+  mOutMap.clear();
+  for (ymuint i = 0; i < mLibList.size(); ++ i) {
+    Lib& lib = *mLibList[i];
+    const GdsStructIndex& index = *lib.mIndex;
+    ymuint n = lib.mCellArray.size();
+    vector<bool> has_parent(n, false);
+    std::map<string, bool> missing_map;
+    for (ymuint id = 0; id < n; ++ id) {
+      const vector<string>& ref_list = lib.mCellArray[id].mRefList;
+      for (ymuint j = 0; j < ref_list.size(); ++ j) {
+	ymuint cid = index.find(ref_list[j]);
+	if ( cid < n ) {
+	  if ( cid != id ) {
+	    has_parent[cid] = true;
+	  }
+	}
+	else if ( missing_map.count(ref_list[j]) == 0 ) {
+	  missing_map[ref_list[j]] = true;
+	  warning_header(__FILE__, __LINE__, "GdsMerge", 0)
+	    << lib.mFileName << ": " << ref_list[j]
+	    << ": referenced from " << index.struct_name(id)
+	    << " but not defined";
+	  msg_end();
+	}
+      }
+    }
+    for (ymuint id = 0; id < n; ++ id) {
+      if ( !has_parent[id] ) {
+	decide(i, id);
+      }
+    }
+
+    // 参照の循環の中にしかない構造は最上位から到達できないが，
+    // 黙って捨てずに出力する．
+    // まとめた構造の下にある構造も未決定のまま残るので，
+    // 最上位から到達できるかどうかは別に調べる．
+    vector<bool> reached(n, false);
+    vector<ymuint> queue;
+    for (ymuint id = 0; id < n; ++ id) {
+      if ( !has_parent[id] ) {
+	reached[id] = true;
+	queue.push_back(id);
+      }
+    }
+    for (ymuint rpos = 0; rpos < queue.size(); ++ rpos) {
+      const vector<string>& ref_list = lib.mCellArray[queue[rpos]].mRefList;
+      for (ymuint j = 0; j < ref_list.size(); ++ j) {
+	ymuint cid = index.find(ref_list[j]);
+	if ( cid < n && !reached[cid] ) {
+	  reached[cid] = true;
+	  queue.push_back(cid);
+	}
+      }
+    }
+    for (ymuint id = 0; id < n; ++ id) {
+      if ( !reached[id] && lib.mCellArray[id].mState == kUndecided ) {
+	warning_header(__FILE__, __LINE__, "GdsMerge", index.struct_offset(id))
+	  << lib.mFileName << ": " << index.struct_name(id)
+	  << ": reachable only through a reference cycle";
+	msg_end();
+	decide(i, id);
+      }
+    }
+  }
+
+  if ( !write_header(writer) ) {
+    return false;
+  }
+  for (ymuint i = 0; i < mLibList.size(); ++ i) {
+    const Lib& lib = *mLibList[i];
+    for (ymuint id = 0; id < lib.mCellArray.size(); ++ id) {
+      if ( !lib.mCellArray[id].mEmit ) {
+	continue;
+      }
+      bool stat;
+      if ( need_rewrite(lib, id) ) {
+	stat = rewrite_cell(lib, id, writer);
+      }
+      else {
+	stat = lib.mIndex->copy_struct(id, writer);
+	++ mCopyNum;
+      }
+      if ( !stat ) {
+	return false;
+      }
+      ++ mStructNum;
+    }
+  }
+  return writer.write_nodata(kGdsENDLIB);
+}
+
+// @brief 出力の UNITS のユーザー単位を返す．
+double
+GdsMerge::user_unit() const
+{
+  return mUserUnit;
+}
+
+// @brief 出力の UNITS のメートル単位を返す．
+double
+GdsMerge::meter_unit() const
+{
+  return mMeterUnit;
+}
+
+// @brief ファイルの数を返す．
+ymuint
+GdsMerge::file_num() const
+{
+  return mLibList.size();
+}
+
+// @brief ファイルの座標の倍率を返す．
+// @param[in] pos ファイル番号 ( 0 <= pos < file_num() )
+double
+GdsMerge::scale(ymuint pos) const
+{
+  ASSERT_COND( pos < file_num() );
+  return mLibList[pos]->mScale;
+}
+
+// @brief 書き出した構造の数を返す．
+ymuint
+GdsMerge::struct_num() const
+{
+  return mStructNum;
+}
+
+// @brief バイト列をそのまま書き出した構造の数を返す．
+ymuint
+GdsMerge::copy_num() const
+{
+  return mCopyNum;
+}
+
+// @brief 一つにまとめた構造の数を返す．
+ymuint
+GdsMerge::dedup_num() const
+{
+  return mDedupNum;
+}
+
+// @brief 名前を変えた構造の数を返す．
+ymuint
+GdsMerge::rename_num() const
+{
+  return mRenameList.size();
+}
+
+// @brief 名前を変えた構造のファイル番号を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < rename_num() )
+ymuint
+GdsMerge::rename_file(ymuint pos) const
+{
+  ASSERT_COND( pos < rename_num() );
+  return mRenameList[pos].mFile;
+}
+
+// @brief 名前を変えた構造の元の名前を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < rename_num() )
+const string&
+GdsMerge::rename_from(ymuint pos) const
+{
+  ASSERT_COND( pos < rename_num() );
+  return mRenameList[pos].mFrom;
+}
+
+// @brief 名前を変えた構造の新しい名前を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < rename_num() )
+const string&
+GdsMerge::rename_to(ymuint pos) const
+{
+  ASSERT_COND( pos < rename_num() );
+  return mRenameList[pos].mTo;
+}
+
+// @brief 構造の内容を読んで mRefList と mLocalHash を求める．
+// @param[in] lib ファイル
+// @param[in] id 構造番号
+//
+// ハッシュ値は拡大後の座標で求めるので単位の異なるファイルの間でも比べられる．
+// BGNSTR(日付) と STRNAME は含めず，SNAME の位置には印だけを加える．
+void
+GdsMerge::scan_cell(Lib& lib,
+		    ymuint id)
+{
+  Cell& cell = lib.mCellArray[id];
+  const GdsStructIndex& index = *lib.mIndex;
+  ymuint64 size = index.struct_size(id);
+  if ( size > 0xFFFF0000ULL ) {
+    cell.mOk = false;
+    return;
+  }
+
+  GdsScanner scanner;
+  scanner.open_memory(index.data() + index.struct_offset(id), size,
+		      index.struct_offset(id));
+  GdsHashValue h;
+  bool ok = true;
+  while ( scanner.read_rec() ) {
+    GdsRtype rtype = scanner.cur_rtype();
+    if ( rtype == kGdsBGNSTR || rtype == kGdsSTRNAME ) {
+      continue;
+    }
+    h = hash_add(h, static_cast<ymuint64>(rtype));
+    if ( rtype == kGdsSNAME ) {
+      cell.mRefList.push_back(rec_string(scanner));
+    }
+    else if ( is_coord_rec(rtype) ) {
+      ymuint n = scanner.cur_dsize() / 4;
+      for (ymuint i = 0; i < n; ++ i) {
+	ymint32 v = scale_coord(scanner.conv_4byte_int(i), lib.mScale, ok);
+	h = hash_add(h, static_cast<ymuint32>(v));
+      }
+    }
+    else {
+      h = hash_add(h, static_cast<ymuint64>(scanner.cur_dtype()));
+      h = hash_add_bytes(h, scanner.cur_data(), scanner.cur_dsize());
+    }
+  }
+  cell.mLocalHash = h;
+  cell.mOk = ok && scanner.cur_pos() >= size;
+}
+
+// @brief 子孫の内容も含めたハッシュ値を求める．
+// @param[in] lib ファイル
+// @param[in] id 構造番号
+const GdsHashValue&
+GdsMerge::calc_hash(Lib& lib,
+		    ymuint id)
+{
+  Cell& cell = lib.mCellArray[id];
+  if ( cell.mHashDone ) {
+    return cell.mHash;
+  }
+  // 循環参照に備えて先に印をつけておく．
+  cell.mHashDone = true;
+  cell.mHash = cell.mLocalHash;
+
+  GdsHashValue h = cell.mLocalHash;
+  ymuint n = lib.mCellArray.size();
+  for (ymuint i = 0; i < cell.mRefList.size(); ++ i) {
+    const string& name = cell.mRefList[i];
+    ymuint cid = lib.mIndex->find(name);
+    if ( cid < n ) {
+      const GdsHashValue& ch = calc_hash(lib, cid);
+      h = hash_add(hash_add(h, ch.hi()), ch.lo());
+    }
+    else {
+      // 定義されていない構造は名前を用いる．
+      h = hash_add_bytes(h, reinterpret_cast<const ymuint8*>(name.c_str()), name.size());
+    }
+  }
+  cell.mHash = h;
+  return cell.mHash;
+}
+
+// @brief 構造の扱いを決める．
+// @param[in] lib_id ファイル番号
+// @param[in] id 構造番号
+//
+// 出力する構造の子供も再帰的に決める．
+void
+GdsMerge::decide(ymuint lib_id,
+		 ymuint id)
+{
+  Lib& lib = *mLibList[lib_id];
+  Cell& cell = lib.mCellArray[id];
+  if ( cell.mState != kUndecided ) {
+    return;
+  }
+
+  const string& name = lib.mIndex->struct_name(id);
+  std::pair<string, GdsHashValue> key(name, cell.mHash);
+  std::map<std::pair<string, GdsHashValue>, string>::iterator p = mOutMap.find(key);
+  if ( p != mOutMap.end() ) {
+    // 子孫を含めて同じ内容のものを既に出力しているのでそれを使う．
+    // 名前を変えて出力したものかもしれない．
+    cell.mState = kDedup;
+    cell.mOutName = p->second;
+    ++ mDedupNum;
+    return;
+  }
+  if ( mOutName.count(name) == 0 ) {
+    cell.mState = kNew;
+    cell.mOutName = name;
+  }
+  else {
+    cell.mState = kRename;
+    cell.mOutName = new_name(name);
+    Rename rename;
+    rename.mFile = lib_id;
+    rename.mFrom = name;
+    rename.mTo = cell.mOutName;
+    mRenameList.push_back(rename);
+  }
+  mOutName[cell.mOutName] = true;
+  mOutMap.insert(make_pair(key, cell.mOutName));
+  cell.mEmit = true;
+
+  ymuint n = lib.mCellArray.size();
+  for (ymuint i = 0; i < cell.mRefList.size(); ++ i) {
+    ymuint cid = lib.mIndex->find(cell.mRefList[i]);
+    if ( cid < n ) {
+      decide(lib_id, cid);
+    }
+  }
+}
+
+// @brief 重ならない新しい名前を作る．
+// @param[in] name 元の名前
+string
+GdsMerge::new_name(const string& name)
+{
+  for (ymuint i = 1; ; ++ i) {
+    ostringstream buf;
+    buf << name << "_" << i;
+    string cand = buf.str();
+    if ( mUsedName.count(cand) == 0 ) {
+      mUsedName[cand] = true;
+      return cand;
+    }
+  }
+}
+
+// @brief ヘッダ部分を書き出す．
+// @param[in] writer 出力先
+//
+// 最初のファイルのヘッダを用い，LIBNAME と UNITS だけを必要に応じて書き換える．
+bool
+GdsMerge::write_header(GdsWriter& writer)
+{
+  const Lib& lib = *mLibList[0];
+  if ( mLibName.empty() && lib.mScale == 1.0 ) {
+    return lib.mIndex->copy_header(writer);
+  }
+
+  GdsScanner scanner;
+  scanner.open_memory(lib.mIndex->data(), lib.mIndex->header_size());
+  while ( scanner.read_rec() ) {
+    GdsRtype rtype = scanner.cur_rtype();
+    bool stat;
+    if ( rtype == kGdsLIBNAME && !mLibName.empty() ) {
+      stat = writer.write_string(kGdsLIBNAME, mLibName.c_str());
+    }
+    else if ( rtype == kGdsUNITS && lib.mScale != 1.0 ) {
+      double vals[2] = { mUserUnit, mMeterUnit };
+      stat = writer.write_8real(kGdsUNITS, vals, 2);
+    }
+    else {
+      stat = writer.copy_rec(scanner);
+    }
+    if ( !stat ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// @brief 構造のレコードを書き換えながら書き出す．
+// @param[in] lib ファイル
+// @param[in] id 構造番号
+// @param[in] writer 出力先
+bool
+GdsMerge::rewrite_cell(const Lib& lib,
+		       ymuint id,
+		       GdsWriter& writer)
+{
+  const GdsStructIndex& index = *lib.mIndex;
+  ymuint n = lib.mCellArray.size();
+  GdsScanner scanner;
+  scanner.open_memory(index.data() + index.struct_offset(id),
+		      index.struct_size(id), index.struct_offset(id));
+  vector<ymint32> vals;
+  while ( scanner.read_rec() ) {
+    GdsRtype rtype = scanner.cur_rtype();
+    bool stat;
+    if ( rtype == kGdsSTRNAME ) {
+      stat = writer.write_string(kGdsSTRNAME, lib.mCellArray[id].mOutName.c_str());
+    }
+    else if ( rtype == kGdsSNAME ) {
+      string name = rec_string(scanner);
+      ymuint cid = index.find(name);
+      if ( cid < n ) {
+	name = lib.mCellArray[cid].mOutName;
+      }
+      stat = writer.write_string(kGdsSNAME, name.c_str());
+    }
+    else if ( is_coord_rec(rtype) && lib.mScale != 1.0 ) {
+      // 範囲は scan_cell() で確かめてある．
+      bool ok = true;
+      ymuint nv = scanner.cur_dsize() / 4;
+      vals.resize(nv);
+      for (ymuint i = 0; i < nv; ++ i) {
+	vals[i] = scale_coord(scanner.conv_4byte_int(i), lib.mScale, ok);
+      }
+      stat = writer.write_4int(rtype, &vals[0], nv);
+    }
+    else {
+      stat = writer.copy_rec(scanner);
+    }
+    if ( !stat ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// @brief 構造を書き換える必要があるか調べる．
+// @param[in] lib ファイル
+// @param[in] id 構造番号
+bool
+GdsMerge::need_rewrite(const Lib& lib,
+		       ymuint id) const
+{
+  if ( lib.mScale != 1.0 ) {
+    return true;
+  }
+  const Cell& cell = lib.mCellArray[id];
+  if ( cell.mOutName != lib.mIndex->struct_name(id) ) {
+    return true;
+  }
+  ymuint n = lib.mCellArray.size();
+  for (ymuint i = 0; i < cell.mRefList.size(); ++ i) {
+    const string& name = cell.mRefList[i];
+    ymuint cid = lib.mIndex->find(name);
+    if ( cid < n && lib.mCellArray[cid].mOutName != name ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+END_NAMESPACE_YM_GDS
@@ -39,6 +39,13 @@ GdsNode::~GdsNode()
 {
 }
 
+// @brief 要素の種類を返す．
+GdsRtype
+GdsNode::type() const
+{
+  return kGdsNODE;
+}
+
 // @brief層番号を返す．
 int
 GdsNode::layer() const
@@ -0,0 +1,2405 @@
+﻿
+/// @file GdsOasisParser.cc
+/// @brief GdsOasisParser の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsOasisParser.h"
+#include "YmGds/Msg.h"
+
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsDate.h"
+
+#include "GdsParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// OASIS のレコード番号
+enum {
+  kOasPAD = 0,
+  kOasSTART = 1,
+  kOasEND = 2,
+  kOasCELLNAME = 3,
+  kOasCELLNAME_R = 4,
+  kOasTEXTSTRING = 5,
+  kOasTEXTSTRING_R = 6,
+  kOasPROPNAME = 7,
+  kOasPROPNAME_R = 8,
+  kOasPROPSTRING = 9,
+  kOasPROPSTRING_R = 10,
+  kOasLAYERNAME = 11,
+  kOasLAYERNAME_T = 12,
+  kOasCELL_R = 13,
+  kOasCELL = 14,
+  kOasXYABSOLUTE = 15,
+  kOasXYRELATIVE = 16,
+  kOasPLACEMENT = 17,
+  kOasPLACEMENT_T = 18,
+  kOasTEXT = 19,
+  kOasRECTANGLE = 20,
+  kOasPOLYGON = 21,
+  kOasPATH = 22,
+  kOasTRAPEZOID = 23,
+  kOasTRAPEZOID_A = 24,
+  kOasTRAPEZOID_B = 25,
+  kOasCTRAPEZOID = 26,
+  kOasCIRCLE = 27,
+  kOasPROPERTY = 28,
+  kOasPROPERTY_R = 29,
+  kOasXNAME = 30,
+  kOasXNAME_R = 31,
+  kOasXELEMENT = 32,
+  kOasXGEOMETRY = 33,
+  kOasCBLOCK = 34
+};
+
+// マジック文字列
+static
+const char* kMagic = "%SEMI-OASIS\r\n";
+
+// マジック文字列の長さ
+static
+const ymuint kMagicSize = 13;
+
+// END レコードの長さ
+static
+const ymuint64 kEndSize = 256;
+
+// 一つのレコードから作る要素の数の上限
+static
+const ymuint64 kMaxRepetition = 1 << 24;
+
+// CIRCLE を近似する多角形の頂点数
+static
+const ymuint kCircleSegments = 64;
+
+// 8 方向の変位 ( E, N, W, S, NE, NW, SW, SE の順 )
+static
+const int kDirX[8] = { 1, 0, -1,  0, 1, -1, -1,  1 };
+static
+const int kDirY[8] = { 0, 1,  0, -1, 1,  1, -1, -1 };
+
+// CTRAPEZOID の頂点の表
+// 頂点は ( x = a * w + b * h, y = c * w + d * h ) で表す．
+static
+const struct {
+  ymuint mNum;
+  int mCoef[4][4];
+} kCtrapTable[26] = {
+  { 4, { {  0,  0,  0,  0 }, {  0,  0,  0,  1 }, {  1, -1,  0,  1 }, {  1,  0,  0,  0 } } },
+  { 4, { {  0,  0,  0,  0 }, {  0,  0,  0,  1 }, {  1,  0,  0,  1 }, {  1, -1,  0,  0 } } },
+  { 4, { {  0,  0,  0,  0 }, {  0,  1,  0,  1 }, {  1,  0,  0,  1 }, {  1,  0,  0,  0 } } },
+  { 4, { {  0,  0,  0,  1 }, {  1,  0,  0,  1 }, {  1,  0,  0,  0 }, {  0,  1,  0,  0 } } },
+  { 4, { {  0,  0,  0,  0 }, {  0,  1,  0,  1 }, {  1, -1,  0,  1 }, {  1,  0,  0,  0 } } },
+  { 4, { {  0,  1,  0,  0 }, {  0,  0,  0,  1 }, {  1,  0,  0,  1 }, {  1, -1,  0,  0 } } },
+  { 4, { {  0,  0,  0,  0 }, {  0,  1,  0,  1 }, {  1,  0,  0,  1 }, {  1, -1,  0,  0 } } },
+  { 4, { {  0,  1,  0,  0 }, {  0,  0,  0,  1 }, {  1, -1,  0,  1 }, {  1,  0,  0,  0 } } },
+  { 4, { {  0,  0,  0,  0 }, {  1,  0,  0,  0 }, {  1,  0, -1,  1 }, {  0,  0,  0,  1 } } },
+  { 4, { {  0,  0,  0,  0 }, {  1,  0,  0,  0 }, {  1,  0,  0,  1 }, {  0,  0, -1,  1 } } },
+  { 4, { {  0,  0,  0,  0 }, {  1,  0,  1,  0 }, {  1,  0,  0,  1 }, {  0,  0,  0,  1 } } },
+  { 4, { {  1,  0,  0,  0 }, {  1,  0,  0,  1 }, {  0,  0,  0,  1 }, {  0,  0,  1,  0 } } },
+  { 4, { {  0,  0,  0,  0 }, {  1,  0,  1,  0 }, {  1,  0, -1,  1 }, {  0,  0,  0,  1 } } },
+  { 4, { {  0,  0,  1,  0 }, {  1,  0,  0,  0 }, {  1,  0,  0,  1 }, {  0,  0, -1,  1 } } },
+  { 4, { {  0,  0,  0,  0 }, {  1,  0,  1,  0 }, {  1,  0,  0,  1 }, {  0,  0, -1,  1 } } },
+  { 4, { {  0,  0,  1,  0 }, {  1,  0,  0,  0 }, {  1,  0, -1,  1 }, {  0,  0,  0,  1 } } },
+  { 3, { {  0,  0,  0,  0 }, {  0,  0,  0,  1 }, {  1,  0,  0,  0 }, {  0,  0,  0,  0 } } },
+  { 3, { {  0,  0,  0,  0 }, {  0,  0,  0,  1 }, {  1,  0,  0,  1 }, {  0,  0,  0,  0 } } },
+  { 3, { {  0,  0,  0,  0 }, {  1,  0,  0,  1 }, {  1,  0,  0,  0 }, {  0,  0,  0,  0 } } },
+  { 3, { {  0,  0,  0,  1 }, {  1,  0,  0,  1 }, {  1,  0,  0,  0 }, {  0,  0,  0,  0 } } },
+  { 3, { {  0,  0,  0,  0 }, {  0,  1,  0,  1 }, {  1,  0,  0,  0 }, {  0,  0,  0,  0 } } },
+  { 3, { {  0,  0,  0,  1 }, {  1,  0,  0,  1 }, {  0,  1,  0,  0 }, {  0,  0,  0,  0 } } },
+  { 3, { {  0,  0,  0,  0 }, {  0,  0,  0,  1 }, {  1,  0,  1,  0 }, {  0,  0,  0,  0 } } },
+  { 3, { {  1,  0,  0,  0 }, {  0,  0,  1,  0 }, {  1,  0,  0,  1 }, {  0,  0,  0,  0 } } },
+  { 4, { {  0,  0,  0,  0 }, {  0,  0,  0,  1 }, {  1,  0,  0,  1 }, {  1,  0,  0,  0 } } },
+  { 4, { {  0,  0,  0,  0 }, {  0,  0,  0,  1 }, {  1,  0,  0,  1 }, {  1,  0,  0,  0 } } }
+};
+
+// @brief 名前の表のレコードの時 true を返す．
+//
+// PROPERTY は含まない．
+static
+inline
+bool
+is_name_record(ymuint64 rtype)
+{
+  return ( rtype >= kOasCELLNAME && rtype <= kOasLAYERNAME_T &&
+	   rtype != kOasCELL_R && rtype != kOasCELL ) ||
+    rtype == kOasXNAME || rtype == kOasXNAME_R;
+}
+
+// @brief モーダル変数の座標を更新する．
+// @param[inout] val 対象の値
+// @param[in] d 読み込んだ値
+// @param[in] relative XYRELATIVE の時 true
+static
+inline
+void
+update_coord(ymint64& val,
+	     ymint64 d,
+	     bool relative)
+{
+  if ( relative ) {
+    val += d;
+  }
+  else {
+    val = d;
+  }
+}
+
+// @brief 座標を追加する．
+// @retval false 32ビットに収まらなかった．
+static
+inline
+bool
+push_coord(vector<ymint32>& xy_list,
+	   ymint64 x,
+	   ymint64 y)
+{
+  if ( x < -2147483648LL || x > 2147483647LL ||
+       y < -2147483648LL || y > 2147483647LL ) {
+    return false;
+  }
+  xy_list.push_back(static_cast<ymint32>(x));
+  xy_list.push_back(static_cast<ymint32>(y));
+  return true;
+}
+
+// @brief raw deflate 形式のデータを展開する．
+// @param[in] src 圧縮されたデータ
+// @param[in] csize src のバイト数
+// @param[in] usize 展開後のバイト数
+// @param[out] dst 結果
+static
+bool
+inflate_raw(const ymuint8* src,
+	    ymuint64 csize,
+	    ymuint64 usize,
+	    vector<ymuint8>& dst)
+{
+  dst.clear();
+  if ( usize == 0 ) {
+    return true;
+  }
+  // deflate の圧縮率は高々 1032 倍なので，それを超える大きさは誤り
+  if ( usize > 0xFFFFFFFFULL || csize > 0xFFFFFFFFULL ||
+       usize > csize * 1032 + 64 ) {
+    return false;
+  }
+  dst.resize(usize);
+
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if ( inflateInit2(&zs, -15) != Z_OK ) {
+    return false;
+  }
+  zs.next_in = const_cast<Bytef*>(src);
+  zs.avail_in = csize;
+  zs.next_out = &dst[0];
+  zs.avail_out = usize;
+  int ret = inflate(&zs, Z_FINISH);
+  ymuint64 out_size = zs.total_out;
+  inflateEnd(&zs);
+  return ret == Z_STREAM_END && out_size == usize;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsOasisParser::Reader
+//////////////////////////////////////////////////////////////////////
+
+// @brief 1バイト読む．
+ymuint
+GdsOasisParser::Reader::read_byte()
+{
+  if ( mCur >= mEnd ) {
+    mError = true;
+    return 0;
+  }
+  return *mCur ++;
+}
+
+// @brief 符号なし整数を読む．
+ymuint64
+GdsOasisParser::Reader::read_uint()
+{
+  ymuint64 val = 0;
+  for (ymuint shift = 0; ; shift += 7) {
+    if ( mCur >= mEnd || shift > 63 ) {
+      mError = true;
+      return 0;
+    }
+    ymuint8 b = *mCur ++;
+    val |= static_cast<ymuint64>(b & 0x7F) << shift;
+    if ( (b & 0x80) == 0 ) {
+      break;
+    }
+  }
+  return val;
+}
+
+// @brief 符号つき整数を読む．
+ymint64
+GdsOasisParser::Reader::read_sint()
+{
+  ymuint64 val = read_uint();
+  ymint64 mag = static_cast<ymint64>(val >> 1);
+  return (val & 1) ? -mag : mag;
+}
+
+// @brief 実数を読む．
+double
+GdsOasisParser::Reader::read_real()
+{
+  ymuint64 type = read_uint();
+  return read_real_body(type);
+}
+
+// @brief 型を読んだ後の実数を読む．
+double
+GdsOasisParser::Reader::read_real_body(ymuint64 type)
+{
+  switch ( type ) {
+  case 0:
+  case 1:
+    {
+      double val = static_cast<double>(read_uint());
+      return type == 0 ? val : -val;
+    }
+
+  case 2:
+  case 3:
+    {
+      ymuint64 d = read_uint();
+      if ( d == 0 ) {
+	mError = true;
+	return 0.0;
+      }
+      double val = 1.0 / static_cast<double>(d);
+      return type == 2 ? val : -val;
+    }
+
+  case 4:
+  case 5:
+    {
+      ymuint64 n = read_uint();
+      ymuint64 d = read_uint();
+      if ( d == 0 ) {
+	mError = true;
+	return 0.0;
+      }
+      double val = static_cast<double>(n) / static_cast<double>(d);
+      return type == 4 ? val : -val;
+    }
+
+  case 6:
+    {
+      ymuint32 bits = 0;
+      for (ymuint i = 0; i < 4; ++ i) {
+	bits |= static_cast<ymuint32>(read_byte()) << (i * 8);
+      }
+      float val;
+      memcpy(&val, &bits, sizeof(val));
+      return val;
+    }
+
+  case 7:
+    {
+      ymuint64 bits = 0;
+      for (ymuint i = 0; i < 8; ++ i) {
+	bits |= static_cast<ymuint64>(read_byte()) << (i * 8);
+      }
+      double val;
+      memcpy(&val, &bits, sizeof(val));
+      return val;
+    }
+
+  default:
+    break;
+  }
+  mError = true;
+  return 0.0;
+}
+
+// @brief 文字列を読む．
+void
+GdsOasisParser::Reader::read_string(string& str)
+{
+  ymuint64 n = read_uint();
+  if ( mError || n > static_cast<ymuint64>(mEnd - mCur) ) {
+    mError = true;
+    str.clear();
+    return;
+  }
+  str.assign(reinterpret_cast<const char*>(mCur), n);
+  mCur += n;
+}
+
+// @brief g-delta を読む．
+void
+GdsOasisParser::Reader::read_gdelta(ymint64& dx,
+				    ymint64& dy)
+{
+  ymuint64 val = read_uint();
+  if ( (val & 1) == 0 ) {
+    // 8 方向の形式
+    ymuint dir = (val >> 1) & 7;
+    ymint64 mag = static_cast<ymint64>(val >> 4);
+    dx = kDirX[dir] * mag;
+    dy = kDirY[dir] * mag;
+  }
+  else {
+    // 一般の形式
+    dx = static_cast<ymint64>(val >> 2);
+    if ( val & 2 ) {
+      dx = -dx;
+    }
+    dy = read_sint();
+  }
+}
+
+// @brief point-list を読む．
+void
+GdsOasisParser::Reader::read_point_list(bool polygon,
+					vector<ymint64>& pts)
+{
+  ymuint64 type = read_uint();
+  ymuint64 n = read_uint();
+  pts.clear();
+  // 各点は少なくとも 1 バイトを使う．
+  if ( mError || n > static_cast<ymuint64>(mEnd - mCur) ) {
+    mError = true;
+    return;
+  }
+  pts.reserve(n * 2 + 2);
+
+  ymint64 x = 0;
+  ymint64 y = 0;
+  switch ( type ) {
+  case 0:
+  case 1:
+    {
+      // 水平と垂直を交互にくり返す．
+      bool horizontal = (type == 0);
+      for (ymuint64 i = 0; i < n; ++ i) {
+	ymint64 d = read_sint();
+	if ( horizontal ) {
+	  x += d;
+	}
+	else {
+	  y += d;
+	}
+	pts.push_back(x);
+	pts.push_back(y);
+	horizontal = !horizontal;
+      }
+      if ( polygon ) {
+	// 始点に戻る前の頂点は省略されている．
+	if ( horizontal ) {
+	  pts.push_back(0);
+	  pts.push_back(y);
+	}
+	else {
+	  pts.push_back(x);
+	  pts.push_back(0);
+	}
+      }
+    }
+    break;
+
+  case 2:
+  case 3:
+    {
+      for (ymuint64 i = 0; i < n; ++ i) {
+	ymuint64 val = read_uint();
+	ymuint dir;
+	ymint64 mag;
+	if ( type == 2 ) {
+	  dir = val & 3;
+	  mag = static_cast<ymint64>(val >> 2);
+	}
+	else {
+	  dir = val & 7;
+	  mag = static_cast<ymint64>(val >> 3);
+	}
+	x += kDirX[dir] * mag;
+	y += kDirY[dir] * mag;
+	pts.push_back(x);
+	pts.push_back(y);
+      }
+    }
+    break;
+
+  case 4:
+  case 5:
+    {
+      // 型 5 は直前の変位からの差分
+      ymint64 ddx = 0;
+      ymint64 ddy = 0;
+      for (ymuint64 i = 0; i < n; ++ i) {
+	ymint64 dx;
+	ymint64 dy;
+	read_gdelta(dx, dy);
+	if ( type == 5 ) {
+	  ddx += dx;
+	  ddy += dy;
+	  dx = ddx;
+	  dy = ddy;
+	}
+	x += dx;
+	y += dy;
+	pts.push_back(x);
+	pts.push_back(y);
+      }
+    }
+    break;
+
+  default:
+    mError = true;
+    break;
+  }
+}
+
+// @brief n バイト読み飛ばす．
+void
+GdsOasisParser::Reader::skip(ymuint64 n)
+{
+  if ( n > static_cast<ymuint64>(mEnd - mCur) ) {
+    mError = true;
+    mCur = mEnd;
+    return;
+  }
+  mCur += n;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsOasisParser::Modal
+//////////////////////////////////////////////////////////////////////
+
+// @brief すべてを未定義にする．
+void
+GdsOasisParser::Modal::clear()
+{
+  mRelative = false;
+  mPlacementX = 0;
+  mPlacementY = 0;
+  mPlacementCell = 0;
+  mLayer = 0;
+  mDatatype = 0;
+  mTextLayer = 0;
+  mTextType = 0;
+  mTextX = 0;
+  mTextY = 0;
+  mTextString = 0;
+  mGeomX = 0;
+  mGeomY = 0;
+  mGeomW = 0;
+  mGeomH = 0;
+  mHalfWidth = 0;
+  mStartExt = 0;
+  mEndExt = 0;
+  mPolygonList.clear();
+  mPathList.clear();
+  mRadius = 0;
+  mCtrapType = 0;
+  mRep.mType = 0;
+  mRep.mPosList.clear();
+  mPropNameDef = false;
+  mPropNameRef = false;
+  mPropNameNum = 0;
+  mPropNameStr.clear();
+  mPropValues.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsOasisParser
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsOasisParser::GdsOasisParser() :
+  mThreadNum(0),
+  mExpand(false),
+  mData(NULL),
+  mFileSize(0),
+  mCurData(NULL)
+{
+}
+
+// @brief デストラクタ
+GdsOasisParser::~GdsOasisParser()
+{
+}
+
+// @brief OASIS ファイルかどうか調べる．
+// @param[in] filename ファイル名
+//
+// 先頭のマジック文字列だけを調べる．
+bool
+GdsOasisParser::is_oasis(const string& filename)
+{
+  std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+  if ( !ifs ) {
+    return false;
+  }
+  char buf[kMagicSize];
+  ifs.read(buf, kMagicSize);
+  return ifs.gcount() == kMagicSize && memcmp(buf, kMagic, kMagicSize) == 0;
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsOasisParser::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief repetition をすべて展開するか設定する．
+// @param[in] flag true の時は AREF を作らずに SREF に展開する．
+//
+// 既定では規則的な配置は AREF にする．
+void
+GdsOasisParser::set_expand_repetition(bool flag)
+{
+  mExpand = flag;
+}
+
+// @brief ファイルを読み込む．
+// @param[in] filename ファイル名
+// @retval true 読み込みが成功した．
+// @retval false 読み込みが失敗した．
+bool
+GdsOasisParser::parse(const string& filename)
+{
+  mCurData = NULL;
+  mTableLoaded = false;
+  for (ymuint i = 0; i < 6; ++ i) {
+    mTableFlag[i] = 0;
+    mTableOffset[i] = 0;
+  }
+  for (ymuint i = 0; i < 4; ++ i) {
+    mNextRef[i] = 0;
+  }
+  mLastCellName = -1;
+  mCellName.clear();
+  mTextString.clear();
+  mPropName.clear();
+  mPropString.clear();
+  mCellOffset.clear();
+  mCellProp.clear();
+  mBlockList.clear();
+  mCellList.clear();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if ( fd < 0 ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", 0)
+      << filename << ": Could not open";
+    msg_end();
+    return false;
+  }
+  struct stat st;
+  if ( fstat(fd, &st) < 0 ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", 0)
+      << "error occured in 'fstat()'";
+    msg_end();
+    ::close(fd);
+    return false;
+  }
+  mFileSize = st.st_size;
+  if ( mFileSize < kMagicSize + kEndSize ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", 0)
+      << filename << ": Not an OASIS file";
+    msg_end();
+    ::close(fd);
+    return false;
+  }
+  void* addr = mmap(NULL, mFileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if ( addr == MAP_FAILED ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", 0)
+      << "error occured in 'mmap()'";
+    msg_end();
+    return false;
+  }
+  mData = static_cast<const ymuint8*>(addr);
+
+  bool stat = read_start_end();
+
+  // 名前の表がすべて strict ならその位置から読む．
+  if ( stat && mTableFlag[0] == 1 && mTableFlag[1] == 1 &&
+       mTableFlag[2] == 1 && mTableFlag[3] == 1 ) {
+    mTableLoaded = true;
+    for (ymuint i = 0; i < 4 && stat; ++ i) {
+      stat = read_table(i);
+    }
+  }
+
+  if ( stat && !locate_cells() ) {
+    mCellList.clear();
+    stat = scan_cells();
+  }
+
+  if ( stat ) {
+    parallel_for(mCellList.size(), mThreadNum, [&](ymuint i) {
+	read_cell(mCellList[i]);
+      });
+    for (ymuint i = 0; i < mCellList.size(); ++ i) {
+      const Cell& cell = mCellList[i];
+      if ( !cell.mError.empty() ) {
+	error_header(__FILE__, __LINE__, "GdsOasisParser", cell.mOffset)
+	  << cell.mError;
+	msg_end();
+	stat = false;
+	break;
+      }
+    }
+  }
+
+  if ( stat ) {
+    stat = make_data(filename);
+  }
+
+  munmap(const_cast<ymuint8*>(mData), mFileSize);
+  mData = NULL;
+  mBlockList.clear();
+  mCellList.clear();
+
+  if ( !stat ) {
+    mCurData = NULL;
+  }
+  return stat;
+}
+
+// @brief 読み込んだデータを返す．
+//
+// parse() が失敗した場合には NULL を返す．
+// 返り値はこのオブジェクトが破壊されるまで有効．
+const GdsData*
+GdsOasisParser::data() const
+{
+  return mCurData;
+}
+
+// @brief START と END を読む．
+bool
+GdsOasisParser::read_start_end()
+{
+  if ( memcmp(mData, kMagic, kMagicSize) != 0 ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", 0)
+      << "Not an OASIS file";
+    msg_end();
+    return false;
+  }
+
+  Reader r = { mData + kMagicSize, mData + mFileSize, false };
+  if ( r.read_uint() != kOasSTART ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", kMagicSize)
+      << "START record expected";
+    msg_end();
+    return false;
+  }
+  string version;
+  r.read_string(version);
+  if ( version != "1.0" ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", kMagicSize)
+      << version << ": unsupported version";
+    msg_end();
+    return false;
+  }
+  mUnit = r.read_real();
+  ymuint64 offset_flag = r.read_uint();
+  if ( offset_flag == 0 ) {
+    for (ymuint i = 0; i < 6; ++ i) {
+      mTableFlag[i] = r.read_uint();
+      mTableOffset[i] = r.read_uint();
+    }
+  }
+  if ( r.mError || !(mUnit > 0.0) || offset_flag > 1 ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", kMagicSize)
+      << "invalid START record";
+    msg_end();
+    return false;
+  }
+  mBodyPos = r.mCur - mData;
+  mEndPos = mFileSize - kEndSize;
+  if ( mBodyPos > mEndPos ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", kMagicSize)
+      << "invalid START record";
+    msg_end();
+    return false;
+  }
+
+  Reader e = { mData + mEndPos, mData + mFileSize, false };
+  if ( e.read_uint() != kOasEND ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", mEndPos)
+      << "END record expected";
+    msg_end();
+    return false;
+  }
+  if ( offset_flag == 1 ) {
+    for (ymuint i = 0; i < 6; ++ i) {
+      mTableFlag[i] = e.read_uint();
+      mTableOffset[i] = e.read_uint();
+    }
+    if ( e.mError ) {
+      error_header(__FILE__, __LINE__, "GdsOasisParser", mEndPos)
+	<< "invalid END record";
+      msg_end();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// @brief 名前の表を読む．
+// @param[in] table 表の番号 ( CELLNAME から順に 0 - 3 )
+bool
+GdsOasisParser::read_table(ymuint table)
+{
+  ymuint64 offset = mTableOffset[table];
+  if ( offset == 0 ) {
+    // 表は空
+    return true;
+  }
+  if ( offset < mBodyPos || offset >= mEndPos ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", mEndPos)
+      << "invalid table offset";
+    msg_end();
+    return false;
+  }
+
+  Reader r = { mData + offset, mData + mEndPos, false };
+  Modal modal;
+  modal.clear();
+  mLastCellName = -1;
+  if ( !read_names(r, modal, table) ) {
+    error_header(__FILE__, __LINE__, "GdsOasisParser", offset)
+      << "invalid name table";
+    msg_end();
+    return false;
+  }
+  return true;
+}
+
+// @brief 名前のレコードを続けて読む．
+// @param[in] r カーソル
+// @param[inout] modal モーダル変数
+// @param[in] table 登録する表の番号
+// @retval true 名前以外のレコードか末尾に達した．
+// @retval false 形式が正しくなかった．
+//
+// CBLOCK は展開して中を読む．
+// 表が隣り合っている場合があるので，他の表の名前は読み飛ばす．
+bool
+GdsOasisParser::read_names(Reader& r,
+			   Modal& modal,
+			   ymuint table)
+{
+  while ( r.mCur < r.mEnd ) {
+    const ymuint8* pos = r.mCur;
+    ymuint64 rtype = r.read_uint();
+    if ( rtype == kOasCBLOCK ) {
+      ymuint64 comp = r.read_uint();
+      ymuint64 usize = r.read_uint();
+      ymuint64 csize = r.read_uint();
+      if ( r.mError || comp != 0 ||
+	   csize > static_cast<ymuint64>(r.mEnd - r.mCur) ) {
+	return false;
+      }
+      vector<ymuint8> buf;
+      if ( !inflate_raw(r.mCur, csize, usize, buf) ) {
+	return false;
+      }
+      r.mCur += csize;
+      if ( !buf.empty() ) {
+	Reader r1 = { &buf[0], &buf[0] + buf.size(), false };
+	if ( !read_names(r1, modal, table) ) {
+	  return false;
+	}
+	if ( r1.mCur < r1.mEnd ) {
+	  // 表の終わり
+	  return true;
+	}
+      }
+      continue;
+    }
+    if ( rtype == kOasPAD ) {
+      continue;
+    }
+    if ( is_name_record(rtype) ) {
+      // 3, 4 -> 0, 5, 6 -> 1, 7, 8 -> 2, 9, 10 -> 3
+      bool store = rtype <= kOasPROPSTRING_R &&
+	(rtype - kOasCELLNAME) / 2 == table;
+      if ( !read_name_record(rtype, r, modal, store) ) {
+	return false;
+      }
+    }
+    else if ( rtype == kOasPROPERTY || rtype == kOasPROPERTY_R ) {
+      if ( !read_name_record(rtype, r, modal, true) ) {
+	return false;
+      }
+    }
+    else {
+      r.mCur = pos;
+      return true;
+    }
+  }
+  return true;
+}
+
+// @brief 名前のレコードを一つ読む．
+// @param[in] rtype レコード番号
+// @param[in] r カーソル
+// @param[inout] modal モーダル変数
+// @param[in] store false の時は読み飛ばす．
+bool
+GdsOasisParser::read_name_record(ymuint64 rtype,
+				 Reader& r,
+				 Modal& modal,
+				 bool store)
+{
+  ymint64 last_cell = mLastCellName;
+  mLastCellName = -1;
+
+  switch ( rtype ) {
+  case kOasCELLNAME:
+  case kOasCELLNAME_R:
+  case kOasTEXTSTRING:
+  case kOasTEXTSTRING_R:
+  case kOasPROPNAME:
+  case kOasPROPNAME_R:
+  case kOasPROPSTRING:
+  case kOasPROPSTRING_R:
+    {
+      std::map<ymuint64, string>* table_list[4] = {
+	&mCellName, &mTextString, &mPropName, &mPropString
+      };
+      ymuint kind = (rtype - kOasCELLNAME) / 2;
+      string name;
+      r.read_string(name);
+      ymuint64 ref = 0;
+      if ( (rtype - kOasCELLNAME) % 2 == 0 ) {
+	// 参照番号は現れた順につける．
+	if ( store ) {
+	  ref = mNextRef[kind] ++;
+	}
+      }
+      else {
+	ref = r.read_uint();
+      }
+      if ( store && !r.mError ) {
+	(*table_list[kind])[ref] = name;
+	if ( kind == 0 ) {
+	  mLastCellName = ref;
+	}
+      }
+    }
+    break;
+
+  case kOasLAYERNAME:
+  case kOasLAYERNAME_T:
+    {
+      string name;
+      r.read_string(name);
+      // 層番号とデータ型の区間
+      for (ymuint i = 0; i < 2; ++ i) {
+	ymuint64 type = r.read_uint();
+	if ( type == 4 ) {
+	  r.read_uint();
+	  r.read_uint();
+	}
+	else if ( type >= 1 && type <= 3 ) {
+	  r.read_uint();
+	}
+	else if ( type != 0 ) {
+	  return false;
+	}
+      }
+    }
+    break;
+
+  case kOasXNAME:
+  case kOasXNAME_R:
+    {
+      r.read_uint();
+      string name;
+      r.read_string(name);
+      if ( rtype == kOasXNAME_R ) {
+	r.read_uint();
+      }
+    }
+    break;
+
+  case kOasPROPERTY:
+  case kOasPROPERTY_R:
+    {
+      if ( !read_prop_values(rtype, r, modal) ) {
+	return false;
+      }
+      // 続く PROPERTY も同じ CELLNAME に付く．
+      mLastCellName = last_cell;
+      if ( last_cell >= 0 && modal.mPropNameDef &&
+	   !modal.mPropValues.empty() && modal.mPropValues[0].mType == 8 ) {
+	ymuint64 val = modal.mPropValues[0].mUint;
+	if ( modal.mPropNameRef ) {
+	  mCellProp.push_back(std::make_pair(last_cell,
+					     std::make_pair(modal.mPropNameNum, val)));
+	}
+	else if ( modal.mPropNameStr == "S_CELL_OFFSET" ) {
+	  mCellOffset[last_cell] = val;
+	}
+      }
+    }
+    break;
+
+  default:
+    return false;
+  }
+
+  return !r.mError;
+}
+
+// @brief S_CELL_OFFSET から構造の範囲を求める．
+//
+// 使えない時は false を返す．
+bool
+GdsOasisParser::locate_cells()
+{
+  if ( !mTableLoaded || mCellName.empty() ) {
+    return false;
+  }
+
+  // PROPNAME の参照番号で書かれた S_CELL_OFFSET を調べる．
+  for (ymuint i = 0; i < mCellProp.size(); ++ i) {
+    std::map<ymuint64, string>::const_iterator p = mPropName.find(mCellProp[i].second.first);
+    if ( p != mPropName.end() && p->second == "S_CELL_OFFSET" ) {
+      mCellOffset[mCellProp[i].first] = mCellProp[i].second.second;
+    }
+  }
+
+  vector<std::pair<ymuint64, ymuint64> > pos_list;
+  for (std::map<ymuint64, string>::const_iterator p = mCellName.begin();
+       p != mCellName.end(); ++ p) {
+    std::map<ymuint64, ymuint64>::const_iterator q = mCellOffset.find(p->first);
+    if ( q == mCellOffset.end() ) {
+      return false;
+    }
+    ymuint64 offset = q->second;
+    if ( offset == 0 ) {
+      // このファイルでは定義されていない．
+      continue;
+    }
+    if ( offset < mBodyPos || offset >= mEndPos ) {
+      return false;
+    }
+    ymuint8 b = mData[offset];
+    if ( b != kOasCELL_R && b != kOasCELL ) {
+      return false;
+    }
+    pos_list.push_back(std::make_pair(offset, p->first));
+  }
+  std::sort(pos_list.begin(), pos_list.end());
+  for (ymuint i = 1; i < pos_list.size(); ++ i) {
+    if ( pos_list[i - 1].first == pos_list[i].first ) {
+      return false;
+    }
+  }
+
+  // 各構造は CELL から次の CELL (あるいは名前の表や END)までになる．
+  ymuint n = pos_list.size();
+  mCellList.resize(n);
+  for (ymuint i = 0; i < n; ++ i) {
+    Cell& cell = mCellList[i];
+    cell.mOffset = pos_list[i].first;
+    cell.mName = 0;
+    cell.mLastBegin = 0;
+    cell.mLastEnd = 0;
+    cell.mSkip = false;
+    Segment seg = { mData + cell.mOffset, mData + mEndPos };
+    cell.mSegList.push_back(seg);
+  }
+  return true;
+}
+
+// @brief ファイルを先頭からたどって構造の範囲を求める．
+bool
+GdsOasisParser::scan_cells()
+{
+  // ファイルを生のレコードの範囲と CBLOCK に分ける．
+  struct Chunk {
+    const ymuint8* mBegin;
+    const ymuint8* mEnd;
+    // CBLOCK の番号 (生のレコードの時は -1)
+    ymint64 mBlock;
+    // 展開後のバイト数
+    ymuint64 mSize;
+  };
+  vector<Chunk> chunk_list;
+
+  // 要素のレコードは作らずに読み飛ばす．
+  Cell scratch;
+  scratch.mOffset = 0;
+  scratch.mName = 0;
+  scratch.mLastBegin = 0;
+  scratch.mLastEnd = 0;
+  scratch.mSkip = true;
+  Modal modal;
+  modal.clear();
+
+  Reader r = { mData + mBodyPos, mData + mEndPos, false };
+  const ymuint8* raw_begin = r.mCur;
+  ymuint64 block_num = 0;
+  while ( r.mCur < r.mEnd ) {
+    const ymuint8* pos = r.mCur;
+    ymuint64 rtype = r.read_uint();
+    bool stat = true;
+    if ( rtype == kOasCBLOCK ) {
+      ymuint64 comp = r.read_uint();
+      ymuint64 usize = r.read_uint();
+      ymuint64 csize = r.read_uint();
+      if ( r.mError || comp != 0 ||
+	   csize > static_cast<ymuint64>(r.mEnd - r.mCur) ) {
+	error_header(__FILE__, __LINE__, "GdsOasisParser", pos - mData)
+	  << "invalid CBLOCK";
+	msg_end();
+	return false;
+      }
+      if ( raw_begin < pos ) {
+	Chunk raw = { raw_begin, pos, -1, 0 };
+	chunk_list.push_back(raw);
+      }
+      Chunk block = { r.mCur, r.mCur + csize, static_cast<ymint64>(block_num), usize };
+      chunk_list.push_back(block);
+      ++ block_num;
+      r.mCur += csize;
+      raw_begin = r.mCur;
+      continue;
+    }
+    else if ( rtype == kOasCELL_R ) {
+      r.read_uint();
+    }
+    else if ( rtype == kOasCELL ) {
+      string name;
+      r.read_string(name);
+    }
+    else if ( is_name_record(rtype) ) {
+      stat = read_name_record(rtype, r, modal, false);
+    }
+    else {
+      stat = read_record(rtype, r, modal, scratch);
+    }
+    if ( !stat || r.mError ) {
+      error_header(__FILE__, __LINE__, "GdsOasisParser", pos - mData)
+	<< "invalid record";
+      msg_end();
+      return false;
+    }
+  }
+  if ( raw_begin < r.mEnd ) {
+    Chunk raw = { raw_begin, r.mEnd, -1, 0 };
+    chunk_list.push_back(raw);
+  }
+
+  // CBLOCK をまとめて並列に展開する．
+  ymuint nc = chunk_list.size();
+  mBlockList.clear();
+  mBlockList.resize(block_num);
+  vector<ymuint8> ok_list(nc, 1);
+  parallel_for(nc, mThreadNum, [&](ymuint i) {
+      const Chunk& chunk = chunk_list[i];
+      if ( chunk.mBlock >= 0 ) {
+	ok_list[i] = inflate_raw(chunk.mBegin, chunk.mEnd - chunk.mBegin,
+				 chunk.mSize, mBlockList[chunk.mBlock]);
+      }
+    });
+  for (ymuint i = 0; i < nc; ++ i) {
+    if ( !ok_list[i] ) {
+      error_header(__FILE__, __LINE__, "GdsOasisParser", chunk_list[i].mBegin - mData)
+	<< "CBLOCK decompression failed";
+      msg_end();
+      return false;
+    }
+  }
+
+  // 展開後のレコードをたどって名前の表と構造の範囲を求める．
+  // 構造の範囲は CBLOCK の境界で分ける．
+  Modal nmodal;
+  nmodal.clear();
+  modal.clear();
+  mLastCellName = -1;
+  bool in_cell = false;
+  for (ymuint i = 0; i < nc; ++ i) {
+    const Chunk& chunk = chunk_list[i];
+    const ymuint8* begin = chunk.mBegin;
+    const ymuint8* end = chunk.mEnd;
+    if ( chunk.mBlock >= 0 ) {
+      const vector<ymuint8>& buf = mBlockList[chunk.mBlock];
+      if ( buf.empty() ) {
+	continue;
+      }
+      begin = &buf[0];
+      end = begin + buf.size();
+    }
+    Reader r1 = { begin, end, false };
+    const ymuint8* seg_begin = begin;
+    while ( r1.mCur < r1.mEnd ) {
+      const ymuint8* pos = r1.mCur;
+      ymuint64 rtype = r1.read_uint();
+      bool stat = true;
+      if ( rtype == kOasCELL_R || rtype == kOasCELL ) {
+	if ( in_cell && seg_begin < pos ) {
+	  Segment seg = { seg_begin, pos };
+	  mCellList.back().mSegList.push_back(seg);
+	}
+	mCellList.push_back(Cell());
+	Cell& cell = mCellList.back();
+	cell.mOffset = (chunk.mBlock >= 0 ? chunk.mBegin : pos) - mData;
+	cell.mName = 0;
+	cell.mLastBegin = 0;
+	cell.mLastEnd = 0;
+	cell.mSkip = false;
+	seg_begin = pos;
+	in_cell = true;
+	mLastCellName = -1;
+	if ( rtype == kOasCELL_R ) {
+	  r1.read_uint();
+	}
+	else {
+	  string name;
+	  r1.read_string(name);
+	}
+      }
+      else if ( is_name_record(rtype) ||
+		( !in_cell && (rtype == kOasPROPERTY || rtype == kOasPROPERTY_R) ) ) {
+	// 名前の表で構造は終わる．
+	if ( in_cell && seg_begin < pos ) {
+	  Segment seg = { seg_begin, pos };
+	  mCellList.back().mSegList.push_back(seg);
+	}
+	in_cell = false;
+	stat = read_name_record(rtype, r1, nmodal, !mTableLoaded);
+      }
+      else if ( rtype == kOasCBLOCK ) {
+	// CBLOCK の中の CBLOCK
+	stat = false;
+      }
+      else {
+	stat = read_record(rtype, r1, modal, scratch);
+      }
+      if ( !stat || r1.mError ) {
+	ymuint64 offset = (chunk.mBlock >= 0 ? chunk.mBegin : pos) - mData;
+	error_header(__FILE__, __LINE__, "GdsOasisParser", offset)
+	  << "invalid record";
+	msg_end();
+	return false;
+      }
+    }
+    if ( in_cell && seg_begin < end ) {
+      Segment seg = { seg_begin, end };
+      mCellList.back().mSegList.push_back(seg);
+    }
+  }
+
+  return true;
+}
+
+// @brief 構造を一つ読む．
+// @param[in] cell 対象の構造
+void
+GdsOasisParser::read_cell(Cell& cell) const
+{
+  Modal modal;
+  modal.clear();
+  bool first = true;
+  for (ymuint i = 0; i < cell.mSegList.size(); ++ i) {
+    const Segment& seg = cell.mSegList[i];
+    Reader r = { seg.mBegin, seg.mEnd, false };
+    ymuint stat = read_body(r, modal, cell, first, false);
+    if ( stat != 0 ) {
+      break;
+    }
+  }
+}
+
+// @brief 構造の中身を読む．
+// @param[in] r カーソル
+// @param[inout] modal モーダル変数
+// @param[inout] cell 結果を追加する構造
+// @param[inout] first 先頭の CELL レコードを読むまで true
+// @param[in] in_block CBLOCK の中の時 true
+// @retval 0 末尾に達した．
+// @retval 1 構造の終わりに達した．
+// @retval 2 形式が正しくなかった．
+ymuint
+GdsOasisParser::read_body(Reader& r,
+			  Modal& modal,
+			  Cell& cell,
+			  bool& first,
+			  bool in_block) const
+{
+  while ( r.mCur < r.mEnd ) {
+    const ymuint8* pos = r.mCur;
+    ymuint64 rtype = r.read_uint();
+    if ( rtype == kOasCELL_R || rtype == kOasCELL ) {
+      if ( !first ) {
+	r.mCur = pos;
+	return 1;
+      }
+      first = false;
+      if ( rtype == kOasCELL_R ) {
+	cell.mName = static_cast<ymint64>(r.read_uint());
+      }
+      else {
+	string name;
+	r.read_string(name);
+	cell.mName = -1 - static_cast<ymint64>(cell.mStrList.size());
+	cell.mStrList.push_back(name);
+      }
+      // モーダル変数は CELL ごとに未定義に戻る．
+      modal.clear();
+      cell.mLastBegin = cell.mElemList.size();
+      cell.mLastEnd = cell.mLastBegin;
+    }
+    else if ( first ) {
+      cell.mError = "CELL record expected";
+      return 2;
+    }
+    else if ( rtype == kOasCBLOCK ) {
+      if ( in_block ) {
+	cell.mError = "CBLOCK in CBLOCK";
+	return 2;
+      }
+      ymuint64 comp = r.read_uint();
+      ymuint64 usize = r.read_uint();
+      ymuint64 csize = r.read_uint();
+      if ( r.mError || comp != 0 ||
+	   csize > static_cast<ymuint64>(r.mEnd - r.mCur) ) {
+	cell.mError = "invalid CBLOCK";
+	return 2;
+      }
+      vector<ymuint8> buf;
+      if ( !inflate_raw(r.mCur, csize, usize, buf) ) {
+	cell.mError = "CBLOCK decompression failed";
+	return 2;
+      }
+      r.mCur += csize;
+      if ( !buf.empty() ) {
+	Reader r1 = { &buf[0], &buf[0] + buf.size(), false };
+	ymuint stat = read_body(r1, modal, cell, first, true);
+	if ( stat != 0 ) {
+	  return stat;
+	}
+      }
+    }
+    else if ( is_name_record(rtype) || rtype == kOasEND || rtype == kOasSTART ) {
+      r.mCur = pos;
+      return 1;
+    }
+    else if ( !read_record(rtype, r, modal, cell) ) {
+      if ( cell.mError.empty() ) {
+	cell.mError = "invalid record";
+      }
+      return 2;
+    }
+    if ( r.mError ) {
+      cell.mError = "invalid record";
+      return 2;
+    }
+  }
+  return 0;
+}
+
+// @brief 構造の中のレコードを一つ読む．
+// @param[in] rtype レコード番号
+// @param[in] r カーソル
+// @param[inout] modal モーダル変数
+// @param[inout] cell 結果を追加する構造
+// @retval true 成功した．
+// @retval false 形式が正しくなかった．
+bool
+GdsOasisParser::read_record(ymuint64 rtype,
+			    Reader& r,
+			    Modal& modal,
+			    Cell& cell) const
+{
+  // repetition がない時に用いる．
+  Rep no_rep;
+  no_rep.mType = 0;
+
+  switch ( rtype ) {
+  case kOasPAD:
+    return true;
+
+  case kOasXYABSOLUTE:
+    modal.mRelative = false;
+    return true;
+
+  case kOasXYRELATIVE:
+    modal.mRelative = true;
+    return true;
+
+  case kOasPLACEMENT:
+  case kOasPLACEMENT_T:
+    {
+      // CNXYRAAF または CNXYRMAF
+      ymuint info = r.read_byte();
+      if ( info & 0x80 ) {
+	if ( info & 0x40 ) {
+	  modal.mPlacementCell = static_cast<ymint64>(r.read_uint());
+	}
+	else {
+	  string name;
+	  r.read_string(name);
+	  modal.mPlacementCell = -1 - static_cast<ymint64>(cell.mStrList.size());
+	  cell.mStrList.push_back(name);
+	}
+      }
+      double mag = 1.0;
+      double angle = 0.0;
+      if ( rtype == kOasPLACEMENT ) {
+	angle = ((info >> 1) & 3) * 90.0;
+      }
+      else {
+	if ( info & 0x04 ) {
+	  mag = r.read_real();
+	}
+	if ( info & 0x02 ) {
+	  angle = r.read_real();
+	}
+      }
+      if ( info & 0x20 ) {
+	update_coord(modal.mPlacementX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x10 ) {
+	update_coord(modal.mPlacementY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x08) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      if ( r.mError ) {
+	return false;
+      }
+      const Rep& rep = (info & 0x08) ? modal.mRep : no_rep;
+
+      Elem elem = Elem();
+      elem.mType = kGdsSREF;
+      elem.mRef = modal.mPlacementCell;
+      elem.mFlip = (info & 0x01) != 0;
+      elem.mMag = mag;
+      elem.mAngle = angle;
+      bool grid = rep.mType == 1 || rep.mType == 2 || rep.mType == 3 ||
+	rep.mType == 8 || rep.mType == 9;
+      if ( !mExpand && grid && rep.mNx <= 32767 && rep.mNy <= 32767 ) {
+	// AREF にする．
+	elem.mType = kGdsAREF;
+	elem.mColRow = (rep.mNx << 16) | rep.mNy;
+	ymint64 nx = rep.mNx;
+	ymint64 ny = rep.mNy;
+	vector<ymint64> pts(4);
+	pts[0] = nx * rep.mCx;
+	pts[1] = nx * rep.mCy;
+	pts[2] = ny * rep.mRx;
+	pts[3] = ny * rep.mRy;
+	return add_elem(elem, modal.mPlacementX, modal.mPlacementY,
+			pts, false, no_rep, cell);
+      }
+      vector<ymint64> pts;
+      return add_elem(elem, modal.mPlacementX, modal.mPlacementY,
+		      pts, false, rep, cell);
+    }
+
+  case kOasTEXT:
+    {
+      // 0CNXYRTL
+      ymuint info = r.read_byte();
+      if ( info & 0x40 ) {
+	if ( info & 0x20 ) {
+	  modal.mTextString = static_cast<ymint64>(r.read_uint());
+	}
+	else {
+	  string text;
+	  r.read_string(text);
+	  modal.mTextString = -1 - static_cast<ymint64>(cell.mStrList.size());
+	  cell.mStrList.push_back(text);
+	}
+      }
+      if ( info & 0x01 ) {
+	modal.mTextLayer = r.read_uint();
+      }
+      if ( info & 0x02 ) {
+	modal.mTextType = r.read_uint();
+      }
+      if ( info & 0x10 ) {
+	update_coord(modal.mTextX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x08 ) {
+	update_coord(modal.mTextY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x04) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      if ( r.mError ) {
+	return false;
+      }
+      if ( modal.mTextLayer > 32767 || modal.mTextType > 32767 ) {
+	cell.mError = "textlayer or texttype out of range";
+	return false;
+      }
+      Elem elem = Elem();
+      elem.mType = kGdsTEXT;
+      elem.mLayer = modal.mTextLayer;
+      elem.mDatatype = modal.mTextType;
+      elem.mRef = modal.mTextString;
+      vector<ymint64> pts;
+      return add_elem(elem, modal.mTextX, modal.mTextY, pts, false,
+		      (info & 0x04) ? modal.mRep : no_rep, cell);
+    }
+
+  case kOasRECTANGLE:
+    {
+      // SWHXYRDL
+      ymuint info = r.read_byte();
+      if ( info & 0x01 ) {
+	modal.mLayer = r.read_uint();
+      }
+      if ( info & 0x02 ) {
+	modal.mDatatype = r.read_uint();
+      }
+      if ( info & 0x40 ) {
+	modal.mGeomW = r.read_uint();
+      }
+      if ( info & 0x20 ) {
+	modal.mGeomH = r.read_uint();
+      }
+      if ( info & 0x80 ) {
+	// 正方形
+	modal.mGeomH = modal.mGeomW;
+      }
+      if ( info & 0x10 ) {
+	update_coord(modal.mGeomX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x08 ) {
+	update_coord(modal.mGeomY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x04) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      if ( r.mError ) {
+	return false;
+      }
+      ymint64 w = modal.mGeomW;
+      ymint64 h = modal.mGeomH;
+      vector<ymint64> verts(8);
+      verts[0] = 0; verts[1] = 0;
+      verts[2] = w; verts[3] = 0;
+      verts[4] = w; verts[5] = h;
+      verts[6] = 0; verts[7] = h;
+      return add_polygon(modal, modal.mGeomX, modal.mGeomY, verts,
+			 (info & 0x04) ? modal.mRep : no_rep, cell);
+    }
+
+  case kOasPOLYGON:
+    {
+      // 00PXYRDL
+      ymuint info = r.read_byte();
+      if ( info & 0x01 ) {
+	modal.mLayer = r.read_uint();
+      }
+      if ( info & 0x02 ) {
+	modal.mDatatype = r.read_uint();
+      }
+      if ( info & 0x20 ) {
+	r.read_point_list(true, modal.mPolygonList);
+      }
+      if ( info & 0x10 ) {
+	update_coord(modal.mGeomX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x08 ) {
+	update_coord(modal.mGeomY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x04) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      if ( r.mError ) {
+	return false;
+      }
+      vector<ymint64> verts;
+      verts.reserve(modal.mPolygonList.size() + 2);
+      verts.push_back(0);
+      verts.push_back(0);
+      verts.insert(verts.end(), modal.mPolygonList.begin(), modal.mPolygonList.end());
+      return add_polygon(modal, modal.mGeomX, modal.mGeomY, verts,
+			 (info & 0x04) ? modal.mRep : no_rep, cell);
+    }
+
+  case kOasPATH:
+    {
+      // EWPXYRDL
+      ymuint info = r.read_byte();
+      if ( info & 0x01 ) {
+	modal.mLayer = r.read_uint();
+      }
+      if ( info & 0x02 ) {
+	modal.mDatatype = r.read_uint();
+      }
+      if ( info & 0x40 ) {
+	modal.mHalfWidth = r.read_uint();
+      }
+      if ( info & 0x80 ) {
+	// 0000SSEE
+	// 0: 前の値，1: 0, 2: 幅の半分，3: 明示
+	ymuint scheme = r.read_byte();
+	ymint64 hw = modal.mHalfWidth;
+	switch ( (scheme >> 2) & 3 ) {
+	case 1: modal.mStartExt = 0; break;
+	case 2: modal.mStartExt = hw; break;
+	case 3: modal.mStartExt = r.read_sint(); break;
+	default: break;
+	}
+	switch ( scheme & 3 ) {
+	case 1: modal.mEndExt = 0; break;
+	case 2: modal.mEndExt = hw; break;
+	case 3: modal.mEndExt = r.read_sint(); break;
+	default: break;
+	}
+      }
+      if ( info & 0x20 ) {
+	r.read_point_list(false, modal.mPathList);
+      }
+      if ( info & 0x10 ) {
+	update_coord(modal.mGeomX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x08 ) {
+	update_coord(modal.mGeomY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x04) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      if ( r.mError ) {
+	return false;
+      }
+      if ( modal.mLayer > 32767 || modal.mDatatype > 32767 ) {
+	cell.mError = "layer or datatype out of range";
+	return false;
+      }
+      ymint64 hw = modal.mHalfWidth;
+      ymint64 bgn_extn = modal.mStartExt;
+      ymint64 end_extn = modal.mEndExt;
+      if ( hw > 1073741823LL ||
+	   bgn_extn < -2147483648LL || bgn_extn > 2147483647LL ||
+	   end_extn < -2147483648LL || end_extn > 2147483647LL ) {
+	cell.mError = "path width or extension out of range";
+	return false;
+      }
+      Elem elem = Elem();
+      elem.mType = kGdsPATH;
+      elem.mLayer = modal.mLayer;
+      elem.mDatatype = modal.mDatatype;
+      elem.mWidth = hw * 2;
+      if ( bgn_extn == 0 && end_extn == 0 ) {
+	elem.mPathtype = 0;
+      }
+      else if ( bgn_extn == hw && end_extn == hw ) {
+	elem.mPathtype = 2;
+      }
+      else {
+	elem.mPathtype = 4;
+	elem.mBgnExtn = bgn_extn;
+	elem.mEndExtn = end_extn;
+      }
+      if ( modal.mPathList.empty() ) {
+	// 点が一つしかない PATH は作らない．
+	cell.mLastBegin = cell.mLastEnd;
+	return true;
+      }
+      return add_elem(elem, modal.mGeomX, modal.mGeomY, modal.mPathList, false,
+		      (info & 0x04) ? modal.mRep : no_rep, cell);
+    }
+
+  case kOasTRAPEZOID:
+  case kOasTRAPEZOID_A:
+  case kOasTRAPEZOID_B:
+    {
+      // OWHXYRDL
+      ymuint info = r.read_byte();
+      if ( info & 0x01 ) {
+	modal.mLayer = r.read_uint();
+      }
+      if ( info & 0x02 ) {
+	modal.mDatatype = r.read_uint();
+      }
+      if ( info & 0x40 ) {
+	modal.mGeomW = r.read_uint();
+      }
+      if ( info & 0x20 ) {
+	modal.mGeomH = r.read_uint();
+      }
+      ymint64 a = 0;
+      ymint64 b = 0;
+      if ( rtype != kOasTRAPEZOID_B ) {
+	a = r.read_sint();
+      }
+      if ( rtype != kOasTRAPEZOID_A ) {
+	b = r.read_sint();
+      }
+      if ( info & 0x10 ) {
+	update_coord(modal.mGeomX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x08 ) {
+	update_coord(modal.mGeomY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x04) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      if ( r.mError ) {
+	return false;
+      }
+      ymint64 w = modal.mGeomW;
+      ymint64 h = modal.mGeomH;
+      ymint64 zero = 0;
+      vector<ymint64> verts(8);
+      if ( info & 0x80 ) {
+	// 垂直方向
+	verts[0] = 0; verts[1] = std::max(a, zero);
+	verts[2] = 0; verts[3] = h + std::min(b, zero);
+	verts[4] = w; verts[5] = h - std::max(b, zero);
+	verts[6] = w; verts[7] = -std::min(a, zero);
+      }
+      else {
+	// 水平方向
+	verts[0] = std::max(a, zero); verts[1] = h;
+	verts[2] = w + std::min(b, zero); verts[3] = h;
+	verts[4] = w - std::max(b, zero); verts[5] = 0;
+	verts[6] = -std::min(a, zero); verts[7] = 0;
+      }
+      return add_polygon(modal, modal.mGeomX, modal.mGeomY, verts,
+			 (info & 0x04) ? modal.mRep : no_rep, cell);
+    }
+
+  case kOasCTRAPEZOID:
+    {
+      // TWHXYRDL
+      ymuint info = r.read_byte();
+      if ( info & 0x01 ) {
+	modal.mLayer = r.read_uint();
+      }
+      if ( info & 0x02 ) {
+	modal.mDatatype = r.read_uint();
+      }
+      if ( info & 0x80 ) {
+	modal.mCtrapType = r.read_uint();
+      }
+      if ( info & 0x40 ) {
+	modal.mGeomW = r.read_uint();
+      }
+      if ( info & 0x20 ) {
+	modal.mGeomH = r.read_uint();
+      }
+      if ( info & 0x10 ) {
+	update_coord(modal.mGeomX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x08 ) {
+	update_coord(modal.mGeomY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x04) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      if ( r.mError ) {
+	return false;
+      }
+      ymuint type = modal.mCtrapType;
+      if ( modal.mCtrapType > 25 ) {
+	cell.mError = "invalid ctrapezoid-type";
+	return false;
+      }
+      // 型によっては幅と高さの一方だけが与えられる．
+      ymint64 w = modal.mGeomW;
+      ymint64 h = modal.mGeomH;
+      if ( (type >= 16 && type <= 19) || type == 25 ) {
+	h = w;
+      }
+      else if ( type == 20 || type == 21 ) {
+	w = h * 2;
+      }
+      else if ( type == 22 || type == 23 ) {
+	h = w * 2;
+      }
+      ymuint n = kCtrapTable[type].mNum;
+      vector<ymint64> verts(n * 2);
+      for (ymuint i = 0; i < n; ++ i) {
+	const int* coef = kCtrapTable[type].mCoef[i];
+	verts[i * 2 + 0] = coef[0] * w + coef[1] * h;
+	verts[i * 2 + 1] = coef[2] * w + coef[3] * h;
+      }
+      return add_polygon(modal, modal.mGeomX, modal.mGeomY, verts,
+			 (info & 0x04) ? modal.mRep : no_rep, cell);
+    }
+
+  case kOasCIRCLE:
+    {
+      // 00rXYRDL
+      ymuint info = r.read_byte();
+      if ( info & 0x01 ) {
+	modal.mLayer = r.read_uint();
+      }
+      if ( info & 0x02 ) {
+	modal.mDatatype = r.read_uint();
+      }
+      if ( info & 0x20 ) {
+	modal.mRadius = r.read_uint();
+      }
+      if ( info & 0x10 ) {
+	update_coord(modal.mGeomX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x08 ) {
+	update_coord(modal.mGeomY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x04) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      if ( r.mError ) {
+	return false;
+      }
+      // 中心のまわりの多角形で近似する．
+      double radius = static_cast<double>(modal.mRadius);
+      // 丸めで重なった頂点は除く．
+      vector<ymint64> verts;
+      verts.reserve(kCircleSegments * 2);
+      for (ymuint i = 0; i < kCircleSegments; ++ i) {
+	double t = 2.0 * M_PI * i / kCircleSegments;
+	ymint64 x = static_cast<ymint64>(floor(radius * cos(t) + 0.5));
+	ymint64 y = static_cast<ymint64>(floor(radius * sin(t) + 0.5));
+	ymuint n = verts.size();
+	if ( n > 0 && verts[n - 2] == x && verts[n - 1] == y ) {
+	  continue;
+	}
+	verts.push_back(x);
+	verts.push_back(y);
+      }
+      return add_polygon(modal, modal.mGeomX, modal.mGeomY, verts,
+			 (info & 0x04) ? modal.mRep : no_rep, cell);
+    }
+
+  case kOasPROPERTY:
+  case kOasPROPERTY_R:
+    return read_property(rtype, r, modal, cell);
+
+  case kOasXELEMENT:
+    {
+      r.read_uint();
+      string data;
+      r.read_string(data);
+      cell.mLastBegin = cell.mLastEnd;
+      return !r.mError;
+    }
+
+  case kOasXGEOMETRY:
+    {
+      // 000XYRDL
+      ymuint info = r.read_byte();
+      r.read_uint();
+      if ( info & 0x01 ) {
+	modal.mLayer = r.read_uint();
+      }
+      if ( info & 0x02 ) {
+	modal.mDatatype = r.read_uint();
+      }
+      string data;
+      r.read_string(data);
+      if ( info & 0x10 ) {
+	update_coord(modal.mGeomX, r.read_sint(), modal.mRelative);
+      }
+      if ( info & 0x08 ) {
+	update_coord(modal.mGeomY, r.read_sint(), modal.mRelative);
+      }
+      if ( (info & 0x04) && !read_repetition(r, modal, cell) ) {
+	return false;
+      }
+      cell.mLastBegin = cell.mLastEnd;
+      return !r.mError;
+    }
+
+  default:
+    break;
+  }
+
+  return false;
+}
+
+// @brief repetition を読む．
+// @param[in] r カーソル
+// @param[inout] modal モーダル変数
+// @param[inout] cell エラーメッセージを設定する構造
+//
+// 結果は modal.mRep に入る．
+bool
+GdsOasisParser::read_repetition(Reader& r,
+				Modal& modal,
+				Cell& cell) const
+{
+  ymuint64 type = r.read_uint();
+  Rep& rep = modal.mRep;
+  if ( type == 0 ) {
+    // 直前の repetition をくり返す．
+    // 読み飛ばしている時は CBLOCK の中で定義されたものかもしれない．
+    if ( rep.mType == 0 && !cell.mSkip ) {
+      cell.mError = "undefined repetition";
+      return false;
+    }
+    return true;
+  }
+
+  rep.mType = type;
+  rep.mPosList.clear();
+  rep.mNx = 1;
+  rep.mNy = 1;
+  rep.mCx = 0;
+  rep.mCy = 0;
+  rep.mRx = 0;
+  rep.mRy = 0;
+  switch ( type ) {
+  case 1:
+    rep.mNx = r.read_uint() + 2;
+    rep.mNy = r.read_uint() + 2;
+    rep.mCx = r.read_uint();
+    rep.mRy = r.read_uint();
+    break;
+
+  case 2:
+    rep.mNx = r.read_uint() + 2;
+    rep.mCx = r.read_uint();
+    break;
+
+  case 3:
+    rep.mNy = r.read_uint() + 2;
+    rep.mRy = r.read_uint();
+    break;
+
+  case 4:
+  case 5:
+  case 6:
+  case 7:
+    {
+      // 水平あるいは垂直方向の間隔のリスト
+      ymuint64 n = r.read_uint() + 2;
+      if ( r.mError || n > static_cast<ymuint64>(r.mEnd - r.mCur) ) {
+	r.mError = true;
+	return false;
+      }
+      ymint64 grid = 1;
+      if ( type == 5 || type == 7 ) {
+	grid = r.read_uint();
+      }
+      rep.mPosList.reserve(n);
+      rep.mPosList.push_back(std::pair<ymint64, ymint64>(0, 0));
+      ymint64 d = 0;
+      for (ymuint64 i = 1; i < n; ++ i) {
+	d += static_cast<ymint64>(r.read_uint()) * grid;
+	if ( type <= 5 ) {
+	  rep.mPosList.push_back(std::pair<ymint64, ymint64>(d, 0));
+	}
+	else {
+	  rep.mPosList.push_back(std::pair<ymint64, ymint64>(0, d));
+	}
+      }
+    }
+    break;
+
+  case 8:
+    rep.mNx = r.read_uint() + 2;
+    rep.mNy = r.read_uint() + 2;
+    r.read_gdelta(rep.mCx, rep.mCy);
+    r.read_gdelta(rep.mRx, rep.mRy);
+    break;
+
+  case 9:
+    rep.mNx = r.read_uint() + 2;
+    r.read_gdelta(rep.mCx, rep.mCy);
+    break;
+
+  case 10:
+  case 11:
+    {
+      // 変位のリスト
+      ymuint64 n = r.read_uint() + 2;
+      if ( r.mError || n > static_cast<ymuint64>(r.mEnd - r.mCur) ) {
+	r.mError = true;
+	return false;
+      }
+      ymint64 grid = 1;
+      if ( type == 11 ) {
+	grid = r.read_uint();
+      }
+      rep.mPosList.reserve(n);
+      rep.mPosList.push_back(std::pair<ymint64, ymint64>(0, 0));
+      ymint64 x = 0;
+      ymint64 y = 0;
+      for (ymuint64 i = 1; i < n; ++ i) {
+	ymint64 dx;
+	ymint64 dy;
+	r.read_gdelta(dx, dy);
+	x += dx * grid;
+	y += dy * grid;
+	rep.mPosList.push_back(std::make_pair(x, y));
+      }
+    }
+    break;
+
+  default:
+    rep.mType = 0;
+    cell.mError = "invalid repetition type";
+    return false;
+  }
+
+  if ( rep.mNx > kMaxRepetition || rep.mNy > kMaxRepetition ) {
+    rep.mType = 0;
+    cell.mError = "repetition too large";
+    return false;
+  }
+  return !r.mError;
+}
+
+// @brief PROPERTY の名前と値を読む．
+// @param[in] rtype レコード番号 ( 28 か 29 )
+// @param[in] r カーソル
+// @param[inout] modal モーダル変数
+//
+// 結果は modal の last-property-name と last-value-list に入る．
+bool
+GdsOasisParser::read_prop_values(ymuint64 rtype,
+				 Reader& r,
+				 Modal& modal) const
+{
+  if ( rtype == kOasPROPERTY_R ) {
+    // 直前のプロパティをくり返す．
+    return true;
+  }
+
+  // UUUUVCNS
+  ymuint info = r.read_byte();
+  if ( info & 0x04 ) {
+    modal.mPropNameDef = true;
+    if ( info & 0x02 ) {
+      modal.mPropNameRef = true;
+      modal.mPropNameNum = r.read_uint();
+    }
+    else {
+      modal.mPropNameRef = false;
+      r.read_string(modal.mPropNameStr);
+    }
+  }
+  if ( info & 0x08 ) {
+    // 直前の値のリストを用いる．
+    return !r.mError;
+  }
+
+  ymuint64 n = info >> 4;
+  if ( n == 15 ) {
+    n = r.read_uint();
+  }
+  if ( r.mError || n > static_cast<ymuint64>(r.mEnd - r.mCur) ) {
+    return false;
+  }
+  modal.mPropValues.clear();
+  modal.mPropValues.resize(n);
+  for (ymuint64 i = 0; i < n; ++ i) {
+    PropValue& value = modal.mPropValues[i];
+    value.mType = r.read_uint();
+    value.mUint = 0;
+    if ( value.mType <= 7 ) {
+      r.read_real_body(value.mType);
+    }
+    else if ( value.mType == 8 ) {
+      value.mUint = r.read_uint();
+    }
+    else if ( value.mType == 9 ) {
+      value.mUint = static_cast<ymuint64>(r.read_sint());
+    }
+    else if ( value.mType <= 12 ) {
+      r.read_string(value.mStr);
+    }
+    else if ( value.mType <= 15 ) {
+      value.mUint = r.read_uint();
+    }
+    else {
+      return false;
+    }
+  }
+  return !r.mError;
+}
+
+// @brief 構造の中の PROPERTY を読む．
+// @param[in] rtype レコード番号 ( 28 か 29 )
+// @param[in] r カーソル
+// @param[inout] modal モーダル変数
+// @param[inout] cell 結果を追加する構造
+//
+// S_GDS_PROPERTY なら直前の要素に付ける．
+bool
+GdsOasisParser::read_property(ymuint64 rtype,
+			      Reader& r,
+			      Modal& modal,
+			      Cell& cell) const
+{
+  if ( !read_prop_values(rtype, r, modal) ) {
+    return false;
+  }
+  if ( cell.mSkip || cell.mLastBegin == cell.mLastEnd || !modal.mPropNameDef ) {
+    return true;
+  }
+
+  if ( modal.mPropNameRef ) {
+    std::map<ymuint64, string>::const_iterator p = mPropName.find(modal.mPropNameNum);
+    if ( p == mPropName.end() || p->second != "S_GDS_PROPERTY" ) {
+      return true;
+    }
+  }
+  else if ( modal.mPropNameStr != "S_GDS_PROPERTY" ) {
+    return true;
+  }
+
+  // 値は [ 属性 (整数), 値 (文字列) ]
+  const vector<PropValue>& values = modal.mPropValues;
+  if ( values.size() != 2 || (values[0].mType != 8 && values[0].mType != 9) ) {
+    return true;
+  }
+  string value;
+  if ( values[1].mType >= 10 && values[1].mType <= 12 ) {
+    value = values[1].mStr;
+  }
+  else if ( values[1].mType >= 13 && values[1].mType <= 15 ) {
+    std::map<ymuint64, string>::const_iterator p = mPropString.find(values[1].mUint);
+    if ( p == mPropString.end() ) {
+      cell.mError = "undefined PROPSTRING reference";
+      return false;
+    }
+    value = p->second;
+  }
+  else {
+    return true;
+  }
+
+  // repetition で複製した要素はすべて同じプロパティを持つ．
+  // 同じ要素のプロパティは mPropList 中で連続している．
+  ymuint32 pos = cell.mPropList.size();
+  Prop prop;
+  prop.mAttr = values[0].mUint;
+  prop.mValue = cell.mStrList.size();
+  cell.mStrList.push_back(value);
+  cell.mPropList.push_back(prop);
+  for (ymuint32 i = cell.mLastBegin; i < cell.mLastEnd; ++ i) {
+    Elem& elem = cell.mElemList[i];
+    if ( elem.mPropNum == 0 ) {
+      elem.mPropPos = pos;
+    }
+    ++ elem.mPropNum;
+  }
+  return true;
+}
+
+// @brief 要素を repetition に従って複製しながら追加する．
+// @param[in] elem 要素
+// @param[in] x, y 基準点
+// @param[in] pts 基準点からの変位 ( dx1, dy1, dx2, dy2, ... )
+// @param[in] close 基準点を末尾に追加する時 true
+// @param[in] rep repetition
+// @param[inout] cell 結果を追加する構造
+bool
+GdsOasisParser::add_elem(Elem& elem,
+			 ymint64 x,
+			 ymint64 y,
+			 const vector<ymint64>& pts,
+			 bool close,
+			 const Rep& rep,
+			 Cell& cell) const
+{
+  if ( cell.mSkip ) {
+    return true;
+  }
+
+  bool grid = rep.mType == 1 || rep.mType == 2 || rep.mType == 3 ||
+    rep.mType == 8 || rep.mType == 9;
+  ymuint64 n = 1;
+  if ( grid ) {
+    n = rep.mNx * rep.mNy;
+  }
+  else if ( rep.mType != 0 ) {
+    n = rep.mPosList.size();
+  }
+  if ( n > kMaxRepetition ) {
+    cell.mError = "repetition too large";
+    return false;
+  }
+
+  ymuint32 np = pts.size() / 2 + 1;
+  if ( close ) {
+    ++ np;
+  }
+  cell.mLastBegin = cell.mElemList.size();
+  for (ymuint64 k = 0; k < n; ++ k) {
+    ymint64 bx = x;
+    ymint64 by = y;
+    if ( grid ) {
+      ymint64 i = k % rep.mNx;
+      ymint64 j = k / rep.mNx;
+      bx += i * rep.mCx + j * rep.mRx;
+      by += i * rep.mCy + j * rep.mRy;
+    }
+    else if ( rep.mType != 0 ) {
+      bx += rep.mPosList[k].first;
+      by += rep.mPosList[k].second;
+    }
+    elem.mXYPos = cell.mXYList.size();
+    elem.mXYNum = np;
+    bool ok = push_coord(cell.mXYList, bx, by);
+    for (ymuint i = 0; ok && i + 1 < pts.size(); i += 2) {
+      ok = push_coord(cell.mXYList, bx + pts[i], by + pts[i + 1]);
+    }
+    if ( ok && close ) {
+      ok = push_coord(cell.mXYList, bx, by);
+    }
+    if ( !ok ) {
+      cell.mError = "coordinate out of range";
+      return false;
+    }
+    cell.mElemList.push_back(elem);
+  }
+  cell.mLastEnd = cell.mElemList.size();
+  return true;
+}
+
+// @brief 多角形を追加する．
+// @param[in] modal モーダル変数 ( layer, datatype を用いる )
+// @param[in] x, y 基準点
+// @param[in] verts 基準点からの頂点の位置 ( x0, y0, x1, y1, ... )
+// @param[in] rep repetition
+// @param[inout] cell 結果を追加する構造
+bool
+GdsOasisParser::add_polygon(const Modal& modal,
+			    ymint64 x,
+			    ymint64 y,
+			    const vector<ymint64>& verts,
+			    const Rep& rep,
+			    Cell& cell) const
+{
+  if ( modal.mLayer > 32767 || modal.mDatatype > 32767 ) {
+    cell.mError = "layer or datatype out of range";
+    return false;
+  }
+
+  // 先頭の頂点からの変位にする．
+  // 面積を持たない図形もそのまま BOUNDARY にする．
+  ymint64 x0 = verts[0];
+  ymint64 y0 = verts[1];
+  vector<ymint64> pts;
+  pts.reserve(verts.size());
+  for (ymuint i = 2; i + 1 < verts.size(); i += 2) {
+    pts.push_back(verts[i] - x0);
+    pts.push_back(verts[i + 1] - y0);
+  }
+
+  Elem elem = Elem();
+  elem.mType = kGdsBOUNDARY;
+  elem.mLayer = modal.mLayer;
+  elem.mDatatype = modal.mDatatype;
+  return add_elem(elem, x + x0, y + y0, pts, true, rep, cell);
+}
+
+// @brief GdsData を作る．
+// @param[in] filename ファイル名
+bool
+GdsOasisParser::make_data(const string& filename)
+{
+  // 日付は OASIS にはないので 0 にする．
+  GdsDate* date = mBuilder.new_date();
+  date[0].set(0, 0, 0, 0, 0, 0);
+  date[1].set(0, 0, 0, 0, 0, 0);
+
+  // ライブラリ名はファイル名から拡張子を除いたもの
+  string libname = filename;
+  string::size_type pos = libname.rfind('/');
+  if ( pos != string::npos ) {
+    libname = libname.substr(pos + 1);
+  }
+  pos = libname.rfind('.');
+  if ( pos != string::npos && pos > 0 ) {
+    libname = libname.substr(0, pos);
+  }
+
+  // 格子の大きさは 1 / mUnit ミクロン
+  GdsUnits* units = mBuilder.new_units(1.0 / mUnit, 1e-6 / mUnit);
+
+  mCurData = mBuilder.new_data(600, date, 0, NULL, NULL, new_string(libname),
+			       NULL, NULL, NULL, 0, NULL, units);
+
+  GdsStruct* last = NULL;
+  for (ymuint i = 0; i < mCellList.size(); ++ i) {
+    const Cell& cell = mCellList[i];
+    string name;
+    if ( !ref_name(cell, mCellName, cell.mName, name) ) {
+      error_header(__FILE__, __LINE__, "GdsOasisParser", cell.mOffset)
+	<< "undefined CELLNAME reference";
+      msg_end();
+      return false;
+    }
+    GdsStruct* str = mBuilder.new_struct(date, new_string(name));
+    GdsBuilder::link_struct(mCurData, last, str);
+    last = str;
+    if ( !make_elements(cell, str) ) {
+      return false;
+    }
+  }
+
+  // 構造の表を作り，SREF/AREF の参照先を解決する．
+  mBuilder.make_struct_table(mCurData);
+
+  return true;
+}
+
+// @brief 構造の要素を作る．
+// @param[in] cell 読み込んだ構造
+// @param[in] str 要素を追加する構造
+bool
+GdsOasisParser::make_elements(const Cell& cell,
+			      GdsStruct* str)
+{
+  // 表の名前の GdsString は共有する．
+  std::map<ymint64, GdsString*> strname_map;
+  std::map<ymint64, GdsString*> text_map;
+
+  GdsElement* last = NULL;
+  for (ymuint i = 0; i < cell.mElemList.size(); ++ i) {
+    const Elem& e = cell.mElemList[i];
+
+    ymuint num = e.mXYNum;
+    GdsXY* xy = mBuilder.new_xy(cell.mXYList.data() + e.mXYPos, num);
+
+    GdsElement* elem = NULL;
+    switch ( e.mType ) {
+    case kGdsBOUNDARY:
+      {
+	elem = mBuilder.new_boundary(0, 0, e.mLayer, e.mDatatype, xy);
+      }
+      break;
+
+    case kGdsPATH:
+      {
+	elem = mBuilder.new_path(0, 0, e.mLayer, e.mDatatype, e.mPathtype,
+				 e.mWidth, e.mBgnExtn, e.mEndExtn, xy);
+      }
+      break;
+
+    case kGdsSREF:
+    case kGdsAREF:
+    case kGdsTEXT:
+      {
+	bool is_text = e.mType == kGdsTEXT;
+	std::map<ymint64, GdsString*>& str_map = is_text ? text_map : strname_map;
+	GdsString* name_str = NULL;
+	std::map<ymint64, GdsString*>::iterator p = str_map.find(e.mRef);
+	if ( p != str_map.end() ) {
+	  name_str = p->second;
+	}
+	else {
+	  string name;
+	  if ( !ref_name(cell, is_text ? mTextString : mCellName, e.mRef, name) ) {
+	    error_header(__FILE__, __LINE__, "GdsOasisParser", cell.mOffset)
+	      << (is_text ? "undefined TEXTSTRING reference" : "undefined CELLNAME reference");
+	    msg_end();
+	    return false;
+	  }
+	  name_str = new_string(name);
+	  if ( e.mRef >= 0 ) {
+	    str_map.insert(std::make_pair(e.mRef, name_str));
+	  }
+	}
+
+	if ( is_text ) {
+	  elem = mBuilder.new_text(0, 0, e.mLayer, e.mDatatype, 0, 0, 0, NULL, xy, name_str);
+	  break;
+	}
+
+	GdsStrans* strans = NULL;
+	if ( e.mFlip || e.mMag != 1.0 || e.mAngle != 0.0 ) {
+	  strans = mBuilder.new_strans(e.mFlip ? 0x8000 : 0, e.mMag, e.mAngle);
+	}
+	if ( e.mType == kGdsSREF ) {
+	  elem = mBuilder.new_sref(0, 0, name_str, strans, xy);
+	}
+	else {
+	  elem = mBuilder.new_aref(0, 0, name_str, strans, e.mColRow, xy);
+	}
+      }
+      break;
+
+    default:
+      ASSERT_NOT_REACHED;
+      break;
+    }
+
+    GdsProperty* last_prop = NULL;
+    for (ymuint j = 0; j < e.mPropNum; ++ j) {
+      const Prop& prop = cell.mPropList[e.mPropPos + j];
+      GdsProperty* new_prop = mBuilder.new_property(prop.mAttr, new_string(cell.mStrList[prop.mValue]));
+      GdsBuilder::link_property(elem, last_prop, new_prop);
+      last_prop = new_prop;
+    }
+
+    GdsBuilder::link_element(str, last, elem);
+    last = elem;
+  }
+
+  return true;
+}
+
+// @brief GdsString を作る．
+// @param[in] str 文字列
+GdsString*
+GdsOasisParser::new_string(const string& str)
+{
+  return mBuilder.new_string(str.c_str(), str.size());
+}
+
+// @brief 名前の参照から文字列を求める．
+// @param[in] cell 構造
+// @param[in] table 参照番号の時の表
+// @param[in] ref 名前の参照
+// @param[out] name 結果
+// @retval false 表にない参照番号だった．
+bool
+GdsOasisParser::ref_name(const Cell& cell,
+			 const std::map<ymuint64, string>& table,
+			 ymint64 ref,
+			 string& name) const
+{
+  if ( ref < 0 ) {
+    name = cell.mStrList[-1 - ref];
+    return true;
+  }
+  std::map<ymuint64, string>::const_iterator p = table.find(ref);
+  if ( p == table.end() ) {
+    return false;
+  }
+  name = p->second;
+  return true;
+}
+
+END_NAMESPACE_YM_GDS
@@ -0,0 +1,1460 @@
+﻿
+/// @file GdsOasisWriter.cc
+/// @brief GdsOasisWriter の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsOasisWriter.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsProperty.h"
+#include "YmGds/GdsPathExpander.h"
+#include "YmGds/GdsXY.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <zlib.h>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// OASIS のレコード番号
+enum {
+  kOasPAD = 0,
+  kOasSTART = 1,
+  kOasEND = 2,
+  kOasCELLNAME = 3,
+  kOasTEXTSTRING = 5,
+  kOasPROPNAME = 7,
+  kOasCELL = 13,
+  kOasXYRELATIVE = 16,
+  kOasPLACEMENT = 17,
+  kOasPLACEMENT_T = 18,
+  kOasTEXT = 19,
+  kOasRECTANGLE = 20,
+  kOasPOLYGON = 21,
+  kOasPATH = 22,
+  kOasPROPERTY = 28,
+  kOasCBLOCK = 34
+};
+
+// 一つの CBLOCK に入れるバイト数の目安
+static
+const ymuint64 kBlockSize = 1 << 20;
+
+// 一度に符号化する構造の数の最小値
+static
+const ymuint kMinBatch = 16;
+
+
+//////////////////////////////////////////////////////////////////////
+// OASIS の基本的なデータの符号化
+//////////////////////////////////////////////////////////////////////
+
+// @brief 符号なし整数を書き込む．
+static
+inline
+void
+put_uint(vector<ymuint8>& buf,
+	 ymuint64 val)
+{
+  for ( ; ; ) {
+    ymuint8 b = val & 0x7F;
+    val >>= 7;
+    if ( val == 0 ) {
+      buf.push_back(b);
+      break;
+    }
+    buf.push_back(b | 0x80);
+  }
+}
+
+// @brief 符号つき整数を書き込む．
+//
+// 符号は最下位ビットに置く．
+static
+inline
+void
+put_sint(vector<ymuint8>& buf,
+	 ymint64 val)
+{
+  if ( val < 0 ) {
+    put_uint(buf, (static_cast<ymuint64>(-val) << 1) | 1);
+  }
+  else {
+    put_uint(buf, static_cast<ymuint64>(val) << 1);
+  }
+}
+
+// @brief 実数を書き込む．
+//
+// 整数で表せる時は型 0/1 を，そうでなければ型 7 (倍精度)を用いる．
+static
+void
+put_real(vector<ymuint8>& buf,
+	 double val)
+{
+  if ( val == floor(val) && fabs(val) < 4503599627370496.0 ) {
+    if ( val >= 0.0 ) {
+      put_uint(buf, 0);
+      put_uint(buf, static_cast<ymuint64>(val));
+    }
+    else {
+      put_uint(buf, 1);
+      put_uint(buf, static_cast<ymuint64>(-val));
+    }
+    return;
+  }
+  put_uint(buf, 7);
+  ymuint64 bits;
+  memcpy(&bits, &val, sizeof(bits));
+  for (ymuint i = 0; i < 8; ++ i) {
+    buf.push_back((bits >> (i * 8)) & 0xFF);
+  }
+}
+
+// @brief 文字列を書き込む．
+static
+inline
+void
+put_string(vector<ymuint8>& buf,
+	   const char* str)
+{
+  ymuint len = strlen(str);
+  put_uint(buf, len);
+  buf.insert(buf.end(), str, str + len);
+}
+
+// @brief 8方向の方向番号を返す．
+//
+// 0: 東, 1: 北, 2: 西, 3: 南, 4: 北東, 5: 北西, 6: 南西, 7: 南東
+// 8方向でない時は 8 を返す．
+static
+inline
+ymuint
+oct_dir(ymint64 dx,
+	ymint64 dy)
+{
+  if ( dy == 0 ) {
+    return dx >= 0 ? 0 : 2;
+  }
+  if ( dx == 0 ) {
+    return dy > 0 ? 1 : 3;
+  }
+  if ( dx == dy ) {
+    return dx > 0 ? 4 : 6;
+  }
+  if ( dx == -dy ) {
+    return dx > 0 ? 7 : 5;
+  }
+  return 8;
+}
+
+// @brief g-delta を書き込む．
+static
+void
+put_gdelta(vector<ymuint8>& buf,
+	   ymint64 dx,
+	   ymint64 dy)
+{
+  ymuint dir = oct_dir(dx, dy);
+  if ( dir < 8 ) {
+    ymuint64 mag = dx != 0 ? std::abs(dx) : std::abs(dy);
+    put_uint(buf, (mag << 4) | (dir << 1));
+  }
+  else {
+    ymuint64 ux = (static_cast<ymuint64>(std::abs(dx)) << 2) | ((dx < 0) << 1) | 1;
+    put_uint(buf, ux);
+    put_sint(buf, dy);
+  }
+}
+
+// @brief 点列を書き込む．
+// @param[out] buf 出力先
+// @param[in] xy 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 点の数
+//
+// 先頭の点からの差分を書き込む．
+// すべての差分が水平か垂直なら型 2，8方向なら型 3，それ以外は型 4 を用いる．
+static
+void
+put_point_list(vector<ymuint8>& buf,
+	       const ymint64* xy,
+	       ymuint n)
+{
+  bool manhattan = true;
+  bool octangular = true;
+  for (ymuint i = 1; i < n; ++ i) {
+    ymint64 dx = xy[i * 2 + 0] - xy[i * 2 - 2];
+    ymint64 dy = xy[i * 2 + 1] - xy[i * 2 - 1];
+    if ( dx != 0 && dy != 0 ) {
+      manhattan = false;
+      if ( std::abs(dx) != std::abs(dy) ) {
+	octangular = false;
+	break;
+      }
+    }
+  }
+  ymuint type = manhattan ? 2 : octangular ? 3 : 4;
+  put_uint(buf, type);
+  put_uint(buf, n - 1);
+  for (ymuint i = 1; i < n; ++ i) {
+    ymint64 dx = xy[i * 2 + 0] - xy[i * 2 - 2];
+    ymint64 dy = xy[i * 2 + 1] - xy[i * 2 - 1];
+    if ( type == 4 ) {
+      put_gdelta(buf, dx, dy);
+      continue;
+    }
+    ymuint dir = oct_dir(dx, dy);
+    ymuint64 mag = dx != 0 ? std::abs(dx) : std::abs(dy);
+    if ( type == 2 ) {
+      put_uint(buf, (mag << 2) | dir);
+    }
+    else {
+      put_uint(buf, (mag << 3) | dir);
+    }
+  }
+}
+
+// @brief 配置位置のリストから repetition を作る．
+// @param[inout] pos_list 配置位置のリスト ( 2 個以上 )
+// @param[out] ox, oy 最初の配置位置
+// @param[out] rep repetition の符号
+//
+// 格子状なら型 1, 2, 3 を，一行に並んでいれば型 4 を，
+// それ以外は型 10 (変位のリスト) を用いる．
+// pos_list は並べ替えられる．
+static
+void
+make_repetition(vector<std::pair<ymint64, ymint64> >& pos_list,
+		ymint64& ox,
+		ymint64& oy,
+		vector<ymuint8>& rep)
+{
+  // y, x の順に並べる．
+  vector<std::pair<ymint64, ymint64> > yx_list(pos_list.size());
+  for (ymuint i = 0; i < pos_list.size(); ++ i) {
+    yx_list[i] = std::make_pair(pos_list[i].second, pos_list[i].first);
+  }
+  std::sort(yx_list.begin(), yx_list.end());
+  ymuint n = yx_list.size();
+  ox = yx_list[0].second;
+  oy = yx_list[0].first;
+
+  // 最初の行の x 座標と行の y 座標を求める．
+  vector<ymint64> x_list;
+  for (ymuint i = 0; i < n && yx_list[i].first == oy; ++ i) {
+    x_list.push_back(yx_list[i].second);
+  }
+  ymuint nx = x_list.size();
+  vector<ymint64> y_list;
+  bool grid = (n % nx) == 0;
+  for (ymuint i = 0; grid && i < n; i += nx) {
+    ymint64 y = yx_list[i].first;
+    y_list.push_back(y);
+    for (ymuint j = 0; j < nx; ++ j) {
+      if ( yx_list[i + j].first != y || yx_list[i + j].second != x_list[j] ) {
+	grid = false;
+	break;
+      }
+    }
+  }
+  ymuint ny = y_list.size();
+  ymint64 dx = nx > 1 ? x_list[1] - x_list[0] : 0;
+  ymint64 dy = ny > 1 ? y_list[1] - y_list[0] : 0;
+  for (ymuint i = 2; grid && i < nx; ++ i) {
+    grid = x_list[i] - x_list[i - 1] == dx;
+  }
+  for (ymuint i = 2; grid && i < ny; ++ i) {
+    grid = y_list[i] - y_list[i - 1] == dy;
+  }
+  // 同じ位置に重なっている時は格子とみなさない．
+  if ( grid && (nx == 1 || dx > 0) && (ny == 1 || dy > 0) ) {
+    if ( nx > 1 && ny > 1 ) {
+      put_uint(rep, 1);
+      put_uint(rep, nx - 2);
+      put_uint(rep, ny - 2);
+      put_uint(rep, dx);
+      put_uint(rep, dy);
+    }
+    else if ( nx > 1 ) {
+      put_uint(rep, 2);
+      put_uint(rep, nx - 2);
+      put_uint(rep, dx);
+    }
+    else {
+      put_uint(rep, 3);
+      put_uint(rep, ny - 2);
+      put_uint(rep, dy);
+    }
+    return;
+  }
+
+  if ( nx == n ) {
+    // すべて同じ行にある．
+    put_uint(rep, 4);
+    put_uint(rep, n - 2);
+    for (ymuint i = 1; i < n; ++ i) {
+      put_uint(rep, x_list[i] - x_list[i - 1]);
+    }
+    return;
+  }
+
+  put_uint(rep, 10);
+  put_uint(rep, n - 2);
+  for (ymuint i = 1; i < n; ++ i) {
+    put_gdelta(rep,
+	       yx_list[i].second - yx_list[i - 1].second,
+	       yx_list[i].first - yx_list[i - 1].first);
+  }
+}
+
+// @brief AREF の repetition を作る．
+// @param[in] elem AREF 要素
+// @param[out] ox, oy 最初の配置位置
+// @param[out] rep repetition の符号 (1x1 の時は空)
+static
+void
+make_aref_repetition(const GdsElement* elem,
+		     ymint64& ox,
+		     ymint64& oy,
+		     vector<ymuint8>& rep)
+{
+  const GdsXY* xy = elem->xy();
+  ymint64 nc = elem->column();
+  ymint64 nr = elem->row();
+  ox = xy->x(0);
+  oy = xy->y(0);
+  if ( nc < 1 || nr < 1 || nc * nr == 1 ) {
+    return;
+  }
+  ymint64 cdx = xy->x(1) - ox;
+  ymint64 cdy = xy->y(1) - oy;
+  ymint64 rdx = xy->x(2) - ox;
+  ymint64 rdy = xy->y(2) - oy;
+  if ( cdx % nc != 0 || cdy % nc != 0 || rdx % nr != 0 || rdy % nr != 0 ) {
+    // ピッチが整数でない時は位置を一つずつ求める．
+    vector<std::pair<ymint64, ymint64> > pos_list;
+    for (ymint64 r = 0; r < nr; ++ r) {
+      for (ymint64 c = 0; c < nc; ++ c) {
+	double x = ox + static_cast<double>(cdx) * c / nc + static_cast<double>(rdx) * r / nr;
+	double y = oy + static_cast<double>(cdy) * c / nc + static_cast<double>(rdy) * r / nr;
+	pos_list.push_back(std::make_pair(llround(x), llround(y)));
+      }
+    }
+    make_repetition(pos_list, ox, oy, rep);
+    return;
+  }
+  cdx /= nc;
+  cdy /= nc;
+  rdx /= nr;
+  rdy /= nr;
+
+  // 1行(1列)の時は使わない方の変位を 0 にしておく．
+  if ( nc == 1 ) {
+    cdx = cdy = 0;
+  }
+  if ( nr == 1 ) {
+    rdx = rdy = 0;
+  }
+  if ( cdy == 0 && rdx == 0 ) {
+    // 列が x 方向，行が y 方向
+  }
+  else if ( cdx == 0 && rdy == 0 ) {
+    // 列が y 方向，行が x 方向なので入れ替える．
+    std::swap(nc, nr);
+    std::swap(cdx, rdx);
+    std::swap(cdy, rdy);
+  }
+  else {
+    if ( nc > 1 && nr > 1 ) {
+      put_uint(rep, 8);
+      put_uint(rep, nc - 2);
+      put_uint(rep, nr - 2);
+      put_gdelta(rep, cdx, cdy);
+      put_gdelta(rep, rdx, rdy);
+    }
+    else if ( nc > 1 ) {
+      put_uint(rep, 9);
+      put_uint(rep, nc - 2);
+      put_gdelta(rep, cdx, cdy);
+    }
+    else {
+      put_uint(rep, 9);
+      put_uint(rep, nr - 2);
+      put_gdelta(rep, rdx, rdy);
+    }
+    return;
+  }
+
+  // 間隔は正でなければならないので負の時は原点を反対側に移す．
+  if ( cdx < 0 ) {
+    ox += cdx * (nc - 1);
+    cdx = -cdx;
+  }
+  if ( rdy < 0 ) {
+    oy += rdy * (nr - 1);
+    rdy = -rdy;
+  }
+  if ( nc > 1 && nr > 1 ) {
+    put_uint(rep, 1);
+    put_uint(rep, nc - 2);
+    put_uint(rep, nr - 2);
+    put_uint(rep, cdx);
+    put_uint(rep, rdy);
+  }
+  else if ( nc > 1 ) {
+    put_uint(rep, 2);
+    put_uint(rep, nc - 2);
+    put_uint(rep, cdx);
+  }
+  else {
+    put_uint(rep, 3);
+    put_uint(rep, nr - 2);
+    put_uint(rep, rdy);
+  }
+}
+
+// @brief AREF の配置の数を返す．
+static
+inline
+ymuint64
+aref_count(const GdsElement* elem)
+{
+  return static_cast<ymuint64>(std::max(elem->column(), 1)) *
+    static_cast<ymuint64>(std::max(elem->row(), 1));
+}
+
+// @brief 点列が軸に平行な長方形か調べる．
+// @param[in] xy 座標の配列 ( 4 点 )
+static
+bool
+is_rectangle(const ymint64* xy)
+{
+  bool h0 = xy[1] == xy[3];
+  for (ymuint i = 0; i < 4; ++ i) {
+    ymuint j = (i + 1) % 4;
+    bool h = ((i & 1) == 0) == h0;
+    if ( h ) {
+      if ( xy[i * 2 + 1] != xy[j * 2 + 1] || xy[i * 2] == xy[j * 2] ) {
+	return false;
+      }
+    }
+    else {
+      if ( xy[i * 2] != xy[j * 2] || xy[i * 2 + 1] == xy[j * 2 + 1] ) {
+	return false;
+      }
+    }
+  }
+  return true;
+}
+
+// @brief バイト列を raw deflate で圧縮する．
+// @param[in] data 元のデータ
+// @param[in] size サイズ
+// @param[in] level 圧縮レベル
+// @param[out] out 結果
+// @retval true 成功した．
+// @retval false 失敗した．
+static
+bool
+deflate_raw(const ymuint8* data,
+	    ymuint64 size,
+	    int level,
+	    vector<ymuint8>& out)
+{
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if ( deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK ) {
+    return false;
+  }
+  out.resize(deflateBound(&zs, size));
+  zs.next_in = const_cast<Bytef*>(data);
+  zs.avail_in = size;
+  zs.next_out = &out[0];
+  zs.avail_out = out.size();
+  int stat = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return stat == Z_STREAM_END;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsOasisWriter
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsOasisWriter::GdsOasisWriter() :
+  mThreadNum(0),
+  mCompress(true),
+  mLevel(6),
+  mMergePlacement(true),
+  mStructNum(0),
+  mHasProperty(false),
+  mFileSize(0),
+  mPlacementNum(0),
+  mInstanceNum(0),
+  mShapeNum(0),
+  mSkipNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsOasisWriter::~GdsOasisWriter()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsOasisWriter::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief CBLOCK による圧縮を行うか設定する．
+// @param[in] flag true の時圧縮する．
+// @param[in] level 圧縮レベル ( 1 - 9 )
+//
+// 既定では level 6 で圧縮する．
+void
+GdsOasisWriter::set_compress(bool flag,
+			     int level)
+{
+  mCompress = flag;
+  mLevel = level;
+}
+
+// @brief SREF を repetition にまとめるか設定する．
+// @param[in] flag true の時まとめる．
+//
+// 既定ではまとめる．
+void
+GdsOasisWriter::set_merge_placement(bool flag)
+{
+  mMergePlacement = flag;
+}
+
+// @brief ファイルに書き出す．
+// @param[in] data 対象のデータ
+// @param[in] filename ファイル名
+// @retval true 成功した．
+// @retval false 書き込みに失敗した．
+bool
+GdsOasisWriter::write(const GdsData& data,
+		      const string& filename)
+{
+  mFileSize = 0;
+  mPlacementNum = 0;
+  mInstanceNum = 0;
+  mShapeNum = 0;
+  mSkipNum = 0;
+
+  std::ofstream ofs(filename.c_str(), std::ios::out | std::ios::binary);
+  if ( !ofs ) {
+    error_header(__FILE__, __LINE__, "GdsOasisWriter", 0)
+      << filename << ": Could not create";
+    msg_end();
+    return false;
+  }
+
+  make_tables(data);
+
+  // マジック文字列と START
+  // 単位は 1 ミクロンあたりの格子の数
+  vector<ymuint8> buf;
+  const char* magic = "%SEMI-OASIS\r\n";
+  buf.insert(buf.end(), magic, magic + strlen(magic));
+  put_uint(buf, kOasSTART);
+  put_string(buf, "1.0");
+  double unit = 1e-6 / data.meter_unit();
+  double runit = floor(unit + 0.5);
+  if ( fabs(unit - runit) < unit * 1e-9 ) {
+    unit = runit;
+  }
+  put_real(buf, unit);
+  // 表の位置は END に書く．
+  put_uint(buf, 1);
+  if ( !put_file(ofs, buf) ) {
+    return false;
+  }
+
+  // 名前の表
+  // CELLNAME の表は S_CELL_OFFSET を付けるために構造の後に置く．
+  ymuint64 textstring_offset = 0;
+  if ( !mTextList.empty() ) {
+    textstring_offset = mFileSize;
+    for (ymuint i = 0; i < mTextList.size(); ++ i) {
+      put_uint(buf, kOasTEXTSTRING);
+      put_string(buf, mTextList[i].c_str());
+    }
+  }
+  // PROPNAME の参照番号 0 は S_CELL_OFFSET, 1 は S_GDS_PROPERTY
+  ymuint64 propname_offset = mFileSize + buf.size();
+  put_uint(buf, kOasPROPNAME);
+  put_string(buf, "S_CELL_OFFSET");
+  if ( mHasProperty ) {
+    put_uint(buf, kOasPROPNAME);
+    put_string(buf, "S_GDS_PROPERTY");
+  }
+  if ( !put_file(ofs, buf) ) {
+    return false;
+  }
+
+  // 構造ごとに並列に符号化する．
+  // メモリを抑えるために一度に扱う構造の数を制限する．
+  ymuint batch = std::max(get_thread_num(mThreadNum, mStructNum) * 4, kMinBatch);
+  vector<ymuint64> cell_offset(mStructNum);
+  vector<CellCode> code_list;
+  for (ymuint base = 0; base < mStructNum; base += batch) {
+    ymuint n = std::min(batch, mStructNum - base);
+    code_list.clear();
+    code_list.resize(n);
+    parallel_for(n, mThreadNum, [&](ymuint i) {
+	encode_cell(data.structure(base + i), code_list[i]);
+      });
+    for (ymuint i = 0; i < n; ++ i) {
+      CellCode& code = code_list[i];
+      if ( !code.mOk ) {
+	error_header(__FILE__, __LINE__, "GdsOasisWriter", 0)
+	  << data.structure(base + i)->name() << ": compression failed";
+	msg_end();
+	return false;
+      }
+      mPlacementNum += code.mPlacementNum;
+      mInstanceNum += code.mInstanceNum;
+      mShapeNum += code.mShapeNum;
+      mSkipNum += code.mSkipNum;
+      if ( code.mAbsWidthNum > 0 ) {
+	warning_header(__FILE__, __LINE__, "GdsOasisWriter", 0)
+	  << data.structure(base + i)->name() << ": "
+	  << code.mAbsWidthNum
+	  << " PATH(s) with absolute width written with the plain width";
+	msg_end();
+      }
+      if ( code.mAbsTransNum > 0 ) {
+	warning_header(__FILE__, __LINE__, "GdsOasisWriter", 0)
+	  << data.structure(base + i)->name() << ": "
+	  << code.mAbsTransNum
+	  << " SREF/AREF(s) with absolute magnification/angle written"
+	  << " as relative";
+	msg_end();
+      }
+      cell_offset[base + i] = mFileSize;
+      if ( !put_file(ofs, code.mBuf) ) {
+	return false;
+      }
+    }
+  }
+
+  // CELLNAME の表
+  // 定義されている構造には S_CELL_OFFSET (CELL レコードの位置)を付ける．
+  ymuint64 cellname_offset = mFileSize;
+  for (ymuint i = 0; i < mStructNum; ++ i) {
+    put_uint(buf, kOasCELLNAME);
+    put_string(buf, data.structure(i)->name());
+    put_uint(buf, kOasPROPERTY);
+    // UUUU = 1, V = 0, C = 1, N = 1, S = 1
+    buf.push_back((1 << 4) | (1 << 2) | (1 << 1) | 1);
+    put_uint(buf, 0);
+    put_uint(buf, 8);
+    put_uint(buf, cell_offset[i]);
+  }
+  for (ymuint i = 0; i < mExtraName.size(); ++ i) {
+    put_uint(buf, kOasCELLNAME);
+    put_string(buf, mExtraName[i].c_str());
+  }
+  if ( !put_file(ofs, buf) ) {
+    return false;
+  }
+
+  // END
+  // 表は CELLNAME, TEXTSTRING, PROPNAME, PROPSTRING, LAYERNAME, XNAME の順
+  // すべて strict (そこにしかない)
+  put_uint(buf, kOasEND);
+  ymuint64 offset_list[6] = {
+    cellname_offset, textstring_offset, propname_offset, 0, 0, 0
+  };
+  for (ymuint i = 0; i < 6; ++ i) {
+    put_uint(buf, 1);
+    put_uint(buf, offset_list[i]);
+  }
+  // END は全体で 256 バイトにする．
+  // 残りは padding-string と validation-scheme (0: なし)
+  // padding-string の長さが 1 バイトで足りなければ常に 2 バイトで表す．
+  // 残りが 129 バイトの時はどちらの最短表現でも合わないので
+  // 127 を冗長な 2 バイト ( 0xFF 0x00 ) で表す．
+  ymuint rest = 256 - buf.size() - 1;
+  ymuint pad;
+  if ( rest <= 128 ) {
+    pad = rest - 1;
+    put_uint(buf, pad);
+  }
+  else {
+    pad = rest - 2;
+    buf.push_back(static_cast<ymuint8>((pad & 0x7F) | 0x80));
+    buf.push_back(static_cast<ymuint8>(pad >> 7));
+  }
+  buf.insert(buf.end(), pad, 0);
+  put_uint(buf, 0);
+  if ( !put_file(ofs, buf) ) {
+    return false;
+  }
+
+  ofs.close();
+  if ( !ofs ) {
+    error_header(__FILE__, __LINE__, "GdsOasisWriter", 0)
+      << filename << ": write error";
+    msg_end();
+    return false;
+  }
+  return true;
+}
+
+// @brief 書き出したバイト数を返す．
+ymuint64
+GdsOasisWriter::file_size() const
+{
+  return mFileSize;
+}
+
+// @brief 書き出した PLACEMENT レコードの数を返す．
+ymuint64
+GdsOasisWriter::placement_num() const
+{
+  return mPlacementNum;
+}
+
+// @brief 書き出した PLACEMENT が表す配置の数を返す．
+ymuint64
+GdsOasisWriter::instance_num() const
+{
+  return mInstanceNum;
+}
+
+// @brief 書き出した図形のレコードの数を返す．
+ymuint64
+GdsOasisWriter::shape_num() const
+{
+  return mShapeNum;
+}
+
+// @brief 書き出さなかった要素の数を返す．
+//
+// NODE と面積を持たない図形の数
+ymuint64
+GdsOasisWriter::skip_num() const
+{
+  return mSkipNum;
+}
+
+// @brief 名前の表を作る．
+// @param[in] data 対象のデータ
+void
+GdsOasisWriter::make_tables(const GdsData& data)
+{
+  mStructNum = data.struct_num();
+  mExtraName.clear();
+  mExtraMap.clear();
+  mTextList.clear();
+  mTextMap.clear();
+  mHasProperty = false;
+
+  for (ymuint i = 0; i < mStructNum; ++ i) {
+    const GdsStruct* str = data.structure(i);
+    for (const GdsElement* elem = str->element(); elem != NULL; elem = elem->next()) {
+      if ( elem->property() != NULL ) {
+	mHasProperty = true;
+      }
+      GdsRtype type = elem->type();
+      if ( type == kGdsTEXT ) {
+	string text = elem->text();
+	if ( mTextMap.count(text) == 0 ) {
+	  mTextMap.insert(std::make_pair(text, mTextList.size()));
+	  mTextList.push_back(text);
+	}
+      }
+      else if ( type == kGdsSREF || type == kGdsAREF ) {
+	if ( elem->ref_struct() == NULL ) {
+	  string name = elem->strname();
+	  if ( mExtraMap.count(name) == 0 ) {
+	    mExtraMap.insert(std::make_pair(name, mStructNum + mExtraName.size()));
+	    mExtraName.push_back(name);
+	  }
+	}
+      }
+    }
+  }
+}
+
+// @brief 構造を一つ符号化する．
+// @param[in] str 対象の構造
+// @param[out] code 結果
+void
+GdsOasisWriter::encode_cell(const GdsStruct* str,
+			    CellCode& code) const
+{
+  code.mPlacementNum = 0;
+  code.mInstanceNum = 0;
+  code.mShapeNum = 0;
+  code.mSkipNum = 0;
+  code.mAbsWidthNum = 0;
+  code.mAbsTransNum = 0;
+  code.mOk = true;
+
+  // 要素を種類ごとに分ける．
+  vector<const GdsElement*> shape_list;
+  vector<const GdsElement*> text_list;
+  vector<const GdsElement*> sref_list;
+  vector<const GdsElement*> aref_list;
+  for (const GdsElement* elem = str->element(); elem != NULL; elem = elem->next()) {
+    switch ( elem->type() ) {
+    case kGdsBOUNDARY:
+    case kGdsBOX:
+      shape_list.push_back(elem);
+      break;
+
+    case kGdsPATH:
+      if ( elem->width() < 0 ) {
+	++ code.mAbsWidthNum;
+      }
+      shape_list.push_back(elem);
+      break;
+
+    case kGdsTEXT:
+      text_list.push_back(elem);
+      break;
+
+    case kGdsSREF:
+      if ( elem->absolute_magnification() || elem->absolute_angle() ) {
+	++ code.mAbsTransNum;
+      }
+      sref_list.push_back(elem);
+      break;
+
+    case kGdsAREF:
+      if ( elem->absolute_magnification() || elem->absolute_angle() ) {
+	++ code.mAbsTransNum;
+      }
+      aref_list.push_back(elem);
+      break;
+
+    default:
+      ++ code.mSkipNum;
+      break;
+    }
+  }
+
+  // 層ごとにまとめるとモーダル変数で省略できるものが増える．
+  std::stable_sort(shape_list.begin(), shape_list.end(),
+		   [](const GdsElement* a, const GdsElement* b) {
+		     int adt = a->type() == kGdsBOX ? a->boxtype() : a->datatype();
+		     int bdt = b->type() == kGdsBOX ? b->boxtype() : b->datatype();
+		     if ( a->layer() != b->layer() ) {
+		       return a->layer() < b->layer();
+		     }
+		     return adt < bdt;
+		   });
+  std::stable_sort(text_list.begin(), text_list.end(),
+		   [](const GdsElement* a, const GdsElement* b) {
+		     if ( a->layer() != b->layer() ) {
+		       return a->layer() < b->layer();
+		     }
+		     return a->texttype() < b->texttype();
+		   });
+
+  Modal modal;
+  modal.mPlacementX = 0;
+  modal.mPlacementY = 0;
+  modal.mPlacementCell = -1;
+  modal.mLayer = -1;
+  modal.mDatatype = -1;
+  modal.mTextLayer = -1;
+  modal.mTextType = -1;
+  modal.mTextX = 0;
+  modal.mTextY = 0;
+  modal.mTextString = -1;
+  modal.mGeomX = 0;
+  modal.mGeomY = 0;
+  modal.mGeomW = -1;
+  modal.mGeomH = -1;
+  modal.mHalfWidth = -1;
+  modal.mStartScheme = -1;
+  modal.mStartExt = 0;
+  modal.mEndScheme = -1;
+  modal.mEndExt = 0;
+  modal.mPropName = false;
+
+  // 本体を符号化する．
+  // 一定の大きさごとにレコードの境界で区切って CBLOCK にする．
+  vector<ymuint8> body;
+  vector<ymuint64> cut_list;
+  ymuint64 last_cut = 0;
+  put_uint(body, kOasXYRELATIVE);
+  for (ymuint i = 0; i < shape_list.size(); ++ i) {
+    encode_shape(shape_list[i], modal, body, code);
+    if ( body.size() - last_cut >= kBlockSize ) {
+      last_cut = body.size();
+      cut_list.push_back(last_cut);
+    }
+  }
+  for (ymuint i = 0; i < text_list.size(); ++ i) {
+    encode_text(text_list[i], modal, body);
+    encode_property(text_list[i], modal, body);
+    ++ code.mShapeNum;
+    if ( body.size() - last_cut >= kBlockSize ) {
+      last_cut = body.size();
+      cut_list.push_back(last_cut);
+    }
+  }
+
+  // 同じ構造を同じ変換で置いた SREF をまとめる．
+  // プロパティを持つものはまとめない．
+  std::stable_sort(sref_list.begin(), sref_list.end(),
+		   [this](const GdsElement* a, const GdsElement* b) {
+		     bool ap = a->property() != NULL;
+		     bool bp = b->property() != NULL;
+		     if ( ap != bp ) {
+		       return bp;
+		     }
+		     ymuint ac = cell_ref(a);
+		     ymuint bc = cell_ref(b);
+		     if ( ac != bc ) {
+		       return ac < bc;
+		     }
+		     if ( a->reflection() != b->reflection() ) {
+		       return b->reflection();
+		     }
+		     if ( a->angle() != b->angle() ) {
+		       return a->angle() < b->angle();
+		     }
+		     return a->mag() < b->mag();
+		   });
+  vector<ymuint8> no_rep;
+  vector<std::pair<ymint64, ymint64> > pos_list;
+  for (ymuint i = 0; i < sref_list.size(); ) {
+    const GdsElement* elem = sref_list[i];
+    ymuint j = i + 1;
+    if ( mMergePlacement && elem->property() == NULL ) {
+      ymuint c = cell_ref(elem);
+      for ( ; j < sref_list.size(); ++ j) {
+	const GdsElement* elem1 = sref_list[j];
+	if ( elem1->property() != NULL ||
+	     cell_ref(elem1) != c ||
+	     elem1->reflection() != elem->reflection() ||
+	     elem1->angle() != elem->angle() ||
+	     elem1->mag() != elem->mag() ) {
+	  break;
+	}
+      }
+    }
+    if ( j == i + 1 ) {
+      encode_placement(elem, elem->xy()->x(0), elem->xy()->y(0), no_rep, modal, body);
+      encode_property(elem, modal, body);
+    }
+    else {
+      pos_list.clear();
+      for (ymuint k = i; k < j; ++ k) {
+	const GdsXY* xy = sref_list[k]->xy();
+	pos_list.push_back(std::make_pair(xy->x(0), xy->y(0)));
+      }
+      ymint64 ox;
+      ymint64 oy;
+      vector<ymuint8> rep;
+      make_repetition(pos_list, ox, oy, rep);
+      encode_placement(elem, ox, oy, rep, modal, body);
+    }
+    ++ code.mPlacementNum;
+    code.mInstanceNum += j - i;
+    i = j;
+    if ( body.size() - last_cut >= kBlockSize ) {
+      last_cut = body.size();
+      cut_list.push_back(last_cut);
+    }
+  }
+  for (ymuint i = 0; i < aref_list.size(); ++ i) {
+    const GdsElement* elem = aref_list[i];
+    ymint64 ox;
+    ymint64 oy;
+    vector<ymuint8> rep;
+    make_aref_repetition(elem, ox, oy, rep);
+    encode_placement(elem, ox, oy, rep, modal, body);
+    encode_property(elem, modal, body);
+    ++ code.mPlacementNum;
+    code.mInstanceNum += aref_count(elem);
+    if ( body.size() - last_cut >= kBlockSize ) {
+      last_cut = body.size();
+      cut_list.push_back(last_cut);
+    }
+  }
+  if ( cut_list.empty() || cut_list.back() < body.size() ) {
+    cut_list.push_back(body.size());
+  }
+
+  // CELL の後に本体を置く．
+  vector<ymuint8>& buf = code.mBuf;
+  put_uint(buf, kOasCELL);
+  put_uint(buf, str->id());
+  if ( !mCompress ) {
+    buf.insert(buf.end(), body.begin(), body.end());
+    return;
+  }
+  ymuint64 begin = 0;
+  vector<ymuint8> cbuf;
+  for (ymuint i = 0; i < cut_list.size(); ++ i) {
+    ymuint64 end = cut_list[i];
+    ymuint64 size = end - begin;
+    if ( !deflate_raw(&body[begin], size, mLevel, cbuf) ) {
+      code.mOk = false;
+      return;
+    }
+    if ( cbuf.size() + 8 < size ) {
+      put_uint(buf, kOasCBLOCK);
+      put_uint(buf, 0);
+      put_uint(buf, size);
+      put_uint(buf, cbuf.size());
+      buf.insert(buf.end(), cbuf.begin(), cbuf.end());
+    }
+    else {
+      // 縮まない時はそのまま置く．
+      buf.insert(buf.end(), body.begin() + begin, body.begin() + end);
+    }
+    begin = end;
+  }
+}
+
+// @brief 図形の要素を一つ符号化する．
+// @param[in] elem 対象の要素 ( BOUNDARY, BOX, PATH )
+// @param[inout] modal モーダル変数
+// @param[out] buf 出力先
+// @param[inout] code 結果の統計を更新する．
+void
+GdsOasisWriter::encode_shape(const GdsElement* elem,
+			     Modal& modal,
+			     vector<ymuint8>& buf,
+			     CellCode& code) const
+{
+  const GdsXY* xy = elem->xy();
+  ymuint n = xy->num();
+  GdsRtype type = elem->type();
+  int layer = elem->layer();
+  int datatype = type == kGdsBOX ? elem->boxtype() : elem->datatype();
+
+  vector<ymint64> pts;
+  if ( type == kGdsPATH ) {
+    ymint64 width = std::abs(elem->width());
+    int pathtype = elem->pathtype();
+    if ( n < 2 || pathtype == 1 || (width & 1) ) {
+      // OASIS の PATH では表せないので多角形にする．
+      GdsPathExpander expander;
+      expander.expand(elem);
+      if ( expander.polygon_num() == 0 ) {
+	++ code.mSkipNum;
+	return;
+      }
+      for (ymuint i = 0; i < expander.polygon_num(); ++ i) {
+	ymuint np = expander.point_num(i);
+	const ymint32* data = expander.polygon_data(i);
+	pts.assign(data, data + np * 2);
+	if ( encode_polygon(layer, datatype, &pts[0], np, modal, buf) ) {
+	  encode_property(elem, modal, buf);
+	  ++ code.mShapeNum;
+	}
+	else {
+	  ++ code.mSkipNum;
+	}
+      }
+      return;
+    }
+
+    pts.resize(n * 2);
+    for (ymuint i = 0; i < n; ++ i) {
+      pts[i * 2 + 0] = xy->x(i);
+      pts[i * 2 + 1] = xy->y(i);
+    }
+    ymint64 hw = width / 2;
+    // 延長の方式 1: flush, 2: 幅の半分, 3: 明示
+    ymint64 ss = 1;
+    ymint64 sv = 0;
+    ymint64 es = 1;
+    ymint64 ev = 0;
+    if ( pathtype == 2 ) {
+      ss = es = 2;
+    }
+    else if ( pathtype == 4 ) {
+      ss = es = 3;
+      sv = elem->bgn_extn();
+      ev = elem->end_extn();
+    }
+    bool W = hw != modal.mHalfWidth;
+    bool E = ss != modal.mStartScheme || sv != modal.mStartExt ||
+      es != modal.mEndScheme || ev != modal.mEndExt;
+    vector<ymuint8> pl;
+    put_point_list(pl, &pts[0], n);
+    bool P = pl != modal.mPathList;
+    bool X = pts[0] != modal.mGeomX;
+    bool Y = pts[1] != modal.mGeomY;
+    bool D = datatype != modal.mDatatype;
+    bool L = layer != modal.mLayer;
+    put_uint(buf, kOasPATH);
+    buf.push_back((E << 7) | (W << 6) | (P << 5) | (X << 4) | (Y << 3) | (D << 1) | L);
+    if ( L ) {
+      put_uint(buf, layer);
+      modal.mLayer = layer;
+    }
+    if ( D ) {
+      put_uint(buf, datatype);
+      modal.mDatatype = datatype;
+    }
+    if ( W ) {
+      put_uint(buf, hw);
+      modal.mHalfWidth = hw;
+    }
+    if ( E ) {
+      // 変わらない方は 0 (モーダル変数を用いる)とする．
+      ymuint s1 = (ss != modal.mStartScheme || sv != modal.mStartExt) ? ss : 0;
+      ymuint e1 = (es != modal.mEndScheme || ev != modal.mEndExt) ? es : 0;
+      buf.push_back((s1 << 2) | e1);
+      if ( s1 == 3 ) {
+	put_sint(buf, sv);
+      }
+      if ( e1 == 3 ) {
+	put_sint(buf, ev);
+      }
+      modal.mStartScheme = ss;
+      modal.mStartExt = sv;
+      modal.mEndScheme = es;
+      modal.mEndExt = ev;
+    }
+    if ( P ) {
+      buf.insert(buf.end(), pl.begin(), pl.end());
+      modal.mPathList.swap(pl);
+    }
+    if ( X ) {
+      put_sint(buf, pts[0] - modal.mGeomX);
+      modal.mGeomX = pts[0];
+    }
+    if ( Y ) {
+      put_sint(buf, pts[1] - modal.mGeomY);
+      modal.mGeomY = pts[1];
+    }
+    encode_property(elem, modal, buf);
+    ++ code.mShapeNum;
+    return;
+  }
+
+  // BOUNDARY と BOX
+  // 始点と同じ終点は除く．
+  pts.reserve(n * 2);
+  for (ymuint i = 0; i < n; ++ i) {
+    pts.push_back(xy->x(i));
+    pts.push_back(xy->y(i));
+  }
+  if ( n > 1 && pts[0] == pts[n * 2 - 2] && pts[1] == pts[n * 2 - 1] ) {
+    -- n;
+  }
+  if ( type == kGdsBOX || (n == 4 && is_rectangle(&pts[0])) ) {
+    ymint64 xmin = pts[0];
+    ymint64 ymin = pts[1];
+    ymint64 xmax = pts[0];
+    ymint64 ymax = pts[1];
+    for (ymuint i = 1; i < n; ++ i) {
+      xmin = std::min(xmin, pts[i * 2 + 0]);
+      ymin = std::min(ymin, pts[i * 2 + 1]);
+      xmax = std::max(xmax, pts[i * 2 + 0]);
+      ymax = std::max(ymax, pts[i * 2 + 1]);
+    }
+    ymint64 w = xmax - xmin;
+    ymint64 h = ymax - ymin;
+    bool S = w == h;
+    bool W = w != modal.mGeomW;
+    bool H = !S && h != modal.mGeomH;
+    bool X = xmin != modal.mGeomX;
+    bool Y = ymin != modal.mGeomY;
+    bool D = datatype != modal.mDatatype;
+    bool L = layer != modal.mLayer;
+    put_uint(buf, kOasRECTANGLE);
+    buf.push_back((S << 7) | (W << 6) | (H << 5) | (X << 4) | (Y << 3) | (D << 1) | L);
+    if ( L ) {
+      put_uint(buf, layer);
+      modal.mLayer = layer;
+    }
+    if ( D ) {
+      put_uint(buf, datatype);
+      modal.mDatatype = datatype;
+    }
+    if ( W ) {
+      put_uint(buf, w);
+      modal.mGeomW = w;
+    }
+    if ( H ) {
+      put_uint(buf, h);
+    }
+    // 正方形の時は geometry-h も幅になる．
+    modal.mGeomH = h;
+    if ( X ) {
+      put_sint(buf, xmin - modal.mGeomX);
+      modal.mGeomX = xmin;
+    }
+    if ( Y ) {
+      put_sint(buf, ymin - modal.mGeomY);
+      modal.mGeomY = ymin;
+    }
+    encode_property(elem, modal, buf);
+    ++ code.mShapeNum;
+    return;
+  }
+
+  if ( encode_polygon(layer, datatype, &pts[0], n, modal, buf) ) {
+    encode_property(elem, modal, buf);
+    ++ code.mShapeNum;
+  }
+  else {
+    ++ code.mSkipNum;
+  }
+}
+
+// @brief 多角形を一つ符号化する．
+// @param[in] layer, datatype 層番号とデータ型
+// @param[in] xy 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 頂点数 ( 始点と同じ終点は含まない )
+// @param[inout] modal モーダル変数
+// @param[out] buf 出力先
+// @retval true 書き出した．
+// @retval false 頂点が少ないので書き出さなかった．
+bool
+GdsOasisWriter::encode_polygon(int layer,
+			       int datatype,
+			       const ymint64* xy,
+			       ymuint n,
+			       Modal& modal,
+			       vector<ymuint8>& buf) const
+{
+  if ( n < 3 ) {
+    return false;
+  }
+
+  vector<ymuint8> pl;
+  put_point_list(pl, xy, n);
+  bool P = pl != modal.mPolygonList;
+  bool X = xy[0] != modal.mGeomX;
+  bool Y = xy[1] != modal.mGeomY;
+  bool D = datatype != modal.mDatatype;
+  bool L = layer != modal.mLayer;
+  put_uint(buf, kOasPOLYGON);
+  buf.push_back((P << 5) | (X << 4) | (Y << 3) | (D << 1) | L);
+  if ( L ) {
+    put_uint(buf, layer);
+    modal.mLayer = layer;
+  }
+  if ( D ) {
+    put_uint(buf, datatype);
+    modal.mDatatype = datatype;
+  }
+  if ( P ) {
+    buf.insert(buf.end(), pl.begin(), pl.end());
+    modal.mPolygonList.swap(pl);
+  }
+  if ( X ) {
+    put_sint(buf, xy[0] - modal.mGeomX);
+    modal.mGeomX = xy[0];
+  }
+  if ( Y ) {
+    put_sint(buf, xy[1] - modal.mGeomY);
+    modal.mGeomY = xy[1];
+  }
+  return true;
+}
+
+// @brief TEXT を一つ符号化する．
+// @param[in] elem 対象の要素
+// @param[inout] modal モーダル変数
+// @param[out] buf 出力先
+void
+GdsOasisWriter::encode_text(const GdsElement* elem,
+			    Modal& modal,
+			    vector<ymuint8>& buf) const
+{
+  std::map<string, ymuint>::const_iterator p = mTextMap.find(elem->text());
+  ASSERT_COND( p != mTextMap.end() );
+  ymint64 ref = p->second;
+  ymint64 x = elem->xy()->x(0);
+  ymint64 y = elem->xy()->y(0);
+  int layer = elem->layer();
+  int texttype = elem->texttype();
+
+  bool C = ref != modal.mTextString;
+  bool X = x != modal.mTextX;
+  bool Y = y != modal.mTextY;
+  bool T = texttype != modal.mTextType;
+  bool L = layer != modal.mTextLayer;
+  put_uint(buf, kOasTEXT);
+  buf.push_back((C << 6) | (C << 5) | (X << 4) | (Y << 3) | (T << 1) | L);
+  if ( C ) {
+    put_uint(buf, ref);
+    modal.mTextString = ref;
+  }
+  if ( L ) {
+    put_uint(buf, layer);
+    modal.mTextLayer = layer;
+  }
+  if ( T ) {
+    put_uint(buf, texttype);
+    modal.mTextType = texttype;
+  }
+  if ( X ) {
+    put_sint(buf, x - modal.mTextX);
+    modal.mTextX = x;
+  }
+  if ( Y ) {
+    put_sint(buf, y - modal.mTextY);
+    modal.mTextY = y;
+  }
+}
+
+// @brief PLACEMENT を一つ符号化する．
+// @param[in] elem 変換を与える要素 ( SREF, AREF )
+// @param[in] x, y 配置位置
+// @param[in] rep repetition の符号 (空の時は repetition なし)
+// @param[inout] modal モーダル変数
+// @param[out] buf 出力先
+void
+GdsOasisWriter::encode_placement(const GdsElement* elem,
+				 ymint64 x,
+				 ymint64 y,
+				 const vector<ymuint8>& rep,
+				 Modal& modal,
+				 vector<ymuint8>& buf) const
+{
+  ymint64 ref = cell_ref(elem);
+  double mag = elem->mag();
+  double angle = fmod(elem->angle(), 360.0);
+  if ( angle < 0.0 ) {
+    angle += 360.0;
+  }
+  bool F = elem->reflection();
+
+  bool C = ref != modal.mPlacementCell;
+  bool X = x != modal.mPlacementX;
+  bool Y = y != modal.mPlacementY;
+  bool R = !rep.empty();
+  ymuint aa = static_cast<ymuint>(angle / 90.0);
+  if ( mag == 1.0 && angle == aa * 90.0 ) {
+    put_uint(buf, kOasPLACEMENT);
+    buf.push_back((C << 7) | (C << 6) | (X << 5) | (Y << 4) | (R << 3) | (aa << 1) | F);
+    if ( C ) {
+      put_uint(buf, ref);
+    }
+  }
+  else {
+    bool M = mag != 1.0;
+    bool A = angle != 0.0;
+    put_uint(buf, kOasPLACEMENT_T);
+    buf.push_back((C << 7) | (C << 6) | (X << 5) | (Y << 4) | (R << 3) | (M << 2) | (A << 1) | F);
+    if ( C ) {
+      put_uint(buf, ref);
+    }
+    if ( M ) {
+      put_real(buf, mag);
+    }
+    if ( A ) {
+      put_real(buf, angle);
+    }
+  }
+  modal.mPlacementCell = ref;
+  if ( X ) {
+    put_sint(buf, x - modal.mPlacementX);
+    modal.mPlacementX = x;
+  }
+  if ( Y ) {
+    put_sint(buf, y - modal.mPlacementY);
+    modal.mPlacementY = y;
+  }
+  if ( R ) {
+    if ( rep == modal.mRepetition ) {
+      // 直前と同じ repetition
+      put_uint(buf, 0);
+    }
+    else {
+      buf.insert(buf.end(), rep.begin(), rep.end());
+      modal.mRepetition = rep;
+    }
+  }
+}
+
+// @brief 要素のプロパティを符号化する．
+// @param[in] elem 対象の要素
+// @param[inout] modal モーダル変数
+// @param[out] buf 出力先
+//
+// S_GDS_PROPERTY (PROPNAME の参照番号 0) に PROPATTR と PROPVALUE を入れる．
+void
+GdsOasisWriter::encode_property(const GdsElement* elem,
+				Modal& modal,
+				vector<ymuint8>& buf) const
+{
+  for (const GdsProperty* prop = elem->property(); prop != NULL; prop = prop->next()) {
+    bool C = !modal.mPropName;
+    put_uint(buf, kOasPROPERTY);
+    // UUUU = 2 (値の数), V = 0, C, N = C, S = 1 (標準のプロパティ)
+    buf.push_back((2 << 4) | (C << 2) | (C << 1) | 1);
+    if ( C ) {
+      put_uint(buf, 1);
+      modal.mPropName = true;
+    }
+    // 型 8: 符号なし整数，型 11: b-string
+    put_uint(buf, 8);
+    put_uint(buf, prop->attr());
+    put_uint(buf, 11);
+    put_string(buf, prop->value());
+  }
+}
+
+// @brief 構造の参照番号を返す．
+// @param[in] elem SREF/AREF 要素
+ymuint
+GdsOasisWriter::cell_ref(const GdsElement* elem) const
+{
+  const GdsStruct* str = elem->ref_struct();
+  if ( str != NULL ) {
+    return str->id();
+  }
+  std::map<string, ymuint>::const_iterator p = mExtraMap.find(elem->strname());
+  ASSERT_COND( p != mExtraMap.end() );
+  return p->second;
+}
+
+// @brief ファイルに書き出す．
+// @param[in] s 出力先のストリーム
+// @param[in] buf バイト列
+//
+// buf は空にする．
+bool
+GdsOasisWriter::put_file(ostream& s,
+			 vector<ymuint8>& buf)
+{
+  if ( !buf.empty() ) {
+    s.write(reinterpret_cast<const char*>(&buf[0]), buf.size());
+    mFileSize += buf.size();
+    buf.clear();
+  }
+  if ( !s ) {
+    error_header(__FILE__, __LINE__, "GdsOasisWriter", 0)
+      << "write error";
+    msg_end();
+    return false;
+  }
+  return true;
+}
+
+END_NAMESPACE_YM_GDS
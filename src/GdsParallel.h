@@ -0,0 +1,85 @@
+﻿#ifndef GDSPARALLEL_H
+#define GDSPARALLEL_H
+
+/// @file GdsParallel.h
+/// @brief 並列処理用の関数
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include <atomic>
+#include <thread>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+/// @brief 実際に用いるスレッド数を求める．
+/// @param[in] thread_num 指定されたスレッド数
+/// @param[in] n 仕事の数
+///
+/// thread_num が 0 の時はハードウェアのスレッド数を用いる．
+/// 結果は 1 以上 n 以下になる(ただし n が 0 の時は 1)．
+inline
+ymuint
+get_thread_num(ymuint thread_num,
+	       ymuint n)
+{
+  if ( thread_num == 0 ) {
+    thread_num = std::thread::hardware_concurrency();
+  }
+  if ( thread_num > n ) {
+    thread_num = n;
+  }
+  if ( thread_num == 0 ) {
+    thread_num = 1;
+  }
+  return thread_num;
+}
+
+/// @brief 0 から n - 1 までの番号について func を並列に呼び出す．
+/// @param[in] n 仕事の数
+/// @param[in] thread_num スレッド数 ( 0 の時はハードウェアのスレッド数 )
+/// @param[in] func 番号を引数にとる関数オブジェクト
+///
+/// 番号は各スレッドが一つずつ取り出すので，仕事の大きさに偏りが
+/// あっても負荷が分散される．
+/// func は異なる番号に対して同時に呼ばれても安全でなければならない．
+template<typename Func>
+void
+parallel_for(ymuint n,
+	     ymuint thread_num,
+	     Func func)
+{
+  thread_num = get_thread_num(thread_num, n);
+  if ( thread_num == 1 ) {
+    for (ymuint i = 0; i < n; ++ i) {
+      func(i);
+    }
+    return;
+  }
+
+  std::atomic<ymuint> next(0);
+  vector<std::thread> thread_list;
+  thread_list.reserve(thread_num);
+  for (ymuint t = 0; t < thread_num; ++ t) {
+    thread_list.push_back(std::thread([&]() {
+	  for ( ; ; ) {
+	    ymuint i = next ++;
+	    if ( i >= n ) {
+	      break;
+	    }
+	    func(i);
+	  }
+	}));
+  }
+  for (ymuint t = 0; t < thread_num; ++ t) {
+    thread_list[t].join();
+  }
+}
+
+END_NAMESPACE_YM_GDS
+
+#endif // GDSPARALLEL_H
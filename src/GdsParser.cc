@@ -11,24 +11,8 @@
 #include "YmGds/Msg.h"
 #include "GdsRecTable.h"
 
-#include "YmGds/GdsACL.h"
 #include "YmGds/GdsData.h"
 #include "YmGds/GdsDate.h"
-#include "YmGds/GdsFormat.h"
-#include "YmGds/GdsProperty.h"
-#include "YmGds/GdsStrans.h"
-#include "YmGds/GdsString.h"
-#include "YmGds/GdsStruct.h"
-#include "YmGds/GdsUnits.h"
-#include "YmGds/GdsXY.h"
-
-#include "GdsAref.h"
-#include "GdsBoundary.h"
-#include "GdsBox.h"
-#include "GdsNode.h"
-#include "GdsPath.h"
-#include "GdsSref.h"
-#include "GdsText.h"
 
 
 #if 0
@@ -46,7 +30,9 @@ BEGIN_NAMESPACE_YM_GDS
 
 // @brief コンストラクタ
 GdsParser::GdsParser() :
-  mAlloc(4096)
+  mCurData(NULL),
+  mRecover(false),
+  mDropNum(0)
 {
 }
 
@@ -62,13 +48,20 @@ GdsParser::~GdsParser()
 bool
 GdsParser::parse(const string& filename)
 {
+  mCurData = NULL;
+
+  // ファイルを開く前に中断されていたら何もしない．
+  if ( mScanner.cancelled() ) {
+    return false;
+  }
+
   if ( !mScanner.open_file(filename) ) {
     return false;
   }
 
-  mCurData = NULL;
   mFormatType = 0;
   mMasks.clear();
+  mDropNum = 0;
 
   bool stat = true;
 
@@ -77,34 +70,160 @@ GdsParser::parse(const string& filename)
     goto end;
   }
 
+  if ( !mScanner.read_rec() ) {
+    stat = false;
+    goto end;
+  }
+
   for ( ; ; ) {
-    if ( !mScanner.read_rec() ) {
-      stat = false;
-      goto end;
-    }
+    // read_structure() は ENDSTR の次のレコードまで読み進めている．
     if ( mScanner.cur_rtype() == kGdsBGNSTR ) {
+      GdsStruct* prev_struct = mCurStruct;
+      ymuint32 offset = mScanner.cur_offset();
       if ( !read_structure() ) {
-	stat = false;
-	goto end;
+	if ( !mRecover || mScanner.cancelled() ) {
+	  stat = false;
+	  goto end;
+	}
+	// 読みかけの構造を捨てる．
+	if ( mCurStruct != prev_struct ) {
+	  GdsBuilder::link_struct(mCurData, prev_struct, NULL);
+	  mCurStruct = prev_struct;
+	}
+	++ mDropNum;
+	error_header(__FILE__, __LINE__, "GdsParser", offset)
+	  << "syntax error in structure, dropped";
+	msg_end();
+	if ( !recover(offset) ) {
+	  break;
+	}
       }
     }
     else if ( mScanner.cur_rtype() == kGdsENDLIB ) {
+      make_struct_table();
       break;
     }
     else {
       // error
-      stat = false;
-      goto end;
+      if ( !mRecover || mScanner.cancelled() ) {
+	stat = false;
+	goto end;
+      }
+      error_header(__FILE__, __LINE__, "GdsParser", mScanner.cur_offset())
+	<< "BGNSTR or ENDLIB expected";
+      msg_end();
+      if ( !recover(mScanner.cur_offset()) ) {
+	break;
+      }
     }
   }
 
  end:
 
+  if ( mScanner.cancelled() ) {
+    stat = false;
+  }
+
+  mScanner.report_progress();
   mScanner.close_file();
 
+  if ( !stat ) {
+    mCurData = NULL;
+  }
+
   return stat;
 }
 
+// @brief 読み込んだデータを返す．
+//
+// parse() が失敗した場合には NULL を返す．
+// 返り値はこのオブジェクトが破壊されるまで有効．
+const GdsData*
+GdsParser::data() const
+{
+  return mCurData;
+}
+
+// @brief 回復モードを設定する．
+// @param[in] flag true の時誤りのある構造を捨てて読み込みを続ける．
+void
+GdsParser::set_recover(bool flag)
+{
+  mRecover = flag;
+  mScanner.set_recover(flag);
+}
+
+// @brief 直前の parse() で捨てた構造の数を返す．
+ymuint
+GdsParser::drop_num() const
+{
+  return mDropNum;
+}
+
+// @brief 直前の parse() で不正なレコードを読み飛ばした回数を返す．
+ymuint
+GdsParser::skip_num() const
+{
+  return mScanner.recover_num();
+}
+
+// @brief 進み具合を受け取るハンドラを登録する．
+// @param[in] handler ハンドラ (NULL の時は登録を解除する)
+// @param[in] interval ハンドラを呼ぶ最小の間隔 (秒)
+void
+GdsParser::set_progress(GdsProgressHandler* handler,
+			double interval)
+{
+  mScanner.set_progress(handler, interval);
+}
+
+// @brief 読み込みを中断する．
+void
+GdsParser::cancel()
+{
+  mScanner.cancel();
+}
+
+// @brief 中断を解除する．
+void
+GdsParser::reset_cancel()
+{
+  mScanner.reset_cancel();
+}
+
+// @brief 中断されていたら true を返す．
+bool
+GdsParser::cancelled() const
+{
+  return mScanner.cancelled();
+}
+
+// @brief 誤りのあった構造の後で次の構造を探す．
+// @param[in] offset 誤りのあった構造の BGNSTR のオフセット
+// @retval true 次の BGNSTR か ENDLIB が見つかった．
+// @retval false 末尾に達した．
+//
+// 末尾に達した場合にはそれまでに読めた構造で構造表を作る．
+bool
+GdsParser::recover(ymuint32 offset)
+{
+  // 構造の途中で次の BGNSTR か ENDLIB を読んで失敗した場合は
+  // そこから読み直せばよい．
+  GdsRtype rtype = mScanner.cur_rtype();
+  bool found = ( (rtype == kGdsBGNSTR && mScanner.cur_offset() != offset) ||
+		 rtype == kGdsENDLIB );
+  if ( !found ) {
+    found = mScanner.skip_to_structure();
+  }
+  if ( !found && !mScanner.cancelled() ) {
+    warning_header(__FILE__, __LINE__, "GdsParser", mScanner.cur_pos())
+      << "ENDLIB not found";
+    msg_end();
+    make_struct_table();
+  }
+  return found;
+}
+
 bool
 GdsParser::read_header()
 {
@@ -249,9 +368,8 @@ GdsParser::read_header()
   }
   GdsUnits* units = new_units();
 
-  void* p = mAlloc.get_memory(sizeof(GdsData));
-  mCurData = new (p) GdsData(version, date, libdirsize, srfname, acl, libname,
-			     reflibs, fonts, attrtable, generations, format, units);
+  mCurData = mBuilder.new_data(version, date, libdirsize, srfname, acl, libname,
+				reflibs, fonts, attrtable, generations, format, units);
   mCurStruct = NULL;
 
   return true;
@@ -274,15 +392,8 @@ GdsParser::read_structure()
 
   GdsString* strname = new_string();
 
-  void* p = mAlloc.get_memory(sizeof(GdsStruct));
-  GdsStruct* str = new (p) GdsStruct(date, strname);
-
-  if ( mCurStruct ) {
-    mCurStruct->mLink = str;
-  }
-  else {
-    mCurData->mStruct = str;
-  }
+  GdsStruct* str = mBuilder.new_struct(date, strname);
+  GdsBuilder::link_struct(mCurData, mCurStruct, str);
   mCurStruct = str;
 
   mCurElement = NULL;
@@ -446,10 +557,11 @@ GdsParser::read_boundary()
   }
   GdsXY* xy = new_xy();
 
-  void* p = mAlloc.get_memory(sizeof(GdsBoundary));
-  GdsBoundary* boundary = new (p) GdsBoundary(elflags, plex, layer, datatype, xy);
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
 
-  add_element(boundary);
+  add_element(mBuilder.new_boundary(elflags, plex, layer, datatype, xy));
 
   return true;
 }
@@ -549,10 +661,11 @@ GdsParser::read_path()
   }
   GdsXY* xy = new_xy();
 
-  void* p = mAlloc.get_memory(sizeof(GdsPath));
-  GdsPath* path = new (p) GdsPath(elflags, plex, layer, datatype, pathtype, width, bgn_extn, end_extn, xy);
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
 
-  add_element(path);
+  add_element(mBuilder.new_path(elflags, plex, layer, datatype, pathtype, width, bgn_extn, end_extn, xy));
 
   return true;
 }
@@ -592,6 +705,10 @@ GdsParser::read_sref()
   }
   GdsString* strname = new_string();
 
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
+
   // [ STRANS [ MAG ] [ ANGLE ] ]
   GdsStrans* strans = NULL;
   if ( !read_strans(strans) ) {
@@ -604,10 +721,11 @@ GdsParser::read_sref()
   }
   GdsXY* xy = new_xy();
 
-  void* p = mAlloc.get_memory(sizeof(GdsSref));
-  GdsSref* sref = new (p) GdsSref(elflags, plex, strname, strans, xy);
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
 
-  add_element(sref);
+  add_element(mBuilder.new_sref(elflags, plex, strname, strans, xy));
 
   return true;
 }
@@ -647,6 +765,10 @@ GdsParser::read_aref()
   }
   GdsString* strname = new_string();
 
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
+
   // [ STRANS [ MAG ] [ ANGLE ] ]
   GdsStrans* strans = NULL;
   if ( !read_strans(strans) ) {
@@ -669,10 +791,11 @@ GdsParser::read_aref()
   }
   GdsXY* xy = new_xy();
 
-  void* p = mAlloc.get_memory(sizeof(GdsAref));
-  GdsAref* aref = new (p) GdsAref(elflags, plex, strname, strans, colrow, xy);
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
 
-  add_element(aref);
+  add_element(mBuilder.new_aref(elflags, plex, strname, strans, colrow, xy));
 
   return true;
 }
@@ -722,6 +845,10 @@ GdsParser::read_text()
   }
   ymint16 texttype = new_int2();
 
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
+
   // [ PRESENTATION ]
   ymuint16 presentation = 0;
   if ( mScanner.cur_rtype() == kGdsPRESENTATION ) {
@@ -764,16 +891,21 @@ GdsParser::read_text()
   }
   GdsXY* xy = new_xy();
 
-  // TEXT
-  if ( mScanner.cur_rtype() != kGdsTEXT ) {
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
+
+  // STRING
+  if ( mScanner.cur_rtype() != kGdsSTRING ) {
     return false;
   }
   GdsString* body = new_string();
 
-  void* p = mAlloc.get_memory(sizeof(GdsText));
-  GdsText* text = new (p) GdsText(elflags, plex, layer, texttype, presentation, pathtype, width, strans, xy, body);
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
 
-  add_element(text);
+  add_element(mBuilder.new_text(elflags, plex, layer, texttype, presentation, pathtype, width, strans, xy, body));
 
   return true;
 }
@@ -833,10 +965,11 @@ GdsParser::read_node()
   }
   GdsXY* xy = new_xy();
 
-  void* p = mAlloc.get_memory(sizeof(GdsNode));
-  GdsNode* node = new (p) GdsNode(elflags, plex, layer, nodetype, xy);
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
 
-  add_element(node);
+  add_element(mBuilder.new_node(elflags, plex, layer, nodetype, xy));
 
   return true;
 }
@@ -896,10 +1029,11 @@ GdsParser::read_box()
   }
   GdsXY* xy = new_xy();
 
-  void* p = mAlloc.get_memory(sizeof(GdsBox));
-  GdsBox* box = new (p) GdsBox(elflags, plex, layer, boxtype, xy);
+  if ( !mScanner.read_rec() ) {
+    return false;
+  }
 
-  add_element(box);
+  add_element(mBuilder.new_box(elflags, plex, layer, boxtype, xy));
 
   return true;
 }
@@ -943,8 +1077,7 @@ GdsParser::read_strans(GdsStrans*& strans)
     }
   }
 
-  void* p = mAlloc.get_memory(sizeof(GdsStrans));
-  strans = new (p) GdsStrans(flags, mag, angle);
+  strans = mBuilder.new_strans(flags, mag, angle);
 
   return true;
 }
@@ -953,17 +1086,21 @@ GdsParser::read_strans(GdsStrans*& strans)
 void
 GdsParser::add_element(GdsElement* elem)
 {
-  if ( mCurElement ) {
-    mCurElement->mLink = elem;
-  }
-  else {
-    mCurStruct->mElement = elem;
-  }
+  GdsBuilder::link_element(mCurStruct, mCurElement, elem);
   mCurElement = elem;
 
   mCurProperty = NULL;
 }
 
+// @brief 構造の表を作り，参照を解決する．
+//
+// 全ての構造を読み込んだ後で呼ばれる．
+void
+GdsParser::make_struct_table()
+{
+  mBuilder.make_struct_table(mCurData);
+}
+
 // @brief GdsProperty の作成
 // @param[in] attr PROPATTR の値
 // @param[in] value PROPVALUE の値
@@ -971,15 +1108,8 @@ void
 GdsParser::add_property(ymuint attr,
 			GdsString* value)
 {
-  void* p = mAlloc.get_memory(sizeof(GdsProperty));
-  GdsProperty* prop = new (p) GdsProperty(attr, value);
-
-  if ( mCurProperty ) {
-    mCurProperty->mLink = prop;
-  }
-  else {
-    mCurElement->mProperty = prop;
-  }
+  GdsProperty* prop = mBuilder.new_property(attr, value);
+  GdsBuilder::link_property(mCurElement, mCurProperty, prop);
   mCurProperty = prop;
 }
 
@@ -1048,14 +1178,7 @@ GdsParser::new_format(ymint16 format_type,
   if ( format_type == 0 && masks.empty() ) {
     return NULL;
   }
-  ymuint nm = masks.size();
-  void* p = mAlloc.get_memory(sizeof(GdsFormat) + (nm - 1) * sizeof(GdsString*));
-  GdsFormat* format = new (p) GdsFormat(format_type);
-  format->mMaskNum = nm;
-  for (ymuint i = 0; i < nm; ++ i) {
-    format->mMasks[i] = masks[i];
-  }
-  return format;
+  return mBuilder.new_format(format_type, masks);
 }
 
 // @brief GdsACL の作成
@@ -1065,18 +1188,14 @@ GdsParser::new_acl()
   ymuint dsize = mScanner.cur_dsize();
   ASSERT_COND( dsize % 6 == 0 );
   ymuint n = dsize / 6;
+  // 後ろから作ってつなぐ．
   GdsACL* top = NULL;
-  GdsACL** pprev = &top;
-  for (ymuint i = 0; i < n; ++ i) {
+  for (ymuint i = n; i -- > 0; ) {
     ymuint group = mScanner.conv_2byte_int(i * 3 + 0);
     ymuint user = mScanner.conv_2byte_int(i * 3 + 1);
     ymuint access = mScanner.conv_2byte_int(i * 3 + 2);
-    void* p = mAlloc.get_memory(sizeof(GdsACL));
-    GdsACL* acl = new (p) GdsACL(group, user, access);
-    *pprev = acl;
-    pprev = &acl->mNext;
+    top = mBuilder.new_acl(group, user, access, top);
   }
-  *pprev = NULL;
 
   return top;
 }
@@ -1094,8 +1213,7 @@ GdsParser::new_colrow()
 GdsDate*
 GdsParser::new_date()
 {
-  void* p = mAlloc.get_memory(sizeof(GdsDate[2]));
-  GdsDate* date = new (p) GdsDate[2];
+  GdsDate* date = mBuilder.new_date();
   ymuint year1 = mScanner.conv_2byte_int(0);
   ymuint month1 = mScanner.conv_2byte_int(1);
   ymuint day1 = mScanner.conv_2byte_int(2);
@@ -1128,15 +1246,7 @@ GdsParser::new_string()
     }
   }
 
-  void* p = mAlloc.get_memory(sizeof(GdsString) + len);
-  GdsString* str = new (p) GdsString;
-
-  for (ymuint i = 0; i < len; ++ i) {
-    str->mStr[i] = src_str[i];
-  }
-  str->mStr[len] = '\0';
-
-  return str;
+  return mBuilder.new_string(src_str, len);
 }
 
 // @brief GdsUnits の作成
@@ -1146,10 +1256,7 @@ GdsParser::new_units()
   double user = mScanner.conv_8byte_real(0);
   double meter = mScanner.conv_8byte_real(1);
 
-  void* p = mAlloc.get_memory(sizeof(GdsUnits));
-  GdsUnits* units = new (p) GdsUnits(user, meter);
-
-  return units;
+  return mBuilder.new_units(user, meter);
 }
 
 // @brief GdsXY の作成
@@ -1160,15 +1267,12 @@ GdsParser::new_xy()
   ASSERT_COND( dsize % 8 == 0 );
   ymuint num = dsize / 4;
 
-  void* p = mAlloc.get_memory(sizeof(GdsXY) + sizeof(ymint32) * (num - 1));
-  GdsXY* xy = new (p) GdsXY();
-
-  xy->mNum = num / 2;
+  mXYBuff.resize(num);
   for (ymuint i = 0; i < num; ++ i) {
-    xy->mData[i] = mScanner.conv_4byte_int(i);
+    mXYBuff[i] = mScanner.conv_4byte_int(i);
   }
 
-  return xy;
+  return mBuilder.new_xy(mXYBuff.data(), num / 2);
 }
 
 // @brief int2 の作成
@@ -51,6 +51,13 @@ GdsPath::~GdsPath()
 {
 }
 
+// @brief 要素の種類を返す．
+GdsRtype
+GdsPath::type() const
+{
+  return kGdsPATH;
+}
+
 // 層番号を返す．
 int
 GdsPath::layer() const
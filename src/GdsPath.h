@@ -21,7 +21,7 @@ BEGIN_NAMESPACE_YM_GDS
 class GdsPath :
   public GdsElement
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 private:
 
@@ -54,6 +54,11 @@ public:
   // 外部インターフェイス
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief 要素の種類を返す．
+  virtual
+  GdsRtype
+  type() const;
+
   /// @brief 層番号を返す．
   virtual
   int
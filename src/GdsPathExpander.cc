@@ -0,0 +1,326 @@
+﻿
+/// @file GdsPathExpander.cc
+/// @brief GdsPathExpander の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsPathExpander.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsXY.h"
+#include <cmath>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// 方向が一致しているとみなす閾値
+static
+const double kEps = 1.0e-12;
+
+// @brief 2点間の単位方向ベクトルを求める．
+// @param[in] center 中心線の座標の配列
+// @param[in] i 始点の位置番号
+// @param[out] dx, dy 結果
+static
+void
+unit_dir(const vector<double>& center,
+	 ymuint i,
+	 double& dx,
+	 double& dy)
+{
+  double x = center[i * 2 + 2] - center[i * 2 + 0];
+  double y = center[i * 2 + 3] - center[i * 2 + 1];
+  double len = sqrt(x * x + y * y);
+  dx = x / len;
+  dy = y / len;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsPathExpander
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsPathExpander::GdsPathExpander() :
+  mRoundSegments(16)
+{
+}
+
+// @brief デストラクタ
+GdsPathExpander::~GdsPathExpander()
+{
+}
+
+// @brief 半円を近似する辺の数を設定する．
+// @param[in] num 辺の数 ( 2 以上 )
+void
+GdsPathExpander::set_round_segments(ymuint num)
+{
+  mRoundSegments = num < 2 ? 2 : num;
+}
+
+// @brief 結果をクリアする．
+void
+GdsPathExpander::clear()
+{
+  mPool.clear();
+  mPolygonList.clear();
+}
+
+// @brief PATH を一つ展開して結果に追加する．
+// @param[in] elem 対象の要素 ( PATH )
+// @retval true 多角形を追加した．
+// @retval false 面積を持たないので追加しなかった．
+bool
+GdsPathExpander::expand(const GdsElement* elem)
+{
+  ASSERT_COND( elem->type() == kGdsPATH );
+
+  // 負の幅は絶対値とみなす．
+  double hw = fabs(static_cast<double>(elem->width())) * 0.5;
+  if ( hw == 0.0 ) {
+    return false;
+  }
+
+  // 連続する重複点を取り除く．
+  const GdsXY* xy = elem->xy();
+  ymuint np = xy->num();
+  mCenter.clear();
+  for (ymuint i = 0; i < np; ++ i) {
+    double x = xy->x(i);
+    double y = xy->y(i);
+    ymuint n = mCenter.size();
+    if ( n > 0 && mCenter[n - 2] == x && mCenter[n - 1] == y ) {
+      continue;
+    }
+    mCenter.push_back(x);
+    mCenter.push_back(y);
+  }
+  ymuint m = mCenter.size() / 2;
+  if ( m == 0 ) {
+    return false;
+  }
+
+  int pathtype = elem->pathtype();
+  double bgn_ext = 0.0;
+  double end_ext = 0.0;
+  if ( pathtype == 2 ) {
+    bgn_ext = hw;
+    end_ext = hw;
+  }
+  else if ( pathtype == 4 ) {
+    bgn_ext = elem->bgn_extn();
+    end_ext = elem->end_extn();
+  }
+
+  // 最初と最後の辺の方向
+  // 1点だけの場合は x 軸の正の方向とみなす．
+  double bdx = 1.0;
+  double bdy = 0.0;
+  double edx = 1.0;
+  double edy = 0.0;
+  if ( m > 1 ) {
+    unit_dir(mCenter, 0, bdx, bdy);
+    unit_dir(mCenter, m - 2, edx, edy);
+  }
+  else if ( pathtype != 1 && bgn_ext + end_ext <= 0.0 ) {
+    return false;
+  }
+
+  // 延長後の始点と終点
+  double sx = mCenter[0] - bdx * bgn_ext;
+  double sy = mCenter[1] - bdy * bgn_ext;
+  double ex = mCenter[m * 2 - 2] + edx * end_ext;
+  double ey = mCenter[m * 2 - 1] + edy * end_ext;
+
+  Polygon polygon;
+  polygon.mPos = mPool.size() / 2;
+  polygon.mElem = elem;
+
+  // 右側を順方向にたどる．
+  put_point(sx + bdy * hw, sy - bdx * hw);
+  for (ymuint i = 1; i + 1 < m; ++ i) {
+    double dx1, dy1, dx2, dy2;
+    unit_dir(mCenter, i - 1, dx1, dy1);
+    unit_dir(mCenter, i, dx2, dy2);
+    put_join(mCenter[i * 2], mCenter[i * 2 + 1], dx1, dy1, dx2, dy2, -hw);
+  }
+  put_point(ex + edy * hw, ey - edx * hw);
+
+  if ( pathtype == 1 ) {
+    put_arc(ex, ey, hw, atan2(-edx, edy));
+  }
+
+  // 左側を逆方向にたどる．
+  // 逆向きの経路の右側とみなせる．
+  put_point(ex - edy * hw, ey + edx * hw);
+  for (ymuint i = m - 1; i -- > 1; ) {
+    double dx1, dy1, dx2, dy2;
+    unit_dir(mCenter, i, dx1, dy1);
+    unit_dir(mCenter, i - 1, dx2, dy2);
+    put_join(mCenter[i * 2], mCenter[i * 2 + 1], -dx1, -dy1, -dx2, -dy2, -hw);
+  }
+  put_point(sx - bdy * hw, sy + bdx * hw);
+
+  if ( pathtype == 1 ) {
+    put_arc(sx, sy, hw, atan2(bdx, -bdy));
+  }
+
+  // 始点と重なる終点を取り除く．
+  ymuint num = mPool.size() / 2 - polygon.mPos;
+  if ( num > 1 &&
+       mPool[polygon.mPos * 2] == mPool[mPool.size() - 2] &&
+       mPool[polygon.mPos * 2 + 1] == mPool[mPool.size() - 1] ) {
+    mPool.resize(mPool.size() - 2);
+    -- num;
+  }
+  if ( num < 3 ) {
+    mPool.resize(polygon.mPos * 2);
+    return false;
+  }
+  polygon.mNum = num;
+  mPolygonList.push_back(polygon);
+
+  return true;
+}
+
+// @brief 構造中のすべての PATH を展開して結果に追加する．
+// @param[in] str 対象の構造
+void
+GdsPathExpander::expand_struct(const GdsStruct* str)
+{
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    if ( elem->type() == kGdsPATH ) {
+      expand(elem);
+    }
+  }
+}
+
+// @brief 多角形の数を返す．
+ymuint
+GdsPathExpander::polygon_num() const
+{
+  return mPolygonList.size();
+}
+
+// @brief 多角形の頂点数を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+ymuint
+GdsPathExpander::point_num(ymuint pos) const
+{
+  ASSERT_COND( pos < polygon_num() );
+  return mPolygonList[pos].mNum;
+}
+
+// @brief 多角形の座標の配列を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+//
+// x0, y0, x1, y1, ... の順に point_num(pos) * 2 個の要素を持つ．
+// 次に expand() を呼ぶまで有効．
+const ymint32*
+GdsPathExpander::polygon_data(ymuint pos) const
+{
+  ASSERT_COND( pos < polygon_num() );
+  return &mPool[mPolygonList[pos].mPos * 2];
+}
+
+// @brief 多角形の元になった要素を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < polygon_num() )
+const GdsElement*
+GdsPathExpander::polygon_elem(ymuint pos) const
+{
+  ASSERT_COND( pos < polygon_num() );
+  return mPolygonList[pos].mElem;
+}
+
+// @brief 点をプールに追加する．
+// @param[in] x, y 座標
+//
+// 直前の点と同じ場合には追加しない．
+void
+GdsPathExpander::put_point(double x,
+			   double y)
+{
+  ymint32 ix = static_cast<ymint32>(llround(x));
+  ymint32 iy = static_cast<ymint32>(llround(y));
+  ymuint n = mPool.size();
+  ymuint base = mPolygonList.empty() ? 0 :
+    (mPolygonList.back().mPos + mPolygonList.back().mNum) * 2;
+  if ( n > base && mPool[n - 2] == ix && mPool[n - 1] == iy ) {
+    return;
+  }
+  mPool.push_back(ix);
+  mPool.push_back(iy);
+}
+
+// @brief 円弧をプールに追加する．
+// @param[in] cx, cy 中心の座標
+// @param[in] r 半径
+// @param[in] theta 開始角度(ラジアン)
+//
+// 開始点と終了点を除いて theta から反時計回りに半周する．
+void
+GdsPathExpander::put_arc(double cx,
+			 double cy,
+			 double r,
+			 double theta)
+{
+  double step = M_PI / mRoundSegments;
+  for (ymuint k = 1; k < mRoundSegments; ++ k) {
+    double a = theta + step * k;
+    put_point(cx + r * cos(a), cy + r * sin(a));
+  }
+}
+
+// @brief 片側の折れ曲がり部分の点をプールに追加する．
+// @param[in] px, py 中心線上の点
+// @param[in] dx1, dy1 前の辺の単位方向ベクトル
+// @param[in] dx2, dy2 次の辺の単位方向ベクトル
+// @param[in] hw 中心線からの符号付き距離(左側が正)
+void
+GdsPathExpander::put_join(double px,
+			  double py,
+			  double dx1,
+			  double dy1,
+			  double dx2,
+			  double dy2,
+			  double hw)
+{
+  double cross = dx1 * dy2 - dy1 * dx2;
+  double dot = dx1 * dx2 + dy1 * dy2;
+
+  // 各辺をずらした時のずれ
+  double ox1 = -dy1 * hw;
+  double oy1 =  dx1 * hw;
+  double ox2 = -dy2 * hw;
+  double oy2 =  dx2 * hw;
+
+  if ( fabs(cross) < kEps && dot > 0.0 ) {
+    // 直進なので点は不要
+    return;
+  }
+
+  // 折り返しの場合は両側とも外側とみなす．
+  bool outer = (cross * hw < 0.0) || (fabs(cross) < kEps);
+  if ( outer && dot < 0.0 ) {
+    // 90度より鋭い角の外側は中心線から幅の半分の位置で切り落とす．
+    double ahw = fabs(hw);
+    put_point(px + ox1 + dx1 * ahw, py + oy1 + dy1 * ahw);
+    put_point(px + ox2 - dx2 * ahw, py + oy2 - dy2 * ahw);
+    return;
+  }
+
+  double denom = 1.0 + dot;
+  if ( denom < kEps ) {
+    put_point(px + ox1, py + oy1);
+    put_point(px + ox2, py + oy2);
+    return;
+  }
+  // 2本のずらした辺の交点
+  put_point(px + (ox1 + ox2) / denom, py + (oy1 + oy2) / denom);
+}
+
+END_NAMESPACE_YM_GDS
@@ -0,0 +1,854 @@
+﻿
+/// @file GdsRaster.cc
+/// @brief GdsRaster の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsRaster.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsHier.h"
+#include "YmGds/GdsPathExpander.h"
+#include "YmGds/GdsXY.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <algorithm>
+#include <cmath>
+#include <zlib.h>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// 一つの帯の行数
+static
+const ymuint kBandRows = 16;
+
+// 色を指定されなかった層に順に割り当てる色
+static
+const ymuint32 kPalette[] = {
+  0xFF4040, 0x4090FF, 0x40D040, 0xFFD040,
+  0xD050FF, 0x40E0E0, 0xFF8020, 0xA0A0A0,
+  0xFF80C0, 0x90FF90, 0x8080FF, 0xC0C040,
+  0x20A080, 0xC06040, 0x6040C0, 0xFFFFFF
+};
+
+// @brief 図形の (layer, datatype) を表すキーを返す．
+// @param[in] elem 対象の要素 ( BOUNDARY/BOX/PATH )
+static
+ymuint32
+elem_key(const GdsElement* elem)
+{
+  int dt = elem->type() == kGdsBOX ? elem->boxtype() : elem->datatype();
+  return (static_cast<ymuint32>(elem->layer() & 0xFFFF) << 16) |
+    static_cast<ymuint32>(dt & 0xFFFF);
+}
+
+// @brief 図形の要素の時 true を返す．
+static
+bool
+is_shape(const GdsElement* elem)
+{
+  GdsRtype type = elem->type();
+  return type == kGdsBOUNDARY || type == kGdsBOX || type == kGdsPATH;
+}
+
+// @brief 配列の中で範囲と重なる要素の番号の範囲を求める．
+// @param[in] lo, hi 0番めの要素の区間
+// @param[in] step 要素ごとのずれ
+// @param[in] a, b 範囲
+// @param[inout] k0, k1 番号の範囲 ( k0 <= k < k1 )
+//
+// k 番めの要素の区間は [lo + k * step, hi + k * step] となる．
+// 結果は k0, k1 の元の範囲との共通部分になる．
+static
+void
+index_range(double lo,
+	    double hi,
+	    double step,
+	    double a,
+	    double b,
+	    ymuint& k0,
+	    ymuint& k1)
+{
+  double t0;
+  double t1;
+  if ( step == 0.0 ) {
+    if ( hi < a || lo > b ) {
+      k1 = k0;
+    }
+    return;
+  }
+  if ( step > 0.0 ) {
+    t0 = (a - hi) / step;
+    t1 = (b - lo) / step;
+  }
+  else {
+    t0 = (b - lo) / step;
+    t1 = (a - hi) / step;
+  }
+  t0 = ceil(t0);
+  t1 = floor(t1) + 1.0;
+  if ( t0 > k0 ) {
+    k0 = t0 < k1 ? static_cast<ymuint>(t0) : k1;
+  }
+  if ( t1 < k1 ) {
+    k1 = t1 > k0 ? static_cast<ymuint>(t1) : k0;
+  }
+}
+
+// @brief 32ビットの整数をビッグエンディアンで追加する．
+static
+void
+put_be32(vector<ymuint8>& buf,
+	 ymuint32 val)
+{
+  buf.push_back((val >> 24) & 0xFF);
+  buf.push_back((val >> 16) & 0xFF);
+  buf.push_back((val >>  8) & 0xFF);
+  buf.push_back(val & 0xFF);
+}
+
+// @brief PNG のチャンクを書き出す．
+// @param[in] s 出力先のストリーム
+// @param[in] type チャンクの種類(4文字)
+// @param[in] data データ
+// @param[in] size データのサイズ
+static
+void
+write_chunk(ostream& s,
+	    const char* type,
+	    const ymuint8* data,
+	    ymuint32 size)
+{
+  vector<ymuint8> head;
+  put_be32(head, size);
+  head.insert(head.end(), type, type + 4);
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, reinterpret_cast<const Bytef*>(type), 4);
+  if ( size > 0 ) {
+    crc = crc32(crc, data, size);
+  }
+  vector<ymuint8> tail;
+  put_be32(tail, crc);
+  s.write(reinterpret_cast<const char*>(&head[0]), head.size());
+  if ( size > 0 ) {
+    s.write(reinterpret_cast<const char*>(data), size);
+  }
+  s.write(reinterpret_cast<const char*>(&tail[0]), tail.size());
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsRaster
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsRaster::GdsRaster() :
+  mThreadNum(0),
+  mReqWidth(1024),
+  mReqHeight(0),
+  mLod(1),
+  mBackground(0x000000),
+  mWidth(0),
+  mHeight(0),
+  mScale(1.0),
+  mLeft(0.0),
+  mTop(0.0),
+  mInstanceNum(0),
+  mLodNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsRaster::~GdsRaster()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsRaster::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief 画像の大きさを設定する．
+// @param[in] width 幅(画素数)
+// @param[in] height 高さ(画素数)
+//
+// 一方が 0 の時は描画する領域の縦横比から決める．
+void
+GdsRaster::set_size(ymuint width,
+		    ymuint height)
+{
+  mReqWidth = width;
+  mReqHeight = height;
+}
+
+// @brief 描画する領域を設定する．
+// @param[in] window 領域
+//
+// 空の矩形の時は最上位の構造の外接矩形を用いる．
+// 画像の縦横比と合わない場合には中央に寄せて描く．
+void
+GdsRaster::set_window(const GdsBBox& window)
+{
+  mReqWindow = window;
+}
+
+// @brief 詳細を省略する配置の大きさを設定する．
+// @param[in] pixels 画素数
+//
+// 変換後の外接矩形の幅と高さがともに pixels 未満の配置は
+// 外接矩形で描く．0 の時は省略しない．既定値は 1 ．
+void
+GdsRaster::set_lod(ymuint pixels)
+{
+  mLod = pixels;
+}
+
+// @brief 背景色を設定する．
+// @param[in] rgb 色 ( 0xRRGGBB )
+void
+GdsRaster::set_background(ymuint32 rgb)
+{
+  mBackground = rgb & 0xFFFFFF;
+}
+
+// @brief 層の色を設定する．
+// @param[in] layer 層番号
+// @param[in] datatype データ型
+// @param[in] rgb 色 ( 0xRRGGBB )
+//
+// 設定しなかった層には既定の色を順に割り当てる．
+void
+GdsRaster::set_color(int layer,
+		     int datatype,
+		     ymuint32 rgb)
+{
+  ymuint32 key = (static_cast<ymuint32>(layer & 0xFFFF) << 16) |
+    static_cast<ymuint32>(datatype & 0xFFFF);
+  mColorMap[key] = rgb & 0xFFFFFF;
+}
+
+// @brief 描画する．
+// @param[in] data 対象のデータ
+// @param[in] top_name 最上位の構造名
+// @retval true 成功した．
+// @retval false 最上位の構造が決まらないか階層が循環していた．
+//
+// top_name が NULL の時は唯一の最上位の構造を用いる．
+bool
+GdsRaster::render(const GdsData& data,
+		  const char* top_name)
+{
+  mWidth = 0;
+  mHeight = 0;
+  mWindow = GdsBBox();
+  mKeyList.clear();
+  mColorList.clear();
+  mCellArray.clear();
+  mImage.clear();
+  mInstanceNum = 0;
+  mLodNum = 0;
+
+  // 最上位の構造を求める．
+  GdsHier hier(data);
+  const GdsStruct* top = NULL;
+  if ( top_name != NULL ) {
+    top = data.find_struct(top_name);
+    if ( top == NULL ) {
+      error_header(__FILE__, __LINE__, "GdsRaster", 0)
+	<< top_name << ": No such structure";
+      msg_end();
+      return false;
+    }
+  }
+  else {
+    if ( hier.top_num() != 1 ) {
+      error_header(__FILE__, __LINE__, "GdsRaster", 0)
+	<< hier.top_num() << " top structures. Specify one of them";
+      msg_end();
+      return false;
+    }
+    top = hier.top(0);
+  }
+  if ( !hier.calc_count(top) ) {
+    return false;
+  }
+
+  // 最上位から到達可能な構造中の (layer, datatype) を集める．
+  ymuint order_num = hier.order_num();
+  for (ymuint pos = 0; pos < order_num; ++ pos) {
+    for (const GdsElement* elem = hier.order(pos)->element();
+	 elem; elem = elem->next()) {
+      if ( is_shape(elem) ) {
+	mKeyList.push_back(elem_key(elem));
+      }
+    }
+  }
+  std::sort(mKeyList.begin(), mKeyList.end());
+  mKeyList.erase(std::unique(mKeyList.begin(), mKeyList.end()), mKeyList.end());
+  ymuint nl = mKeyList.size();
+
+  ymuint palette_pos = 0;
+  for (ymuint i = 0; i < nl; ++ i) {
+    std::map<ymuint32, ymuint32>::const_iterator p = mColorMap.find(mKeyList[i]);
+    if ( p != mColorMap.end() ) {
+      mColorList.push_back(p->second);
+    }
+    else {
+      mColorList.push_back(kPalette[palette_pos % (sizeof(kPalette) / sizeof(kPalette[0]))]);
+      ++ palette_pos;
+    }
+  }
+
+  // 構造ごとの図形を並列に集める．
+  mCellArray.resize(data.struct_num());
+  parallel_for(order_num, mThreadNum, [&](ymuint pos) {
+      const GdsStruct* str = hier.order(pos);
+      make_cell(str, mCellArray[str->id()]);
+    });
+
+  // 子孫を含めた外接矩形を子供の構造から順に求める．
+  // AREF の外接矩形は四隅の配置の外接矩形で決まる．
+  vector<GdsBBox> layer_bbox(nl);
+  vector<ymuint32> layer_list;
+  for (ymuint pos = order_num; pos -- > 0; ) {
+    const GdsStruct* str = hier.order(pos);
+    Cell& cell = mCellArray[str->id()];
+    for (ymuint i = 0; i < cell.mShapeList.size(); ++ i) {
+      const CellShape& shape = cell.mShapeList[i];
+      if ( layer_bbox[shape.mLayer].is_empty() ) {
+	layer_list.push_back(shape.mLayer);
+      }
+      layer_bbox[shape.mLayer].merge(shape.mBBox);
+    }
+    for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+      if ( elem->type() != kGdsSREF && elem->type() != kGdsAREF ) {
+	continue;
+      }
+      const GdsStruct* child = elem->ref_struct();
+      if ( child == NULL ) {
+	continue;
+      }
+      if ( elem->column() < 1 || elem->row() < 1 ) {
+	// 不正な COLROW
+	continue;
+      }
+      const Cell& child_cell = mCellArray[child->id()];
+      ymuint col_list[2] = { 0, static_cast<ymuint>(elem->column() - 1) };
+      ymuint row_list[2] = { 0, static_cast<ymuint>(elem->row() - 1) };
+      for (ymuint r = 0; r < 2; ++ r) {
+	for (ymuint c = 0; c < 2; ++ c) {
+	  GdsTrans trans(elem, col_list[c], row_list[r]);
+	  for (ymuint i = 0; i < child_cell.mLayerBBoxList.size(); ++ i) {
+	    ymuint32 layer = child_cell.mLayerBBoxList[i].first;
+	    if ( layer_bbox[layer].is_empty() ) {
+	      layer_list.push_back(layer);
+	    }
+	    layer_bbox[layer].merge(trans.apply(child_cell.mLayerBBoxList[i].second));
+	  }
+	}
+      }
+    }
+    std::sort(layer_list.begin(), layer_list.end());
+    for (ymuint i = 0; i < layer_list.size(); ++ i) {
+      ymuint32 layer = layer_list[i];
+      cell.mLayerBBoxList.push_back(std::make_pair(layer, layer_bbox[layer]));
+      cell.mBBox.merge(layer_bbox[layer]);
+      layer_bbox[layer] = GdsBBox();
+    }
+    layer_list.clear();
+  }
+
+  // 画像の大きさと縮尺を決める．
+  GdsBBox window = mReqWindow.is_empty() ? mCellArray[top->id()].mBBox : mReqWindow;
+  double ww = 1.0;
+  double wh = 1.0;
+  double cx = 0.0;
+  double cy = 0.0;
+  if ( !window.is_empty() ) {
+    ww = std::max(static_cast<double>(window.xmax()) - window.xmin(), 1.0);
+    wh = std::max(static_cast<double>(window.ymax()) - window.ymin(), 1.0);
+    cx = (static_cast<double>(window.xmin()) + window.xmax()) * 0.5;
+    cy = (static_cast<double>(window.ymin()) + window.ymax()) * 0.5;
+  }
+  mWidth = mReqWidth;
+  mHeight = mReqHeight;
+  if ( mWidth == 0 && mHeight == 0 ) {
+    mWidth = 1024;
+  }
+  if ( mHeight == 0 ) {
+    mHeight = std::max(static_cast<ymuint>(floor(mWidth * wh / ww + 0.5)), 1U);
+  }
+  else if ( mWidth == 0 ) {
+    mWidth = std::max(static_cast<ymuint>(floor(mHeight * ww / wh + 0.5)), 1U);
+  }
+  mScale = std::max(ww / mWidth, wh / mHeight);
+  mLeft = cx - mWidth * mScale * 0.5;
+  mTop = cy + mHeight * mScale * 0.5;
+  mWindow = GdsBBox(static_cast<ymint32>(floor(mLeft)),
+		    static_cast<ymint32>(floor(mTop - mHeight * mScale)),
+		    static_cast<ymint32>(ceil(mLeft + mWidth * mScale)),
+		    static_cast<ymint32>(ceil(mTop)));
+
+  // 帯ごとに並列に描画する．
+  mImage.resize(static_cast<ymuint64>(mWidth) * mHeight * 3);
+  ymuint nb = (mHeight + kBandRows - 1) / kBandRows;
+  vector<Band> band_array(nb);
+  parallel_for(nb, mThreadNum, [&](ymuint i) {
+      Band& band = band_array[i];
+      band.mRow0 = i * kBandRows;
+      band.mRowNum = std::min(kBandRows, mHeight - band.mRow0);
+      render_band(top, band);
+    });
+  for (ymuint i = 0; i < nb; ++ i) {
+    mInstanceNum += band_array[i].mInstanceNum;
+    mLodNum += band_array[i].mLodNum;
+  }
+
+  return true;
+}
+
+// @brief 画像の幅を返す．
+ymuint
+GdsRaster::width() const
+{
+  return mWidth;
+}
+
+// @brief 画像の高さを返す．
+ymuint
+GdsRaster::height() const
+{
+  return mHeight;
+}
+
+// @brief 実際に描画した領域を返す．
+//
+// 画像の縦横比に合わせて広げたものになる．
+const GdsBBox&
+GdsRaster::window() const
+{
+  return mWindow;
+}
+
+// @brief 画素の値を返す．
+//
+// 上の行から順に1画素あたり R, G, B の3バイトが並ぶ．
+const ymuint8*
+GdsRaster::image() const
+{
+  return mImage.empty() ? NULL : &mImage[0];
+}
+
+// @brief 描画のためにたどった配置の数を返す．
+ymuint64
+GdsRaster::instance_num() const
+{
+  return mInstanceNum;
+}
+
+// @brief 外接矩形で描いた配置の数を返す．
+ymuint64
+GdsRaster::lod_num() const
+{
+  return mLodNum;
+}
+
+// @brief PPM(P6) 形式で書き出す．
+// @param[in] s 出力先のストリーム
+// @retval true 成功した．
+// @retval false 書き込みに失敗した．
+bool
+GdsRaster::write_ppm(ostream& s) const
+{
+  s << "P6\n" << mWidth << " " << mHeight << "\n255\n";
+  if ( !mImage.empty() ) {
+    s.write(reinterpret_cast<const char*>(&mImage[0]), mImage.size());
+  }
+  return s.good();
+}
+
+// @brief PNG 形式で書き出す．
+// @param[in] s 出力先のストリーム
+// @retval true 成功した．
+// @retval false 圧縮か書き込みに失敗した．
+bool
+GdsRaster::write_png(ostream& s) const
+{
+  if ( mImage.empty() ) {
+    return false;
+  }
+
+  // 各行の先頭にフィルタの種類(0: なし)を置く．
+  ymuint64 row_size = static_cast<ymuint64>(mWidth) * 3;
+  vector<ymuint8> raw;
+  raw.reserve((row_size + 1) * mHeight);
+  for (ymuint y = 0; y < mHeight; ++ y) {
+    raw.push_back(0);
+    const ymuint8* row = &mImage[y * row_size];
+    raw.insert(raw.end(), row, row + row_size);
+  }
+  uLongf zsize = compressBound(raw.size());
+  vector<ymuint8> zdata(zsize);
+  if ( compress2(&zdata[0], &zsize, &raw[0], raw.size(), 6) != Z_OK ) {
+    error_header(__FILE__, __LINE__, "GdsRaster", 0)
+      << "error occured in 'compress2()'";
+    msg_end();
+    return false;
+  }
+
+  static const char signature[] = "\x89PNG\r\n\x1a\n";
+  s.write(signature, 8);
+
+  vector<ymuint8> ihdr;
+  put_be32(ihdr, mWidth);
+  put_be32(ihdr, mHeight);
+  ihdr.push_back(8); // ビット深度
+  ihdr.push_back(2); // RGB
+  ihdr.push_back(0); // 圧縮方式
+  ihdr.push_back(0); // フィルタ方式
+  ihdr.push_back(0); // インターレースなし
+  write_chunk(s, "IHDR", &ihdr[0], ihdr.size());
+  write_chunk(s, "IDAT", &zdata[0], zsize);
+  write_chunk(s, "IEND", NULL, 0);
+  return s.good();
+}
+
+// @brief 構造中の図形を集める．
+// @param[in] str 対象の構造
+// @param[out] cell 結果を格納するオブジェクト
+void
+GdsRaster::make_cell(const GdsStruct* str,
+		     Cell& cell) const
+{
+  GdsPathExpander expander;
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    if ( !is_shape(elem) ) {
+      continue;
+    }
+    ymuint32 key = elem_key(elem);
+    vector<ymuint32>::const_iterator p =
+      std::lower_bound(mKeyList.begin(), mKeyList.end(), key);
+    ASSERT_COND( p != mKeyList.end() && *p == key );
+    ymuint32 layer = p - mKeyList.begin();
+
+    vector<std::pair<const ymint32*, ymuint> > polygon_list;
+    if ( elem->type() == kGdsPATH ) {
+      expander.clear();
+      expander.expand(elem);
+      for (ymuint i = 0; i < expander.polygon_num(); ++ i) {
+	polygon_list.push_back(std::make_pair(expander.polygon_data(i),
+					      expander.point_num(i)));
+      }
+    }
+    else {
+      const GdsXY* xy = elem->xy();
+      polygon_list.push_back(std::make_pair(xy->data(), xy->num()));
+    }
+
+    for (ymuint i = 0; i < polygon_list.size(); ++ i) {
+      const ymint32* data = polygon_list[i].first;
+      ymuint n = polygon_list[i].second;
+      // 閉じるための最後の点は除く．
+      if ( n > 1 && data[0] == data[n * 2 - 2] && data[1] == data[n * 2 - 1] ) {
+	-- n;
+      }
+      if ( n == 0 ) {
+	continue;
+      }
+      CellShape shape;
+      shape.mLayer = layer;
+      shape.mPos = cell.mPool.size() / 2;
+      shape.mNum = n;
+      for (ymuint j = 0; j < n; ++ j) {
+	cell.mPool.push_back(data[j * 2 + 0]);
+	cell.mPool.push_back(data[j * 2 + 1]);
+	shape.mBBox.add_point(data[j * 2 + 0], data[j * 2 + 1]);
+      }
+      cell.mShapeList.push_back(shape);
+    }
+  }
+}
+
+// @brief 一つの帯を描画する．
+// @param[in] top 最上位の構造
+// @param[in] band 帯
+//
+// band の mRow0 と mRowNum は設定されているものとする．
+void
+GdsRaster::render_band(const GdsStruct* top,
+		       Band& band)
+{
+  ymuint nl = mKeyList.size();
+  ymuint nr = band.mRowNum;
+  band.mInstanceNum = 0;
+  band.mLodNum = 0;
+  band.mBBox = GdsBBox(static_cast<ymint32>(floor(mLeft)),
+		       static_cast<ymint32>(floor(mTop - (band.mRow0 + nr) * mScale)),
+		       static_cast<ymint32>(ceil(mLeft + mWidth * mScale)),
+		       static_cast<ymint32>(ceil(mTop - band.mRow0 * mScale)));
+  band.mCover.assign(static_cast<ymuint64>(nl) * nr * mWidth, 0);
+
+  if ( mCellArray[top->id()].mBBox.intersect(band.mBBox) ) {
+    draw_struct(top, GdsTrans(), band);
+  }
+
+  // 層を重ねて色を決める．
+  for (ymuint row = 0; row < nr; ++ row) {
+    ymuint8* dst = &mImage[(static_cast<ymuint64>(band.mRow0 + row) * mWidth) * 3];
+    for (ymuint col = 0; col < mWidth; ++ col) {
+      ymuint32 rgb = mBackground;
+      bool first = true;
+      for (ymuint layer = 0; layer < nl; ++ layer) {
+	if ( band.mCover[(static_cast<ymuint64>(layer) * nr + row) * mWidth + col] == 0 ) {
+	  continue;
+	}
+	ymuint32 color = mColorList[layer];
+	if ( first ) {
+	  rgb = color;
+	  first = false;
+	}
+	else {
+	  // チャネルごとの平均をとる．
+	  rgb = ((rgb >> 1) & 0x7F7F7F) + ((color >> 1) & 0x7F7F7F);
+	}
+      }
+      dst[col * 3 + 0] = (rgb >> 16) & 0xFF;
+      dst[col * 3 + 1] = (rgb >>  8) & 0xFF;
+      dst[col * 3 + 2] = rgb & 0xFF;
+    }
+  }
+
+  // 作業領域を解放する．
+  vector<ymuint8>().swap(band.mCover);
+  vector<double>().swap(band.mPointBuf);
+  vector<double>().swap(band.mCrossBuf);
+}
+
+// @brief 構造を帯に描画する．
+// @param[in] str 対象の構造
+// @param[in] trans 座標変換
+// @param[in] band 帯
+void
+GdsRaster::draw_struct(const GdsStruct* str,
+		       const GdsTrans& trans,
+		       Band& band) const
+{
+  const Cell& cell = mCellArray[str->id()];
+  for (ymuint i = 0; i < cell.mShapeList.size(); ++ i) {
+    const CellShape& shape = cell.mShapeList[i];
+    GdsBBox bbox = trans.apply(shape.mBBox);
+    if ( !bbox.intersect(band.mBBox) ) {
+      continue;
+    }
+    // 1画素より小さい図形は外接矩形で描く．
+    if ( (static_cast<double>(bbox.xmax()) - bbox.xmin()) < mScale ||
+	 (static_cast<double>(bbox.ymax()) - bbox.ymin()) < mScale ) {
+      fill_rect(shape.mLayer, bbox, band);
+    }
+    else {
+      fill_polygon(shape.mLayer, &cell.mPool[shape.mPos * 2], shape.mNum, trans, band);
+    }
+  }
+
+  double lod_size = mLod * mScale;
+  const GdsBBox& range = band.mBBox;
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    if ( elem->type() != kGdsSREF && elem->type() != kGdsAREF ) {
+      continue;
+    }
+    const GdsStruct* child = elem->ref_struct();
+    if ( child == NULL ) {
+      continue;
+    }
+    const Cell& child_cell = mCellArray[child->id()];
+    if ( child_cell.mBBox.is_empty() ) {
+      continue;
+    }
+
+    // AREF の場合は帯と重なる可能性のある範囲に絞り込む．
+    ymuint ncol = elem->column();
+    ymuint nrow = elem->row();
+    ymuint c0 = 0;
+    ymuint c1 = ncol;
+    ymuint r0 = 0;
+    ymuint r1 = nrow;
+    if ( ncol > 1 || nrow > 1 ) {
+      GdsBBox b00 = (trans * GdsTrans(elem, 0, 0)).apply(child_cell.mBBox);
+      double cdx = 0.0;
+      double cdy = 0.0;
+      double rdx = 0.0;
+      double rdy = 0.0;
+      if ( ncol > 1 ) {
+	GdsBBox b = (trans * GdsTrans(elem, ncol - 1, 0)).apply(child_cell.mBBox);
+	cdx = (static_cast<double>(b.xmin()) - b00.xmin()) / (ncol - 1);
+	cdy = (static_cast<double>(b.ymin()) - b00.ymin()) / (ncol - 1);
+      }
+      if ( nrow > 1 ) {
+	GdsBBox b = (trans * GdsTrans(elem, 0, nrow - 1)).apply(child_cell.mBBox);
+	rdx = (static_cast<double>(b.xmin()) - b00.xmin()) / (nrow - 1);
+	rdy = (static_cast<double>(b.ymin()) - b00.ymin()) / (nrow - 1);
+      }
+      // 丸め誤差の分だけ範囲を広げておく．
+      double x0 = range.xmin() - 2.0;
+      double x1 = range.xmax() + 2.0;
+      double y0 = range.ymin() - 2.0;
+      double y1 = range.ymax() + 2.0;
+      if ( cdx == 0.0 ) {
+	index_range(b00.xmin(), b00.xmax(), rdx, x0, x1, r0, r1);
+      }
+      if ( cdy == 0.0 ) {
+	index_range(b00.ymin(), b00.ymax(), rdy, y0, y1, r0, r1);
+      }
+      if ( rdx == 0.0 ) {
+	index_range(b00.xmin(), b00.xmax(), cdx, x0, x1, c0, c1);
+      }
+      if ( rdy == 0.0 ) {
+	index_range(b00.ymin(), b00.ymax(), cdy, y0, y1, c0, c1);
+      }
+    }
+
+    for (ymuint r = r0; r < r1; ++ r) {
+      for (ymuint c = c0; c < c1; ++ c) {
+	GdsTrans child_trans = trans * GdsTrans(elem, c, r);
+	GdsBBox bbox = child_trans.apply(child_cell.mBBox);
+	if ( !bbox.intersect(range) ) {
+	  continue;
+	}
+	++ band.mInstanceNum;
+	if ( (static_cast<double>(bbox.xmax()) - bbox.xmin()) < lod_size &&
+	     (static_cast<double>(bbox.ymax()) - bbox.ymin()) < lod_size ) {
+	  // 小さい配置は層ごとの外接矩形で描く．
+	  ++ band.mLodNum;
+	  for (ymuint i = 0; i < child_cell.mLayerBBoxList.size(); ++ i) {
+	    GdsBBox layer_bbox = child_trans.apply(child_cell.mLayerBBoxList[i].second);
+	    if ( layer_bbox.intersect(range) ) {
+	      fill_rect(child_cell.mLayerBBoxList[i].first, layer_bbox, band);
+	    }
+	  }
+	}
+	else {
+	  draw_struct(child, child_trans, band);
+	}
+      }
+    }
+  }
+}
+
+// @brief 多角形を帯に描画する．
+// @param[in] layer 層の位置番号
+// @param[in] data 頂点座標の配列
+// @param[in] n 頂点数
+// @param[in] trans 座標変換
+// @param[in] band 帯
+void
+GdsRaster::fill_polygon(ymuint layer,
+			const ymint32* data,
+			ymuint n,
+			const GdsTrans& trans,
+			Band& band) const
+{
+  // 画素の単位の座標に変換する．
+  vector<double>& point_buf = band.mPointBuf;
+  point_buf.resize(n * 2);
+  double ymin = 0.0;
+  double ymax = 0.0;
+  for (ymuint i = 0; i < n; ++ i) {
+    ymint32 x;
+    ymint32 y;
+    trans.apply(data[i * 2 + 0], data[i * 2 + 1], x, y);
+    double px = to_col(x);
+    double py = to_row(y);
+    point_buf[i * 2 + 0] = px;
+    point_buf[i * 2 + 1] = py;
+    if ( i == 0 || ymin > py ) {
+      ymin = py;
+    }
+    if ( i == 0 || ymax < py ) {
+      ymax = py;
+    }
+  }
+
+  // 画素の中心を通るスキャンラインごとに偶奇規則で塗りつぶす．
+  double row0 = std::max(ceil(ymin - 0.5), static_cast<double>(band.mRow0));
+  double row1 = std::min(ceil(ymax - 0.5), static_cast<double>(band.mRow0 + band.mRowNum));
+  vector<double>& cross_buf = band.mCrossBuf;
+  for (ymint64 row = static_cast<ymint64>(row0); row < row1; ++ row) {
+    double yc = row + 0.5;
+    cross_buf.clear();
+    for (ymuint i = 0; i < n; ++ i) {
+      ymuint j = i + 1 < n ? i + 1 : 0;
+      double x0 = point_buf[i * 2 + 0];
+      double y0 = point_buf[i * 2 + 1];
+      double x1 = point_buf[j * 2 + 0];
+      double y1 = point_buf[j * 2 + 1];
+      if ( (y0 <= yc) != (y1 <= yc) ) {
+	cross_buf.push_back(x0 + (yc - y0) * (x1 - x0) / (y1 - y0));
+      }
+    }
+    std::sort(cross_buf.begin(), cross_buf.end());
+    ymuint8* dst = &band.mCover[(static_cast<ymuint64>(layer) * band.mRowNum +
+				 (row - band.mRow0)) * mWidth];
+    for (ymuint i = 0; i + 1 < cross_buf.size(); i += 2) {
+      double c0 = std::max(ceil(cross_buf[i] - 0.5), 0.0);
+      double c1 = std::min(ceil(cross_buf[i + 1] - 0.5), static_cast<double>(mWidth));
+      if ( c0 < c1 ) {
+	memset(dst + static_cast<ymuint>(c0), 1, static_cast<ymuint>(c1 - c0));
+      }
+    }
+  }
+}
+
+// @brief 矩形を帯に描画する．
+// @param[in] layer 層の位置番号
+// @param[in] bbox 矩形
+// @param[in] band 帯
+//
+// 少しでも重なる画素を塗りつぶす．
+void
+GdsRaster::fill_rect(ymuint layer,
+		     const GdsBBox& bbox,
+		     Band& band) const
+{
+  double c0 = floor(to_col(bbox.xmin()));
+  double c1 = std::max(ceil(to_col(bbox.xmax())), c0 + 1.0);
+  double r0 = floor(to_row(bbox.ymax()));
+  double r1 = std::max(ceil(to_row(bbox.ymin())), r0 + 1.0);
+  c0 = std::max(c0, 0.0);
+  c1 = std::min(c1, static_cast<double>(mWidth));
+  r0 = std::max(r0, static_cast<double>(band.mRow0));
+  r1 = std::min(r1, static_cast<double>(band.mRow0 + band.mRowNum));
+  if ( c0 >= c1 ) {
+    return;
+  }
+  for (ymint64 row = static_cast<ymint64>(r0); row < r1; ++ row) {
+    ymuint8* dst = &band.mCover[(static_cast<ymuint64>(layer) * band.mRowNum +
+				 (row - band.mRow0)) * mWidth];
+    memset(dst + static_cast<ymuint>(c0), 1, static_cast<ymuint>(c1 - c0));
+  }
+}
+
+// @brief X 座標を画素の単位に変換する．
+double
+GdsRaster::to_col(double x) const
+{
+  return (x - mLeft) / mScale;
+}
+
+// @brief Y 座標を画素の単位に変換する．
+double
+GdsRaster::to_row(double y) const
+{
+  return (mTop - y) / mScale;
+}
+
+END_NAMESPACE_YM_GDS
@@ -27,7 +27,8 @@ GdsRefBase::GdsRefBase(ymuint16 elflags,
 		       GdsStrans* strans) :
   GdsElement(elflags, plex),
   mStrName(strname),
-  mStrans(strans)
+  mStrans(strans),
+  mRefStruct(NULL)
 {
 }
 
@@ -38,16 +39,41 @@ GdsRefBase::~GdsRefBase()
 
 // @brief 参照している構造名を返す．
 const char*
-GdsRefBase::strname()
+GdsRefBase::strname() const
 {
   return mStrName->str();
 }
 
+// @brief 参照している構造を返す．
+//
+// 該当する構造が存在しない場合には NULL を返す．
+const GdsStruct*
+GdsRefBase::ref_struct() const
+{
+  return mRefStruct;
+}
+
+// @brief column 数を返す．
+int
+GdsRefBase::column() const
+{
+  return 1;
+}
+
+// @brief row 数を返す．
+int
+GdsRefBase::row() const
+{
+  return 1;
+}
+
 // @brief reflection ビットが立っていたら true を返す．
 bool
 GdsRefBase::reflection() const
 {
-  // mStrans->flags() を解析する．
+  if ( mStrans ) {
+    return mStrans->reflection();
+  }
   return false;
 }
 
@@ -55,7 +81,9 @@ GdsRefBase::reflection() const
 bool
 GdsRefBase::absolute_magnification() const
 {
-  // mStrans->flags() を解析する．
+  if ( mStrans ) {
+    return mStrans->absolute_magnification();
+  }
   return false;
 }
 
@@ -63,7 +91,9 @@ GdsRefBase::absolute_magnification() const
 bool
 GdsRefBase::absolute_angle() const
 {
-  // mStrans->flags() を解析する．
+  if ( mStrans ) {
+    return mStrans->absolute_angle();
+  }
   return false;
 }
 
@@ -71,14 +101,20 @@ GdsRefBase::absolute_angle() const
 double
 GdsRefBase::mag() const
 {
-  return mStrans->mag();
+  if ( mStrans ) {
+    return mStrans->mag();
+  }
+  return 1.0;
 }
 
 // @brief angular rotation factor を返す．
 double
 GdsRefBase::angle() const
 {
-  return mStrans->angle();
+  if ( mStrans ) {
+    return mStrans->angle();
+  }
+  return 0.0;
 }
 
 END_NAMESPACE_YM_GDS
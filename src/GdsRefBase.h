@@ -21,7 +21,7 @@ BEGIN_NAMESPACE_YM_GDS
 class GdsRefBase :
   public GdsElement
 {
-  friend class GdsParser;
+  friend class GdsBuilder;
 
 protected:
 
@@ -48,7 +48,24 @@ public:
   /// @brief 参照している構造名を返す．
   virtual
   const char*
-  strname();
+  strname() const;
+
+  /// @brief 参照している構造を返す．
+  ///
+  /// 該当する構造が存在しない場合には NULL を返す．
+  virtual
+  const GdsStruct*
+  ref_struct() const;
+
+  /// @brief column 数を返す．
+  virtual
+  int
+  column() const;
+
+  /// @brief row 数を返す．
+  virtual
+  int
+  row() const;
 
   /// @brief reflection ビットが立っていたら true を返す．
   virtual
@@ -87,6 +104,10 @@ private:
   // STRANS
   GdsStrans* mStrans;
 
+  // 参照している構造
+  // パース後に GdsParser が設定する．
+  GdsStruct* mRefStruct;
+
 };
 
 END_NAMESPACE_YM_GDS
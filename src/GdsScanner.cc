@@ -9,12 +9,39 @@
 
 #include "YmGds/GdsScanner.h"
 #include "YmGds/Msg.h"
+#include "YmGds/GdsProgress.h"
 #include "GdsRecTable.h"
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <chrono>
 
 
 BEGIN_NAMESPACE_YM_GDS
 
+// resync() で読み直す位置とみなすために続けて正しく読める
+// べきレコードの数
+static
+const ymuint kSyncNum = 4;
+
+// resync() で調べ終わった部分を捨てる大きさ
+static
+const ymuint64 kDropSize = 1 << 16;
+
+// 進み具合を知らせるために時刻を調べるバイト数の間隔
+static
+const ymuint64 kCheckSize = 1 << 18;
+
+// 現在の時刻を秒単位で返す．
+static
+double
+cur_time()
+{
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+
 //////////////////////////////////////////////////////////////////////
 // GDS-II の読み込みを行うクラス
 //////////////////////////////////////////////////////////////////////
@@ -22,9 +49,29 @@ BEGIN_NAMESPACE_YM_GDS
 // コンストラクタ
 GdsScanner::GdsScanner() :
   mFd(-1),
+  mMemData(NULL),
+  mMemSize(0),
+  mMemPos(0),
+  mTotalSize(0),
+  mRawPos(0),
+  mMsgBase(0),
+  mReadPos(0),
+  mEndPos(0),
   mCurPos(0),
   mDataBuff(NULL),
-  mBuffSize(0)
+  mBuffSize(0),
+  mRecover(false),
+  mPendPos(0),
+  mRecoverNum(0),
+  mSkipSize(0),
+  mProgress(NULL),
+  mInterval(0.1),
+  mStartTime(0.0),
+  mLastTime(0.0),
+  mNextCheck(0),
+  mRecordNum(0),
+  mStructNum(0),
+  mCancel(false)
 {
   mBuffSize = 1024;
   mDataBuff = new ymuint8[mBuffSize];
@@ -44,9 +91,58 @@ GdsScanner::~GdsScanner()
 bool
 GdsScanner::open_file(const string& filename)
 {
+  close_file();
+  mMsgBase = 0;
   mCurPos = 0;
+  mReadPos = 0;
+  mEndPos = 0;
+  mPending.clear();
+  mPendPos = 0;
+  mRecoverNum = 0;
+  mSkipSize = 0;
+  mRawPos = 0;
+  mTotalSize = 0;
   mFd = open(filename.c_str(), O_RDONLY);
-  return ( mFd >= 0 );
+  if ( mFd < 0 ) {
+    return false;
+  }
+  struct stat sbuf;
+  if ( fstat(mFd, &sbuf) == 0 && S_ISREG(sbuf.st_mode) ) {
+    mTotalSize = sbuf.st_size;
+  }
+  init_progress();
+  return true;
+}
+
+// @brief メモリ上のデータを読み込む対象にする．
+// @param[in] data データの先頭
+// @param[in] size データのサイズ
+// @param[in] base data の先頭のファイル上の位置
+//
+// data は読み込みが終わるまで有効でなければならない．
+// mmap() した領域の一部を読む時などに用いる．
+// cur_offset() と cur_pos() は data の先頭からの位置となる．
+// base はメッセージに出す位置にだけ用いる．
+void
+GdsScanner::open_memory(const ymuint8* data,
+			ymuint32 size,
+			ymuint64 base)
+{
+  close_file();
+  mMsgBase = base;
+  mCurPos = 0;
+  mReadPos = 0;
+  mEndPos = 0;
+  mPending.clear();
+  mPendPos = 0;
+  mRecoverNum = 0;
+  mSkipSize = 0;
+  mMemData = data;
+  mMemSize = size;
+  mMemPos = 0;
+  mRawPos = 0;
+  mTotalSize = size;
+  init_progress();
 }
 
 // @brief ファイルを閉じる．
@@ -57,6 +153,7 @@ GdsScanner::close_file()
     close(mFd);
     mFd = -1;
   }
+  mMemData = NULL;
 }
 
 // @brief レコード一つ分の読み込みを行う．
@@ -64,11 +161,91 @@ GdsScanner::close_file()
 // @retval false エラーが起った場合や末尾に達した場合
 bool
 GdsScanner::read_rec()
+{
+  if ( cancelled() ) {
+    return false;
+  }
+  for ( ; ; ) {
+    int stat = read_rec_sub();
+    if ( stat == 0 ) {
+      if ( mProgress != NULL ) {
+	++ mRecordNum;
+	if ( mCurRtype == kGdsENDSTR ) {
+	  ++ mStructNum;
+	}
+	if ( byte_num() >= mNextCheck ) {
+	  check_progress();
+	}
+      }
+      return true;
+    }
+    if ( stat == 1 || !mRecover ) {
+      return false;
+    }
+    // 回復モードなら次の BGNSTR か ENDLIB から読み直す．
+    if ( !resync() ) {
+      return false;
+    }
+  }
+}
+
+// @brief 進み具合を受け取るハンドラを登録する．
+// @param[in] handler ハンドラ (NULL の時は登録を解除する)
+// @param[in] interval ハンドラを呼ぶ最小の間隔 (秒)
+void
+GdsScanner::set_progress(GdsProgressHandler* handler,
+			 double interval)
+{
+  mProgress = handler;
+  mInterval = interval;
+  mNextCheck = byte_num() + kCheckSize;
+}
+
+// @brief 現在の進み具合をハンドラに渡す．
+void
+GdsScanner::report_progress()
+{
+  if ( mProgress == NULL ) {
+    return;
+  }
+
+  double now = cur_time();
+  mLastTime = now;
+
+  GdsProgress progress;
+  progress.mByteNum = byte_num();
+  progress.mTotalSize = mTotalSize;
+  progress.mRecordNum = mRecordNum;
+  progress.mStructNum = mStructNum;
+  progress.mTime = now - mStartTime;
+  if ( !(*mProgress)(progress) ) {
+    cancel();
+  }
+}
+
+// @brief 次の BGNSTR か ENDLIB まで読み飛ばして読み込む．
+// @retval true 見つかった．
+// @retval false 末尾に達した．
+bool
+GdsScanner::skip_to_structure()
+{
+  if ( !resync() ) {
+    return false;
+  }
+  return read_rec();
+}
+
+// @brief レコード一つ分の読み込みを行う．
+// @retval 0 読み込みが成功した．
+// @retval 1 末尾に達した．
+// @retval 2 不正なレコードだった．
+int
+GdsScanner::read_rec_sub()
 {
   mCurSize = 0;
   while ( mCurSize == 0 ) {
     if ( !read_2byte_uint(mCurSize) ) {
-      return false;
+      return 1;
     }
     // null word をスキップする．
   }
@@ -76,29 +253,36 @@ GdsScanner::read_rec()
   mCurOffset = mCurPos;
   if ( mCurSize < 4 || (mCurSize & 1) ) {
     // 変なサイズ
-    error_header(__FILE__, __LINE__, "GdsScanner", mCurPos)
+    error_header(__FILE__, __LINE__, "GdsScanner", mMsgBase + mCurPos)
       << "illegal size (" << mCurSize << ")";
     msg_end();
-    return false;
+    return 2;
   }
 
   ymuint32 dsize = mCurSize - 4;
   ymuint tmp_word;
   if ( !read_2byte_uint(tmp_word) ) {
-    return false;
+    return 1;
   }
   mCurRtype = static_cast<GdsRtype>(tmp_word >> 8);
   mCurDtype = static_cast<GdsDtype>(tmp_word & 0xFF);
 
+  if ( mCurRtype > kGdsLast ) {
+    error_header(__FILE__, __LINE__, "GdsScanner", mMsgBase + mCurPos)
+      << "illegal record type (" << (tmp_word >> 8) << ")";
+    msg_end();
+    return 2;
+  }
+
   // データの integrity check を行う．
   const GdsRecTable& table = GdsRecTable::obj();
   if ( table.dtype(mCurRtype) != mCurDtype ) {
-    error_header(__FILE__, __LINE__, "GdsScanner", mCurPos)
+    error_header(__FILE__, __LINE__, "GdsScanner", mMsgBase + mCurPos)
       << "data type mismatch: record type = "
       << table.rtype_string(mCurRtype)
       << ", data type = " << table.dtype_string(mCurDtype);
     msg_end();
-    return false;
+    return 2;
   }
   int unit_size = 1;
   switch ( mCurDtype ) {
@@ -113,7 +297,7 @@ GdsScanner::read_rec()
   int exp_dsize = unit_size * table.data_num(mCurRtype);
   if ( exp_dsize >= 0 ) {
     if ( exp_dsize != static_cast<int>(dsize) ) {
-      error_header(__FILE__, __LINE__, "GdsScanner", mCurPos)
+      error_header(__FILE__, __LINE__, "GdsScanner", mMsgBase + mCurPos)
 	<< "data size mismatch: record type = "
 	<< table.rtype_string(mCurRtype)
 	<< " expected data size = "
@@ -121,14 +305,14 @@ GdsScanner::read_rec()
 	<< ", real data size = "
 	<< dsize;
       msg_end();
-      return false;
+      return 2;
     }
   }
   else {
     // 可変長だが exp_dsize の絶対値の倍数でなければならない．
     int unit = -exp_dsize;
     if ( dsize % unit != 0 ) {
-      error_header(__FILE__, __LINE__, "GdsScanner", mCurPos)
+      error_header(__FILE__, __LINE__, "GdsScanner", mMsgBase + mCurPos)
 	<< "data size mismatch: record type = "
 	<< table.rtype_string(mCurRtype)
 	<< " expected data size = "
@@ -136,15 +320,15 @@ GdsScanner::read_rec()
 	<< " x N, real data size = "
 	<< dsize;
       msg_end();
-      return false;
+      return 2;
     }
   }
 
   if ( !read_block(dsize) ) {
-    return false;
+    return 1;
   }
 
-  return true;
+  return 0;
 }
 
 // @brief 直前の read_rec() で読んだレコードのデータを2バイト整数に変換する．
@@ -275,6 +459,177 @@ GdsScanner::conv_8byte_real(ymuint pos) const
   return ans;
 }
 
+// @brief 進み具合の記録を初期化する．
+void
+GdsScanner::init_progress()
+{
+  mStartTime = cur_time();
+  mLastTime = mStartTime;
+  mNextCheck = kCheckSize;
+  mRecordNum = 0;
+  mStructNum = 0;
+}
+
+// @brief 前回から interval 以上経っていたらハンドラを呼ぶ．
+void
+GdsScanner::check_progress()
+{
+  mNextCheck = byte_num() + kCheckSize;
+  if ( cur_time() - mLastTime >= mInterval ) {
+    report_progress();
+  }
+}
+
+// @brief BGNSTR か ENDLIB の先頭まで読み飛ばす．
+// @retval true 見つかった．
+// @retval false 末尾に達した．
+//
+// 見つかったレコードの先頭からは mPending から読み出す．
+bool
+GdsScanner::resync()
+{
+  ymuint32 start_pos = mCurPos;
+  ++ mRecoverNum;
+
+  // レコードは偶数の位置から始まる．
+  vector<ymuint8> window;
+  ymuint32 base = mCurPos;
+  if ( base & 1 ) {
+    if ( !fill_window(window, 1) ) {
+      return false;
+    }
+    window.clear();
+    ++ base;
+  }
+
+  const GdsRecTable& table = GdsRecTable::obj();
+  ymuint64 pos = 0;
+  for ( ; ; ) {
+    if ( !fill_window(window, pos + 4) ) {
+      // 末尾に達した．
+      mSkipSize += mCurPos - start_pos;
+      warning_header(__FILE__, __LINE__, "GdsScanner", mMsgBase + start_pos)
+	<< "reached end of file after skipping "
+	<< (mCurPos - start_pos) << " bytes";
+      msg_end();
+      return false;
+    }
+    ymuint rsize = check_header(window, pos);
+    GdsRtype rtype = static_cast<GdsRtype>(window[pos + 2]);
+    if ( rsize > 0 && (rtype == kGdsBGNSTR || rtype == kGdsENDLIB) ) {
+      // 後に続くレコードも正しいか調べる．
+      // 途中で末尾に達した場合も正しいとみなす．
+      bool ok = true;
+      ymuint64 p = pos + rsize;
+      for (ymuint n = 0; n < kSyncNum; ) {
+	if ( !fill_window(window, p + 2) ) {
+	  break;
+	}
+	if ( window[p] == 0 && window[p + 1] == 0 ) {
+	  // null word
+	  p += 2;
+	  continue;
+	}
+	if ( !fill_window(window, p + 4) ) {
+	  break;
+	}
+	ymuint size1 = check_header(window, p);
+	if ( size1 == 0 ) {
+	  ok = false;
+	  break;
+	}
+	p += size1;
+	++ n;
+      }
+      if ( ok ) {
+	break;
+      }
+    }
+    pos += 2;
+    if ( pos >= kDropSize ) {
+      if ( cancelled() ) {
+	return false;
+      }
+      // 調べ終わった部分を捨てる．
+      window.erase(window.begin(), window.begin() + pos);
+      base += pos;
+      pos = 0;
+    }
+  }
+
+  // window[pos] 以降を読み戻す．
+  vector<ymuint8> tmp(window.begin() + pos, window.end());
+  tmp.insert(tmp.end(), mPending.begin() + mPendPos, mPending.end());
+  mPending.swap(tmp);
+  mPendPos = 0;
+  mCurPos = base + pos;
+
+  mSkipSize += mCurPos - start_pos;
+  warning_header(__FILE__, __LINE__, "GdsScanner", mMsgBase + mCurPos)
+    << (mCurPos - start_pos) << " bytes skipped, resumed at "
+    << table.rtype_string(static_cast<GdsRtype>(window[pos + 2]));
+  msg_end();
+
+  return true;
+}
+
+// @brief resync() 用に window の大きさが size 以上になるまで読み込む．
+// @retval true 読み込めた．
+// @retval false 末尾に達した．
+bool
+GdsScanner::fill_window(vector<ymuint8>& window,
+			ymuint64 size)
+{
+  while ( window.size() < size ) {
+    ymuint val;
+    if ( !read_1byte(val) ) {
+      return false;
+    }
+    window.push_back(static_cast<ymuint8>(val));
+  }
+  return true;
+}
+
+// @brief window 上の pos から始まるレコードのヘッダを調べる．
+// @return 正しければレコードのサイズを，そうでなければ 0 を返す．
+ymuint
+GdsScanner::check_header(const vector<ymuint8>& window,
+			 ymuint64 pos)
+{
+  ymuint size = (window[pos] << 8) | window[pos + 1];
+  ymuint rt = window[pos + 2];
+  ymuint dt = window[pos + 3];
+  if ( size < 4 || (size & 1) || rt > kGdsLast ) {
+    return 0;
+  }
+  const GdsRecTable& table = GdsRecTable::obj();
+  GdsRtype rtype = static_cast<GdsRtype>(rt);
+  if ( static_cast<ymuint>(table.dtype(rtype)) != dt ) {
+    return 0;
+  }
+  ymuint dsize = size - 4;
+  int unit_size = 1;
+  switch ( table.dtype(rtype) ) {
+  case kGdsNodata:                   break;
+  case kGdsBitArray: unit_size =  2; break;
+  case kGds2Int:     unit_size =  2; break;
+  case kGds4Int:     unit_size =  4; break;
+  case kGds4Real:    unit_size =  4; break;
+  case kGds8Real:    unit_size =  8; break;
+  case kGdsString:   unit_size = -2; break;
+  }
+  int exp_dsize = unit_size * table.data_num(rtype);
+  if ( exp_dsize >= 0 ) {
+    if ( exp_dsize != static_cast<int>(dsize) ) {
+      return 0;
+    }
+  }
+  else if ( dsize % (-exp_dsize) != 0 ) {
+    return 0;
+  }
+  return size;
+}
+
 // @brief 2バイト読んで符号なし整数に変換する．
 // @param[out] val 読み込んだ値を格納する変数
 // @retval true 読み込みが成功した．
@@ -305,6 +660,18 @@ GdsScanner::read_2byte_uint(ymuint& val)
 bool
 GdsScanner::read_1byte(ymuint& val)
 {
+  if ( !mPending.empty() ) {
+    // resync() で読み戻したデータ
+    val = mPending[mPendPos];
+    ++ mPendPos;
+    ++ mCurPos;
+    if ( mPendPos == mPending.size() ) {
+      mPending.clear();
+      mPendPos = 0;
+    }
+    return true;
+  }
+
   while ( mReadPos >= mEndPos ) {
     bool stat = raw_read();
     if ( !stat ) {
@@ -330,6 +697,19 @@ GdsScanner::read_block(ymuint dsize)
   alloc_buff(dsize);
 
   ymuint wpos = 0;
+  if ( !mPending.empty() ) {
+    // resync() で読み戻したデータ
+    for ( ; dsize > 0 && mPendPos < mPending.size(); -- dsize) {
+      mDataBuff[wpos] = mPending[mPendPos];
+      ++ mPendPos;
+      ++ mCurPos;
+      ++ wpos;
+    }
+    if ( mPendPos == mPending.size() ) {
+      mPending.clear();
+      mPendPos = 0;
+    }
+  }
   while ( dsize > 0 ) {
     ymuint n = dsize;
     if ( mReadPos + n >= mEndPos ) {
@@ -375,6 +755,23 @@ GdsScanner::alloc_buff(ymuint32 req_size)
 bool
 GdsScanner::raw_read()
 {
+  if ( mMemData != NULL ) {
+    ymuint32 n = mMemSize - mMemPos;
+    if ( n == 0 ) {
+      // 末尾
+      return false;
+    }
+    if ( n > sizeof(mBuff) ) {
+      n = sizeof(mBuff);
+    }
+    memcpy(mBuff, mMemData + mMemPos, n);
+    mMemPos += n;
+    mEndPos = static_cast<ymuint>(n);
+    mReadPos = 0;
+    mRawPos += n;
+    return true;
+  }
+
   if ( mFd < 0 ) {
     return false;
   }
@@ -382,7 +779,7 @@ GdsScanner::raw_read()
   ssize_t n = read(mFd, mBuff, 4096);
   if ( n < 0 ) {
     // エラー
-    error_header(__FILE__, __LINE__, "GdsScanner", mCurPos)
+    error_header(__FILE__, __LINE__, "GdsScanner", mMsgBase + mCurPos)
       << "error occured in 'read()'";
     msg_end();
     return false;
@@ -394,6 +791,7 @@ GdsScanner::raw_read()
 
   mEndPos = static_cast<ymuint>(n);
   mReadPos = 0;
+  mRawPos += n;
 
   return true;
 }
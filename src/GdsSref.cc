@@ -37,6 +37,13 @@ GdsSref::~GdsSref()
 {
 }
 
+// @brief 要素の種類を返す．
+GdsRtype
+GdsSref::type() const
+{
+  return kGdsSREF;
+}
+
 // XY 座標を返す．
 GdsXY*
 GdsSref::xy() const
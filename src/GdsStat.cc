@@ -0,0 +1,465 @@
+﻿
+/// @file GdsStat.cc
+/// @brief GdsStat の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsStat.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsHier.h"
+#include "YmGds/GdsPathExpander.h"
+#include "YmGds/GdsTrans.h"
+#include "YmGds/GdsXY.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief 面積の2倍の絶対値を返す．
+static
+inline
+tGdsInt128
+abs_area2(tGdsInt128 area2)
+{
+  return area2 < 0 ? -area2 : area2;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsLayerStat
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsLayerStat::GdsLayerStat() :
+  mLayer(0),
+  mDataType(0),
+  mBoundaryNum(0),
+  mPathNum(0),
+  mBoxNum(0),
+  mTextNum(0),
+  mVertexNum(0),
+  mFlatNum(0),
+  mPolygonArea2(0),
+  mPerimeter(0.0)
+{
+}
+
+// @brief デストラクタ
+GdsLayerStat::~GdsLayerStat()
+{
+}
+
+// @brief 層番号を返す．
+int
+GdsLayerStat::layer() const
+{
+  return mLayer;
+}
+
+// @brief データ型を返す．
+int
+GdsLayerStat::datatype() const
+{
+  return mDataType;
+}
+
+// @brief ファイル中の BOUNDARY の数を返す．
+ymuint64
+GdsLayerStat::boundary_num() const
+{
+  return mBoundaryNum;
+}
+
+// @brief ファイル中の PATH の数を返す．
+ymuint64
+GdsLayerStat::path_num() const
+{
+  return mPathNum;
+}
+
+// @brief ファイル中の BOX の数を返す．
+ymuint64
+GdsLayerStat::box_num() const
+{
+  return mBoxNum;
+}
+
+// @brief ファイル中の TEXT の数を返す．
+ymuint64
+GdsLayerStat::text_num() const
+{
+  return mTextNum;
+}
+
+// @brief ファイル中の頂点数の合計を返す．
+ymuint64
+GdsLayerStat::vertex_num() const
+{
+  return mVertexNum;
+}
+
+// @brief 展開後の図形(BOUNDARY/PATH/BOX)の数を返す．
+ymuint64
+GdsLayerStat::flat_num() const
+{
+  return mFlatNum;
+}
+
+// @brief 展開後の面積の合計を返す．
+//
+// 単位は database unit の2乗．
+// 図形どうしの重なりは考慮しない．
+double
+GdsLayerStat::area() const
+{
+  return static_cast<double>(mPolygonArea2) * 0.5;
+}
+
+// @brief 展開後の面積の合計の2倍を返す．
+//
+// PATH は GdsPathExpander で求めた輪郭の面積を数える．
+// 整数で計算しているので誤差はない．
+tGdsInt128
+GdsLayerStat::polygon_area2() const
+{
+  return mPolygonArea2;
+}
+
+// @brief 展開後の周囲長の合計を返す．
+//
+// PATH は輪郭の長さを数える．
+double
+GdsLayerStat::perimeter() const
+{
+  return mPerimeter;
+}
+
+// @brief 展開後の外接矩形を返す．
+const GdsBBox&
+GdsLayerStat::bbox() const
+{
+  return mBBox;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsStat
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsStat::GdsStat() :
+  mThreadNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsStat::~GdsStat()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsStat::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief 統計情報を求める．
+// @param[in] data 対象のデータ
+// @param[in] top_name 最上位の構造名
+// @retval true 成功した．
+// @retval false 失敗した．
+//
+// top_name が NULL の時はどこからも参照されていない構造をすべて
+// 最上位とみなす．
+// top_name が見つからない場合や階層が循環している場合は失敗する．
+bool
+GdsStat::compute(const GdsData& data,
+		 const char* top_name)
+{
+  mLayerStatList.clear();
+  mTopList.clear();
+  mCountArray.clear();
+
+  ymuint n = data.struct_num();
+
+  // 構造ごとの集計を並列に行う．
+  vector<vector<LocalStat> > local_array(n);
+  parallel_for(n, mThreadNum, [&](ymuint id) {
+      calc_local(data.structure(id), local_array[id]);
+    });
+
+  // 最上位の構造を求める．
+  GdsHier hier(data);
+  const GdsStruct* top = NULL;
+  if ( top_name != NULL ) {
+    top = data.find_struct(top_name);
+    if ( top == NULL ) {
+      error_header(__FILE__, __LINE__, "GdsStat", 0)
+	<< top_name << ": No such structure";
+      msg_end();
+      return false;
+    }
+    mTopList.push_back(top);
+  }
+  else {
+    for (ymuint i = 0; i < hier.top_num(); ++ i) {
+      mTopList.push_back(hier.top(i));
+    }
+  }
+
+  // 配置数を求める．
+  if ( !hier.calc_count(top) ) {
+    return false;
+  }
+  mCountArray.resize(n);
+  for (ymuint id = 0; id < n; ++ id) {
+    mCountArray[id] = hier.count(id);
+  }
+
+  // (layer, datatype) ごとに集計する．
+  std::map<ymuint32, GdsLayerStat> stat_map;
+  for (ymuint id = 0; id < n; ++ id) {
+    ymuint64 count = mCountArray[id];
+    const vector<LocalStat>& local_list = local_array[id];
+    for (ymuint i = 0; i < local_list.size(); ++ i) {
+      const LocalStat& local = local_list[i];
+      GdsLayerStat& stat = stat_map[local.mKey];
+      stat.mLayer = static_cast<ymint16>(local.mKey >> 16);
+      stat.mDataType = static_cast<ymint16>(local.mKey & 0xFFFF);
+      stat.mBoundaryNum += local.mBoundaryNum;
+      stat.mPathNum += local.mPathNum;
+      stat.mBoxNum += local.mBoxNum;
+      stat.mTextNum += local.mTextNum;
+      stat.mVertexNum += local.mVertexNum;
+      ymuint64 shape_num = local.mBoundaryNum + local.mPathNum + local.mBoxNum;
+      stat.mFlatNum += shape_num * count;
+      stat.mPolygonArea2 += local.mPolygonArea2 * count;
+      stat.mPerimeter += local.mPerimeter * count;
+    }
+  }
+
+  // 子供から順に外接矩形を求める．
+  vector<std::map<ymuint32, GdsBBox> > bbox_array(n);
+  for (ymuint rpos = hier.order_num(); rpos -- > 0; ) {
+    ymuint id = hier.order(rpos)->id();
+    std::map<ymuint32, GdsBBox>& bbox_map = bbox_array[id];
+    const vector<LocalStat>& local_list = local_array[id];
+    for (ymuint i = 0; i < local_list.size(); ++ i) {
+      const LocalStat& local = local_list[i];
+      bbox_map[local.mKey].merge(local.mBBox);
+    }
+    const GdsStruct* str = data.structure(id);
+    for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+      const GdsStruct* child = elem->ref_struct();
+      if ( child == NULL ) {
+	continue;
+      }
+      // AREF の場合は四隅の配置だけを考えればよい．
+      vector<GdsTrans> trans_list;
+      ymuint ncol = elem->column();
+      ymuint nrow = elem->row();
+      if ( ncol == 0 || nrow == 0 ) {
+	continue;
+      }
+      trans_list.push_back(GdsTrans(elem, 0, 0));
+      if ( ncol > 1 ) {
+	trans_list.push_back(GdsTrans(elem, ncol - 1, 0));
+      }
+      if ( nrow > 1 ) {
+	trans_list.push_back(GdsTrans(elem, 0, nrow - 1));
+      }
+      if ( ncol > 1 && nrow > 1 ) {
+	trans_list.push_back(GdsTrans(elem, ncol - 1, nrow - 1));
+      }
+      const std::map<ymuint32, GdsBBox>& child_map = bbox_array[child->id()];
+      for (std::map<ymuint32, GdsBBox>::const_iterator p = child_map.begin();
+	   p != child_map.end(); ++ p) {
+	GdsBBox& bbox = bbox_map[p->first];
+	for (ymuint i = 0; i < trans_list.size(); ++ i) {
+	  bbox.merge(trans_list[i].apply(p->second));
+	}
+      }
+    }
+  }
+  for (ymuint i = 0; i < mTopList.size(); ++ i) {
+    const std::map<ymuint32, GdsBBox>& bbox_map = bbox_array[mTopList[i]->id()];
+    for (std::map<ymuint32, GdsBBox>::const_iterator p = bbox_map.begin();
+	 p != bbox_map.end(); ++ p) {
+      stat_map[p->first].mBBox.merge(p->second);
+    }
+  }
+
+  mLayerStatList.reserve(stat_map.size());
+  for (std::map<ymuint32, GdsLayerStat>::const_iterator p = stat_map.begin();
+       p != stat_map.end(); ++ p) {
+    mLayerStatList.push_back(p->second);
+  }
+
+  return true;
+}
+
+// @brief (layer, datatype) の種類の数を返す．
+ymuint
+GdsStat::layer_num() const
+{
+  return mLayerStatList.size();
+}
+
+// @brief (layer, datatype) ごとの統計情報を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+//
+// (layer, datatype) の昇順に並んでいる．
+const GdsLayerStat&
+GdsStat::layer_stat(ymuint pos) const
+{
+  ASSERT_COND( pos < layer_num() );
+  return mLayerStatList[pos];
+}
+
+// @brief 最上位の構造の数を返す．
+ymuint
+GdsStat::top_num() const
+{
+  return mTopList.size();
+}
+
+// @brief 最上位の構造を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < top_num() )
+const GdsStruct*
+GdsStat::top(ymuint pos) const
+{
+  ASSERT_COND( pos < top_num() );
+  return mTopList[pos];
+}
+
+// @brief 構造の配置数を返す．
+// @param[in] id 構造のID番号
+//
+// 最上位の構造の下で何回使われているかを返す．
+// 最上位の構造自身は 1 となる．
+ymuint64
+GdsStat::instance_count(ymuint id) const
+{
+  ASSERT_COND( id < mCountArray.size() );
+  return mCountArray[id];
+}
+
+// @brief 一つの構造内の集計を行う．
+// @param[in] str 対象の構造
+// @param[out] stat_list 結果を格納するリスト
+//
+// 結果は mKey の昇順に並ぶ．
+void
+GdsStat::calc_local(const GdsStruct* str,
+		    vector<LocalStat>& stat_list)
+{
+  std::map<ymuint32, LocalStat> stat_map;
+  GdsPathExpander expander;
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    int datatype = 0;
+    switch ( elem->type() ) {
+    case kGdsBOUNDARY:
+    case kGdsPATH:
+      datatype = elem->datatype();
+      break;
+
+    case kGdsBOX:
+      datatype = elem->boxtype();
+      break;
+
+    case kGdsTEXT:
+      datatype = elem->texttype();
+      break;
+
+    default:
+      // SREF/AREF/NODE は対象外
+      continue;
+    }
+
+    ymuint32 key = (static_cast<ymuint32>(elem->layer()) << 16) | (datatype & 0xFFFF);
+    std::map<ymuint32, LocalStat>::iterator p = stat_map.find(key);
+    if ( p == stat_map.end() ) {
+      LocalStat init;
+      init.mKey = key;
+      init.mBoundaryNum = 0;
+      init.mPathNum = 0;
+      init.mBoxNum = 0;
+      init.mTextNum = 0;
+      init.mVertexNum = 0;
+      init.mPolygonArea2 = 0;
+      init.mPerimeter = 0.0;
+      p = stat_map.insert(std::make_pair(key, init)).first;
+    }
+    LocalStat& stat = p->second;
+
+    const GdsXY* xy = elem->xy();
+    ymuint np = xy->num();
+    stat.mVertexNum += np;
+    GdsBBox bbox;
+    for (ymuint i = 0; i < np; ++ i) {
+      bbox.add_point(xy->x(i), xy->y(i));
+    }
+
+    switch ( elem->type() ) {
+    case kGdsBOUNDARY:
+      ++ stat.mBoundaryNum;
+      stat.mPolygonArea2 += abs_area2(polygon_area2(xy));
+      stat.mPerimeter += polygon_perimeter(xy);
+      break;
+
+    case kGdsPATH:
+      ++ stat.mPathNum;
+      // 外接矩形も輪郭から求める．
+      bbox = GdsBBox();
+      if ( expander.expand(elem) ) {
+	ymuint pos = expander.polygon_num() - 1;
+	const ymint32* data = expander.polygon_data(pos);
+	ymuint n = expander.point_num(pos);
+	stat.mPolygonArea2 += abs_area2(polygon_area2(data, n));
+	stat.mPerimeter += polygon_perimeter(data, n);
+	for (ymuint i = 0; i < n; ++ i) {
+	  bbox.add_point(data[i * 2], data[i * 2 + 1]);
+	}
+      }
+      break;
+
+    case kGdsBOX:
+      ++ stat.mBoxNum;
+      stat.mPolygonArea2 += abs_area2(polygon_area2(xy));
+      stat.mPerimeter += polygon_perimeter(xy);
+      break;
+
+    case kGdsTEXT:
+      ++ stat.mTextNum;
+      break;
+
+    default:
+      break;
+    }
+    stat.mBBox.merge(bbox);
+  }
+
+  stat_list.clear();
+  stat_list.reserve(stat_map.size());
+  for (std::map<ymuint32, LocalStat>::const_iterator p = stat_map.begin();
+       p != stat_map.end(); ++ p) {
+    stat_list.push_back(p->second);
+  }
+}
+
+
+END_NAMESPACE_YM_GDS
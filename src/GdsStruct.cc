@@ -23,9 +23,11 @@ BEGIN_NAMESPACE_YM_GDS
 // @param[in] name 名前
 GdsStruct::GdsStruct(GdsDate* date,
 		     GdsString* name) :
+  mId(0),
   mName(name),
   mElement(NULL),
-  mLink(NULL)
+  mLink(NULL),
+  mHashLink(NULL)
 {
   mCreationTime = date;
   mLastModificationTime = date + 1;
@@ -36,6 +38,15 @@ GdsStruct::~GdsStruct()
 {
 }
 
+// @brief ID番号を返す．
+//
+// ID番号はファイル中の出現順に 0 から振られる．
+ymuint
+GdsStruct::id() const
+{
+  return mId;
+}
+
 // @brief生成日時を返す．
 const GdsDate&
 GdsStruct::creation_time() const
@@ -0,0 +1,424 @@
+﻿
+/// @file GdsStructHash.cc
+/// @brief GdsStructHash の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsStructHash.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsHier.h"
+#include "YmGds/GdsProperty.h"
+#include "YmGds/GdsXY.h"
+#include "GdsParallel.h"
+#include <cstring>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief 64 ビットの値をかき混ぜる．
+static
+inline
+ymuint64
+hash_fmix(ymuint64 k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+// @brief ハッシュ値に値を一つ加える．
+// @param[in] h 元のハッシュ値
+// @param[in] v 加える値
+//
+// 上位と下位は異なる定数で独立にかき混ぜ，互いの値も取り込む．
+static
+inline
+GdsHashValue
+hash_add(const GdsHashValue& h,
+	 ymuint64 v)
+{
+  ymuint64 hi = h.hi();
+  ymuint64 lo = h.lo();
+  ymuint64 lo1 = hash_fmix(lo ^ (v + 0x9e3779b97f4a7c15ULL + (lo << 6) + (lo >> 2)));
+  ymuint64 hi1 = hash_fmix(hi ^ (v * 0xc2b2ae3d27d4eb4fULL + lo1 + (hi << 7) + (hi >> 3)));
+  return GdsHashValue(hi1, lo1);
+}
+
+// @brief ハッシュ値にハッシュ値を加える．
+static
+inline
+GdsHashValue
+hash_add(const GdsHashValue& h,
+	 const GdsHashValue& v)
+{
+  return hash_add(hash_add(h, v.hi()), v.lo());
+}
+
+// @brief 実数のハッシュ値を加える．
+static
+inline
+GdsHashValue
+hash_add_double(const GdsHashValue& h,
+		double v)
+{
+  ymuint64 bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return hash_add(h, bits);
+}
+
+// @brief 文字列のハッシュ値を加える．
+static
+GdsHashValue
+hash_add_string(const GdsHashValue& h,
+		const char* str)
+{
+  ymuint64 len = strlen(str);
+  GdsHashValue h1 = hash_add(h, len);
+  // 8 バイトずつまとめて加える．
+  for (ymuint64 i = 0; i < len; i += 8) {
+    ymuint64 v = 0;
+    for (ymuint64 j = i; j < i + 8 && j < len; ++ j) {
+      v = (v << 8) | static_cast<ymuint8>(str[j]);
+    }
+    h1 = hash_add(h1, v);
+  }
+  return h1;
+}
+
+// @brief 座標のリストのハッシュ値を加える．
+static
+GdsHashValue
+hash_add_xy(const GdsHashValue& h,
+	    const GdsXY* xy)
+{
+  ymuint n = xy->num();
+  const ymint32* data = xy->data();
+  GdsHashValue h1 = hash_add(h, n);
+  for (ymuint i = 0; i < n; ++ i) {
+    ymuint64 x = static_cast<ymuint32>(data[i * 2 + 0]);
+    ymuint64 y = static_cast<ymuint32>(data[i * 2 + 1]);
+    h1 = hash_add(h1, (x << 32) | y);
+  }
+  return h1;
+}
+
+// @brief STRANS/MAG/ANGLE のハッシュ値を加える．
+static
+GdsHashValue
+hash_add_strans(const GdsHashValue& h,
+		const GdsElement* elem)
+{
+  ymuint64 flags = 0;
+  if ( elem->reflection() ) {
+    flags |= 1;
+  }
+  if ( elem->absolute_magnification() ) {
+    flags |= 2;
+  }
+  if ( elem->absolute_angle() ) {
+    flags |= 4;
+  }
+  GdsHashValue h1 = hash_add(h, flags);
+  h1 = hash_add_double(h1, elem->mag());
+  return hash_add_double(h1, elem->angle());
+}
+
+// @brief 構造名を表すハッシュ値を求める．
+static
+GdsHashValue
+name_hash(const char* name)
+{
+  // 内容から求めたハッシュ値と区別するための定数を加える．
+  return hash_add_string(GdsHashValue(0, 0x6e616d65ULL), name);
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsHashValue
+//////////////////////////////////////////////////////////////////////
+
+// @brief 32 桁の16進数で出力する．
+// @param[in] s 出力先のストリーム
+// @param[in] hv ハッシュ値
+ostream&
+operator<<(ostream& s,
+	   const GdsHashValue& hv)
+{
+  static const char* digit = "0123456789abcdef";
+  char buf[33];
+  for (ymuint i = 0; i < 16; ++ i) {
+    buf[i] = digit[(hv.hi() >> ((15 - i) * 4)) & 15];
+    buf[i + 16] = digit[(hv.lo() >> ((15 - i) * 4)) & 15];
+  }
+  buf[32] = '\0';
+  return s << buf;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsStructHash
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsStructHash::GdsStructHash() :
+  mThreadNum(0),
+  mOrderInsensitive(false)
+{
+}
+
+// @brief デストラクタ
+GdsStructHash::~GdsStructHash()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsStructHash::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief 要素の順番を無視するかどうかを設定する．
+// @param[in] flag true の時は要素の順番を無視する．
+//
+// デフォルトは false
+void
+GdsStructHash::set_order_insensitive(bool flag)
+{
+  mOrderInsensitive = flag;
+}
+
+// @brief 構造ごとのハッシュ値を求める．
+// @param[in] data 対象のデータ
+// @retval true 成功した．
+// @retval false 階層が循環していた．
+bool
+GdsStructHash::compute(const GdsData& data)
+{
+  mHashArray.clear();
+
+  GdsHier hier(data);
+  if ( !hier.calc_count() ) {
+    return false;
+  }
+
+  ymuint n = data.struct_num();
+  mHashArray.resize(n);
+
+  // 葉からの段数ごとに構造を分ける．
+  // 同じ段の構造は互いに独立に計算できる．
+  vector<ymuint> level_array(n, 0);
+  vector<vector<ymuint> > level_list;
+  for (ymuint pos = hier.order_num(); pos -- > 0; ) {
+    ymuint id = hier.order(pos)->id();
+    ymuint level = 0;
+    for (ymuint i = 0; i < hier.child_num(id); ++ i) {
+      ymuint level1 = level_array[hier.child(id, i)->id()] + 1;
+      if ( level < level1 ) {
+	level = level1;
+      }
+    }
+    level_array[id] = level;
+    if ( level_list.size() <= level ) {
+      level_list.resize(level + 1);
+    }
+    level_list[level].push_back(id);
+  }
+
+  for (ymuint level = 0; level < level_list.size(); ++ level) {
+    const vector<ymuint>& id_list = level_list[level];
+    parallel_for(id_list.size(), mThreadNum, [&](ymuint i) {
+	ymuint id = id_list[i];
+	mHashArray[id] = calc_struct(data.structure(id));
+      });
+  }
+
+  return true;
+}
+
+// @brief 構造数を返す．
+ymuint
+GdsStructHash::struct_num() const
+{
+  return mHashArray.size();
+}
+
+// @brief 構造のハッシュ値を返す．
+// @param[in] id 構造のID番号 ( 0 <= id < struct_num() )
+const GdsHashValue&
+GdsStructHash::hash(ymuint id) const
+{
+  ASSERT_COND( id < struct_num() );
+  return mHashArray[id];
+}
+
+// @brief 要素のハッシュ値を返す．
+// @param[in] elem 対象の要素
+//
+// SREF/AREF の参照先の構造は compute() で求めたハッシュ値を用いる．
+GdsHashValue
+GdsStructHash::elem_hash(const GdsElement* elem) const
+{
+  GdsHashValue h;
+  if ( elem->type() == kGdsSREF || elem->type() == kGdsAREF ) {
+    const GdsStruct* child = elem->ref_struct();
+    if ( child != NULL && child->id() < mHashArray.size() ) {
+      h = ref_hash(elem, mHashArray[child->id()]);
+    }
+    else {
+      h = ref_hash(elem, name_hash(elem->strname()));
+    }
+  }
+  else {
+    h = body_hash(elem);
+  }
+  return hash_add(h, property_hash(elem));
+}
+
+// @brief SREF/AREF の配置のハッシュ値を返す．
+// @param[in] elem 対象の要素 ( SREF/AREF )
+//
+// 参照先の構造は内容ではなく名前で区別する．
+GdsHashValue
+GdsStructHash::place_hash(const GdsElement* elem)
+{
+  return ref_hash(elem, name_hash(elem->strname()));
+}
+
+// @brief プロパティを除いた要素のハッシュ値を返す．
+// @param[in] elem 対象の要素
+//
+// SREF/AREF は place_hash() と同じ値を返す．
+GdsHashValue
+GdsStructHash::shape_hash(const GdsElement* elem)
+{
+  if ( elem->type() == kGdsSREF || elem->type() == kGdsAREF ) {
+    return place_hash(elem);
+  }
+  return body_hash(elem);
+}
+
+// @brief 要素のプロパティのハッシュ値を返す．
+// @param[in] elem 対象の要素
+GdsHashValue
+GdsStructHash::property_hash(const GdsElement* elem)
+{
+  GdsHashValue h;
+  for (const GdsProperty* prop = elem->property(); prop; prop = prop->next()) {
+    h = hash_add(h, prop->attr());
+    h = hash_add_string(h, prop->value());
+  }
+  return h;
+}
+
+// @brief 構造のハッシュ値を求める．
+// @param[in] str 対象の構造
+//
+// 子供の構造のハッシュ値は求められていなければならない．
+GdsHashValue
+GdsStructHash::calc_struct(const GdsStruct* str) const
+{
+  ymuint64 num = 0;
+  GdsHashValue h;
+  // 順番を無視する時は 128 ビットの和をとる．
+  ymuint64 sum_hi = 0;
+  ymuint64 sum_lo = 0;
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    GdsHashValue eh = elem_hash(elem);
+    if ( mOrderInsensitive ) {
+      ymuint64 lo = sum_lo + eh.lo();
+      sum_hi += eh.hi() + (lo < sum_lo ? 1 : 0);
+      sum_lo = lo;
+    }
+    else {
+      h = hash_add(h, eh);
+    }
+    ++ num;
+  }
+  if ( mOrderInsensitive ) {
+    h = GdsHashValue(sum_hi, sum_lo);
+  }
+  return hash_add(h, num);
+}
+
+// @brief SREF/AREF のハッシュ値を求める．
+// @param[in] elem 対象の要素
+// @param[in] child_hash 参照先の構造を表すハッシュ値
+GdsHashValue
+GdsStructHash::ref_hash(const GdsElement* elem,
+			const GdsHashValue& child_hash)
+{
+  GdsHashValue h = hash_add(GdsHashValue(), elem->type());
+  h = hash_add(h, child_hash);
+  h = hash_add_strans(h, elem);
+  if ( elem->type() == kGdsAREF ) {
+    h = hash_add(h, elem->column());
+    h = hash_add(h, elem->row());
+  }
+  return hash_add_xy(h, elem->xy());
+}
+
+// @brief SREF/AREF 以外の要素のプロパティを除いたハッシュ値を求める．
+// @param[in] elem 対象の要素
+GdsHashValue
+GdsStructHash::body_hash(const GdsElement* elem)
+{
+  GdsHashValue h = hash_add(GdsHashValue(), elem->type());
+  switch ( elem->type() ) {
+  case kGdsBOUNDARY:
+    h = hash_add(h, elem->layer());
+    h = hash_add(h, elem->datatype());
+    h = hash_add_xy(h, elem->xy());
+    break;
+
+  case kGdsBOX:
+    h = hash_add(h, elem->layer());
+    h = hash_add(h, elem->boxtype());
+    h = hash_add_xy(h, elem->xy());
+    break;
+
+  case kGdsPATH:
+    h = hash_add(h, elem->layer());
+    h = hash_add(h, elem->datatype());
+    h = hash_add(h, elem->pathtype());
+    h = hash_add(h, elem->width());
+    if ( elem->pathtype() == 4 ) {
+      h = hash_add(h, elem->bgn_extn());
+      h = hash_add(h, elem->end_extn());
+    }
+    h = hash_add_xy(h, elem->xy());
+    break;
+
+  case kGdsTEXT:
+    h = hash_add(h, elem->layer());
+    h = hash_add(h, elem->texttype());
+    h = hash_add(h, elem->pathtype());
+    h = hash_add(h, elem->width());
+    h = hash_add_strans(h, elem);
+    h = hash_add_xy(h, elem->xy());
+    h = hash_add_string(h, elem->text());
+    break;
+
+  case kGdsNODE:
+    h = hash_add(h, elem->layer());
+    h = hash_add_xy(h, elem->xy());
+    break;
+
+  default:
+    break;
+  }
+  return h;
+}
+
+END_NAMESPACE_YM_GDS
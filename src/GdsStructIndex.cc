@@ -0,0 +1,697 @@
+﻿
+/// @file GdsStructIndex.cc
+/// @brief GdsStructIndex の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsStructIndex.h"
+#include "YmGds/GdsScanner.h"
+#include "YmGds/GdsWriter.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// 索引ファイルの先頭のしるし
+static
+const char kIndexMagic[8] = { 'G', 'D', 'S', 'S', 'I', 'D', 'X', '2' };
+
+// 64ビットの値をリトルエンディアンで書き出す．
+static
+void
+put_u64(ostream& s,
+	ymuint64 val)
+{
+  char buf[8];
+  for (ymuint i = 0; i < 8; ++ i) {
+    buf[i] = static_cast<char>((val >> (i * 8)) & 0xFF);
+  }
+  s.write(buf, 8);
+}
+
+// 64ビットの値をリトルエンディアンで読み込む．
+static
+bool
+get_u64(istream& s,
+	ymuint64& val)
+{
+  unsigned char buf[8];
+  if ( !s.read(reinterpret_cast<char*>(buf), 8) ) {
+    return false;
+  }
+  val = 0;
+  for (ymuint i = 0; i < 8; ++ i) {
+    val |= static_cast<ymuint64>(buf[i]) << (i * 8);
+  }
+  return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsStructIndex
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsStructIndex::GdsStructIndex() :
+  mThreadNum(0),
+  mData(NULL),
+  mFileSize(0),
+  mMtime(0),
+  mMtimeNsec(0),
+  mHeaderSize(0)
+{
+}
+
+// @brief デストラクタ
+GdsStructIndex::~GdsStructIndex()
+{
+  close();
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsStructIndex::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief ファイルを開く．
+// @param[in] filename ファイル名
+// @retval true 成功した．
+// @retval false ファイルが読めなかった．
+//
+// この時点では索引は作らない．
+bool
+GdsStructIndex::open(const char* filename)
+{
+  close();
+
+  int fd = ::open(filename, O_RDONLY);
+  if ( fd < 0 ) {
+    error_header(__FILE__, __LINE__, "GdsStructIndex", 0)
+      << filename << ": Could not open";
+    msg_end();
+    return false;
+  }
+  struct stat st;
+  if ( fstat(fd, &st) < 0 ) {
+    error_header(__FILE__, __LINE__, "GdsStructIndex", 0)
+      << "error occured in 'fstat()'";
+    msg_end();
+    ::close(fd);
+    return false;
+  }
+  mFileSize = st.st_size;
+  mMtime = st.st_mtim.tv_sec;
+  mMtimeNsec = st.st_mtim.tv_nsec;
+  if ( mFileSize == 0 ) {
+    ::close(fd);
+    return true;
+  }
+  void* addr = mmap(NULL, mFileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if ( addr == MAP_FAILED ) {
+    error_header(__FILE__, __LINE__, "GdsStructIndex", 0)
+      << "error occured in 'mmap()'";
+    msg_end();
+    mFileSize = 0;
+    return false;
+  }
+  // 必要な部分しか読まないので先読みはさせない．
+  madvise(addr, mFileSize, MADV_RANDOM);
+  mData = static_cast<const ymuint8*>(addr);
+  return true;
+}
+
+// @brief ファイルを閉じる．
+void
+GdsStructIndex::close()
+{
+  if ( mData != NULL ) {
+    munmap(const_cast<ymuint8*>(mData), mFileSize);
+    mData = NULL;
+  }
+  mFileSize = 0;
+  mMtime = 0;
+  mMtimeNsec = 0;
+  mHeaderSize = 0;
+  mStructList.clear();
+  mStructMap.clear();
+}
+
+// @brief ファイルをたどって索引を作る．
+// @retval true 成功した．
+// @retval false 形式が正しくなかった．
+//
+// レコードの先頭だけをたどるので要素は解釈しない．
+bool
+GdsStructIndex::build()
+{
+  mHeaderSize = 0;
+  mStructList.clear();
+
+  const ymuint8* data = mData;
+  ymuint64 size = mFileSize;
+  if ( size > 0 ) {
+    madvise(const_cast<ymuint8*>(data), size, MADV_SEQUENTIAL);
+  }
+
+  bool in_struct = false;
+  bool header = true;
+  ymuint64 pos = 0;
+  bool stat = true;
+  while ( pos + 4 <= size ) {
+    ymuint rsize = (data[pos] << 8) | data[pos + 1];
+    if ( rsize == 0 ) {
+      // null word をスキップする．
+      pos += 2;
+      continue;
+    }
+    if ( rsize < 4 || (rsize & 1) || pos + rsize > size ) {
+      error_header(__FILE__, __LINE__, "GdsStructIndex", pos)
+	<< "illegal size (" << rsize << ")";
+      msg_end();
+      stat = false;
+      break;
+    }
+    ymuint8 rtype = data[pos + 2];
+    if ( rtype == kGdsBGNSTR ) {
+      if ( in_struct ) {
+	error_header(__FILE__, __LINE__, "GdsStructIndex", pos)
+	  << "BGNSTR without ENDSTR";
+	msg_end();
+	stat = false;
+	break;
+      }
+      if ( header ) {
+	mHeaderSize = pos;
+	header = false;
+      }
+      mStructList.push_back(StructInfo());
+      mStructList.back().mOffset = pos;
+      in_struct = true;
+    }
+    else if ( rtype == kGdsSTRNAME && in_struct ) {
+      // 末尾の詰め物の '\0' は除く．
+      const char* str = reinterpret_cast<const char*>(data + pos + 4);
+      ymuint len = rsize - 4;
+      while ( len > 0 && str[len - 1] == '\0' ) {
+	-- len;
+      }
+      mStructList.back().mName = string(str, len);
+    }
+    else if ( rtype == kGdsENDSTR && in_struct ) {
+      StructInfo& info = mStructList.back();
+      info.mSize = pos + rsize - info.mOffset;
+      in_struct = false;
+    }
+    else if ( rtype == kGdsENDLIB ) {
+      if ( header ) {
+	mHeaderSize = pos;
+	header = false;
+      }
+      break;
+    }
+    pos += rsize;
+  }
+  if ( stat && in_struct ) {
+    error_header(__FILE__, __LINE__, "GdsStructIndex", pos)
+      << "unexpected end of file";
+    msg_end();
+    stat = false;
+  }
+  if ( stat && header ) {
+    mHeaderSize = pos;
+  }
+  if ( size > 0 ) {
+    madvise(const_cast<ymuint8*>(data), size, MADV_RANDOM);
+  }
+  if ( !stat ) {
+    mStructList.clear();
+    return false;
+  }
+
+  make_map();
+  return true;
+}
+
+// @brief 保存した索引を読み込む．
+// @param[in] filename 索引のファイル名
+// @retval true 成功した．
+// @retval false 索引が読めないか元のファイルと一致しなかった．
+//
+// 失敗してもエラーメッセージは出力しない．
+bool
+GdsStructIndex::read_index(const char* filename)
+{
+  std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+  if ( !ifs ) {
+    return false;
+  }
+
+  char magic[8];
+  if ( !ifs.read(magic, 8) || memcmp(magic, kIndexMagic, 8) != 0 ) {
+    return false;
+  }
+  ymuint64 file_size;
+  ymuint64 mtime;
+  ymuint64 mtime_nsec;
+  ymuint64 header_size;
+  ymuint64 n;
+  if ( !get_u64(ifs, file_size) ||
+       !get_u64(ifs, mtime) ||
+       !get_u64(ifs, mtime_nsec) ||
+       !get_u64(ifs, header_size) ||
+       !get_u64(ifs, n) ) {
+    return false;
+  }
+  if ( file_size != mFileSize ||
+       static_cast<ymint64>(mtime) != mMtime ||
+       static_cast<ymint64>(mtime_nsec) != mMtimeNsec ) {
+    // 元のファイルが変わっている．
+    return false;
+  }
+  if ( header_size > mFileSize || n > mFileSize / 4 ) {
+    return false;
+  }
+
+  vector<StructInfo> struct_list(n);
+  for (ymuint64 i = 0; i < n; ++ i) {
+    StructInfo& info = struct_list[i];
+    ymuint64 len;
+    if ( !get_u64(ifs, info.mOffset) ||
+	 !get_u64(ifs, info.mSize) ||
+	 !get_u64(ifs, len) ) {
+      return false;
+    }
+    if ( info.mOffset + info.mSize > mFileSize || len > 0xFFFF ) {
+      return false;
+    }
+    info.mName.resize(len);
+    if ( len > 0 && !ifs.read(&info.mName[0], len) ) {
+      return false;
+    }
+  }
+
+  // 同じ秒のうちに同じサイズのファイルで置き換えられた場合や
+  // 時刻を戻された場合に備えて中身も調べる．
+  if ( n > 0 && header_size != struct_list[0].mOffset ) {
+    return false;
+  }
+  for (ymuint64 i = 0; i < n; ++ i) {
+    if ( !check_info(mData, mFileSize, struct_list[i]) ) {
+      return false;
+    }
+  }
+
+  mHeaderSize = header_size;
+  mStructList.swap(struct_list);
+  make_map();
+  return true;
+}
+
+// @brief 索引を保存する．
+// @param[in] filename 索引のファイル名
+// @retval true 成功した．
+// @retval false 書き込みに失敗した．
+bool
+GdsStructIndex::write_index(const char* filename) const
+{
+  std::ofstream ofs(filename, std::ios::out | std::ios::binary);
+  if ( !ofs ) {
+    error_header(__FILE__, __LINE__, "GdsStructIndex", 0)
+      << filename << ": Could not create";
+    msg_end();
+    return false;
+  }
+
+  ofs.write(kIndexMagic, 8);
+  put_u64(ofs, mFileSize);
+  put_u64(ofs, static_cast<ymuint64>(mMtime));
+  put_u64(ofs, static_cast<ymuint64>(mMtimeNsec));
+  put_u64(ofs, mHeaderSize);
+  put_u64(ofs, mStructList.size());
+  for (ymuint i = 0; i < mStructList.size(); ++ i) {
+    const StructInfo& info = mStructList[i];
+    put_u64(ofs, info.mOffset);
+    put_u64(ofs, info.mSize);
+    put_u64(ofs, info.mName.size());
+    ofs.write(info.mName.c_str(), info.mName.size());
+  }
+  ofs.close();
+  if ( !ofs ) {
+    error_header(__FILE__, __LINE__, "GdsStructIndex", 0)
+      << filename << ": write error";
+    msg_end();
+    return false;
+  }
+  return true;
+}
+
+// @brief 保存した索引を読み込み，使えなければ作り直す．
+// @param[in] filename 索引のファイル名 (NULL の時は保存した索引を用いない)
+// @param[in] save true の時は作り直した索引を filename に保存する．
+// @retval true 成功した．
+// @retval false 形式が正しくなかった．
+//
+// 索引を保存できなくても true を返す．
+bool
+GdsStructIndex::read_or_build(const char* filename,
+			      bool save)
+{
+  if ( filename != NULL && read_index(filename) ) {
+    return true;
+  }
+  if ( !build() ) {
+    return false;
+  }
+  if ( filename != NULL && save ) {
+    // 保存できなくても処理は続ける．
+    write_index(filename);
+  }
+  return true;
+}
+
+// @brief 索引のファイル名の既定値を返す．
+// @param[in] filename GDS-II ファイル名
+string
+GdsStructIndex::default_index_name(const string& filename)
+{
+  return filename + ".sidx";
+}
+
+// @brief ファイルの先頭を返す．
+const ymuint8*
+GdsStructIndex::data() const
+{
+  return mData;
+}
+
+// @brief ファイルのサイズを返す．
+ymuint64
+GdsStructIndex::file_size() const
+{
+  return mFileSize;
+}
+
+// @brief 最初の構造の前のヘッダ部分のサイズを返す．
+ymuint64
+GdsStructIndex::header_size() const
+{
+  return mHeaderSize;
+}
+
+// @brief 構造の数を返す．
+ymuint
+GdsStructIndex::struct_num() const
+{
+  return mStructList.size();
+}
+
+// @brief 構造の名前を返す．
+// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+const string&
+GdsStructIndex::struct_name(ymuint id) const
+{
+  ASSERT_COND( id < struct_num() );
+  return mStructList[id].mName;
+}
+
+// @brief 構造のファイル上の先頭位置を返す．
+// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+ymuint64
+GdsStructIndex::struct_offset(ymuint id) const
+{
+  ASSERT_COND( id < struct_num() );
+  return mStructList[id].mOffset;
+}
+
+// @brief 構造のサイズを返す．
+// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+//
+// BGNSTR から ENDSTR までのバイト数
+ymuint64
+GdsStructIndex::struct_size(ymuint id) const
+{
+  ASSERT_COND( id < struct_num() );
+  return mStructList[id].mSize;
+}
+
+// @brief 名前から構造を探す．
+// @param[in] name 構造名
+// @return 構造番号を返す．
+//
+// 見つからない時は struct_num() を返す．
+ymuint
+GdsStructIndex::find(const string& name) const
+{
+  std::map<string, ymuint>::const_iterator p = mStructMap.find(name);
+  if ( p == mStructMap.end() ) {
+    return struct_num();
+  }
+  return p->second;
+}
+
+// @brief 構造が参照している構造名のリストを得る．
+// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+// @param[out] name_list 構造名のリスト
+// @retval true 成功した．
+// @retval false 形式が正しくなかった．
+//
+// 構造の SNAME レコードだけを読む．
+// name_list は重複を除いて現れた順に並ぶ．
+bool
+GdsStructIndex::ref_list(ymuint id,
+			 vector<string>& name_list) const
+{
+  ASSERT_COND( id < struct_num() );
+
+  name_list.clear();
+
+  const StructInfo& info = mStructList[id];
+  if ( info.mSize > 0xFFFF0000ULL ) {
+    error_header(__FILE__, __LINE__, "GdsStructIndex", info.mOffset)
+      << info.mName << ": too large structure";
+    msg_end();
+    return false;
+  }
+  const ymuint8* begin = mData + info.mOffset;
+  madvise(const_cast<ymuint8*>(begin), info.mSize, MADV_WILLNEED);
+
+  GdsScanner scanner;
+  scanner.open_memory(begin, info.mSize, info.mOffset);
+  std::map<string, bool> name_map;
+  while ( scanner.read_rec() ) {
+    if ( scanner.cur_rtype() != kGdsSNAME ) {
+      continue;
+    }
+    const char* str = reinterpret_cast<const char*>(scanner.cur_data());
+    ymuint len = scanner.cur_dsize();
+    while ( len > 0 && str[len - 1] == '\0' ) {
+      -- len;
+    }
+    string name(str, len);
+    if ( name_map.count(name) == 0 ) {
+      name_map[name] = true;
+      name_list.push_back(name);
+    }
+  }
+  if ( scanner.cur_pos() < info.mSize ) {
+    error_header(__FILE__, __LINE__, "GdsStructIndex", info.mOffset)
+      << info.mName << ": format error";
+    msg_end();
+    return false;
+  }
+  return true;
+}
+
+// @brief 指定した構造とその子孫の構造を求める．
+// @param[in] root_list 根の構造番号のリスト
+// @param[out] id_list 結果の構造番号のリスト
+// @retval true 成功した．
+// @retval false 形式が正しくなかった．
+//
+// id_list はファイル中の順に並ぶ．
+// ファイル中にない構造を参照していたら警告を出して無視する．
+bool
+GdsStructIndex::closure(const vector<ymuint>& root_list,
+			vector<ymuint>& id_list) const
+{
+  id_list.clear();
+
+  ymuint n = struct_num();
+  vector<bool> mark(n, false);
+  vector<ymuint> queue;
+  for (ymuint i = 0; i < root_list.size(); ++ i) {
+    ymuint id = root_list[i];
+    ASSERT_COND( id < n );
+    if ( !mark[id] ) {
+      mark[id] = true;
+      queue.push_back(id);
+    }
+  }
+
+  // 深さごとにまとめて並列に SNAME を読む．
+  bool stat = true;
+  std::map<string, bool> missing_map;
+  while ( !queue.empty() ) {
+    ymuint qn = queue.size();
+    vector<vector<string> > ref_array(qn);
+    vector<ymuint8> ok_array(qn, 1);
+    // 並列に出されたメッセージはファイル位置の順に並べる．
+    MsgMgr& msgmgr = MsgMgr::the_mgr();
+    bool ordered = msgmgr.ordered();
+    msgmgr.set_ordered(true);
+    parallel_for(qn, mThreadNum, [&](ymuint i) {
+	ok_array[i] = ref_list(queue[i], ref_array[i]);
+      });
+    msgmgr.set_ordered(ordered);
+
+    id_list.insert(id_list.end(), queue.begin(), queue.end());
+    vector<ymuint> next_queue;
+    for (ymuint i = 0; i < qn; ++ i) {
+      if ( !ok_array[i] ) {
+	stat = false;
+	continue;
+      }
+      const vector<string>& name_list = ref_array[i];
+      for (ymuint j = 0; j < name_list.size(); ++ j) {
+	const string& name = name_list[j];
+	ymuint id = find(name);
+	if ( id == n ) {
+	  if ( missing_map.count(name) == 0 ) {
+	    missing_map[name] = true;
+	    warning_header(__FILE__, __LINE__, "GdsStructIndex", 0)
+	      << name << ": referenced from " << struct_name(queue[i])
+	      << " but not defined";
+	    msg_end();
+	  }
+	  continue;
+	}
+	if ( !mark[id] ) {
+	  mark[id] = true;
+	  next_queue.push_back(id);
+	}
+      }
+    }
+    queue.swap(next_queue);
+  }
+
+  sort(id_list.begin(), id_list.end());
+  return stat;
+}
+
+// @brief ヘッダ部分をそのまま書き出す．
+// @param[in] writer 出力先
+// @retval true 成功した．
+// @retval false 書き込みに失敗した．
+bool
+GdsStructIndex::copy_header(GdsWriter& writer) const
+{
+  return writer.write_raw(mData, mHeaderSize);
+}
+
+// @brief 構造のバイト列をそのまま書き出す．
+// @param[in] id 構造番号 ( 0 <= id < struct_num() )
+// @param[in] writer 出力先
+// @retval true 成功した．
+// @retval false 書き込みに失敗した．
+bool
+GdsStructIndex::copy_struct(ymuint id,
+			    GdsWriter& writer) const
+{
+  ASSERT_COND( id < struct_num() );
+
+  const StructInfo& info = mStructList[id];
+  const ymuint8* begin = mData + info.mOffset;
+  madvise(const_cast<ymuint8*>(begin), info.mSize, MADV_WILLNEED);
+  return writer.write_raw(begin, info.mSize);
+}
+
+// @brief mStructMap を作る．
+void
+GdsStructIndex::make_map()
+{
+  mStructMap.clear();
+  for (ymuint i = 0; i < mStructList.size(); ++ i) {
+    const string& name = mStructList[i].mName;
+    if ( mStructMap.count(name) > 0 ) {
+      // 同名の構造は最初のものを用いる．
+      warning_header(__FILE__, __LINE__, "GdsStructIndex", mStructList[i].mOffset)
+	<< name << ": duplicated structure name";
+      msg_end();
+      continue;
+    }
+    mStructMap.insert(make_pair(name, i));
+  }
+}
+
+// @brief 構造の情報が元のファイルの内容と一致するか調べる．
+// @param[in] data ファイルの先頭
+// @param[in] size ファイルのサイズ
+// @param[in] info 構造の情報
+bool
+GdsStructIndex::check_info(const ymuint8* data,
+			   ymuint64 size,
+			   const StructInfo& info)
+{
+  ymuint64 begin = info.mOffset;
+  ymuint64 end = info.mOffset + info.mSize;
+  if ( data == NULL || end > size || info.mSize < 8 ) {
+    return false;
+  }
+
+  // 先頭は BGNSTR
+  if ( data[begin + 2] != kGdsBGNSTR ) {
+    return false;
+  }
+
+  // 末尾は ENDSTR
+  if ( data[end - 4] != 0 || data[end - 3] != 4 ||
+       data[end - 2] != kGdsENDSTR ) {
+    return false;
+  }
+
+  // STRNAME を探して名前を比べる．
+  ymuint64 pos = begin;
+  while ( pos + 4 <= end ) {
+    ymuint rsize = (data[pos] << 8) | data[pos + 1];
+    if ( rsize == 0 ) {
+      pos += 2;
+      continue;
+    }
+    if ( rsize < 4 || pos + rsize > end ) {
+      return false;
+    }
+    ymuint8 rtype = data[pos + 2];
+    if ( rtype == kGdsSTRNAME ) {
+      const char* str = reinterpret_cast<const char*>(data + pos + 4);
+      ymuint len = rsize - 4;
+      while ( len > 0 && str[len - 1] == '\0' ) {
+	-- len;
+      }
+      return info.mName.size() == len &&
+	memcmp(info.mName.c_str(), str, len) == 0;
+    }
+    if ( rtype == kGdsENDSTR ) {
+      break;
+    }
+    pos += rsize;
+  }
+  return false;
+}
+
+END_NAMESPACE_YM_GDS
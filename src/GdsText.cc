@@ -9,6 +9,7 @@
 
 #include "GdsText.h"
 #include "YmGds/GdsString.h"
+#include "YmGds/GdsStrans.h"
 
 
 BEGIN_NAMESPACE_YM_GDS
@@ -55,6 +56,13 @@ GdsText::~GdsText()
 {
 }
 
+// @brief 要素の種類を返す．
+GdsRtype
+GdsText::type() const
+{
+  return kGdsTEXT;
+}
+
 // @brief 層番号を返す．
 int
 GdsText::layer() const
@@ -87,7 +95,9 @@ GdsText::width() const
 bool
 GdsText::reflection() const
 {
-  // mPresentation ビットを解析する．
+  if ( mStrans ) {
+    return mStrans->reflection();
+  }
   return false;
 }
 
@@ -95,7 +105,9 @@ GdsText::reflection() const
 bool
 GdsText::absolute_magnification() const
 {
-  // mPresentation ビットを解析する．
+  if ( mStrans ) {
+    return mStrans->absolute_magnification();
+  }
   return false;
 }
 
@@ -103,7 +115,9 @@ GdsText::absolute_magnification() const
 bool
 GdsText::absolute_angle() const
 {
-  // mPresentation ビットを解析する．
+  if ( mStrans ) {
+    return mStrans->absolute_angle();
+  }
   return false;
 }
 
@@ -111,13 +125,19 @@ GdsText::absolute_angle() const
 double
 GdsText::mag() const
 {
-  return 0.0;
+  if ( mStrans ) {
+    return mStrans->mag();
+  }
+  return 1.0;
 }
 
 // @brief angular rotation factor を返す．
 double
 GdsText::angle() const
 {
+  if ( mStrans ) {
+    return mStrans->angle();
+  }
   return 0.0;
 }
 
@@ -0,0 +1,488 @@
+﻿
+/// @file GdsTextIndex.cc
+/// @brief GdsTextIndex の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsTextIndex.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsHier.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <algorithm>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief '[...]' の形の文字クラスと照合する．
+// @param[in] p '[' の位置
+// @param[in] c 対象の文字
+// @param[out] next 文字クラスの次の位置
+//
+// 閉じる ']' がない場合は '[' をそのままの文字として扱う．
+static
+bool
+match_class(const char* p,
+	    char c,
+	    const char*& next)
+{
+  const char* q = p + 1;
+  bool negate = false;
+  if ( *q == '!' || *q == '^' ) {
+    negate = true;
+    ++ q;
+  }
+  // 先頭の ']' はそのままの文字とみなす．
+  const char* end = q;
+  if ( *end == ']' ) {
+    ++ end;
+  }
+  while ( *end != '\0' && *end != ']' ) {
+    ++ end;
+  }
+  if ( *end == '\0' ) {
+    next = p + 1;
+    return c == '[';
+  }
+  next = end + 1;
+
+  unsigned char uc = static_cast<unsigned char>(c);
+  bool found = false;
+  while ( q < end ) {
+    unsigned char lo = static_cast<unsigned char>(q[0]);
+    if ( q + 2 < end && q[1] == '-' ) {
+      unsigned char hi = static_cast<unsigned char>(q[2]);
+      if ( lo <= uc && uc <= hi ) {
+	found = true;
+      }
+      q += 3;
+    }
+    else {
+      if ( lo == uc ) {
+	found = true;
+      }
+      ++ q;
+    }
+  }
+  return found != negate;
+}
+
+// @brief 文字列がパタンに合う時 true を返す．
+// @param[in] p パタン
+// @param[in] s 文字列
+static
+bool
+glob_match(const char* p,
+	   const char* s)
+{
+  // 最後に現れた '*' の位置と，そこで照合を始めた文字列の位置
+  const char* star_p = NULL;
+  const char* star_s = NULL;
+  while ( *s != '\0' ) {
+    if ( *p == '*' ) {
+      ++ p;
+      star_p = p;
+      star_s = s;
+      continue;
+    }
+    if ( *p != '\0' ) {
+      const char* next;
+      bool ok;
+      if ( *p == '?' ) {
+	ok = true;
+	next = p + 1;
+      }
+      else if ( *p == '[' ) {
+	ok = match_class(p, *s, next);
+      }
+      else if ( *p == '\\' && p[1] != '\0' ) {
+	ok = p[1] == *s;
+	next = p + 2;
+      }
+      else {
+	ok = *p == *s;
+	next = p + 1;
+      }
+      if ( ok ) {
+	p = next;
+	++ s;
+	continue;
+      }
+    }
+    // 直前の '*' に一文字多く対応させてやり直す．
+    if ( star_p == NULL ) {
+      return false;
+    }
+    p = star_p;
+    ++ star_s;
+    s = star_s;
+  }
+  while ( *p == '*' ) {
+    ++ p;
+  }
+  return *p == '\0';
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsTextIndex
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsTextIndex::GdsTextIndex() :
+  mThreadNum(0),
+  mData(NULL),
+  mTop(NULL)
+{
+}
+
+// @brief デストラクタ
+GdsTextIndex::~GdsTextIndex()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsTextIndex::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief 索引を作る．
+// @param[in] data 対象のデータ
+//
+// data はこのオブジェクトより長く存在しなければならない．
+void
+GdsTextIndex::build(const GdsData& data)
+{
+  mData = &data;
+  mEntryList.clear();
+  mParentArray.clear();
+  mTop = NULL;
+  mCountArray.clear();
+
+  // 文字列，構造，構造中の順番の辞書式順序
+  auto comp = [](const Entry& a, const Entry& b) -> bool {
+    int c = strcmp(a.mText, b.mText);
+    if ( c != 0 ) {
+      return c < 0;
+    }
+    if ( a.mStruct->id() != b.mStruct->id() ) {
+      return a.mStruct->id() < b.mStruct->id();
+    }
+    return a.mSeq < b.mSeq;
+  };
+
+  // 構造ごとに TEXT 要素を集めて整列する．
+  ymuint n = data.struct_num();
+  vector<vector<Entry> > list_array(n);
+  parallel_for(n, mThreadNum, [&](ymuint id) {
+      const GdsStruct* str = data.structure(id);
+      vector<Entry>& entry_list = list_array[id];
+      ymuint32 seq = 0;
+      for (const GdsElement* elem = str->element(); elem; elem = elem->next(), ++ seq) {
+	if ( elem->type() != kGdsTEXT ) {
+	  continue;
+	}
+	Entry entry;
+	entry.mText = elem->text() != NULL ? elem->text() : "";
+	entry.mStruct = str;
+	entry.mElem = elem;
+	entry.mSeq = seq;
+	entry_list.push_back(entry);
+      }
+      std::sort(entry_list.begin(), entry_list.end(), comp);
+    });
+
+  // 整列済みの区間を二つずつ並列にマージする．
+  vector<ymuint> bound_list(1, 0);
+  for (ymuint id = 0; id < n; ++ id) {
+    if ( list_array[id].empty() ) {
+      continue;
+    }
+    mEntryList.insert(mEntryList.end(), list_array[id].begin(), list_array[id].end());
+    vector<Entry>().swap(list_array[id]);
+    bound_list.push_back(mEntryList.size());
+  }
+  while ( bound_list.size() > 2 ) {
+    ymuint nr = bound_list.size() - 1;
+    parallel_for(nr / 2, mThreadNum, [&](ymuint i) {
+	std::inplace_merge(mEntryList.begin() + bound_list[i * 2 + 0],
+			   mEntryList.begin() + bound_list[i * 2 + 1],
+			   mEntryList.begin() + bound_list[i * 2 + 2],
+			   comp);
+      });
+    vector<ymuint> new_list;
+    for (ymuint i = 0; i <= nr; i += 2) {
+      new_list.push_back(bound_list[i]);
+    }
+    if ( nr % 2 != 0 ) {
+      new_list.push_back(bound_list[nr]);
+    }
+    bound_list.swap(new_list);
+  }
+
+  // 親の構造からの参照を集める．
+  mParentArray.resize(n);
+  for (ymuint id = 0; id < n; ++ id) {
+    const GdsStruct* str = data.structure(id);
+    for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+      if ( elem->type() != kGdsSREF && elem->type() != kGdsAREF ) {
+	continue;
+      }
+      const GdsStruct* child = elem->ref_struct();
+      if ( child == NULL ) {
+	continue;
+      }
+      ParentRef ref;
+      ref.mParent = str;
+      ref.mElem = elem;
+      mParentArray[child->id()].push_back(ref);
+    }
+  }
+}
+
+// @brief 最上位の構造を設定する．
+// @param[in] top_name 最上位の構造名
+// @retval true 成功した．
+// @retval false 最上位の構造が決まらないか階層が循環していた．
+//
+// top_name が NULL の時は唯一の最上位の構造を用いる．
+// build() の後で呼ばなければならない．
+bool
+GdsTextIndex::set_top(const char* top_name)
+{
+  ASSERT_COND( mData != NULL );
+
+  mTop = NULL;
+  mCountArray.clear();
+
+  GdsHier hier(*mData);
+  const GdsStruct* top = NULL;
+  if ( top_name != NULL ) {
+    top = mData->find_struct(top_name);
+    if ( top == NULL ) {
+      error_header(__FILE__, __LINE__, "GdsTextIndex", 0)
+	<< top_name << ": No such structure";
+      msg_end();
+      return false;
+    }
+  }
+  else {
+    if ( hier.top_num() != 1 ) {
+      error_header(__FILE__, __LINE__, "GdsTextIndex", 0)
+	<< hier.top_num() << " top structures. Specify one of them";
+      msg_end();
+      return false;
+    }
+    top = hier.top(0);
+  }
+  if ( !hier.calc_count(top) ) {
+    return false;
+  }
+
+  ymuint n = mData->struct_num();
+  mCountArray.resize(n);
+  for (ymuint id = 0; id < n; ++ id) {
+    mCountArray[id] = hier.count(id);
+  }
+  mTop = top;
+  return true;
+}
+
+// @brief 登録されている TEXT 要素の数を返す．
+ymuint
+GdsTextIndex::text_num() const
+{
+  return mEntryList.size();
+}
+
+// @brief 文字列を返す．
+// @param[in] id 番号 ( 0 <= id < text_num() )
+//
+// 番号は文字列の順に振られている．
+const char*
+GdsTextIndex::text(ymuint id) const
+{
+  ASSERT_COND( id < text_num() );
+  return mEntryList[id].mText;
+}
+
+// @brief TEXT 要素を含む構造を返す．
+// @param[in] id 番号 ( 0 <= id < text_num() )
+const GdsStruct*
+GdsTextIndex::text_struct(ymuint id) const
+{
+  ASSERT_COND( id < text_num() );
+  return mEntryList[id].mStruct;
+}
+
+// @brief TEXT 要素を返す．
+// @param[in] id 番号 ( 0 <= id < text_num() )
+const GdsElement*
+GdsTextIndex::text_elem(ymuint id) const
+{
+  ASSERT_COND( id < text_num() );
+  return mEntryList[id].mElem;
+}
+
+// @brief 文字列が一致する要素を探す．
+// @param[in] str 文字列
+// @param[out] id_list 見つかった要素の番号のリスト
+void
+GdsTextIndex::find(const char* str,
+		   vector<ymuint>& id_list) const
+{
+  id_list.clear();
+  for (ymuint id = lower_bound(str);
+       id < mEntryList.size() && strcmp(mEntryList[id].mText, str) == 0; ++ id) {
+    id_list.push_back(id);
+  }
+}
+
+// @brief 文字列が指定した文字列で始まる要素を探す．
+// @param[in] prefix 先頭の文字列
+// @param[out] id_list 見つかった要素の番号のリスト
+void
+GdsTextIndex::find_prefix(const char* prefix,
+			  vector<ymuint>& id_list) const
+{
+  id_list.clear();
+  ymuint len = strlen(prefix);
+  for (ymuint id = lower_bound(prefix);
+       id < mEntryList.size() && strncmp(mEntryList[id].mText, prefix, len) == 0; ++ id) {
+    id_list.push_back(id);
+  }
+}
+
+// @brief 文字列がパタンに合う要素を探す．
+// @param[in] pattern パタン
+// @param[out] id_list 見つかった要素の番号のリスト
+//
+// パタンには '*', '?', '[...]' ('[!...]' は否定) が使える．
+// '\' の次の文字はそのままの文字として扱う．
+void
+GdsTextIndex::find_glob(const char* pattern,
+			vector<ymuint>& id_list) const
+{
+  id_list.clear();
+
+  // 先頭の固定部分を取り出す．
+  string prefix;
+  for (const char* p = pattern; *p != '\0'; ++ p) {
+    if ( *p == '*' || *p == '?' || *p == '[' ) {
+      break;
+    }
+    if ( *p == '\\' && p[1] != '\0' ) {
+      ++ p;
+    }
+    prefix += *p;
+  }
+
+  for (ymuint id = lower_bound(prefix.c_str());
+       id < mEntryList.size() &&
+	 strncmp(mEntryList[id].mText, prefix.c_str(), prefix.size()) == 0; ++ id) {
+    if ( glob_match(pattern, mEntryList[id].mText) ) {
+      id_list.push_back(id);
+    }
+  }
+}
+
+// @brief 最上位の構造を返す．
+//
+// set_top() を呼んでいない時は NULL を返す．
+const GdsStruct*
+GdsTextIndex::top() const
+{
+  return mTop;
+}
+
+// @brief 最上位の構造の下での配置数を返す．
+// @param[in] str 対象の構造
+//
+// 最上位から到達できない構造は 0 となる．
+ymuint64
+GdsTextIndex::placement_num(const GdsStruct* str) const
+{
+  if ( mTop == NULL ) {
+    return 0;
+  }
+  return mCountArray[str->id()];
+}
+
+// @brief 最上位の構造の下でのすべての配置の座標変換を求める．
+// @param[in] str 対象の構造
+// @param[out] trans_list str の座標を最上位の座標に移す変換のリスト
+//
+// 結果の数は placement_num(str) に等しい．
+void
+GdsTextIndex::placement_list(const GdsStruct* str,
+			     vector<GdsTrans>& trans_list) const
+{
+  trans_list.clear();
+  ymuint64 num = placement_num(str);
+  if ( num == 0 ) {
+    return;
+  }
+  trans_list.reserve(num);
+  walk_up(str, GdsTrans(), trans_list);
+}
+
+// @brief 文字列が str 以上の最初の位置を返す．
+ymuint
+GdsTextIndex::lower_bound(const char* str) const
+{
+  ymuint lo = 0;
+  ymuint hi = mEntryList.size();
+  while ( lo < hi ) {
+    ymuint mid = lo + (hi - lo) / 2;
+    if ( strcmp(mEntryList[mid].mText, str) < 0 ) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// @brief 親の構造をたどって配置の座標変換を求める．
+// @param[in] str 対象の構造
+// @param[in] trans 元の構造の座標を str の座標に移す変換
+// @param[out] trans_list 結果を格納するリスト
+void
+GdsTextIndex::walk_up(const GdsStruct* str,
+		      const GdsTrans& trans,
+		      vector<GdsTrans>& trans_list) const
+{
+  if ( str == mTop ) {
+    trans_list.push_back(trans);
+    return;
+  }
+
+  const vector<ParentRef>& ref_list = mParentArray[str->id()];
+  for (ymuint i = 0; i < ref_list.size(); ++ i) {
+    const ParentRef& ref = ref_list[i];
+    // 最上位から到達できない親はたどらない．
+    if ( mCountArray[ref.mParent->id()] == 0 ) {
+      continue;
+    }
+    ymuint ncol = ref.mElem->column();
+    ymuint nrow = ref.mElem->row();
+    for (ymuint r = 0; r < nrow; ++ r) {
+      for (ymuint c = 0; c < ncol; ++ c) {
+	walk_up(ref.mParent, GdsTrans(ref.mElem, c, r) * trans, trans_list);
+      }
+    }
+  }
+}
+
+END_NAMESPACE_YM_GDS
@@ -0,0 +1,173 @@
+﻿
+/// @file GdsTrans.cc
+/// @brief GdsTrans の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsTrans.h"
+#include "YmGds/GdsBBox.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsXY.h"
+#include <cmath>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsTrans
+//////////////////////////////////////////////////////////////////////
+
+// @brief 恒等変換を表すコンストラクタ
+GdsTrans::GdsTrans() :
+  mA(1.0),
+  mB(0.0),
+  mC(0.0),
+  mD(1.0),
+  mTx(0.0),
+  mTy(0.0)
+{
+}
+
+// @brief 要素の変換を表すコンストラクタ
+// @param[in] elem 対象の要素 ( SREF/AREF/TEXT )
+// @param[in] col AREF の column 番号
+// @param[in] row AREF の row 番号
+//
+// SREF と TEXT の場合には col, row は無視される．
+GdsTrans::GdsTrans(const GdsElement* elem,
+		   ymuint col,
+		   ymuint row)
+{
+  double mag = elem->mag();
+  double angle = elem->angle();
+
+  // 90 度の倍数の時は誤差が出ないように値を直接与える．
+  double c;
+  double s;
+  double q = angle / 90.0;
+  if ( q == floor(q) ) {
+    int iq = static_cast<int>(fmod(q, 4.0));
+    if ( iq < 0 ) {
+      iq += 4;
+    }
+    static const double cos_table[] = { 1.0, 0.0, -1.0, 0.0 };
+    static const double sin_table[] = { 0.0, 1.0, 0.0, -1.0 };
+    c = cos_table[iq];
+    s = sin_table[iq];
+  }
+  else {
+    double rad = angle * M_PI / 180.0;
+    c = cos(rad);
+    s = sin(rad);
+  }
+
+  // 反転 -> 拡大 -> 回転 の順に適用する．
+  double ry = elem->reflection() ? -1.0 : 1.0;
+  mA = mag * c;
+  mB = - mag * s * ry;
+  mC = mag * s;
+  mD = mag * c * ry;
+
+  const GdsXY* xy = elem->xy();
+  mTx = xy->x(0);
+  mTy = xy->y(0);
+  if ( elem->type() == kGdsAREF ) {
+    int ncol = elem->column();
+    int nrow = elem->row();
+    if ( ncol > 0 ) {
+      mTx += static_cast<double>(xy->x(1) - xy->x(0)) * col / ncol;
+      mTy += static_cast<double>(xy->y(1) - xy->y(0)) * col / ncol;
+    }
+    if ( nrow > 0 ) {
+      mTx += static_cast<double>(xy->x(2) - xy->x(0)) * row / nrow;
+      mTy += static_cast<double>(xy->y(2) - xy->y(0)) * row / nrow;
+    }
+  }
+}
+
+// @brief デストラクタ
+GdsTrans::~GdsTrans()
+{
+}
+
+// @brief 点を変換する．
+// @param[in] x, y 元の座標
+// @param[out] ox, oy 変換後の座標
+//
+// 結果は最も近い整数に丸められる．
+void
+GdsTrans::apply(ymint32 x,
+		ymint32 y,
+		ymint32& ox,
+		ymint32& oy) const
+{
+  double dx = mA * x + mB * y + mTx;
+  double dy = mC * x + mD * y + mTy;
+  ox = static_cast<ymint32>(floor(dx + 0.5));
+  oy = static_cast<ymint32>(floor(dy + 0.5));
+}
+
+// @brief 矩形を変換した結果の外接矩形を求める．
+// @param[in] bbox 元の矩形
+GdsBBox
+GdsTrans::apply(const GdsBBox& bbox) const
+{
+  GdsBBox ans;
+  if ( bbox.is_empty() ) {
+    return ans;
+  }
+
+  ymint32 x;
+  ymint32 y;
+  apply(bbox.xmin(), bbox.ymin(), x, y);
+  ans.add_point(x, y);
+  apply(bbox.xmax(), bbox.ymin(), x, y);
+  ans.add_point(x, y);
+  apply(bbox.xmin(), bbox.ymax(), x, y);
+  ans.add_point(x, y);
+  apply(bbox.xmax(), bbox.ymax(), x, y);
+  ans.add_point(x, y);
+  return ans;
+}
+
+// @brief 合成した変換を返す．
+// @param[in] right 先に適用する変換
+//
+// 結果は right を適用してから自身を適用する変換となる．
+GdsTrans
+GdsTrans::operator*(const GdsTrans& right) const
+{
+  GdsTrans ans;
+  ans.mA = mA * right.mA + mB * right.mC;
+  ans.mB = mA * right.mB + mB * right.mD;
+  ans.mC = mC * right.mA + mD * right.mC;
+  ans.mD = mC * right.mB + mD * right.mD;
+  ans.mTx = mA * right.mTx + mB * right.mTy + mTx;
+  ans.mTy = mC * right.mTx + mD * right.mTy + mTy;
+  return ans;
+}
+
+// @brief 回転が 90 度の倍数で拡大率が 1 の時 true を返す．
+bool
+GdsTrans::is_orthogonal() const
+{
+  if ( mA == 0.0 && mD == 0.0 ) {
+    return fabs(mB) == 1.0 && fabs(mC) == 1.0;
+  }
+  if ( mB == 0.0 && mC == 0.0 ) {
+    return fabs(mA) == 1.0 && fabs(mD) == 1.0;
+  }
+  return false;
+}
+
+// @brief 拡大率を返す．
+double
+GdsTrans::mag() const
+{
+  return sqrt(fabs(mA * mD - mB * mC));
+}
+
+END_NAMESPACE_YM_GDS
@@ -0,0 +1,417 @@
+﻿
+/// @file GdsValidator.cc
+/// @brief GdsValidator の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsValidator.h"
+#include "YmGds/GdsScanner.h"
+#include "YmGds/GdsStructIndex.h"
+#include "YmGds/Msg.h"
+#include "GdsRecTable.h"
+#include "GdsParallel.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <sys/mman.h>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// STRANS で定義されているビット
+// ( reflection, absolute magnification, absolute angle )
+static
+const ymuint16 kStransMask = 0x8006;
+
+// ELFLAGS で定義されているビット ( template, external )
+static
+const ymuint16 kElflagsMask = 0x0003;
+
+// PRESENTATION で定義されているビット ( font, 縦と横の位置合わせ )
+static
+const ymuint16 kPresentationMask = 0x003F;
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsValidator
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsValidator::GdsValidator() :
+  mThreadNum(0),
+  mErrorNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsValidator::~GdsValidator()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsValidator::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief 検査を行う．
+// @param[in] index 索引 ( build() か read_index() を済ませておく )
+// @retval true 誤りがなかった．
+// @retval false 誤りが見つかった．
+bool
+GdsValidator::check(const GdsStructIndex& index)
+{
+  mErrorNum = 0;
+
+  // 構造ごとの検査は並列に行う．
+  ymuint n = index.struct_num();
+  vector<StructResult> result_list(n);
+  // GdsScanner が並列に出すメッセージはファイル位置の順に並べる．
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  bool ordered = msgmgr.ordered();
+  msgmgr.set_ordered(true);
+  parallel_for(n, mThreadNum, [&](ymuint id) {
+      check_struct(index, id, result_list[id]);
+    });
+  msgmgr.set_ordered(ordered);
+
+  // 構造名の重複
+  std::map<string, ymuint> name_map;
+  for (ymuint id = 0; id < n; ++ id) {
+    const string& name = index.struct_name(id);
+    std::map<string, ymuint>::iterator p = name_map.find(name);
+    if ( p != name_map.end() ) {
+      ostringstream buf;
+      buf << "duplicate structure name (first defined at "
+	  << hex << index.struct_offset(p->second) << ")";
+      add_issue(result_list[id].mIssueList, index.struct_offset(id), buf.str());
+    }
+    else {
+      name_map[name] = id;
+    }
+  }
+
+  // 定義されていない構造の参照
+  vector<vector<ymuint> > child_list(n);
+  for (ymuint id = 0; id < n; ++ id) {
+    StructResult& result = result_list[id];
+    std::map<string, bool> done_map;
+    for (ymuint i = 0; i < result.mRefList.size(); ++ i) {
+      const Ref& ref = result.mRefList[i];
+      if ( done_map.count(ref.mName) > 0 ) {
+	continue;
+      }
+      done_map[ref.mName] = true;
+      ymuint child = index.find(ref.mName);
+      if ( child == n ) {
+	add_issue(result.mIssueList, ref.mOffset,
+		  ref.mName + ": undefined structure");
+      }
+      else {
+	child_list[id].push_back(child);
+      }
+    }
+  }
+
+  // 構造の再帰的な参照
+  check_cycle(index, child_list, result_list);
+
+  // ファイル上の順に出力する．
+  for (ymuint id = 0; id < n; ++ id) {
+    vector<Issue>& issue_list = result_list[id].mIssueList;
+    stable_sort(issue_list.begin(), issue_list.end(),
+		[](const Issue& a, const Issue& b) {
+		  return a.mOffset < b.mOffset;
+		});
+    for (ymuint i = 0; i < issue_list.size(); ++ i) {
+      const Issue& issue = issue_list[i];
+      error_header(__FILE__, __LINE__, "GdsValidator", issue.mOffset)
+	<< index.struct_name(id) << ": " << issue.mMsg;
+      msg_end();
+      ++ mErrorNum;
+    }
+  }
+
+  return mErrorNum == 0;
+}
+
+// @brief 直前の check() で見つかった誤りの数を返す．
+ymuint
+GdsValidator::error_num() const
+{
+  return mErrorNum;
+}
+
+// @brief 一つの構造の中を検査する．
+// @param[in] index 索引
+// @param[in] id 構造番号
+// @param[out] result 結果
+//
+// 異なる構造に対して並列に呼ばれる．
+void
+GdsValidator::check_struct(const GdsStructIndex& index,
+			   ymuint id,
+			   StructResult& result)
+{
+  vector<Issue>& issue_list = result.mIssueList;
+  ymuint64 base = index.struct_offset(id);
+  ymuint64 size = index.struct_size(id);
+  if ( size > 0xFFFF0000ULL ) {
+    add_issue(issue_list, base, "too large structure");
+    return;
+  }
+  const ymuint8* begin = index.data() + base;
+  madvise(const_cast<ymuint8*>(begin), size, MADV_WILLNEED);
+
+  const GdsRecTable& table = GdsRecTable::obj();
+
+  GdsScanner scanner;
+  scanner.open_memory(begin, size, base);
+
+  // 読んでいる要素の種類 ( 要素の外では kGdsENDEL )
+  GdsRtype elem_type = kGdsENDEL;
+  ymuint64 elem_offset = 0;
+  bool has_xy = false;
+  while ( scanner.read_rec() ) {
+    // cur_offset() はサイズの次の位置を指している．
+    ymuint64 offset = base + scanner.cur_offset() - 2;
+    switch ( scanner.cur_rtype() ) {
+    case kGdsBOUNDARY:
+    case kGdsPATH:
+    case kGdsSREF:
+    case kGdsAREF:
+    case kGdsTEXT:
+    case kGdsNODE:
+    case kGdsBOX:
+      elem_type = scanner.cur_rtype();
+      elem_offset = offset;
+      has_xy = false;
+      break;
+
+    case kGdsENDEL:
+      if ( elem_type != kGdsENDEL && !has_xy ) {
+	add_issue(issue_list, elem_offset,
+		  string(table.rtype_string(elem_type)) + " without XY");
+      }
+      elem_type = kGdsENDEL;
+      break;
+
+    case kGdsXY:
+      has_xy = true;
+      check_xy(scanner, elem_type, offset, issue_list);
+      break;
+
+    case kGdsCOLROW:
+      {
+	int cols = scanner.conv_2byte_int(0);
+	int rows = scanner.conv_2byte_int(1);
+	if ( cols < 1 || rows < 1 ) {
+	  ostringstream buf;
+	  buf << "COLROW out of range (" << cols << ", " << rows << ")";
+	  add_issue(issue_list, offset, buf.str());
+	}
+      }
+      break;
+
+    case kGdsSTRANS:
+      {
+	ymuint16 flags = static_cast<ymuint16>(scanner.conv_2byte_int(0));
+	if ( flags & ~kStransMask ) {
+	  ostringstream buf;
+	  buf << "undefined bits in STRANS (" << hex << flags << ")";
+	  add_issue(issue_list, offset, buf.str());
+	}
+      }
+      break;
+
+    case kGdsELFLAGS:
+      {
+	ymuint16 flags = static_cast<ymuint16>(scanner.conv_2byte_int(0));
+	if ( flags & ~kElflagsMask ) {
+	  ostringstream buf;
+	  buf << "undefined bits in ELFLAGS (" << hex << flags << ")";
+	  add_issue(issue_list, offset, buf.str());
+	}
+      }
+      break;
+
+    case kGdsPRESENTATION:
+      {
+	ymuint16 flags = static_cast<ymuint16>(scanner.conv_2byte_int(0));
+	// 縦と横の位置合わせはそれぞれ 0 から 2 まで
+	if ( (flags & ~kPresentationMask) ||
+	     (flags & 3U) == 3U || ((flags >> 2) & 3U) == 3U ) {
+	  ostringstream buf;
+	  buf << "illegal PRESENTATION (" << hex << flags << ")";
+	  add_issue(issue_list, offset, buf.str());
+	}
+      }
+      break;
+
+    case kGdsSNAME:
+      {
+	// 末尾の詰め物の '\0' は除く．
+	const char* str = reinterpret_cast<const char*>(scanner.cur_data());
+	ymuint len = scanner.cur_dsize();
+	while ( len > 0 && str[len - 1] == '\0' ) {
+	  -- len;
+	}
+	result.mRefList.push_back(Ref());
+	result.mRefList.back().mName = string(str, len);
+	result.mRefList.back().mOffset = offset;
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+  if ( scanner.cur_pos() < size ) {
+    add_issue(issue_list, base + scanner.cur_pos(), "format error");
+  }
+}
+
+// @brief XY の点の数を検査する．
+// @param[in] scanner XY を読んだスキャナ
+// @param[in] elem_type 要素の種類
+// @param[in] offset XY のファイル上の先頭位置
+// @param[out] issue_list 見つかった誤りを追加するリスト
+void
+GdsValidator::check_xy(const GdsScanner& scanner,
+		       GdsRtype elem_type,
+		       ymuint64 offset,
+		       vector<Issue>& issue_list)
+{
+  ymuint dsize = scanner.cur_dsize();
+  if ( dsize % 8 != 0 ) {
+    add_issue(issue_list, offset, "odd number of coordinates in XY");
+    return;
+  }
+  ymuint n = dsize / 8;
+
+  // 点の数の下限と上限
+  ymuint min_num = 1;
+  ymuint max_num = 1;
+  bool closed = false;
+  switch ( elem_type ) {
+  case kGdsBOUNDARY: min_num = 4; max_num = 8191; closed = true; break;
+  case kGdsPATH:     min_num = 2; max_num = 8191; break;
+  case kGdsSREF:     break;
+  case kGdsAREF:     min_num = 3; max_num = 3; break;
+  case kGdsTEXT:     break;
+  case kGdsNODE:     min_num = 1; max_num = 50; break;
+  case kGdsBOX:      min_num = 5; max_num = 5; closed = true; break;
+  default:
+    // 要素の外の XY は文法の誤りなのでここでは調べない．
+    return;
+  }
+
+  const GdsRecTable& table = GdsRecTable::obj();
+  if ( n < min_num || n > max_num ) {
+    ostringstream buf;
+    buf << table.rtype_string(elem_type) << " has " << n << " points (";
+    if ( min_num == max_num ) {
+      buf << min_num;
+    }
+    else {
+      buf << min_num << " - " << max_num;
+    }
+    buf << " expected)";
+    add_issue(issue_list, offset, buf.str());
+    return;
+  }
+
+  if ( closed ) {
+    ymuint last = (n - 1) * 2;
+    if ( scanner.conv_4byte_int(0) != scanner.conv_4byte_int(last) ||
+	 scanner.conv_4byte_int(1) != scanner.conv_4byte_int(last + 1) ) {
+      add_issue(issue_list, offset,
+		string(table.rtype_string(elem_type)) + " is not closed");
+    }
+  }
+}
+
+// @brief 構造の再帰的な参照を検査する．
+// @param[in] index 索引
+// @param[in] child_list 構造ごとの子の構造番号のリスト
+// @param[inout] result_list 構造ごとの検査結果
+//
+// 深さ優先でたどり，たどっている途中の構造に戻る枝を見つけたら
+// その閉路を誤りとする．深い階層でも大丈夫なように再帰は使わない．
+void
+GdsValidator::check_cycle(const GdsStructIndex& index,
+			  const vector<vector<ymuint> >& child_list,
+			  vector<StructResult>& result_list)
+{
+  ymuint n = child_list.size();
+
+  // 0: 未訪問, 1: たどっている途中, 2: 済み
+  vector<ymuint8> mark(n, 0);
+
+  // たどっている途中の構造番号と次に調べる子の位置
+  vector<ymuint> id_stack;
+  vector<ymuint> pos_stack;
+  for (ymuint root = 0; root < n; ++ root) {
+    if ( mark[root] != 0 ) {
+      continue;
+    }
+    mark[root] = 1;
+    id_stack.push_back(root);
+    pos_stack.push_back(0);
+    while ( !id_stack.empty() ) {
+      ymuint id = id_stack.back();
+      ymuint& pos = pos_stack.back();
+      if ( pos == child_list[id].size() ) {
+	mark[id] = 2;
+	id_stack.pop_back();
+	pos_stack.pop_back();
+	continue;
+      }
+      ymuint child = child_list[id][pos];
+      ++ pos;
+      if ( mark[child] == 0 ) {
+	mark[child] = 1;
+	id_stack.push_back(child);
+	pos_stack.push_back(0);
+      }
+      else if ( mark[child] == 1 ) {
+	// child から id までが閉路になっている．
+	ymuint start = id_stack.size() - 1;
+	while ( id_stack[start] != child ) {
+	  -- start;
+	}
+	string path;
+	for (ymuint i = start; i < id_stack.size(); ++ i) {
+	  path += index.struct_name(id_stack[i]);
+	  path += " -> ";
+	}
+	path += index.struct_name(child);
+	add_issue(result_list[child].mIssueList, index.struct_offset(child),
+		  "recursive reference: " + path);
+      }
+    }
+  }
+}
+
+// @brief 誤りを追加する．
+// @param[in] issue_list 追加するリスト
+// @param[in] offset ファイル上の位置
+// @param[in] msg メッセージ
+void
+GdsValidator::add_issue(vector<Issue>& issue_list,
+			ymuint64 offset,
+			const string& msg)
+{
+  issue_list.push_back(Issue());
+  issue_list.back().mOffset = offset;
+  issue_list.back().mMsg = msg;
+}
+
+END_NAMESPACE_YM_GDS
@@ -0,0 +1,632 @@
+﻿
+/// @file GdsWriter.cc
+/// @brief GdsWriter の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsWriter.h"
+#include "YmGds/GdsScanner.h"
+#include "YmGds/Msg.h"
+#include <fcntl.h>
+#include <time.h>
+#include <zlib.h>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+//////////////////////////////////////////////////////////////////////
+// GDS-II の書き出しを行うクラス
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsWriter::GdsWriter() :
+  mFd(-1),
+  mCompType(kGdsCompNone),
+  mLevel(6),
+  mThreadNum(1),
+  mBlockSize(1024 * 1024),
+  mBuffPos(0),
+  mCurPos(0)
+{
+}
+
+// @brief デストラクタ
+GdsWriter::~GdsWriter()
+{
+  close_file();
+}
+
+// @brief ファイルを開く
+// @param[in] filename ファイル名
+// @param[in] comp_type 圧縮形式
+// @param[in] level 圧縮レベル ( 0 - 9 )
+// @param[in] thread_num 圧縮に用いるスレッド数
+// @retval true オープンに成功した．
+// @retval false オープンに失敗した．
+bool
+GdsWriter::open_file(const string& filename,
+		     GdsCompType comp_type,
+		     int level,
+		     ymuint thread_num)
+{
+  close_file();
+
+  mFd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if ( mFd < 0 ) {
+    return false;
+  }
+
+  mCompType = comp_type;
+  mLevel = level;
+  if ( mLevel < 0 ) {
+    mLevel = 0;
+  }
+  else if ( mLevel > 9 ) {
+    mLevel = 9;
+  }
+  mThreadNum = thread_num;
+  if ( mThreadNum == 0 ) {
+    mThreadNum = std::thread::hardware_concurrency();
+    if ( mThreadNum == 0 ) {
+      mThreadNum = 1;
+    }
+  }
+  mBuff.resize(mBlockSize);
+  mBuffPos = 0;
+  mCurPos = 0;
+
+  return true;
+}
+
+// @brief ファイルを閉じる．
+// @retval true 残りのデータの書き出しに成功した．
+// @retval false 書き出しに失敗した．
+bool
+GdsWriter::close_file()
+{
+  if ( mFd < 0 ) {
+    return true;
+  }
+
+  bool stat = flush_buff();
+  if ( !wait_blocks() ) {
+    stat = false;
+  }
+  if ( !mPendingList.empty() ) {
+    // 端数のブロックを圧縮する．
+    mRunningList.swap(mPendingList);
+    for (ymuint i = 0; i < mRunningList.size(); ++ i) {
+      mWorkerList.push_back(std::thread(compress_block, mRunningList[i], mLevel));
+    }
+    if ( !wait_blocks() ) {
+      stat = false;
+    }
+  }
+
+  close(mFd);
+  mFd = -1;
+
+  return stat;
+}
+
+// @brief 圧縮の単位となるブロックサイズを設定する．
+// @param[in] size ブロックサイズ(バイト)
+// @retval true 設定した．
+// @retval false ファイルを開いているので設定しなかった．
+bool
+GdsWriter::set_block_size(ymuint32 size)
+{
+  // mBuff は open_file() で確保するので書き込み中には変えられない．
+  if ( mFd >= 0 ) {
+    return false;
+  }
+
+  if ( size < 4096 ) {
+    size = 4096;
+  }
+  mBlockSize = size;
+  return true;
+}
+
+// @brief データを持たないレコードを書き出す．
+// @param[in] rtype レコード型
+bool
+GdsWriter::write_nodata(GdsRtype rtype)
+{
+  return put_header(rtype, kGdsNodata, 0);
+}
+
+// @brief 2バイト整数のレコードを書き出す．
+// @param[in] rtype レコード型
+// @param[in] val 値
+bool
+GdsWriter::write_2int(GdsRtype rtype,
+		      ymint16 val)
+{
+  return write_2int(rtype, &val, 1);
+}
+
+// @brief 2バイト整数の配列のレコードを書き出す．
+// @param[in] rtype レコード型
+// @param[in] vals 値の配列
+// @param[in] n 要素数
+bool
+GdsWriter::write_2int(GdsRtype rtype,
+		      const ymint16* vals,
+		      ymuint n)
+{
+  if ( !put_header(rtype, kGds2Int, n * 2) ) {
+    return false;
+  }
+  ymuint8 buf[2];
+  for (ymuint i = 0; i < n; ++ i) {
+    ymuint16 v = static_cast<ymuint16>(vals[i]);
+    buf[0] = (v >> 8) & 255;
+    buf[1] = v & 255;
+    if ( !put_bytes(buf, 2) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// @brief BitArray のレコードを書き出す．
+// @param[in] rtype レコード型
+// @param[in] val 値
+bool
+GdsWriter::write_bitarray(GdsRtype rtype,
+			  ymuint16 val)
+{
+  ymuint8 buf[2];
+  buf[0] = (val >> 8) & 255;
+  buf[1] = val & 255;
+  return write_rec(rtype, kGdsBitArray, buf, 2);
+}
+
+// @brief 4バイト整数のレコードを書き出す．
+// @param[in] rtype レコード型
+// @param[in] val 値
+bool
+GdsWriter::write_4int(GdsRtype rtype,
+		      ymint32 val)
+{
+  return write_4int(rtype, &val, 1);
+}
+
+// @brief 4バイト整数の配列のレコードを書き出す．
+// @param[in] rtype レコード型
+// @param[in] vals 値の配列
+// @param[in] n 要素数
+bool
+GdsWriter::write_4int(GdsRtype rtype,
+		      const ymint32* vals,
+		      ymuint n)
+{
+  if ( !put_header(rtype, kGds4Int, n * 4) ) {
+    return false;
+  }
+  ymuint8 buf[256];
+  ymuint pos = 0;
+  for (ymuint i = 0; i < n; ++ i) {
+    ymuint32 v = static_cast<ymuint32>(vals[i]);
+    buf[pos + 0] = (v >> 24) & 255;
+    buf[pos + 1] = (v >> 16) & 255;
+    buf[pos + 2] = (v >>  8) & 255;
+    buf[pos + 3] = v & 255;
+    pos += 4;
+    if ( pos == sizeof(buf) ) {
+      if ( !put_bytes(buf, pos) ) {
+	return false;
+      }
+      pos = 0;
+    }
+  }
+  return put_bytes(buf, pos);
+}
+
+// @brief 8バイト浮動小数点数の配列のレコードを書き出す．
+// @param[in] rtype レコード型
+// @param[in] vals 値の配列
+// @param[in] n 要素数
+bool
+GdsWriter::write_8real(GdsRtype rtype,
+		       const double* vals,
+		       ymuint n)
+{
+  if ( !put_header(rtype, kGds8Real, n * 8) ) {
+    return false;
+  }
+  for (ymuint i = 0; i < n; ++ i) {
+    ymuint8 buf[8];
+    conv_8byte_real(vals[i], buf);
+    if ( !put_bytes(buf, 8) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// @brief 文字列のレコードを書き出す．
+// @param[in] rtype レコード型
+// @param[in] str 文字列
+bool
+GdsWriter::write_string(GdsRtype rtype,
+			const char* str)
+{
+  ymuint32 len = strlen(str);
+  ymuint32 dsize = (len + 1) & ~1U;
+  if ( !put_header(rtype, kGdsString, dsize) ) {
+    return false;
+  }
+  if ( !put_bytes(reinterpret_cast<const ymuint8*>(str), len) ) {
+    return false;
+  }
+  if ( dsize > len ) {
+    ymuint8 pad = '\0';
+    return put_bytes(&pad, 1);
+  }
+  return true;
+}
+
+// @brief 任意のレコードを書き出す．
+// @param[in] rtype レコード型
+// @param[in] dtype データ型
+// @param[in] data データ(ビッグエンディアンに変換済みのもの)
+// @param[in] dsize データサイズ
+bool
+GdsWriter::write_rec(GdsRtype rtype,
+		     GdsDtype dtype,
+		     const ymuint8* data,
+		     ymuint32 dsize)
+{
+  if ( !put_header(rtype, dtype, dsize) ) {
+    return false;
+  }
+  return put_bytes(data, dsize);
+}
+
+// @brief GdsScanner が直前に読み込んだレコードをそのまま書き出す．
+// @param[in] scanner 字句解析器
+bool
+GdsWriter::copy_rec(const GdsScanner& scanner)
+{
+  return write_rec(scanner.cur_rtype(), scanner.cur_dtype(),
+		   scanner.cur_data(), scanner.cur_dsize());
+}
+
+// @brief バイト列をそのまま書き出す．
+// @param[in] buf バイト列
+// @param[in] size サイズ
+bool
+GdsWriter::write_raw(const ymuint8* buf,
+		     ymuint64 size)
+{
+  return put_bytes(buf, size);
+}
+
+// @brief HEADER から UNITS までを書き出す．
+// @param[in] libname ライブラリ名
+// @param[in] user_unit user unit
+// @param[in] meter_unit unit in meters
+bool
+GdsWriter::write_header(const char* libname,
+			double user_unit,
+			double meter_unit)
+{
+  ymint16 date[12];
+  set_date(date);
+  double units[2] = { user_unit, meter_unit };
+
+  return write_2int(kGdsHEADER, 600) &&
+    write_2int(kGdsBGNLIB, date, 12) &&
+    write_string(kGdsLIBNAME, libname) &&
+    write_8real(kGdsUNITS, units, 2);
+}
+
+// @brief BGNSTR と STRNAME を書き出す．
+// @param[in] name 構造名
+bool
+GdsWriter::write_bgnstr(const char* name)
+{
+  ymint16 date[12];
+  set_date(date);
+
+  return write_2int(kGdsBGNSTR, date, 12) &&
+    write_string(kGdsSTRNAME, name);
+}
+
+// @brief BOUNDARY 要素を書き出す．
+// @param[in] layer 層番号
+// @param[in] datatype データ型
+// @param[in] data 座標の配列 ( x0, y0, x1, y1, ... )
+// @param[in] n 点数
+bool
+GdsWriter::write_boundary(int layer,
+			  int datatype,
+			  const ymint32* data,
+			  ymuint n)
+{
+  if ( n == 0 ) {
+    return true;
+  }
+  bool closed = ( data[0] == data[n * 2 - 2] && data[1] == data[n * 2 - 1] );
+  ymuint n1 = closed ? n : n + 1;
+  if ( n1 * 8 + 4 > 0xFFFF ) {
+    error_header(__FILE__, __LINE__, "GdsWriter", mCurPos)
+      << "too many points (" << n << ") in a BOUNDARY";
+    msg_end();
+    return false;
+  }
+
+  if ( !write_nodata(kGdsBOUNDARY) ||
+       !write_2int(kGdsLAYER, layer) ||
+       !write_2int(kGdsDATATYPE, datatype) ||
+       !put_header(kGdsXY, kGds4Int, n1 * 8) ) {
+    return false;
+  }
+  ymuint8 buf[8];
+  for (ymuint i = 0; i < n1; ++ i) {
+    ymuint pos = ( i < n ) ? i : 0;
+    ymuint32 x = static_cast<ymuint32>(data[pos * 2 + 0]);
+    ymuint32 y = static_cast<ymuint32>(data[pos * 2 + 1]);
+    buf[0] = (x >> 24) & 255;
+    buf[1] = (x >> 16) & 255;
+    buf[2] = (x >>  8) & 255;
+    buf[3] = x & 255;
+    buf[4] = (y >> 24) & 255;
+    buf[5] = (y >> 16) & 255;
+    buf[6] = (y >>  8) & 255;
+    buf[7] = y & 255;
+    if ( !put_bytes(buf, 8) ) {
+      return false;
+    }
+  }
+  return write_nodata(kGdsENDEL);
+}
+
+// @brief レコードヘッダを書き出す．
+// @param[in] rtype レコード型
+// @param[in] dtype データ型
+// @param[in] dsize データサイズ
+bool
+GdsWriter::put_header(GdsRtype rtype,
+		      GdsDtype dtype,
+		      ymuint32 dsize)
+{
+  ymuint32 size = dsize + 4;
+  if ( size > 0xFFFF ) {
+    error_header(__FILE__, __LINE__, "GdsWriter", mCurPos)
+      << "record too large (" << size << ")";
+    msg_end();
+    return false;
+  }
+  ymuint8 buf[4];
+  buf[0] = (size >> 8) & 255;
+  buf[1] = size & 255;
+  buf[2] = static_cast<ymuint8>(rtype);
+  buf[3] = static_cast<ymuint8>(dtype);
+  return put_bytes(buf, 4);
+}
+
+// @brief バッファにデータを書き込む．
+// @param[in] buf データ
+// @param[in] size サイズ
+bool
+GdsWriter::put_bytes(const ymuint8* buf,
+		     ymuint64 size)
+{
+  if ( mFd < 0 ) {
+    return false;
+  }
+
+  mCurPos += size;
+  while ( size > 0 ) {
+    ymuint64 n = mBlockSize - mBuffPos;
+    if ( n > size ) {
+      n = size;
+    }
+    memcpy(&mBuff[mBuffPos], buf, n);
+    mBuffPos += n;
+    buf += n;
+    size -= n;
+    if ( mBuffPos == mBlockSize ) {
+      if ( !flush_buff() ) {
+	return false;
+      }
+    }
+  }
+  return true;
+}
+
+// @brief 現在のバッファの内容を掃き出す．
+bool
+GdsWriter::flush_buff()
+{
+  if ( mBuffPos == 0 ) {
+    return true;
+  }
+
+  if ( mCompType == kGdsCompNone ) {
+    bool stat = raw_write(&mBuff[0], mBuffPos);
+    mBuffPos = 0;
+    return stat;
+  }
+
+  // ブロックに詰め替えて圧縮待ちのリストに入れる．
+  Block* block = new Block;
+  block->mSrc.assign(mBuff.begin(), mBuff.begin() + mBuffPos);
+  block->mStat = false;
+  mPendingList.push_back(block);
+  mBuffPos = 0;
+
+  if ( mPendingList.size() < mThreadNum ) {
+    return true;
+  }
+
+  // 前回の圧縮結果を書き出してから次の圧縮を始める．
+  // こうすることで圧縮と書き込みデータの生成を並行して行える．
+  bool stat = wait_blocks();
+  mRunningList.swap(mPendingList);
+  for (ymuint i = 0; i < mRunningList.size(); ++ i) {
+    mWorkerList.push_back(std::thread(compress_block, mRunningList[i], mLevel));
+  }
+  return stat;
+}
+
+// @brief 圧縮中のブロックの完了を待って書き出す．
+bool
+GdsWriter::wait_blocks()
+{
+  for (ymuint i = 0; i < mWorkerList.size(); ++ i) {
+    mWorkerList[i].join();
+  }
+  mWorkerList.clear();
+
+  bool stat = true;
+  for (ymuint i = 0; i < mRunningList.size(); ++ i) {
+    Block* block = mRunningList[i];
+    if ( stat ) {
+      if ( block->mStat ) {
+	stat = raw_write(&block->mDst[0], block->mDst.size());
+      }
+      else {
+	error_header(__FILE__, __LINE__, "GdsWriter", mCurPos)
+	  << "error occured in 'deflate()'";
+	msg_end();
+	stat = false;
+      }
+    }
+    delete block;
+  }
+  mRunningList.clear();
+
+  return stat;
+}
+
+// @brief ブロックを gzip のメンバーとして圧縮する．
+// @param[in] block 対象のブロック
+// @param[in] level 圧縮レベル
+void
+GdsWriter::compress_block(Block* block,
+			  int level)
+{
+  z_stream zs;
+  zs.zalloc = Z_NULL;
+  zs.zfree = Z_NULL;
+  zs.opaque = Z_NULL;
+  // windowBits に 16 を加えると gzip 形式になる．
+  if ( deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK ) {
+    block->mStat = false;
+    return;
+  }
+
+  ymuint src_size = block->mSrc.size();
+  block->mDst.resize(deflateBound(&zs, src_size));
+  zs.next_in = &block->mSrc[0];
+  zs.avail_in = src_size;
+  zs.next_out = &block->mDst[0];
+  zs.avail_out = block->mDst.size();
+  int stat = deflate(&zs, Z_FINISH);
+  block->mDst.resize(zs.total_out);
+  deflateEnd(&zs);
+
+  block->mStat = ( stat == Z_STREAM_END );
+}
+
+// @brief fd にデータを書き出す．
+// @param[in] buf データ
+// @param[in] size サイズ
+bool
+GdsWriter::raw_write(const ymuint8* buf,
+		     ymuint64 size)
+{
+  while ( size > 0 ) {
+    ssize_t n = write(mFd, buf, size);
+    if ( n < 0 ) {
+      error_header(__FILE__, __LINE__, "GdsWriter", mCurPos)
+	<< "error occured in 'write()'";
+      msg_end();
+      return false;
+    }
+    buf += n;
+    size -= n;
+  }
+  return true;
+}
+
+// @brief 現在時刻を BGNLIB/BGNSTR 用の配列に設定する．
+// @param[out] buf 結果を格納する配列(12要素)
+void
+GdsWriter::set_date(ymint16 buf[])
+{
+  time_t t = time(NULL);
+  struct tm tm;
+  localtime_r(&t, &tm);
+  buf[0] = tm.tm_year;
+  buf[1] = tm.tm_mon + 1;
+  buf[2] = tm.tm_mday;
+  buf[3] = tm.tm_hour;
+  buf[4] = tm.tm_min;
+  buf[5] = tm.tm_sec;
+  for (ymuint i = 0; i < 6; ++ i) {
+    buf[i + 6] = buf[i];
+  }
+}
+
+// @brief 浮動小数点数を 8バイトの実数形式に変換する．
+// @param[in] val 値
+// @param[out] buf 結果を格納する配列(8要素)
+//
+// 符号1ビット，16を底とする指数7ビット(+64のゲタ)，仮数56ビットの
+// 形式に変換する．
+void
+GdsWriter::conv_8byte_real(double val,
+			   ymuint8 buf[])
+{
+  for (ymuint i = 0; i < 8; ++ i) {
+    buf[i] = 0;
+  }
+  if ( val == 0.0 ) {
+    return;
+  }
+
+  ymuint8 sign = 0;
+  if ( val < 0.0 ) {
+    sign = 0x80;
+    val = -val;
+  }
+  int exp = 64;
+  while ( val >= 1.0 ) {
+    val /= 16.0;
+    ++ exp;
+  }
+  while ( val < 0.0625 ) {
+    val *= 16.0;
+    -- exp;
+  }
+  // 仮数は 2^56 倍して丸める．
+  ymuint64 mag = static_cast<ymuint64>(val * 72057594037927936.0 + 0.5);
+  if ( mag >= (static_cast<ymuint64>(1) << 56) ) {
+    mag >>= 4;
+    ++ exp;
+  }
+  if ( exp < 0 ) {
+    // アンダーフロー
+    return;
+  }
+  if ( exp > 127 ) {
+    // オーバーフロー
+    exp = 127;
+    mag = (static_cast<ymuint64>(1) << 56) - 1;
+  }
+  buf[0] = sign | static_cast<ymuint8>(exp);
+  for (ymuint i = 0; i < 7; ++ i) {
+    buf[7 - i] = static_cast<ymuint8>(mag & 255);
+    mag >>= 8;
+  }
+}
+
+END_NAMESPACE_YM_GDS
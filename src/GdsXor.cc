@@ -0,0 +1,987 @@
+﻿
+/// @file GdsXor.cc
+/// @brief GdsXor の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/GdsXor.h"
+#include "YmGds/GdsBoolean.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsHier.h"
+#include "YmGds/GdsXY.h"
+#include "YmGds/Msg.h"
+#include "GdsParallel.h"
+#include <algorithm>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// タイルの総数の上限
+static
+const ymuint64 kMaxTileNum = 1U << 20;
+
+// ハッシュ値と要素の組
+typedef std::pair<GdsHashValue, const GdsElement*> HashPair;
+
+// @brief ハッシュ値の等しい要素を取り除く．
+// @param[in] list1, list2 ハッシュ値と要素の組のリスト
+// @param[out] rest1, rest2 取り除かれずに残った要素のリスト
+// @param[out] common_list 取り除いた要素の組のリスト
+//
+// list1, list2 はハッシュ値でソートされる．
+static
+void
+cancel_common(vector<HashPair>& list1,
+	      vector<HashPair>& list2,
+	      vector<const GdsElement*>& rest1,
+	      vector<const GdsElement*>& rest2,
+	      vector<std::pair<const GdsElement*, const GdsElement*> >& common_list)
+{
+  // 同じハッシュ値の要素の順番は元の順番に保つ．
+  auto comp = [](const HashPair& a, const HashPair& b) { return a.first < b.first; };
+  std::stable_sort(list1.begin(), list1.end(), comp);
+  std::stable_sort(list2.begin(), list2.end(), comp);
+
+  ymuint i1 = 0;
+  ymuint i2 = 0;
+  ymuint n1 = list1.size();
+  ymuint n2 = list2.size();
+  while ( i1 < n1 && i2 < n2 ) {
+    if ( list1[i1].first < list2[i2].first ) {
+      rest1.push_back(list1[i1].second);
+      ++ i1;
+    }
+    else if ( list2[i2].first < list1[i1].first ) {
+      rest2.push_back(list2[i2].second);
+      ++ i2;
+    }
+    else {
+      common_list.push_back(std::make_pair(list1[i1].second, list2[i2].second));
+      ++ i1;
+      ++ i2;
+    }
+  }
+  for ( ; i1 < n1; ++ i1) {
+    rest1.push_back(list1[i1].second);
+  }
+  for ( ; i2 < n2; ++ i2) {
+    rest2.push_back(list2[i2].second);
+  }
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// クラス GdsXor
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+GdsXor::GdsXor() :
+  mThreadNum(0),
+  mTileSize(0),
+  mTileX0(0),
+  mTileY0(0),
+  mTileStep(1),
+  mTileXNum(0),
+  mTileYNum(0),
+  mSkipNum(0),
+  mTileNum(0),
+  mDirtyTileNum(0)
+{
+}
+
+// @brief デストラクタ
+GdsXor::~GdsXor()
+{
+}
+
+// @brief 用いるスレッド数を設定する．
+// @param[in] num スレッド数
+//
+// 0 の時はハードウェアのスレッド数を用いる．
+void
+GdsXor::set_thread_num(ymuint num)
+{
+  mThreadNum = num;
+}
+
+// @brief タイルの一辺の長さを設定する．
+// @param[in] size 長さ(database unit)
+//
+// 0 の時は全体の外接矩形の長辺の 1/16 とする．
+void
+GdsXor::set_tile_size(ymint32 size)
+{
+  mTileSize = size < 0 ? 0 : size;
+}
+
+// @brief 差分を求める．
+// @param[in] data1, data2 対象のデータ
+// @param[in] top_name1, top_name2 最上位の構造名
+// @retval true 成功した．
+// @retval false 最上位の構造が決まらないか階層が循環していた．
+//
+// top_name1 が NULL の時は data1 の唯一の最上位の構造を用いる．
+// top_name2 が NULL の時は top_name1 と同じ名前の構造を用いる．
+// ともに NULL の時は data2 の唯一の最上位の構造を用いる．
+bool
+GdsXor::compute(const GdsData& data1,
+		const char* top_name1,
+		const GdsData& data2,
+		const char* top_name2)
+{
+  mLayerList.clear();
+  mLayerMap.clear();
+  mCommonList.clear();
+  mCommonTransList.clear();
+  mJobList.clear();
+  mDirtySum.clear();
+  mSkipNum = 0;
+  mTileNum = 0;
+  mDirtyTileNum = 0;
+
+  if ( top_name2 == NULL ) {
+    top_name2 = top_name1;
+  }
+  const GdsStruct* top1 = find_top(data1, top_name1);
+  if ( top1 == NULL ) {
+    return false;
+  }
+  const GdsStruct* top2 = find_top(data2, top_name2);
+  if ( top2 == NULL ) {
+    return false;
+  }
+
+  // 要素の順番は図形に影響しないので無視する．
+  const GdsData* data_array[2] = { &data1, &data2 };
+  for (ymuint side = 0; side < 2; ++ side) {
+    mHash[side].set_thread_num(mThreadNum);
+    mHash[side].set_order_insensitive(true);
+    if ( !mHash[side].compute(*data_array[side]) ) {
+      return false;
+    }
+  }
+  if ( !make_bbox(0, data1, top1) || !make_bbox(1, data2, top2) ) {
+    return false;
+  }
+
+  diff_struct(top1, top2, GdsTrans());
+
+  compute_tiles(top1, top2);
+
+  // 差分のない (layer, datatype) を取り除く．
+  // mLayerList はキーの昇順に並べる．
+  vector<LayerData> layer_list;
+  for (std::map<ymuint32, ymuint>::const_iterator p = mLayerMap.begin();
+       p != mLayerMap.end(); ++ p) {
+    LayerData& layer_data = mLayerList[p->second];
+    if ( layer_data.mResult.mPosList.size() > 1 ) {
+      layer_list.push_back(LayerData());
+      LayerData& dst = layer_list.back();
+      dst.mKey = layer_data.mKey;
+      dst.mResult.mPool.swap(layer_data.mResult.mPool);
+      dst.mResult.mPosList.swap(layer_data.mResult.mPosList);
+      dst.mArea2 = layer_data.mArea2;
+    }
+  }
+  mLayerList.swap(layer_list);
+  mLayerMap.clear();
+  mCommonList.clear();
+  mCommonTransList.clear();
+  mJobList.clear();
+  mDirtySum.clear();
+
+  return true;
+}
+
+// @brief 差分のある (layer, datatype) の数を返す．
+ymuint
+GdsXor::layer_num() const
+{
+  return mLayerList.size();
+}
+
+// @brief 層番号を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+int
+GdsXor::layer(ymuint pos) const
+{
+  ASSERT_COND( pos < layer_num() );
+  return static_cast<ymint16>(mLayerList[pos].mKey >> 16);
+}
+
+// @brief データ型を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+int
+GdsXor::datatype(ymuint pos) const
+{
+  ASSERT_COND( pos < layer_num() );
+  return static_cast<ymint16>(mLayerList[pos].mKey & 0xFFFF);
+}
+
+// @brief 差分の多角形の数を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+ymuint
+GdsXor::polygon_num(ymuint pos) const
+{
+  ASSERT_COND( pos < layer_num() );
+  return mLayerList[pos].mResult.mPosList.size() - 1;
+}
+
+// @brief 差分の多角形の頂点数を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+// @param[in] idx 多角形の番号 ( 0 <= idx < polygon_num(pos) )
+ymuint
+GdsXor::point_num(ymuint pos,
+		  ymuint idx) const
+{
+  ASSERT_COND( idx < polygon_num(pos) );
+  const vector<ymuint32>& pos_list = mLayerList[pos].mResult.mPosList;
+  return pos_list[idx + 1] - pos_list[idx];
+}
+
+// @brief 差分の多角形の座標の配列を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+// @param[in] idx 多角形の番号 ( 0 <= idx < polygon_num(pos) )
+//
+// x0, y0, x1, y1, ... の順に point_num(pos, idx) * 2 個の要素を持つ．
+// 頂点は反時計回りに並ぶ．
+const ymint32*
+GdsXor::polygon_data(ymuint pos,
+		     ymuint idx) const
+{
+  ASSERT_COND( idx < polygon_num(pos) );
+  const PolygonList& result = mLayerList[pos].mResult;
+  return &result.mPool[result.mPosList[idx] * 2];
+}
+
+// @brief 差分の面積の2倍を返す．
+// @param[in] pos 位置番号 ( 0 <= pos < layer_num() )
+tGdsInt128
+GdsXor::area2(ymuint pos) const
+{
+  ASSERT_COND( pos < layer_num() );
+  return mLayerList[pos].mArea2;
+}
+
+// @brief 同一と判定して比較を省略した配置の数を返す．
+//
+// AREF は要素数を数える．
+ymuint64
+GdsXor::skip_num() const
+{
+  return mSkipNum;
+}
+
+// @brief タイルの総数を返す．
+ymuint64
+GdsXor::tile_num() const
+{
+  return mTileNum;
+}
+
+// @brief 実際に XOR を行った (layer, datatype, タイル) の数を返す．
+ymuint64
+GdsXor::dirty_tile_num() const
+{
+  return mDirtyTileNum;
+}
+
+// @brief 最上位の構造を求める．
+// @param[in] data 対象のデータ
+// @param[in] top_name 構造名
+//
+// 見つからない時はエラーを出力して NULL を返す．
+const GdsStruct*
+GdsXor::find_top(const GdsData& data,
+		 const char* top_name)
+{
+  if ( top_name != NULL ) {
+    const GdsStruct* top = data.find_struct(top_name);
+    if ( top == NULL ) {
+      error_header(__FILE__, __LINE__, "GdsXor", 0)
+	<< top_name << ": No such structure in " << data.lib_name();
+      msg_end();
+    }
+    return top;
+  }
+
+  GdsHier hier(data);
+  if ( hier.top_num() != 1 ) {
+    error_header(__FILE__, __LINE__, "GdsXor", 0)
+      << data.lib_name() << ": " << hier.top_num()
+      << " top structures. Specify one of them";
+    msg_end();
+    return NULL;
+  }
+  return hier.top(0);
+}
+
+// @brief 構造ごとの外接矩形を求める．
+// @param[in] side 0 なら data1 側，1 なら data2 側
+// @param[in] data 対象のデータ
+// @param[in] top 最上位の構造
+// @retval false 階層が循環していた．
+bool
+GdsXor::make_bbox(ymuint side,
+		  const GdsData& data,
+		  const GdsStruct* top)
+{
+  GdsHier hier(data);
+  if ( !hier.calc_count(top) ) {
+    return false;
+  }
+
+  // 子供の構造から順に求める．
+  // AREF の外接矩形は四隅の配置の外接矩形で決まる．
+  vector<GdsBBox>& bbox_array = mBBoxArray[side];
+  bbox_array.clear();
+  bbox_array.resize(data.struct_num());
+  for (ymuint pos = hier.order_num(); pos -- > 0; ) {
+    const GdsStruct* str = hier.order(pos);
+    GdsBBox& bbox = bbox_array[str->id()];
+    for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+      switch ( elem->type() ) {
+      case kGdsBOUNDARY:
+      case kGdsBOX:
+      case kGdsPATH:
+	{
+	  ymuint n;
+	  const ymint32* data = shape_data(elem, n);
+	  for (ymuint i = 0; i < n; ++ i) {
+	    bbox.add_point(data[i * 2 + 0], data[i * 2 + 1]);
+	  }
+	}
+	break;
+
+      case kGdsSREF:
+      case kGdsAREF:
+	{
+	  const GdsStruct* child = elem->ref_struct();
+	  if ( child == NULL || bbox_array[child->id()].is_empty() ) {
+	    break;
+	  }
+	  ymuint ncol = elem->column();
+	  ymuint nrow = elem->row();
+	  if ( ncol < 1 || nrow < 1 ) {
+	    break;
+	  }
+	  const GdsBBox& child_bbox = bbox_array[child->id()];
+	  ymuint col_list[2] = { 0, ncol - 1 };
+	  ymuint row_list[2] = { 0, nrow - 1 };
+	  for (ymuint r = 0; r < 2; ++ r) {
+	    for (ymuint c = 0; c < 2; ++ c) {
+	      bbox.merge(GdsTrans(elem, col_list[c], row_list[r]).apply(child_bbox));
+	    }
+	  }
+	}
+	break;
+
+      default:
+	break;
+      }
+    }
+  }
+  return true;
+}
+
+// @brief 図形の座標を求める．
+// @param[in] elem 対象の要素 ( BOUNDARY/BOX/PATH )
+// @param[out] n 頂点数
+//
+// PATH の場合は輪郭を返す．頂点がない時は NULL を返す．
+const ymint32*
+GdsXor::shape_data(const GdsElement* elem,
+		   ymuint& n)
+{
+  if ( elem->type() == kGdsPATH ) {
+    mExpander.clear();
+    if ( !mExpander.expand(elem) ) {
+      n = 0;
+      return NULL;
+    }
+    n = mExpander.point_num(0);
+    return mExpander.polygon_data(0);
+  }
+  const GdsXY* xy = elem->xy();
+  n = xy->num();
+  return xy->data();
+}
+
+// @brief 一致して取り除いた図形か配置を記録する．
+// @param[in] elem 要素 (構造全体の時は NULL)
+// @param[in] str 構造全体の時の構造
+// @param[in] trans_id mCommonTransList 中の座標変換の位置
+void
+GdsXor::add_common(const GdsElement* elem,
+		   const GdsStruct* str,
+		   ymuint32 trans_id)
+{
+  mCommonList.push_back(CommonItem());
+  CommonItem& item = mCommonList.back();
+  item.mElem = elem;
+  item.mStruct = str;
+  item.mTrans = trans_id;
+}
+
+// @brief 二つの構造の差分となる図形を集める．
+// @param[in] str1, str2 対象の構造
+// @param[in] trans 座標変換
+void
+GdsXor::diff_struct(const GdsStruct* str1,
+		    const GdsStruct* str2,
+		    const GdsTrans& trans)
+{
+  if ( mHash[0].hash(str1->id()) == mHash[1].hash(str2->id()) ) {
+    ++ mSkipNum;
+    mCommonTransList.push_back(trans);
+    add_common(NULL, str1, mCommonTransList.size() - 1);
+    return;
+  }
+
+  // 一致して取り除くものはこの座標変換を共有する．
+  ymuint32 trans_id = mCommonTransList.size();
+  mCommonTransList.push_back(trans);
+
+  // 要素をハッシュ値とともに集める．
+  vector<HashPair> geom_list[2];
+  vector<HashPair> ref_list[2];
+  const GdsStruct* str_array[2] = { str1, str2 };
+  for (ymuint side = 0; side < 2; ++ side) {
+    for (const GdsElement* elem = str_array[side]->element();
+	 elem; elem = elem->next()) {
+      switch ( elem->type() ) {
+      case kGdsBOUNDARY:
+      case kGdsBOX:
+      case kGdsPATH:
+	geom_list[side].push_back(HashPair(mHash[side].elem_hash(elem), elem));
+	break;
+
+      case kGdsSREF:
+      case kGdsAREF:
+	ref_list[side].push_back(HashPair(mHash[side].elem_hash(elem), elem));
+	break;
+
+      default:
+	break;
+      }
+    }
+  }
+
+  // 同一の図形は打ち消し合う．
+  vector<const GdsElement*> geom_rest[2];
+  vector<std::pair<const GdsElement*, const GdsElement*> > common_list;
+  cancel_common(geom_list[0], geom_list[1], geom_rest[0], geom_rest[1], common_list);
+  for (ymuint i = 0; i < common_list.size(); ++ i) {
+    add_common(common_list[i].first, NULL, trans_id);
+  }
+  for (ymuint side = 0; side < 2; ++ side) {
+    for (ymuint i = 0; i < geom_rest[side].size(); ++ i) {
+      add_elem(side, geom_rest[side][i], trans);
+    }
+  }
+
+  // 内容まで同一の配置は比較を省略する．
+  vector<const GdsElement*> ref_rest[2];
+  common_list.clear();
+  cancel_common(ref_list[0], ref_list[1], ref_rest[0], ref_rest[1], common_list);
+  for (ymuint i = 0; i < common_list.size(); ++ i) {
+    const GdsElement* elem = common_list[i].first;
+    mSkipNum += static_cast<ymuint64>(elem->column()) * elem->row();
+    add_common(elem, NULL, trans_id);
+  }
+
+  // 同じ名前の構造を同じ位置に置いた配置は階層を保ったまま比較する．
+  vector<HashPair> place_list[2];
+  for (ymuint side = 0; side < 2; ++ side) {
+    for (ymuint i = 0; i < ref_rest[side].size(); ++ i) {
+      const GdsElement* elem = ref_rest[side][i];
+      place_list[side].push_back(HashPair(GdsStructHash::place_hash(elem), elem));
+    }
+    ref_rest[side].clear();
+  }
+  common_list.clear();
+  cancel_common(place_list[0], place_list[1], ref_rest[0], ref_rest[1], common_list);
+  for (ymuint i = 0; i < common_list.size(); ++ i) {
+    const GdsElement* elem1 = common_list[i].first;
+    const GdsElement* elem2 = common_list[i].second;
+    const GdsStruct* child1 = elem1->ref_struct();
+    const GdsStruct* child2 = elem2->ref_struct();
+    if ( child1 == NULL || child2 == NULL ) {
+      flatten_ref(0, elem1, trans);
+      flatten_ref(1, elem2, trans);
+      continue;
+    }
+    ymuint ncol = elem1->column();
+    ymuint nrow = elem1->row();
+    for (ymuint r = 0; r < nrow; ++ r) {
+      for (ymuint c = 0; c < ncol; ++ c) {
+	diff_struct(child1, child2, trans * GdsTrans(elem1, c, r));
+      }
+    }
+  }
+
+  // 残りはすべて展開する．
+  for (ymuint side = 0; side < 2; ++ side) {
+    for (ymuint i = 0; i < ref_rest[side].size(); ++ i) {
+      flatten_ref(side, ref_rest[side][i], trans);
+    }
+  }
+}
+
+// @brief 構造中の図形をすべて集める．
+// @param[in] side 0 なら data1 側，1 なら data2 側
+// @param[in] str 対象の構造
+// @param[in] trans 座標変換
+void
+GdsXor::flatten_struct(ymuint side,
+		       const GdsStruct* str,
+		       const GdsTrans& trans)
+{
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    switch ( elem->type() ) {
+    case kGdsBOUNDARY:
+    case kGdsBOX:
+    case kGdsPATH:
+      add_elem(side, elem, trans);
+      break;
+
+    case kGdsSREF:
+    case kGdsAREF:
+      flatten_ref(side, elem, trans);
+      break;
+
+    default:
+      break;
+    }
+  }
+}
+
+// @brief SREF/AREF の参照先の図形をすべて集める．
+// @param[in] side 0 なら data1 側，1 なら data2 側
+// @param[in] elem 対象の要素 ( SREF/AREF )
+// @param[in] trans 座標変換
+void
+GdsXor::flatten_ref(ymuint side,
+		    const GdsElement* elem,
+		    const GdsTrans& trans)
+{
+  const GdsStruct* child = elem->ref_struct();
+  if ( child == NULL ) {
+    return;
+  }
+  ymuint ncol = elem->column();
+  ymuint nrow = elem->row();
+  for (ymuint r = 0; r < nrow; ++ r) {
+    for (ymuint c = 0; c < ncol; ++ c) {
+      flatten_struct(side, child, trans * GdsTrans(elem, c, r));
+    }
+  }
+}
+
+// @brief 図形を一つ集める．
+// @param[in] side 0 なら data1 側，1 なら data2 側
+// @param[in] elem 対象の要素 ( BOUNDARY/BOX/PATH )
+// @param[in] trans 座標変換
+void
+GdsXor::add_elem(ymuint side,
+		 const GdsElement* elem,
+		 const GdsTrans& trans)
+{
+  int dt = elem->type() == kGdsBOX ? elem->boxtype() : elem->datatype();
+  ymuint32 key = (static_cast<ymuint32>(elem->layer() & 0xFFFF) << 16) |
+    static_cast<ymuint32>(dt & 0xFFFF);
+  ymuint n;
+  const ymint32* data = shape_data(elem, n);
+  add_polygon(key, side, data, n, trans);
+}
+
+// @brief 多角形を一つ追加する．
+// @param[in] key (layer << 16) | datatype
+// @param[in] side 0 なら data1 側，1 なら data2 側
+// @param[in] data 座標の配列
+// @param[in] n 頂点数
+// @param[in] trans 座標変換
+void
+GdsXor::add_polygon(ymuint32 key,
+		    ymuint side,
+		    const ymint32* data,
+		    ymuint n,
+		    const GdsTrans& trans)
+{
+  if ( n < 3 ) {
+    return;
+  }
+
+  std::map<ymuint32, ymuint>::iterator p = mLayerMap.find(key);
+  ymuint pos;
+  if ( p == mLayerMap.end() ) {
+    pos = mLayerList.size();
+    mLayerMap.insert(std::make_pair(key, pos));
+    mLayerList.push_back(LayerData());
+    LayerData& layer_data = mLayerList.back();
+    layer_data.mKey = key;
+    layer_data.mInput[0].mPosList.push_back(0);
+    layer_data.mInput[1].mPosList.push_back(0);
+    layer_data.mResult.mPosList.push_back(0);
+    layer_data.mArea2 = 0;
+  }
+  else {
+    pos = p->second;
+  }
+
+  PolygonList& polygon_list = mLayerList[pos].mInput[side];
+  GdsBBox bbox;
+  for (ymuint i = 0; i < n; ++ i) {
+    ymint32 x;
+    ymint32 y;
+    trans.apply(data[i * 2 + 0], data[i * 2 + 1], x, y);
+    polygon_list.mPool.push_back(x);
+    polygon_list.mPool.push_back(y);
+    bbox.add_point(x, y);
+  }
+  polygon_list.mPosList.push_back(polygon_list.mPool.size() / 2);
+  polygon_list.mBBoxList.push_back(bbox);
+}
+
+// @brief タイルに分割して XOR を行う．
+// @param[in] top1, top2 最上位の構造
+void
+GdsXor::compute_tiles(const GdsStruct* top1,
+		      const GdsStruct* top2)
+{
+  // 比較の残った図形がなければ何もしない．
+  bool found = false;
+  for (ymuint i = 0; i < mLayerList.size() && !found; ++ i) {
+    for (ymuint side = 0; side < 2; ++ side) {
+      if ( !mLayerList[i].mInput[side].mBBoxList.empty() ) {
+	found = true;
+      }
+    }
+  }
+  if ( !found ) {
+    return;
+  }
+
+  // タイルは差分の図形ではなくレイアウト全体の外接矩形から決める．
+  GdsBBox all_bbox = mBBoxArray[0][top1->id()];
+  all_bbox.merge(mBBoxArray[1][top2->id()]);
+  for (ymuint i = 0; i < mLayerList.size(); ++ i) {
+    for (ymuint side = 0; side < 2; ++ side) {
+      const vector<GdsBBox>& bbox_list = mLayerList[i].mInput[side].mBBoxList;
+      for (ymuint j = 0; j < bbox_list.size(); ++ j) {
+	all_bbox.merge(bbox_list[j]);
+      }
+    }
+  }
+
+  ymint64 xmin = all_bbox.xmin();
+  ymint64 ymin = all_bbox.ymin();
+  ymint64 w = static_cast<ymint64>(all_bbox.xmax()) - xmin;
+  ymint64 h = static_cast<ymint64>(all_bbox.ymax()) - ymin;
+  ymint64 tile_size = mTileSize;
+  if ( tile_size == 0 ) {
+    tile_size = (std::max(w, h) + 15) / 16;
+  }
+  if ( tile_size == 0 ) {
+    tile_size = 1;
+  }
+  ymuint64 nx;
+  ymuint64 ny;
+  for ( ; ; ) {
+    nx = w / tile_size + 1;
+    ny = h / tile_size + 1;
+    if ( nx * ny <= kMaxTileNum ) {
+      break;
+    }
+    tile_size *= 2;
+  }
+  mTileNum = nx * ny;
+  mTileX0 = xmin;
+  mTileY0 = ymin;
+  mTileStep = tile_size;
+  mTileXNum = nx;
+  mTileYNum = ny;
+
+  // 図形を含む (layer, datatype, タイル) ごとに作業を作る．
+  for (ymuint i = 0; i < mLayerList.size(); ++ i) {
+    LayerData& layer_data = mLayerList[i];
+    std::map<ymuint64, vector<ymuint32> > tile_map;
+    for (ymuint side = 0; side < 2; ++ side) {
+      const vector<GdsBBox>& bbox_list = layer_data.mInput[side].mBBoxList;
+      for (ymuint j = 0; j < bbox_list.size(); ++ j) {
+	ymuint64 tx0;
+	ymuint64 ty0;
+	ymuint64 tx1;
+	ymuint64 ty1;
+	tile_range(bbox_list[j], tx0, ty0, tx1, ty1);
+	for (ymuint64 ty = ty0; ty <= ty1; ++ ty) {
+	  for (ymuint64 tx = tx0; tx <= tx1; ++ tx) {
+	    tile_map[ty * nx + tx].push_back((side << 31) | j);
+	  }
+	}
+      }
+    }
+    for (std::map<ymuint64, vector<ymuint32> >::iterator p = tile_map.begin();
+	 p != tile_map.end(); ++ p) {
+      layer_data.mJobMap.insert(std::make_pair(p->first, mJobList.size()));
+      mJobList.push_back(Job());
+      Job& job = mJobList.back();
+      job.mLayer = i;
+      job.mTile = p->first;
+      job.mPolygonList.swap(p->second);
+    }
+  }
+  mDirtyTileNum = mJobList.size();
+
+  // 層によらず XOR を行うタイルの累積和を作る．
+  mDirtySum.clear();
+  mDirtySum.resize((nx + 1) * (ny + 1), 0);
+  for (ymuint i = 0; i < mJobList.size(); ++ i) {
+    ymuint64 tile = mJobList[i].mTile;
+    mDirtySum[(tile / nx + 1) * (nx + 1) + (tile % nx + 1)] = 1;
+  }
+  for (ymuint64 ty = 1; ty <= ny; ++ ty) {
+    for (ymuint64 tx = 1; tx <= nx; ++ tx) {
+      mDirtySum[ty * (nx + 1) + tx] += mDirtySum[(ty - 1) * (nx + 1) + tx]
+	+ mDirtySum[ty * (nx + 1) + tx - 1] - mDirtySum[(ty - 1) * (nx + 1) + tx - 1];
+    }
+  }
+
+  // 一致して取り除いた図形も残った図形を覆い隠すことがあるので
+  // XOR を行うタイルと重なるものは両側に加える．
+  for (ymuint i = 0; i < mCommonList.size(); ++ i) {
+    const CommonItem& item = mCommonList[i];
+    const GdsTrans& trans = mCommonTransList[item.mTrans];
+    if ( item.mElem != NULL ) {
+      collect_common(item.mElem, trans);
+    }
+    else if ( is_dirty(trans.apply(mBBoxArray[0][item.mStruct->id()])) ) {
+      collect_common_struct(item.mStruct, trans);
+    }
+  }
+
+  // タイルごとに XOR を行う．
+  vector<PolygonList> result_array(mJobList.size());
+  vector<tGdsInt128> area2_array(mJobList.size());
+  parallel_for(mJobList.size(), mThreadNum, [&](ymuint i) {
+      const Job& job = mJobList[i];
+      const LayerData& layer_data = mLayerList[job.mLayer];
+      GdsBoolean boolean;
+      boolean.set_thread_num(1);
+      boolean.set_tile_num(1);
+      for (ymuint j = 0; j < job.mPolygonList.size(); ++ j) {
+	ymuint side = job.mPolygonList[j] >> 31;
+	ymuint idx = job.mPolygonList[j] & 0x7FFFFFFF;
+	const PolygonList& input = layer_data.mInput[side];
+	ymuint begin = input.mPosList[idx];
+	ymuint end = input.mPosList[idx + 1];
+	boolean.add_polygon(side, &input.mPool[begin * 2], end - begin);
+      }
+      const PolygonList& common = layer_data.mCommon;
+      for (ymuint j = 0; j < job.mCommonList.size(); ++ j) {
+	ymuint idx = job.mCommonList[j];
+	ymuint begin = common.mPosList[idx];
+	ymuint end = common.mPosList[idx + 1];
+	boolean.add_polygon(0, &common.mPool[begin * 2], end - begin);
+	boolean.add_polygon(1, &common.mPool[begin * 2], end - begin);
+      }
+      ymint64 tx = job.mTile % nx;
+      ymint64 ty = job.mTile / nx;
+      ymint64 x0 = xmin + tx * tile_size;
+      ymint64 y0 = ymin + ty * tile_size;
+      ymint64 x1 = std::min(x0 + tile_size, static_cast<ymint64>(all_bbox.xmax()));
+      ymint64 y1 = std::min(y0 + tile_size, static_cast<ymint64>(all_bbox.ymax()));
+      GdsBBox clip;
+      clip.add_point(x0, y0);
+      clip.add_point(x1, y1);
+      boolean.set_clip(clip);
+      boolean.compute(kGdsBoolXor);
+
+      PolygonList& result = result_array[i];
+      result.mPosList.push_back(0);
+      for (ymuint j = 0; j < boolean.polygon_num(); ++ j) {
+	const ymint32* data = boolean.polygon_data(j);
+	ymuint n = boolean.point_num(j);
+	result.mPool.insert(result.mPool.end(), data, data + n * 2);
+	result.mPosList.push_back(result.mPool.size() / 2);
+      }
+      area2_array[i] = boolean.area2();
+    });
+
+  // 作業の順に結果をまとめる．
+  for (ymuint i = 0; i < mJobList.size(); ++ i) {
+    LayerData& layer_data = mLayerList[mJobList[i].mLayer];
+    PolygonList& dst = layer_data.mResult;
+    const PolygonList& src = result_array[i];
+    ymuint32 offset = dst.mPool.size() / 2;
+    dst.mPool.insert(dst.mPool.end(), src.mPool.begin(), src.mPool.end());
+    for (ymuint j = 1; j < src.mPosList.size(); ++ j) {
+      dst.mPosList.push_back(src.mPosList[j] + offset);
+    }
+    layer_data.mArea2 += area2_array[i];
+  }
+}
+
+// @brief 矩形と重なるタイルの範囲を求める．
+// @param[in] bbox 矩形
+// @param[out] tx0, ty0, tx1, ty1 タイルの範囲
+// @retval false 重なるタイルがない．
+bool
+GdsXor::tile_range(const GdsBBox& bbox,
+		   ymuint64& tx0,
+		   ymuint64& ty0,
+		   ymuint64& tx1,
+		   ymuint64& ty1) const
+{
+  if ( bbox.is_empty() ) {
+    return false;
+  }
+  ymint64 x0 = (bbox.xmin() - mTileX0) / mTileStep;
+  ymint64 y0 = (bbox.ymin() - mTileY0) / mTileStep;
+  ymint64 x1 = (bbox.xmax() - mTileX0) / mTileStep;
+  ymint64 y1 = (bbox.ymax() - mTileY0) / mTileStep;
+  ymint64 xlim = static_cast<ymint64>(mTileXNum) - 1;
+  ymint64 ylim = static_cast<ymint64>(mTileYNum) - 1;
+  if ( bbox.xmax() < mTileX0 || bbox.ymax() < mTileY0 || x0 > xlim || y0 > ylim ) {
+    return false;
+  }
+  tx0 = x0 < 0 ? 0 : x0;
+  ty0 = y0 < 0 ? 0 : y0;
+  tx1 = x1 > xlim ? xlim : x1;
+  ty1 = y1 > ylim ? ylim : y1;
+  return true;
+}
+
+// @brief 矩形が XOR を行うタイルと重なる時 true を返す．
+// @param[in] bbox 矩形
+bool
+GdsXor::is_dirty(const GdsBBox& bbox) const
+{
+  ymuint64 tx0;
+  ymuint64 ty0;
+  ymuint64 tx1;
+  ymuint64 ty1;
+  if ( !tile_range(bbox, tx0, ty0, tx1, ty1) ) {
+    return false;
+  }
+  ymuint64 w = mTileXNum + 1;
+  ymuint32 n = mDirtySum[(ty1 + 1) * w + tx1 + 1] - mDirtySum[ty0 * w + tx1 + 1]
+    - mDirtySum[(ty1 + 1) * w + tx0] + mDirtySum[ty0 * w + tx0];
+  return n > 0;
+}
+
+// @brief 共通な構造中の図形のうち XOR を行うタイルと重なるものを集める．
+// @param[in] str 対象の構造
+// @param[in] trans 座標変換
+void
+GdsXor::collect_common_struct(const GdsStruct* str,
+			      const GdsTrans& trans)
+{
+  for (const GdsElement* elem = str->element(); elem; elem = elem->next()) {
+    collect_common(elem, trans);
+  }
+}
+
+// @brief 共通な要素のうち XOR を行うタイルと重なるものを集める．
+// @param[in] elem 対象の要素 ( BOUNDARY/BOX/PATH/SREF/AREF )
+// @param[in] trans 座標変換
+void
+GdsXor::collect_common(const GdsElement* elem,
+		       const GdsTrans& trans)
+{
+  switch ( elem->type() ) {
+  case kGdsBOUNDARY:
+  case kGdsBOX:
+  case kGdsPATH:
+    break;
+
+  case kGdsSREF:
+  case kGdsAREF:
+    {
+      const GdsStruct* child = elem->ref_struct();
+      if ( child == NULL ) {
+	return;
+      }
+      const GdsBBox& child_bbox = mBBoxArray[0][child->id()];
+      ymuint ncol = elem->column();
+      ymuint nrow = elem->row();
+      for (ymuint r = 0; r < nrow; ++ r) {
+	for (ymuint c = 0; c < ncol; ++ c) {
+	  GdsTrans child_trans = trans * GdsTrans(elem, c, r);
+	  if ( is_dirty(child_trans.apply(child_bbox)) ) {
+	    collect_common_struct(child, child_trans);
+	  }
+	}
+      }
+    }
+    return;
+
+  default:
+    return;
+  }
+
+  // 比較の残った図形のない (layer, datatype) は関係ない．
+  int dt = elem->type() == kGdsBOX ? elem->boxtype() : elem->datatype();
+  ymuint32 key = (static_cast<ymuint32>(elem->layer() & 0xFFFF) << 16) |
+    static_cast<ymuint32>(dt & 0xFFFF);
+  std::map<ymuint32, ymuint>::iterator p = mLayerMap.find(key);
+  if ( p == mLayerMap.end() ) {
+    return;
+  }
+  LayerData& layer_data = mLayerList[p->second];
+  if ( layer_data.mJobMap.empty() ) {
+    return;
+  }
+
+  ymuint n;
+  const ymint32* data = shape_data(elem, n);
+  if ( n < 3 ) {
+    return;
+  }
+  PolygonList& common = layer_data.mCommon;
+  if ( common.mPosList.empty() ) {
+    common.mPosList.push_back(0);
+  }
+  ymuint32 begin = common.mPool.size();
+  GdsBBox bbox;
+  for (ymuint i = 0; i < n; ++ i) {
+    ymint32 x;
+    ymint32 y;
+    trans.apply(data[i * 2 + 0], data[i * 2 + 1], x, y);
+    common.mPool.push_back(x);
+    common.mPool.push_back(y);
+    bbox.add_point(x, y);
+  }
+
+  // 重なる作業に登録する．
+  ymuint32 idx = common.mPosList.size() - 1;
+  bool used = false;
+  ymuint64 tx0;
+  ymuint64 ty0;
+  ymuint64 tx1;
+  ymuint64 ty1;
+  if ( tile_range(bbox, tx0, ty0, tx1, ty1) ) {
+    for (ymuint64 ty = ty0; ty <= ty1; ++ ty) {
+      for (ymuint64 tx = tx0; tx <= tx1; ++ tx) {
+	std::map<ymuint64, ymuint>::iterator q = layer_data.mJobMap.find(ty * mTileXNum + tx);
+	if ( q != layer_data.mJobMap.end() ) {
+	  mJobList[q->second].mCommonList.push_back(idx);
+	  used = true;
+	}
+      }
+    }
+  }
+  if ( used ) {
+    common.mPosList.push_back(common.mPool.size() / 2);
+  }
+  else {
+    common.mPool.resize(begin);
+  }
+}
+
+END_NAMESPACE_YM_GDS
@@ -8,12 +8,17 @@
 
 
 #include "YmGds/Msg.h"
+#include <algorithm>
+#include <thread>
 
 
 BEGIN_NAMESPACE_YM_GDS
 
 //////////////////////////////////////////////////////////////////////
 // メッセージ生成用のヘルパークラス
+//
+// スレッドごとに一つずつ作られる．
+// 出力しないメッセージの時は本文を捨てるストリームを返す．
 //////////////////////////////////////////////////////////////////////
 class MsgHelper :
   public ostringstream
@@ -33,7 +38,17 @@ public:
 	   size_t offset,
 	   Msg::tType type,
 	   const string& label,
-	   const string& body);
+	   const string& body,
+	   bool active);
+
+  // 本文を書き込むストリームを返す．
+  ostream& stream();
+
+  // メッセージの種類を返す．
+  Msg::tType type() const;
+
+  // 出力するメッセージの時 true を返す．
+  bool active() const;
 
   // Msg を生成する．
   Msg* new_msg() const;
@@ -62,10 +77,19 @@ private:
   // 本文
   string mBody;
 
+  // 出力するメッセージの時 true
+  bool mActive;
+
+  // 本文を捨てるストリーム
+  // ストリームバッファを持たないので書き込みは何もしない．
+  ostream mNullStream;
+
 };
 
 // コンストラクタ
-MsgHelper::MsgHelper()
+MsgHelper::MsgHelper() :
+  mActive(false),
+  mNullStream(NULL)
 {
 }
 
@@ -81,17 +105,46 @@ MsgHelper::set(const char* src_file,
 	       size_t offset,
 	       Msg::tType type,
 	       const string& label,
-	       const string& body)
+	       const string& body,
+	       bool active)
 {
+  mType = type;
+  mActive = active;
+  if ( !active ) {
+    return;
+  }
   mSrcFile = src_file;
   mSrcLine = src_line;
   mOffset = offset;
-  mType = type;
   mLabel = label;
   mBody = body;
   str("");
 }
 
+// 本文を書き込むストリームを返す．
+ostream&
+MsgHelper::stream()
+{
+  if ( mActive ) {
+    return *this;
+  }
+  return mNullStream;
+}
+
+// メッセージの種類を返す．
+Msg::tType
+MsgHelper::type() const
+{
+  return mType;
+}
+
+// 出力するメッセージの時 true を返す．
+bool
+MsgHelper::active() const
+{
+  return mActive;
+}
+
 // Msg を生成する．
 Msg*
 MsgHelper::new_msg() const
@@ -116,7 +169,8 @@ Msg::Msg(const char* src_file,
   mOffset(offset),
   mType(type),
   mLabel(label),
-  mBody(body)
+  mBody(body),
+  mLink(NULL)
 {
 }
 
@@ -172,30 +226,71 @@ Msg::body() const
 // メッセージを管理するクラス
 //////////////////////////////////////////////////////////////////////
 
-// 唯一のインスタンス
-MsgMgr* MsgMgr::mTheMgr = 0;
+// スレッドごとのヘルパーオブジェクトを返す．
+static
+MsgHelper&
+cur_helper()
+{
+  static thread_local MsgHelper helper;
+  return helper;
+}
+
+// メッセージの種類に対応するマスクのビットを返す．
+static
+size_t
+type_bit(Msg::tType type)
+{
+  switch ( type ) {
+  case Msg::kError:   return kMsgMaskError;
+  case Msg::kWarning: return kMsgMaskWarning;
+  case Msg::kInfo:    return kMsgMaskInfo;
+  case Msg::kFail:    return kMsgMaskFail;
+  case Msg::kDebug:   return kMsgMaskDebug;
+  }
+  return 0;
+}
+
+// メッセージをファイル位置の順に比較する．
+// 同じ位置の時は内容で比べて順番を一定にする．
+static
+bool
+msg_lt(const Msg* a,
+       const Msg* b)
+{
+  if ( a->offset() != b->offset() ) {
+    return a->offset() < b->offset();
+  }
+  if ( a->type() != b->type() ) {
+    return a->type() < b->type();
+  }
+  if ( a->label() != b->label() ) {
+    return a->label() < b->label();
+  }
+  return a->body() < b->body();
+}
 
 // 唯一のインスタンスを得るための関数
 MsgMgr&
 MsgMgr::the_mgr()
 {
-  if ( !mTheMgr ) {
-    mTheMgr = new MsgMgr();
-  }
-  return *mTheMgr;
+  // 関数内の static 変数の初期化はスレッドセーフに行われる．
+  static MsgMgr* the_obj = new MsgMgr();
+  return *the_obj;
 }
 
 // コンストラクタ
-MsgMgr::MsgMgr()
+MsgMgr::MsgMgr() :
+  mQueue(NULL),
+  mOrdered(false)
 {
-  mMsgHelper = new MsgHelper;
+  mDelivering.clear();
   clear();
 }
 
 // デストラクタ
 MsgMgr::~MsgMgr()
 {
-  delete mMsgHelper;
+  flush();
 }
 
 // エラーメッセージを出力する．
@@ -326,6 +421,47 @@ MsgMgr::reg_handler(MsgHandler* handler)
   mHandlerList.push_back(handler);
 }
 
+// メッセージをファイル位置の順に並べるかどうかを設定する．
+void
+MsgMgr::set_ordered(bool flag)
+{
+  mOrdered = flag;
+  if ( !flag ) {
+    flush();
+  }
+}
+
+// メッセージをファイル位置の順に並べている時 true を返す．
+bool
+MsgMgr::ordered() const
+{
+  return mOrdered;
+}
+
+// 溜めておいたメッセージをファイル位置の順にハンドラに渡す．
+void
+MsgMgr::flush()
+{
+  // 他のスレッドがハンドラを呼び終わるのを待つ．
+  while ( mDelivering.test_and_set(std::memory_order_acquire) ) {
+    std::this_thread::yield();
+  }
+
+  take_queue();
+  stable_sort(mHeldList.begin(), mHeldList.end(), msg_lt);
+  for (size_t i = 0; i < mHeldList.size(); ++ i) {
+    dispatch(mHeldList[i]);
+  }
+  mHeldList.clear();
+
+  mDelivering.clear(std::memory_order_release);
+
+  // この間に届いたメッセージ
+  if ( mQueue.load(std::memory_order_acquire) != NULL ) {
+    deliver();
+  }
+}
+
 // メッセージ用のストリームを返す．
 ostream&
 MsgMgr::msg_header(const char* src_file,
@@ -335,25 +471,102 @@ MsgMgr::msg_header(const char* src_file,
 		   size_t offset,
 		   const string& body)
 {
-  mMsgHelper->set(src_file, src_line, offset, type, label, body);
-  return *mMsgHelper;
+  MsgHelper& helper = cur_helper();
+  bool active = (handler_mask() & type_bit(type)) != 0;
+  helper.set(src_file, src_line, offset, type, label, body, active);
+  return helper.stream();
 }
 
 // msg_end() 中で呼ばれる関数
 void
 MsgMgr::put_msg()
 {
-  Msg* msg = mMsgHelper->new_msg();
+  MsgHelper& helper = cur_helper();
 
   ++ mAllMsgNum;
-  size_t bit = 0;
-  switch ( msg->type() ) {
-  case Msg::kError:   bit = kMsgMaskError;   ++ mErrorMsgNum; break;
-  case Msg::kWarning: bit = kMsgMaskWarning; ++ mWarningMsgNum; break;
-  case Msg::kInfo:    bit = kMsgMaskInfo;    ++ mInfoMsgNum; break;
-  case Msg::kFail:    bit = kMsgMaskFail;    ++ mFailMsgNum; break;
-  case Msg::kDebug:   bit = kMsgMaskDebug;   ++ mDebugMsgNum; break;
+  switch ( helper.type() ) {
+  case Msg::kError:   ++ mErrorMsgNum; break;
+  case Msg::kWarning: ++ mWarningMsgNum; break;
+  case Msg::kInfo:    ++ mInfoMsgNum; break;
+  case Msg::kFail:    ++ mFailMsgNum; break;
+  case Msg::kDebug:   ++ mDebugMsgNum; break;
+  }
+
+  if ( !helper.active() ) {
+    return;
   }
+
+  // キューの先頭に入れる．
+  Msg* msg = helper.new_msg();
+  Msg* head = mQueue.load(std::memory_order_relaxed);
+  do {
+    msg->mLink = head;
+  } while ( !mQueue.compare_exchange_weak(head, msg,
+					  std::memory_order_release,
+					  std::memory_order_relaxed) );
+
+  deliver();
+}
+
+// ハンドラのマスクの和を返す．
+size_t
+MsgMgr::handler_mask() const
+{
+  size_t mask = 0;
+  for (list<MsgHandler*>::const_iterator p = mHandlerList.begin();
+       p != mHandlerList.end(); ++ p) {
+    mask |= (*p)->mask();
+  }
+  return mask;
+}
+
+// キューのメッセージを取り出してハンドラに渡す．
+// 他のスレッドが取り出している時は何もしない．
+void
+MsgMgr::deliver()
+{
+  for ( ; ; ) {
+    if ( mDelivering.test_and_set(std::memory_order_acquire) ) {
+      // 取り出しているスレッドが後で見つけてくれる．
+      return;
+    }
+
+    take_queue();
+    if ( !mOrdered ) {
+      for (size_t i = 0; i < mHeldList.size(); ++ i) {
+	dispatch(mHeldList[i]);
+      }
+      mHeldList.clear();
+    }
+
+    mDelivering.clear(std::memory_order_release);
+
+    // フラグを下ろす前に入れられたメッセージを取りこぼさないように
+    // もう一度調べる．
+    if ( mQueue.load(std::memory_order_acquire) == NULL ) {
+      return;
+    }
+  }
+}
+
+// キューのメッセージを届いた順に mHeldList に移す．
+void
+MsgMgr::take_queue()
+{
+  Msg* head = mQueue.exchange(NULL, std::memory_order_acquire);
+  size_t n0 = mHeldList.size();
+  for (Msg* msg = head; msg; msg = msg->mLink) {
+    mHeldList.push_back(msg);
+  }
+  // キューは新しいものが先頭なので逆順にする．
+  reverse(mHeldList.begin() + n0, mHeldList.end());
+}
+
+// メッセージをハンドラに渡して削除する．
+void
+MsgMgr::dispatch(Msg* msg)
+{
+  size_t bit = type_bit(msg->type());
   for (list<MsgHandler*>::const_iterator p = mHandlerList.begin();
        p != mHandlerList.end(); ++ p) {
     MsgHandler* mh = *p;
@@ -361,6 +574,7 @@ MsgMgr::put_msg()
       (*mh)(msg);
     }
   }
+  delete msg;
 }
 
 
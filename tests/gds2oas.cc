@@ -0,0 +1,92 @@
+﻿
+/// @file gdsprint/gds2oas.cc
+/// @brief GDS-II ファイルを OASIS 形式に変換するプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsParser.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsOasisWriter.h"
+#include "YmGds/Msg.h"
+#include <sys/stat.h>
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  bool compress = true;
+  int level = 6;
+  bool merge = true;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-l" && base + 1 < argc ) {
+      ++ base;
+      level = atoi(argv[base]);
+    }
+    else if ( opt == "-n" ) {
+      compress = false;
+    }
+    else if ( opt == "-p" ) {
+      merge = false;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 2 != argc || level < 1 || level > 9 ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-n] [-p] [-l <level>] <gds2 file> <oasis file>" << endl
+	 << "  -n: do not use CBLOCK compression" << endl
+	 << "  -p: do not merge SREFs into repetitions" << endl
+	 << "  -l: compression level (1 - 9)" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsParser parser;
+  if ( !parser.parse(argv[base]) ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+  const GdsData* data = parser.data();
+
+  GdsOasisWriter writer;
+  writer.set_thread_num(thread_num);
+  writer.set_compress(compress, level);
+  writer.set_merge_placement(merge);
+  if ( !writer.write(*data, argv[base + 1]) ) {
+    return 3;
+  }
+
+  struct stat sbuf;
+  if ( stat(argv[base], &sbuf) == 0 ) {
+    cout << "GDS-II: " << sbuf.st_size << " bytes" << endl;
+  }
+  cout << "OASIS:  " << writer.file_size() << " bytes" << endl
+       << writer.shape_num() << " shapes, "
+       << writer.placement_num() << " placements ("
+       << writer.instance_num() << " instances), "
+       << writer.skip_num() << " skipped" << endl;
+
+  return 0;
+}
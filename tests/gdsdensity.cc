@@ -0,0 +1,214 @@
+﻿
+/// @file gdsprint/gdsdensity.cc
+/// @brief 層ごとの被覆率をタイルの格子上で求めるプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsParser.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsDensity.h"
+#include "YmGds/Msg.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief 32ビットの整数をリトルエンディアンで書き出す．
+static
+void
+write_int32(ostream& s,
+	    ymint32 val)
+{
+  ymuint32 v = static_cast<ymuint32>(val);
+  char buf[4];
+  for (ymuint i = 0; i < 4; ++ i) {
+    buf[i] = static_cast<char>((v >> (i * 8)) & 0xFF);
+  }
+  s.write(buf, 4);
+}
+
+// @brief 16ビットの整数をリトルエンディアンで書き出す．
+static
+void
+write_int16(ostream& s,
+	    ymint16 val)
+{
+  ymuint16 v = static_cast<ymuint16>(val);
+  char buf[2];
+  buf[0] = static_cast<char>(v & 0xFF);
+  buf[1] = static_cast<char>((v >> 8) & 0xFF);
+  s.write(buf, 2);
+}
+
+// @brief 被覆率を CSV 形式で書き出す．
+static
+void
+write_csv(ostream& s,
+	  const GdsDensity& density)
+{
+  s << "layer,datatype,ix,iy,x0,y0,x1,y1,density" << endl;
+  for (ymuint pos = 0; pos < density.layer_num(); ++ pos) {
+    for (ymuint iy = 0; iy < density.y_num(); ++ iy) {
+      for (ymuint ix = 0; ix < density.x_num(); ++ ix) {
+	GdsBBox bbox = density.tile(ix, iy);
+	s << density.layer(pos) << "," << density.datatype(pos)
+	  << "," << ix << "," << iy
+	  << "," << bbox.xmin() << "," << bbox.ymin()
+	  << "," << bbox.xmax() << "," << bbox.ymax()
+	  << "," << density.density(pos, ix, iy) << endl;
+      }
+    }
+  }
+}
+
+// @brief 被覆率をバイナリ形式で書き出す．
+//
+// 形式は以下の通り．整数はすべてリトルエンディアン．
+// - "GDSDENS1" (8バイト)
+// - X 方向のタイル数，Y 方向のタイル数，層の数 (各32ビット)
+// - 領域の左下の座標，タイルの幅と高さ (各32ビット)
+// - 層ごとに層番号，データ型 (各16ビット)と
+//   行優先の x_num * y_num 個の被覆率 (IEEE754 倍精度)
+static
+void
+write_binary(ostream& s,
+	     const GdsDensity& density,
+	     ymint32 tile_width,
+	     ymint32 tile_height)
+{
+  s.write("GDSDENS1", 8);
+  write_int32(s, density.x_num());
+  write_int32(s, density.y_num());
+  write_int32(s, density.layer_num());
+  write_int32(s, density.region().xmin());
+  write_int32(s, density.region().ymin());
+  write_int32(s, tile_width);
+  write_int32(s, tile_height);
+  for (ymuint pos = 0; pos < density.layer_num(); ++ pos) {
+    write_int16(s, density.layer(pos));
+    write_int16(s, density.datatype(pos));
+    for (ymuint iy = 0; iy < density.y_num(); ++ iy) {
+      for (ymuint ix = 0; ix < density.x_num(); ++ ix) {
+	double val = density.density(pos, ix, iy);
+	ymuint64 bits;
+	memcpy(&bits, &val, 8);
+	write_int32(s, static_cast<ymint32>(bits & 0xFFFFFFFFU));
+	write_int32(s, static_cast<ymint32>(bits >> 32));
+      }
+    }
+  }
+}
+
+END_NAMESPACE_YM_GDS
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  ymint32 tile_width = 0;
+  ymint32 tile_height = 0;
+  GdsBBox region;
+  bool binary = false;
+  const char* out_name = NULL;
+  GdsDensity density;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-s" && base + 1 < argc ) {
+      ++ base;
+      int n = sscanf(argv[base], "%d,%d", &tile_width, &tile_height);
+      if ( n == 1 ) {
+	tile_height = tile_width;
+      }
+    }
+    else if ( opt == "-r" && base + 1 < argc ) {
+      ++ base;
+      int x0, y0, x1, y1;
+      if ( sscanf(argv[base], "%d,%d,%d,%d", &x0, &y0, &x1, &y1) == 4 ) {
+	region = GdsBBox(x0, y0, x1, y1);
+      }
+    }
+    else if ( opt == "-l" && base + 1 < argc ) {
+      ++ base;
+      int layer;
+      int datatype = 0;
+      if ( sscanf(argv[base], "%d/%d", &layer, &datatype) >= 1 ) {
+	density.add_layer(layer, datatype);
+      }
+    }
+    else if ( opt == "-b" ) {
+      binary = true;
+    }
+    else if ( opt == "-o" && base + 1 < argc ) {
+      ++ base;
+      out_name = argv[base];
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 1 > argc || base + 2 < argc || tile_width <= 0 || tile_height <= 0 ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] -s <width>[,<height>] [-r <x0>,<y0>,<x1>,<y1>]"
+	 << " [-l <layer>[/<datatype>]]... [-b] [-o <output file>]"
+	 << " <gds2 file> [<top>]" << endl
+	 << "  -s: tile size in database units" << endl
+	 << "  -b: write binary output instead of CSV" << endl;
+    return 1;
+  }
+  const char* top_name = base + 1 < argc ? argv[base + 1] : NULL;
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsParser parser;
+  if ( !parser.parse(argv[base]) ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+  const GdsData* data = parser.data();
+
+  density.set_thread_num(thread_num);
+  density.set_tile_size(tile_width, tile_height);
+  density.set_region(region);
+  if ( !density.compute(*data, top_name) ) {
+    return 3;
+  }
+
+  ofstream ofs;
+  if ( out_name != NULL ) {
+    ofs.open(out_name, binary ? ios::out | ios::binary : ios::out);
+    if ( !ofs ) {
+      cerr << out_name << ": Could not open" << endl;
+      return 3;
+    }
+  }
+  ostream& s = out_name != NULL ? ofs : cout;
+  if ( binary ) {
+    write_binary(s, density, tile_width, tile_height);
+  }
+  else {
+    write_csv(s, density);
+  }
+
+  return 0;
+}
@@ -0,0 +1,237 @@
+﻿
+/// @file gdsprint/gdsdiff.cc
+/// @brief 二つの GDS-II (あるいは OASIS) ファイルの構造上の差分を表示するプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsParser.h"
+#include "YmGds/GdsOasisParser.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsProperty.h"
+#include "YmGds/GdsXY.h"
+#include "YmGds/GdsDiff.h"
+#include "YmGds/Msg.h"
+#include <cstring>
+#include <thread>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief 要素の概要を出力する．
+// @param[in] s 出力先のストリーム
+// @param[in] elem 対象の要素
+static
+void
+print_elem(ostream& s,
+	   const GdsElement* elem)
+{
+  switch ( elem->type() ) {
+  case kGdsBOUNDARY:
+    s << "BOUNDARY " << elem->layer() << "/" << elem->datatype();
+    break;
+
+  case kGdsBOX:
+    s << "BOX " << elem->layer() << "/" << elem->boxtype();
+    break;
+
+  case kGdsPATH:
+    s << "PATH " << elem->layer() << "/" << elem->datatype()
+      << " type=" << elem->pathtype()
+      << " width=" << elem->width();
+    break;
+
+  case kGdsTEXT:
+    s << "TEXT " << elem->layer() << "/" << elem->texttype()
+      << " \"" << elem->text() << "\"";
+    break;
+
+  case kGdsNODE:
+    s << "NODE " << elem->layer();
+    break;
+
+  case kGdsSREF:
+  case kGdsAREF:
+    s << (elem->type() == kGdsSREF ? "SREF " : "AREF ") << elem->strname();
+    if ( elem->reflection() ) {
+      s << " reflect";
+    }
+    if ( elem->mag() != 1.0 ) {
+      s << " mag=" << elem->mag();
+    }
+    if ( elem->angle() != 0.0 ) {
+      s << " angle=" << elem->angle();
+    }
+    if ( elem->type() == kGdsAREF ) {
+      s << " " << elem->column() << "x" << elem->row();
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  const GdsXY* xy = elem->xy();
+  if ( xy != NULL && xy->num() > 0 ) {
+    s << " (" << xy->x(0) << ", " << xy->y(0) << ")";
+    if ( xy->num() > 1 ) {
+      s << " " << xy->num() << " points";
+    }
+  }
+
+  for (const GdsProperty* prop = elem->property(); prop; prop = prop->next()) {
+    s << " [" << prop->attr() << "=" << prop->value() << "]";
+  }
+}
+
+// @brief GDS-II か OASIS のファイルを読み込む．
+// @param[in] filename ファイル名
+// @param[in] parser GDS-II の時に用いるパーサー
+// @param[in] oas_parser OASIS の時に用いるパーサー
+// @return 読み込んだデータ (失敗した時は NULL)
+static
+const GdsData*
+read_file(const char* filename,
+	  GdsParser& parser,
+	  GdsOasisParser& oas_parser)
+{
+  if ( GdsOasisParser::is_oasis(filename) ) {
+    return oas_parser.parse(filename) ? oas_parser.data() : NULL;
+  }
+  return parser.parse(filename) ? parser.data() : NULL;
+}
+
+END_NAMESPACE_YM_GDS
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  bool brief = false;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-q" ) {
+      brief = true;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 2 != argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-q] <old gds2|oasis file> <new gds2|oasis file>" << endl
+	 << "  -q: print only the names of the changed structures" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  // 二つのファイルは並列に読み込む．
+  // どちらも GDS-II と OASIS のどちらでもよい．
+  GdsParser parser1;
+  GdsParser parser2;
+  GdsOasisParser oas_parser1;
+  GdsOasisParser oas_parser2;
+  oas_parser1.set_thread_num(thread_num);
+  oas_parser2.set_thread_num(thread_num);
+  const GdsData* data2 = NULL;
+  std::thread th([&]() { data2 = read_file(argv[base + 1], parser2, oas_parser2); });
+  const GdsData* data1 = read_file(argv[base], parser1, oas_parser1);
+  th.join();
+  if ( data1 == NULL || data2 == NULL ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+
+  GdsDiff diff;
+  diff.set_thread_num(thread_num);
+  if ( !diff.compute(*data1, *data2) ) {
+    return 3;
+  }
+
+  bool differ = false;
+  if ( strcmp(data1->lib_name(), data2->lib_name()) != 0 ) {
+    cout << "Library name: " << data1->lib_name()
+	 << " -> " << data2->lib_name() << endl;
+    differ = true;
+  }
+  if ( data1->user_unit() != data2->user_unit() ||
+       data1->meter_unit() != data2->meter_unit() ) {
+    cout << "Units: " << data1->user_unit() << " " << data1->meter_unit()
+	 << " -> " << data2->user_unit() << " " << data2->meter_unit() << endl;
+    differ = true;
+  }
+
+  for (ymuint i = 0; i < diff.removed_num(); ++ i) {
+    cout << "- " << diff.removed(i)->name() << endl;
+  }
+  for (ymuint i = 0; i < diff.added_num(); ++ i) {
+    cout << "+ " << diff.added(i)->name() << endl;
+  }
+  for (ymuint i = 0; i < diff.renamed_num(); ++ i) {
+    cout << "= " << diff.renamed1(i)->name()
+	 << " -> " << diff.renamed2(i)->name() << endl;
+  }
+  for (ymuint i = 0; i < diff.changed_num(); ++ i) {
+    cout << "* " << diff.changed1(i)->name();
+    if ( brief ) {
+      cout << " (" << diff.elem_diff_num(i) << " differences)" << endl;
+      continue;
+    }
+    cout << endl;
+    for (ymuint j = 0; j < diff.elem_diff_num(i); ++ j) {
+      const GdsElement* elem1 = diff.elem_diff1(i, j);
+      const GdsElement* elem2 = diff.elem_diff2(i, j);
+      switch ( diff.elem_diff_type(i, j) ) {
+      case kGdsDiffRemoved:
+	cout << "  - ";
+	print_elem(cout, elem1);
+	break;
+
+      case kGdsDiffAdded:
+	cout << "  + ";
+	print_elem(cout, elem2);
+	break;
+
+      case kGdsDiffPlacement:
+      case kGdsDiffProperty:
+	cout << "  ~ ";
+	print_elem(cout, elem1);
+	cout << endl
+	     << "    -> ";
+	print_elem(cout, elem2);
+	break;
+      }
+      cout << endl;
+    }
+  }
+
+  if ( diff.removed_num() > 0 || diff.added_num() > 0 ||
+       diff.renamed_num() > 0 || diff.changed_num() > 0 ) {
+    differ = true;
+  }
+  cout << "Structures: " << data1->struct_num() << " -> " << data2->struct_num()
+       << ", unchanged " << diff.same_num() << endl;
+
+  return differ ? 4 : 0;
+}
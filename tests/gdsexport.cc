@@ -0,0 +1,109 @@
+﻿
+/// @file gdsprint/gdsexport.cc
+/// @brief GDS-II ファイルの要素を JSON か CSV で書き出すプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsExporter.h"
+#include "YmGds/GdsScanner.h"
+#include "YmGds/Msg.h"
+#include <fstream>
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  GdsExportFormat format = kGdsExportJson;
+  const char* out_name = NULL;
+  bool verbose = false;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-f" && base + 1 < argc ) {
+      ++ base;
+      string fmt = argv[base];
+      if ( fmt == "json" ) {
+	format = kGdsExportJson;
+      }
+      else if ( fmt == "csv" ) {
+	format = kGdsExportCsv;
+      }
+      else {
+	cerr << fmt << ": unknown format" << endl;
+	return 1;
+      }
+    }
+    else if ( opt == "-o" && base + 1 < argc ) {
+      ++ base;
+      out_name = argv[base];
+    }
+    else if ( opt == "-v" ) {
+      verbose = true;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 1 != argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-f json|csv] [-o <output file>] [-v] <gds2 file>" << endl
+	 << "  -f: output format (default: json, one element per line)" << endl
+	 << "  -o: output file (default: standard output)" << endl
+	 << "  -v: print statistics to standard error" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsScanner scanner;
+  if ( !scanner.open_file(argv[base]) ) {
+    cerr << argv[base] << ": Could not open" << endl;
+    return 2;
+  }
+
+  ofstream ofs;
+  if ( out_name != NULL ) {
+    ofs.open(out_name, ios::binary);
+    if ( !ofs ) {
+      cerr << out_name << ": Could not create" << endl;
+      return 3;
+    }
+  }
+  ostream& os = (out_name != NULL) ? static_cast<ostream&>(ofs) : cout;
+
+  GdsExporter exporter(os);
+  exporter.set_format(format);
+  bool stat = exporter.write(scanner);
+  scanner.close_file();
+  os.flush();
+  if ( !os ) {
+    cerr << "Write error" << endl;
+    return 3;
+  }
+  if ( !stat ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+
+  if ( verbose ) {
+    cerr << exporter.record_num() << " records, "
+	 << exporter.struct_num() << " structures, "
+	 << exporter.elem_num() << " elements, "
+	 << exporter.byte_num() << " bytes" << endl;
+  }
+
+  return 0;
+}
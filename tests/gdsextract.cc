@@ -0,0 +1,125 @@
+﻿
+/// @file gdsprint/gdsextract.cc
+/// @brief 指定した構造とその子孫だけを取り出すプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsStructIndex.h"
+#include "YmGds/GdsWriter.h"
+#include "YmGds/Msg.h"
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  const char* out_name = NULL;
+  const char* index_name = NULL;
+  bool use_index = true;
+  bool save_index = false;
+  GdsCompType comp_type = kGdsCompNone;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-o" && base + 1 < argc ) {
+      ++ base;
+      out_name = argv[base];
+    }
+    else if ( opt == "-x" && base + 1 < argc ) {
+      ++ base;
+      index_name = argv[base];
+    }
+    else if ( opt == "-n" ) {
+      use_index = false;
+    }
+    else if ( opt == "-w" ) {
+      save_index = true;
+    }
+    else if ( opt == "-z" ) {
+      comp_type = kGdsCompGzip;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 2 > argc || out_name == NULL ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-x <index file>] [-n] [-w] [-z] -o <output file>"
+	 << " <gds2 file> <cell>..." << endl
+	 << "  -x: structure index file (default: <gds2 file>.sidx)" << endl
+	 << "  -n: do not use the structure index file" << endl
+	 << "  -w: save the structure index file when it is rebuilt" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  string filename = argv[base];
+  string idx_name = index_name != NULL ? index_name : GdsStructIndex::default_index_name(filename);
+
+  GdsStructIndex index;
+  index.set_thread_num(thread_num);
+  if ( !index.open(filename.c_str()) ) {
+    return 2;
+  }
+  // 保存した索引が使えなければ作り直す．
+  // 索引を保存するのは -w が指定された時だけ．
+  if ( !index.read_or_build(use_index ? idx_name.c_str() : NULL, save_index) ) {
+    return 2;
+  }
+
+  vector<ymuint> root_list;
+  for (int i = base + 1; i < argc; ++ i) {
+    ymuint id = index.find(argv[i]);
+    if ( id == index.struct_num() ) {
+      cerr << argv[i] << ": No such structure" << endl;
+      return 3;
+    }
+    root_list.push_back(id);
+  }
+
+  vector<ymuint> id_list;
+  if ( !index.closure(root_list, id_list) ) {
+    return 2;
+  }
+
+  GdsWriter writer;
+  if ( !writer.open_file(out_name, comp_type, 6, thread_num) ) {
+    return 3;
+  }
+  bool stat = index.copy_header(writer);
+  ymuint64 size = 0;
+  for (ymuint i = 0; stat && i < id_list.size(); ++ i) {
+    ymuint id = id_list[i];
+    stat = index.copy_struct(id, writer);
+    size += index.struct_size(id);
+  }
+  stat = stat &&
+    writer.write_nodata(kGdsENDLIB) &&
+    writer.close_file();
+  if ( !stat ) {
+    return 3;
+  }
+
+  cout << id_list.size() << " / " << index.struct_num() << " structures, "
+       << size << " bytes copied" << endl;
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+﻿
+/// @file gdsprint/gdsfilter.cc
+/// @brief 層の付け替えと要素の削除を行いながら GDS-II ファイルを写すプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsFilter.h"
+#include "YmGds/GdsScanner.h"
+#include "YmGds/GdsWriter.h"
+#include "YmGds/Msg.h"
+#include <cstdio>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief "<layer>[/<datatype>]" を読む．
+// @param[in] str 文字列
+// @param[out] layer 層番号
+// @param[out] datatype データ型 ( 省略時は -1 )
+static
+bool
+parse_layer(const char* str,
+	    int& layer,
+	    int& datatype)
+{
+  datatype = -1;
+  return sscanf(str, "%d/%d", &layer, &datatype) >= 1;
+}
+
+END_NAMESPACE_YM_GDS
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  const char* out_name = NULL;
+  GdsCompType comp_type = kGdsCompNone;
+  GdsFilter filter;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-o" && base + 1 < argc ) {
+      ++ base;
+      out_name = argv[base];
+    }
+    else if ( opt == "-z" ) {
+      comp_type = kGdsCompGzip;
+    }
+    else if ( (opt == "-k" || opt == "-d") && base + 1 < argc ) {
+      ++ base;
+      int layer;
+      int datatype;
+      if ( !parse_layer(argv[base], layer, datatype) ) {
+	cerr << argv[base] << ": illegal layer" << endl;
+	return 1;
+      }
+      if ( opt == "-k" ) {
+	filter.add_keep(layer, datatype);
+      }
+      else {
+	filter.add_drop(layer, datatype);
+      }
+    }
+    else if ( opt == "-m" && base + 1 < argc ) {
+      ++ base;
+      string arg = argv[base];
+      string::size_type p = arg.find('=');
+      int layer;
+      int datatype;
+      int new_layer;
+      int new_datatype;
+      if ( p == string::npos ||
+	   !parse_layer(arg.substr(0, p).c_str(), layer, datatype) ||
+	   !parse_layer(arg.substr(p + 1).c_str(), new_layer, new_datatype) ) {
+	cerr << arg << ": illegal layer map" << endl;
+	return 1;
+      }
+      filter.add_map(layer, datatype, new_layer, new_datatype);
+    }
+    else if ( opt == "-e" && base + 1 < argc ) {
+      ++ base;
+      string kind = argv[base];
+      GdsRtype rtype;
+      if ( kind == "boundary" ) {
+	rtype = kGdsBOUNDARY;
+      }
+      else if ( kind == "path" ) {
+	rtype = kGdsPATH;
+      }
+      else if ( kind == "sref" ) {
+	rtype = kGdsSREF;
+      }
+      else if ( kind == "aref" ) {
+	rtype = kGdsAREF;
+      }
+      else if ( kind == "text" ) {
+	rtype = kGdsTEXT;
+      }
+      else if ( kind == "node" ) {
+	rtype = kGdsNODE;
+      }
+      else if ( kind == "box" ) {
+	rtype = kGdsBOX;
+      }
+      else {
+	cerr << kind << ": unknown element kind" << endl;
+	return 1;
+      }
+      filter.drop_element(rtype);
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 1 != argc || out_name == NULL ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-z] [-k <layer>[/<dt>]]... [-d <layer>[/<dt>]]..."
+	 << " [-m <layer>[/<dt>]=<layer>[/<dt>]]..."
+	 << " [-e boundary|path|sref|aref|text|node|box]..."
+	 << " -o <output file> <gds2 file>" << endl
+	 << "  -k: keep only these layers" << endl
+	 << "  -d: drop these layers" << endl
+	 << "  -m: map layers (applied to kept elements)" << endl
+	 << "  -e: drop elements of this kind" << endl
+	 << "  -j: threads for gzip output (with -z)" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsScanner scanner;
+  if ( !scanner.open_file(argv[base]) ) {
+    cerr << argv[base] << ": Could not open" << endl;
+    return 2;
+  }
+  GdsWriter writer;
+  if ( !writer.open_file(out_name, comp_type, 6, thread_num) ) {
+    return 3;
+  }
+  bool stat = filter.filter(scanner, writer);
+  if ( !writer.close_file() ) {
+    return 3;
+  }
+  if ( !stat ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+
+  cout << filter.record_num() << " records, "
+       << filter.elem_num() << " elements, "
+       << filter.drop_num() << " dropped, "
+       << filter.map_num() << " remapped" << endl;
+
+  return 0;
+}
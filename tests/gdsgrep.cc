@@ -0,0 +1,122 @@
+﻿
+/// @file gdsprint/gdsgrep.cc
+/// @brief GDS-II ファイル中の文字列を正規表現で検索するプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsGrep.h"
+#include "YmGds/Msg.h"
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  bool count_only = false;
+  bool select = false;
+  GdsGrep grep;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-i" ) {
+      grep.set_ignore_case(true);
+    }
+    else if ( opt == "-c" ) {
+      count_only = true;
+    }
+    else if ( opt == "-t" && base + 1 < argc ) {
+      ++ base;
+      string type = argv[base];
+      GdsRtype rtype;
+      if ( type == "text" ) {
+	rtype = kGdsSTRING;
+      }
+      else if ( type == "sname" ) {
+	rtype = kGdsSNAME;
+      }
+      else if ( type == "strname" ) {
+	rtype = kGdsSTRNAME;
+      }
+      else if ( type == "propvalue" ) {
+	rtype = kGdsPROPVALUE;
+      }
+      else {
+	cerr << type << ": unknown record type" << endl;
+	return 1;
+      }
+      // 最初に -t が現れたら他の型を対象から外す．
+      if ( !select ) {
+	grep.set_target(kGdsSTRING, false);
+	grep.set_target(kGdsSNAME, false);
+	grep.set_target(kGdsSTRNAME, false);
+	grep.set_target(kGdsPROPVALUE, false);
+	select = true;
+      }
+      grep.set_target(rtype, true);
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 2 > argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-i] [-c] [-t text|sname|strname|propvalue]..."
+	 << " <gds2 file> <regex>..." << endl
+	 << "  -i: ignore case" << endl
+	 << "  -c: print only the number of matches" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  for (int i = base + 1; i < argc; ++ i) {
+    if ( !grep.add_pattern(argv[i]) ) {
+      return 1;
+    }
+  }
+
+  grep.set_thread_num(thread_num);
+  if ( !grep.scan(argv[base]) ) {
+    return 2;
+  }
+
+  if ( count_only ) {
+    cout << grep.hit_num() << endl;
+  }
+  else {
+    for (ymuint i = 0; i < grep.hit_num(); ++ i) {
+      const char* type = "";
+      switch ( grep.hit_rtype(i) ) {
+      case kGdsSTRING:    type = "STRING"; break;
+      case kGdsSNAME:     type = "SNAME"; break;
+      case kGdsSTRNAME:   type = "STRNAME"; break;
+      case kGdsPROPVALUE: type = "PROPVALUE"; break;
+      default: break;
+      }
+      cout << hex << setw(8) << setfill('0') << grep.hit_offset(i)
+	   << dec << setfill(' ')
+	   << "\t" << type
+	   << "\t" << grep.hit_struct(i)
+	   << "\t" << grep.hit_text(i) << endl;
+    }
+  }
+
+  return grep.hit_num() > 0 ? 0 : 4;
+}
@@ -0,0 +1,102 @@
+﻿
+/// @file gdsprint/gdshash.cc
+/// @brief GDS-II ファイルの構造のハッシュ値を表示するプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsParser.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsStructHash.h"
+#include "YmGds/Msg.h"
+#include <algorithm>
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  bool order_insensitive = false;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-u" ) {
+      order_insensitive = true;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 1 != argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-u] <gds2 filename>" << endl
+	 << "  -u: ignore the order of elements" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsParser parser;
+  if ( !parser.parse(argv[base]) ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+  const GdsData* data = parser.data();
+
+  GdsStructHash struct_hash;
+  struct_hash.set_thread_num(thread_num);
+  struct_hash.set_order_insensitive(order_insensitive);
+  if ( !struct_hash.compute(*data) ) {
+    return 3;
+  }
+
+  ymuint n = data->struct_num();
+  vector<pair<GdsHashValue, ymuint> > hash_list(n);
+  for (ymuint id = 0; id < n; ++ id) {
+    const GdsHashValue& hv = struct_hash.hash(id);
+    cout << hv << "  " << data->structure(id)->name() << endl;
+    hash_list[id] = make_pair(hv, id);
+  }
+
+  // 同じハッシュ値を持つ構造をまとめて表示する．
+  sort(hash_list.begin(), hash_list.end());
+  bool first = true;
+  for (ymuint i = 0; i < n; ) {
+    ymuint j = i + 1;
+    while ( j < n && hash_list[j].first == hash_list[i].first ) {
+      ++ j;
+    }
+    if ( j - i > 1 ) {
+      if ( first ) {
+	cout << endl
+	     << "Duplicates" << endl;
+	first = false;
+      }
+      cout << " ";
+      for (ymuint k = i; k < j; ++ k) {
+	cout << " " << data->structure(hash_list[k].second)->name();
+      }
+      cout << endl;
+    }
+    i = j;
+  }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+﻿
+/// @file gdsprint/gdsmerge.cc
+/// @brief 複数の GDS-II ファイルを一つにまとめるプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsMerge.h"
+#include "YmGds/GdsWriter.h"
+#include "YmGds/Msg.h"
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  const char* out_name = NULL;
+  const char* lib_name = NULL;
+  GdsCompType comp_type = kGdsCompNone;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-o" && base + 1 < argc ) {
+      ++ base;
+      out_name = argv[base];
+    }
+    else if ( opt == "-l" && base + 1 < argc ) {
+      ++ base;
+      lib_name = argv[base];
+    }
+    else if ( opt == "-z" ) {
+      comp_type = kGdsCompGzip;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 1 > argc || out_name == NULL ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-l <library name>] [-z] -o <output file>"
+	 << " <gds2 file>..." << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsMerge merge;
+  merge.set_thread_num(thread_num);
+  if ( lib_name != NULL ) {
+    merge.set_libname(lib_name);
+  }
+  for (int i = base; i < argc; ++ i) {
+    if ( !merge.add_file(argv[i]) ) {
+      return 2;
+    }
+  }
+
+  GdsWriter writer;
+  if ( !writer.open_file(out_name, comp_type, 6, thread_num) ) {
+    return 3;
+  }
+  if ( !merge.write(writer) || !writer.close_file() ) {
+    return 3;
+  }
+
+  cout << "Units: " << merge.user_unit() << " " << merge.meter_unit() << endl;
+  for (ymuint i = 0; i < merge.file_num(); ++ i) {
+    if ( merge.scale(i) != 1.0 ) {
+      cout << argv[base + i] << ": scaled by " << merge.scale(i) << endl;
+    }
+  }
+  for (ymuint i = 0; i < merge.rename_num(); ++ i) {
+    cout << argv[base + merge.rename_file(i)] << ": "
+	 << merge.rename_from(i) << " -> " << merge.rename_to(i) << endl;
+  }
+  cout << merge.struct_num() << " structures ("
+       << merge.copy_num() << " copied, "
+       << merge.struct_num() - merge.copy_num() << " rewritten), "
+       << merge.dedup_num() << " merged, "
+       << merge.rename_num() << " renamed" << endl;
+
+  return 0;
+}
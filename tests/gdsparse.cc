@@ -8,7 +8,40 @@
 
 
 #include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsData.h"
 #include "YmGds/GdsParser.h"
+#include "YmGds/GdsOasisParser.h"
+#include "YmGds/GdsProgress.h"
+#include "YmGds/Msg.h"
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// 進み具合を標準エラーに出力するハンドラ
+class ProgressPrinter :
+  public GdsProgressHandler
+{
+public:
+
+  // 進み具合を受け取る．
+  virtual
+  bool
+  operator()(const GdsProgress& progress)
+  {
+    const double mb = 1024.0 * 1024.0;
+    cerr << "\r" << static_cast<ymuint64>(progress.byte_num() / mb) << " MB";
+    if ( progress.total_size() > 0 ) {
+      cerr << " (" << (progress.byte_num() * 100 / progress.total_size()) << "%)";
+    }
+    cerr << ", " << progress.struct_num() << " structures, "
+	 << static_cast<ymuint64>(progress.throughput() / mb) << " MB/s   "
+	 << flush;
+    return true;
+  }
+
+};
+
+END_NAMESPACE_YM_GDS
 
 
 int
@@ -16,16 +49,61 @@ main(int argc,
      char** argv)
 {
   using namespace std;
+  using namespace nsYm;
   using namespace nsYm::nsGds;
 
-  if ( argc != 2 ) {
-    cerr << "USAGE: " << argv[0] << " <gds2 filename>" << endl;
+  bool recover = false;
+  bool progress = false;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-r" ) {
+      recover = true;
+    }
+    else if ( opt == "-p" ) {
+      progress = true;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 1 != argc ) {
+    cerr << "USAGE: " << argv[0] << " [-r] [-p] <gds2|oasis filename>" << endl
+	 << "  -r: skip broken records and structures (GDS-II only)" << endl
+	 << "  -p: show progress (GDS-II only)" << endl;
     return 1;
   }
 
-  GdsParser parser;
+  if ( recover ) {
+    MsgMgr& msgmgr = MsgMgr::the_mgr();
+    tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+    TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+    msgmgr.reg_handler(tmh);
+  }
 
-  bool stat = parser.parse(argv[1]);
+  bool stat;
+  if ( GdsOasisParser::is_oasis(argv[base]) ) {
+    GdsOasisParser parser;
+    stat = parser.parse(argv[base]);
+  }
+  else {
+    GdsParser parser;
+    ProgressPrinter printer;
+    parser.set_recover(recover);
+    if ( progress ) {
+      parser.set_progress(&printer);
+    }
+    stat = parser.parse(argv[base]);
+    if ( progress ) {
+      cerr << endl;
+    }
+    if ( stat && recover ) {
+      cerr << parser.data()->struct_num() << " structures read, "
+	   << parser.drop_num() << " dropped, "
+	   << parser.skip_num() << " skips" << endl;
+    }
+  }
   if ( !stat ) {
     cerr << "Error!" << endl;
     return 2;
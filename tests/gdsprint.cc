@@ -1,34 +1,129 @@
 ﻿
 /// @file gdsprint/gdsprint.cc
 /// @brief GDS-II ファイルダンププログラム
+///
+/// 構造名，バイト範囲，レコードの型で出力を絞ることができる．
 /// @author Yusuke Matsunaga (松永 裕介)
 ///
 /// Copyright (C) 2005-2012 Yusuke Matsunaga
 /// All rights reserved.
 
 
-#include "YmGds/GdsScanner.h"
+#include "YmGds/gds_nsdef.h"
 #include "YmGds/GdsDumper.h"
+#include "YmGds/GdsStructIndex.h"
 #include "YmGds/Msg.h"
+#include <cstdlib>
+
+
+BEGIN_NAMESPACE_YM_GDS
+
+// @brief "<begin>[:<end>]" を読む．
+// @param[in] str 文字列
+// @param[out] begin 先頭
+// @param[out] end 末尾 ( 省略時はファイルの末尾 )
+//
+// 数は 0x を付ければ16進数として読む．
+static
+bool
+parse_range(const char* str,
+	    ymuint64& begin,
+	    ymuint64& end)
+{
+  char* p;
+  begin = strtoull(str, &p, 0);
+  if ( p == str ) {
+    return false;
+  }
+  if ( *p == '\0' ) {
+    end = ~0ULL;
+    return true;
+  }
+  if ( *p != ':' ) {
+    return false;
+  }
+  const char* q = p + 1;
+  end = strtoull(q, &p, 0);
+  return p != q && *p == '\0' && begin <= end;
+}
+
+END_NAMESPACE_YM_GDS
+
 
 int
 main(int argc,
      char** argv)
 {
   using namespace std;
+  using namespace nsYm;
   using namespace nsYm::nsGds;
 
-  if ( argc != 2 ) {
-    cerr << "USAGE: " << argv[0] << " <gds2 filename>" << endl;
-    return 1;
+  ymuint thread_num = 0;
+  vector<string> struct_list;
+  const char* index_name = NULL;
+  bool use_index = true;
+  bool save_index = false;
+  bool has_range = false;
+  ymuint64 range_begin = 0;
+  ymuint64 range_end = 0;
+  vector<GdsRtype> rtype_list;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-s" && base + 1 < argc ) {
+      ++ base;
+      struct_list.push_back(argv[base]);
+    }
+    else if ( opt == "-x" && base + 1 < argc ) {
+      ++ base;
+      index_name = argv[base];
+    }
+    else if ( opt == "-n" ) {
+      use_index = false;
+    }
+    else if ( opt == "-w" ) {
+      save_index = true;
+    }
+    else if ( opt == "-r" && base + 1 < argc ) {
+      ++ base;
+      if ( !parse_range(argv[base], range_begin, range_end) ) {
+	cerr << argv[base] << ": illegal range" << endl;
+	return 1;
+      }
+      has_range = true;
+    }
+    else if ( opt == "-t" && base + 1 < argc ) {
+      ++ base;
+      GdsRtype rtype;
+      if ( !GdsDumper::find_rtype(argv[base], rtype) ) {
+	cerr << argv[base] << ": unknown record type" << endl;
+	return 1;
+      }
+      rtype_list.push_back(rtype);
+    }
+    else {
+      break;
+    }
   }
 
-  GdsScanner scanner;
-  GdsDumper dumper(cout);
-
-  if ( !scanner.open_file(argv[1]) ) {
-    cerr << argv[1] << ": No such file" << endl;
-    return 2;
+  if ( base + 1 != argc || (has_range && !struct_list.empty()) ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-s <structure>]... [-x <index file>] [-n] [-w]"
+	 << " [-r <begin>[:<end>]] [-t <record type>]..."
+	 << " <gds2 filename>" << endl
+	 << "  -s: dump only this structure (BGNSTR to ENDSTR)" << endl
+	 << "  -x: structure index file (default: <gds2 file>.sidx)" << endl
+	 << "  -n: do not use the structure index file" << endl
+	 << "  -w: save the structure index file when it is rebuilt" << endl
+	 << "  -r: dump only records starting in [begin, end) (byte offsets)" << endl
+	 << "      (the offsets printed point 2 bytes after the record start)" << endl
+	 << "  -t: dump only records of this type (e.g. XY, SNAME)" << endl
+	 << "  -s and -r can not be used together" << endl;
+    return 1;
   }
 
   MsgMgr& msgmgr = MsgMgr::the_mgr();
@@ -36,11 +131,53 @@ main(int argc,
   TestMsgHandler* tmh = new TestMsgHandler(msgmask);
   msgmgr.reg_handler(tmh);
 
-  while ( scanner.read_rec() ) {
-    dumper(scanner);
+  GdsDumper dumper(cout);
+  dumper.set_thread_num(thread_num);
+  for (ymuint i = 0; i < rtype_list.size(); ++ i) {
+    dumper.select_rtype(rtype_list[i]);
+  }
+
+  if ( struct_list.empty() && !has_range ) {
+    if ( !dumper.dump_file(argv[base]) ) {
+      return 2;
+    }
+    return 0;
+  }
+
+  string filename = argv[base];
+  GdsStructIndex index;
+  index.set_thread_num(thread_num);
+  if ( !index.open(filename.c_str()) ) {
+    return 2;
+  }
+
+  if ( has_range ) {
+    if ( !dumper.dump_range(index.data(), index.file_size(),
+			    range_begin, range_end) ) {
+      return 2;
+    }
+    return 0;
   }
 
-  scanner.close_file();
+  // 保存した索引が使えなければ作り直す．
+  // 索引を保存するのは -w が指定された時だけ．
+  string idx_name = index_name != NULL ? index_name : GdsStructIndex::default_index_name(filename);
+  if ( !index.read_or_build(use_index ? idx_name.c_str() : NULL, save_index) ) {
+    return 2;
+  }
+
+  for (ymuint i = 0; i < struct_list.size(); ++ i) {
+    ymuint id = index.find(struct_list[i]);
+    if ( id == index.struct_num() ) {
+      cerr << struct_list[i] << ": No such structure" << endl;
+      return 3;
+    }
+    ymuint64 offset = index.struct_offset(id);
+    ymuint64 end = offset + index.struct_size(id);
+    if ( !dumper.dump_range(index.data(), index.file_size(), offset, end) ) {
+      return 2;
+    }
+  }
 
   return 0;
 }
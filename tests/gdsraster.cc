@@ -0,0 +1,135 @@
+﻿
+/// @file gdsprint/gdsraster.cc
+/// @brief レイアウトの一部を画像に描画するプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsParser.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsRaster.h"
+#include "YmGds/Msg.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  ymuint width = 0;
+  ymuint height = 0;
+  const char* out_name = "out.png";
+  GdsRaster raster;
+  bool error = false;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-s" && base + 1 < argc ) {
+      ++ base;
+      if ( sscanf(argv[base], "%ux%u", &width, &height) < 1 ) {
+	error = true;
+      }
+    }
+    else if ( opt == "-r" && base + 1 < argc ) {
+      ++ base;
+      int x0, y0, x1, y1;
+      if ( sscanf(argv[base], "%d,%d,%d,%d", &x0, &y0, &x1, &y1) == 4 ) {
+	raster.set_window(GdsBBox(x0, y0, x1, y1));
+      }
+      else {
+	error = true;
+      }
+    }
+    else if ( opt == "-d" && base + 1 < argc ) {
+      ++ base;
+      raster.set_lod(atoi(argv[base]));
+    }
+    else if ( opt == "-c" && base + 1 < argc ) {
+      ++ base;
+      int layer;
+      int datatype;
+      ymuint32 rgb;
+      if ( sscanf(argv[base], "%d/%d=%x", &layer, &datatype, &rgb) == 3 ) {
+	raster.set_color(layer, datatype, rgb);
+      }
+      else {
+	error = true;
+      }
+    }
+    else if ( opt == "-b" && base + 1 < argc ) {
+      ++ base;
+      raster.set_background(strtoul(argv[base], NULL, 16));
+    }
+    else if ( opt == "-o" && base + 1 < argc ) {
+      ++ base;
+      out_name = argv[base];
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( error || base + 1 > argc || base + 2 < argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-s <width>[x<height>]] [-r <x0>,<y0>,<x1>,<y1>]"
+	 << " [-d <lod pixels>] [-c <layer>/<datatype>=<RRGGBB>]... [-b <RRGGBB>]"
+	 << " [-o <output file>] <gds2 file> [<top>]" << endl
+	 << "  -d: draw instances smaller than this many pixels as boxes (default 1)" << endl
+	 << "  -o: output file (PPM if it ends with .ppm, otherwise PNG)" << endl;
+    return 1;
+  }
+  const char* top_name = base + 1 < argc ? argv[base + 1] : NULL;
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsParser parser;
+  if ( !parser.parse(argv[base]) ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+  const GdsData* data = parser.data();
+
+  raster.set_thread_num(thread_num);
+  raster.set_size(width, height);
+  if ( !raster.render(*data, top_name) ) {
+    return 3;
+  }
+
+  ofstream ofs(out_name, ios::out | ios::binary);
+  if ( !ofs ) {
+    cerr << out_name << ": Could not open" << endl;
+    return 3;
+  }
+  ymuint len = strlen(out_name);
+  bool ppm = len >= 4 && strcmp(out_name + len - 4, ".ppm") == 0;
+  bool stat = ppm ? raster.write_ppm(ofs) : raster.write_png(ofs);
+  if ( !stat ) {
+    return 3;
+  }
+
+  const GdsBBox& window = raster.window();
+  cout << "Image:     " << raster.width() << " x " << raster.height() << endl
+       << "Window:    (" << window.xmin() << ", " << window.ymin() << ") - ("
+       << window.xmax() << ", " << window.ymax() << ")" << endl
+       << "Instances: " << raster.instance_num()
+       << " (" << raster.lod_num() << " drawn as boxes)" << endl;
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+﻿
+/// @file gdsprint/gdsstat.cc
+/// @brief GDS-II (あるいは OASIS) ファイルの統計情報を表示するプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsParser.h"
+#include "YmGds/GdsOasisParser.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsStat.h"
+#include "YmGds/Msg.h"
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  const char* top_name = NULL;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-t" && base + 1 < argc ) {
+      ++ base;
+      top_name = argv[base];
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 1 != argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-t <top structure>] <gds2|oasis filename>" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsParser parser;
+  GdsOasisParser oas_parser;
+  const GdsData* data = NULL;
+  if ( GdsOasisParser::is_oasis(argv[base]) ) {
+    oas_parser.set_thread_num(thread_num);
+    if ( oas_parser.parse(argv[base]) ) {
+      data = oas_parser.data();
+    }
+  }
+  else if ( parser.parse(argv[base]) ) {
+    data = parser.data();
+  }
+  if ( data == NULL ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+
+  GdsStat stat;
+  stat.set_thread_num(thread_num);
+  if ( !stat.compute(*data, top_name) ) {
+    return 3;
+  }
+
+  double meter_unit = data->meter_unit();
+  // database unit の2乗を um^2 に換算する係数
+  double area_unit = meter_unit * meter_unit * 1.0e+12;
+
+  cout << "Library:    " << data->lib_name() << endl
+       << "Structures: " << data->struct_num() << endl
+       << "Top:       ";
+  for (ymuint i = 0; i < stat.top_num(); ++ i) {
+    cout << " " << stat.top(i)->name();
+  }
+  cout << endl
+       << endl;
+
+  // 値が桁あふれしても列が繋がらないように各欄の間には空白を入れる．
+  // Vertices と Flat shapes は ymuint64 の最大桁数 (20) まで揃える．
+  cout << setw(5) << "Layer"
+       << " " << setw(5) << "Dtype"
+       << " " << setw(10) << "Boundary"
+       << " " << setw(10) << "Path"
+       << " " << setw(10) << "Box"
+       << " " << setw(10) << "Text"
+       << " " << setw(20) << "Vertices"
+       << " " << setw(20) << "Flat shapes"
+       << " " << setw(13) << "Area(um^2)"
+       << " " << setw(14) << "Perimeter(um)"
+       << "  BBox" << endl;
+  for (ymuint i = 0; i < stat.layer_num(); ++ i) {
+    const GdsLayerStat& ls = stat.layer_stat(i);
+    cout << setw(5) << ls.layer()
+	 << " " << setw(5) << ls.datatype()
+	 << " " << setw(10) << ls.boundary_num()
+	 << " " << setw(10) << ls.path_num()
+	 << " " << setw(10) << ls.box_num()
+	 << " " << setw(10) << ls.text_num()
+	 << " " << setw(20) << ls.vertex_num()
+	 << " " << setw(20) << ls.flat_num()
+	 << " " << setw(13) << setprecision(6) << ls.area() * area_unit
+	 << " " << setw(14) << setprecision(6) << ls.perimeter() * meter_unit * 1.0e+6;
+    const GdsBBox& bbox = ls.bbox();
+    if ( bbox.is_empty() ) {
+      cout << "  -";
+    }
+    else {
+      cout << "  (" << bbox.xmin() << ", " << bbox.ymin() << ") - ("
+	   << bbox.xmax() << ", " << bbox.ymax() << ")";
+    }
+    cout << endl;
+  }
+  cout << endl;
+
+  cout << "Instances" << endl;
+  for (ymuint id = 0; id < data->struct_num(); ++ id) {
+    ymuint64 count = stat.instance_count(id);
+    if ( count > 0 ) {
+      cout << setw(16) << count << "  " << data->structure(id)->name() << endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+﻿
+/// @file gdsprint/gdstext.cc
+/// @brief TEXT 要素の文字列を検索するプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsParser.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsStruct.h"
+#include "YmGds/GdsElement.h"
+#include "YmGds/GdsXY.h"
+#include "YmGds/GdsTextIndex.h"
+#include "YmGds/Msg.h"
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  char mode = 'e';
+  bool hier = false;
+  const char* top_name = NULL;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-p" ) {
+      mode = 'p';
+    }
+    else if ( opt == "-g" ) {
+      mode = 'g';
+    }
+    else if ( opt == "-t" && base + 1 < argc ) {
+      ++ base;
+      hier = true;
+      top_name = argv[base];
+    }
+    else if ( opt == "-T" ) {
+      hier = true;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 2 > argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-p|-g] [-t <top>|-T] <gds2 file> <text>..." << endl
+	 << "  -p: prefix match" << endl
+	 << "  -g: glob match ('*', '?', '[...]')" << endl
+	 << "  -t: report every placement under <top> in top coordinates" << endl
+	 << "  -T: same as -t with the single top structure" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsParser parser;
+  if ( !parser.parse(argv[base]) ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+  const GdsData* data = parser.data();
+
+  GdsTextIndex index;
+  index.set_thread_num(thread_num);
+  index.build(*data);
+  if ( hier && !index.set_top(top_name) ) {
+    return 3;
+  }
+
+  ymuint64 match_num = 0;
+  vector<ymuint> id_list;
+  vector<GdsTrans> trans_list;
+  for (int i = base + 1; i < argc; ++ i) {
+    switch ( mode ) {
+    case 'p': index.find_prefix(argv[i], id_list); break;
+    case 'g': index.find_glob(argv[i], id_list); break;
+    default:  index.find(argv[i], id_list); break;
+    }
+
+    const GdsStruct* prev_str = NULL;
+    for (ymuint j = 0; j < id_list.size(); ++ j) {
+      ymuint id = id_list[j];
+      const GdsStruct* str = index.text_struct(id);
+      const GdsElement* elem = index.text_elem(id);
+      const GdsXY* xy = elem->xy();
+      ymint32 x = xy->x(0);
+      ymint32 y = xy->y(0);
+      if ( !hier ) {
+	cout << index.text(id) << "\t" << str->name()
+	     << "\t" << elem->layer() << "/" << elem->texttype()
+	     << "\t(" << x << ", " << y << ")" << endl;
+	++ match_num;
+	continue;
+      }
+
+      if ( str != prev_str ) {
+	index.placement_list(str, trans_list);
+	prev_str = str;
+      }
+      for (ymuint k = 0; k < trans_list.size(); ++ k) {
+	ymint32 ox;
+	ymint32 oy;
+	trans_list[k].apply(x, y, ox, oy);
+	cout << index.text(id)
+	     << "\t" << elem->layer() << "/" << elem->texttype()
+	     << "\t(" << ox << ", " << oy << ")"
+	     << "\t" << str->name() << endl;
+	++ match_num;
+      }
+    }
+  }
+  cout << match_num << " matches" << endl;
+
+  return match_num > 0 ? 0 : 4;
+}
@@ -0,0 +1,86 @@
+﻿
+/// @file gdsprint/gdsvalidate.cc
+/// @brief GDS-II ファイルの内容を検査するプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsStructIndex.h"
+#include "YmGds/GdsValidator.h"
+#include "YmGds/Msg.h"
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  const char* index_name = NULL;
+  bool use_index = true;
+  bool save_index = false;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-x" && base + 1 < argc ) {
+      ++ base;
+      index_name = argv[base];
+    }
+    else if ( opt == "-n" ) {
+      use_index = false;
+    }
+    else if ( opt == "-w" ) {
+      save_index = true;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 1 != argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-x <index file>] [-n] [-w] <gds2 file>" << endl
+	 << "  -x: structure index file (default: <gds2 file>.sidx)" << endl
+	 << "  -n: do not use the structure index file" << endl
+	 << "  -w: save the structure index file when it is rebuilt" << endl;
+    return 1;
+  }
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  string filename = argv[base];
+  string idx_name = index_name != NULL ? index_name : GdsStructIndex::default_index_name(filename);
+
+  GdsStructIndex index;
+  index.set_thread_num(thread_num);
+  if ( !index.open(filename.c_str()) ) {
+    return 2;
+  }
+  // 保存した索引が使えなければ作り直す．
+  // 索引を保存するのは -w が指定された時だけ．
+  if ( !index.read_or_build(use_index ? idx_name.c_str() : NULL, save_index) ) {
+    return 2;
+  }
+
+  GdsValidator validator;
+  validator.set_thread_num(thread_num);
+  bool stat = validator.check(index);
+
+  cout << index.struct_num() << " structures, "
+       << validator.error_num() << " errors" << endl;
+
+  return stat ? 0 : 2;
+}
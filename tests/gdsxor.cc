@@ -0,0 +1,141 @@
+﻿
+/// @file gdsprint/gdsxor.cc
+/// @brief 二つの GDS-II ファイルの差分(XOR)を求めるプログラム
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2015 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "YmGds/gds_nsdef.h"
+#include "YmGds/GdsParser.h"
+#include "YmGds/GdsData.h"
+#include "YmGds/GdsWriter.h"
+#include "YmGds/GdsXor.h"
+#include "YmGds/Msg.h"
+
+
+int
+main(int argc,
+     char** argv)
+{
+  using namespace std;
+  using namespace nsYm;
+  using namespace nsYm::nsGds;
+
+  ymuint thread_num = 0;
+  ymint32 tile_size = 0;
+  const char* out_name = NULL;
+  GdsCompType comp_type = kGdsCompNone;
+  int base = 1;
+  for ( ; base < argc; ++ base) {
+    string opt = argv[base];
+    if ( opt == "-j" && base + 1 < argc ) {
+      ++ base;
+      thread_num = atoi(argv[base]);
+    }
+    else if ( opt == "-s" && base + 1 < argc ) {
+      ++ base;
+      tile_size = atoi(argv[base]);
+    }
+    else if ( opt == "-o" && base + 1 < argc ) {
+      ++ base;
+      out_name = argv[base];
+    }
+    else if ( opt == "-z" ) {
+      comp_type = kGdsCompGzip;
+    }
+    else {
+      break;
+    }
+  }
+
+  if ( base + 2 > argc || base + 4 < argc ) {
+    cerr << "USAGE: " << argv[0]
+	 << " [-j <thread num>] [-s <tile size>] [-o <output file>] [-z]"
+	 << " <gds2 file1> <gds2 file2> [<top1> [<top2>]]" << endl;
+    return 1;
+  }
+  const char* top_name1 = base + 2 < argc ? argv[base + 2] : NULL;
+  const char* top_name2 = base + 3 < argc ? argv[base + 3] : NULL;
+
+  MsgMgr& msgmgr = MsgMgr::the_mgr();
+  tMsgMask msgmask = kMsgMaskError | kMsgMaskWarning;
+  TestMsgHandler* tmh = new TestMsgHandler(msgmask);
+  msgmgr.reg_handler(tmh);
+
+  GdsParser parser1;
+  if ( !parser1.parse(argv[base]) ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+  GdsParser parser2;
+  if ( !parser2.parse(argv[base + 1]) ) {
+    cerr << "Error!" << endl;
+    return 2;
+  }
+  const GdsData* data1 = parser1.data();
+  const GdsData* data2 = parser2.data();
+
+  if ( data1->meter_unit() != data2->meter_unit() ) {
+    cerr << "Warning: database units differ ("
+	 << data1->meter_unit() << " vs " << data2->meter_unit() << ")" << endl;
+  }
+
+  GdsXor gds_xor;
+  gds_xor.set_thread_num(thread_num);
+  gds_xor.set_tile_size(tile_size);
+  if ( !gds_xor.compute(*data1, top_name1, *data2, top_name2) ) {
+    return 3;
+  }
+
+  double meter_unit = data1->meter_unit();
+  // database unit の2乗を um^2 に換算する係数
+  double area_unit = meter_unit * meter_unit * 1.0e+12;
+
+  cout << "Skipped instances: " << gds_xor.skip_num() << endl
+       << "Tiles:             " << gds_xor.dirty_tile_num()
+       << " / " << gds_xor.tile_num() << endl
+       << endl;
+
+  if ( gds_xor.layer_num() == 0 ) {
+    cout << "No differences" << endl;
+  }
+  else {
+    cout << "Layer Dtype     Shapes    Area(um^2)" << endl;
+    for (ymuint i = 0; i < gds_xor.layer_num(); ++ i) {
+      double area = static_cast<double>(gds_xor.area2(i)) * 0.5;
+      cout << setw(5) << gds_xor.layer(i)
+	   << setw(6) << gds_xor.datatype(i)
+	   << setw(11) << gds_xor.polygon_num(i)
+	   << setw(14) << setprecision(6) << area * area_unit << endl;
+    }
+  }
+
+  if ( out_name != NULL ) {
+    GdsWriter writer;
+    if ( !writer.open_file(out_name, comp_type, 6, thread_num) ) {
+      return 3;
+    }
+    bool stat = writer.write_header(data1->lib_name(),
+				    data1->user_unit(),
+				    data1->meter_unit()) &&
+      writer.write_bgnstr("XOR");
+    for (ymuint i = 0; stat && i < gds_xor.layer_num(); ++ i) {
+      for (ymuint j = 0; stat && j < gds_xor.polygon_num(i); ++ j) {
+	stat = writer.write_boundary(gds_xor.layer(i), gds_xor.datatype(i),
+				     gds_xor.polygon_data(i, j),
+				     gds_xor.point_num(i, j));
+      }
+    }
+    stat = stat &&
+      writer.write_nodata(kGdsENDSTR) &&
+      writer.write_nodata(kGdsENDLIB) &&
+      writer.close_file();
+    if ( !stat ) {
+      return 3;
+    }
+  }
+
+  return gds_xor.layer_num() == 0 ? 0 : 4;
+}